@@ -0,0 +1,46 @@
+// Example plugin probe reporting the collector's own resource usage.
+//
+//   cmake --build build --target snooper_probe_self
+//   ./build/silicon_snooper cpu --watch 500 --plugin ./build/libsnooper_probe_self.so
+//
+// (The library suffix is .dylib on macOS.)
+#include "snooper/plugin.h"
+#include <sys/resource.h>
+
+static const SnooperFieldDesc kFields[] = {
+    { "user_seconds", SNOOPER_FIELD_DOUBLE },
+    { "system_seconds", SNOOPER_FIELD_DOUBLE },
+    { "max_rss", SNOOPER_FIELD_U64 },
+    { "ctx_switches", SNOOPER_FIELD_U64 },
+};
+
+static SnooperStatus self_sample(void *state, uint64_t monotonic_ns, SnooperFieldValue *values) {
+    (void)state;
+    (void)monotonic_ns;
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    values[0].f64 = (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6;
+    values[1].f64 = (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+    values[2].u64 = (uint64_t)usage.ru_maxrss;
+    values[3].u64 = (uint64_t)(usage.ru_nvcsw + usage.ru_nivcsw);
+    return SNOOPER_OK;
+}
+
+static const SnooperProbeDescriptor kDescriptor = {
+    .abi_version = SNOOPER_PLUGIN_ABI_VERSION,
+    .name = "self",
+    .period_ns = 1000000000ULL,
+    .fields = kFields,
+    .field_count = sizeof(kFields) / sizeof(kFields[0]),
+    .init = NULL,
+    .sample = self_sample,
+    .destroy = NULL,
+};
+
+const SnooperProbeDescriptor *snooper_probe_descriptor(void) {
+    return &kDescriptor;
+}
@@ -11,7 +11,7 @@ void gui_telemetry_destroy(GuiTelemetry *telemetry) {
     snooper_telemetry_destroy(&telemetry->telemetry);
 }
 
-int gui_poll_snapshot(GuiTelemetry *telemetry, SnooperSnapshot *snapshot) {
+int gui_poll_snapshot(GuiTelemetry *telemetry, const SnooperSnapshot **snapshot) {
     if (!telemetry || !snapshot) return -1;
     SnooperStatus status = snooper_snapshot_collect(&telemetry->telemetry, snapshot);
     if (status == SNOOPER_ERR_WARMUP) {
@@ -22,8 +22,8 @@ int gui_poll_snapshot(GuiTelemetry *telemetry, SnooperSnapshot *snapshot) {
 
 const SnooperSystemInfo *gui_system_info(const GuiTelemetry *telemetry) {
     if (!telemetry) return NULL;
-    if (telemetry->telemetry.system_info_loaded) {
-        return &telemetry->telemetry.system_info;
+    if (telemetry->telemetry.session.has_system_info) {
+        return &telemetry->telemetry.session.system_info;
     }
     return NULL;
 }
@@ -9,7 +9,7 @@ typedef struct {
 
 int gui_telemetry_init(GuiTelemetry *telemetry, int show_identifiers);
 void gui_telemetry_destroy(GuiTelemetry *telemetry);
-int gui_poll_snapshot(GuiTelemetry *telemetry, SnooperSnapshot *snapshot);
+int gui_poll_snapshot(GuiTelemetry *telemetry, const SnooperSnapshot **snapshot);
 const SnooperSystemInfo *gui_system_info(const GuiTelemetry *telemetry);
 
 #endif
@@ -224,18 +224,18 @@ static NSString *gui_format_uptime(uint64_t seconds) {
 
 - (void)pollTelemetry {
     if (_telemetry) {
-        SnooperSnapshot snapshot = {0};
+        const SnooperSnapshot *snapshot = NULL;
         int rc = gui_poll_snapshot(_telemetry, &snapshot);
         if (rc == 0) {
-            double cpu_used = snapshot.cpu_used_percent;
+            double cpu_used = snapshot->cpu_used_percent;
             if (cpu_used < 0.0) cpu_used = 0.0;
             if (cpu_used > 100.0) cpu_used = 100.0;
             gui_ring_buffer_push(_cpuBuffer, cpu_used);
             self.cpuView.latestValue = cpu_used;
             self.cpuView.metricAvailable = YES;
 
-            if (snapshot.gpu_available) {
-                double gpu_val = snapshot.gpu_used_percent;
+            if (snapshot->gpu_available) {
+                double gpu_val = snapshot->gpu_used_percent;
                 if (gpu_val < 0.0) gpu_val = 0.0;
                 if (gpu_val > 100.0) gpu_val = 100.0;
                 gui_ring_buffer_push(_gpuBuffer, gpu_val);
@@ -246,7 +246,7 @@ static NSString *gui_format_uptime(uint64_t seconds) {
                 self.gpuView.metricAvailable = NO;
             }
 
-            self.latestMetrics = snapshot.system_metrics;
+            self.latestMetrics = snapshot->system_metrics;
         }
     }
 
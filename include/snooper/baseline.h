@@ -0,0 +1,21 @@
+#ifndef SNOOPER_BASELINE_H
+#define SNOOPER_BASELINE_H
+
+#include "snooper/cpu.h"
+#include "snooper/errors.h"
+
+#define SNOOPER_BASELINE_MAGIC "SNPBASE1"
+#define SNOOPER_BASELINE_VERSION 1
+
+// Per-core tick counters persisted between short-lived runs so the first
+// sample of the next run already has a delta. The file is stamped with the
+// boot id and core count; a different boot is rejected on load and a changed
+// core count by cpu_probe_sample, which then starts over from a warmup. Both
+// calls need a real, non-empty boot id, and load also rejects ticks stamped
+// later than now_ns. The file is rewritten atomically so concurrent runs
+// never see a torn one.
+SnooperStatus snooper_baseline_save(const char *path, const char *boot_id, const SnooperCpuSample *sample);
+SnooperStatus snooper_baseline_load(const char *path, const char *boot_id, uint64_t now_ns, SnooperCpuSample *out);
+void snooper_baseline_free(SnooperCpuSample *sample);
+
+#endif
@@ -3,9 +3,10 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <time.h>
 #include "snooper/errors.h"
 
+#define SNOOPER_MAX_CPUS 512
+
 typedef struct {
     uint64_t user;
     uint64_t system;
@@ -15,7 +16,6 @@ typedef struct {
 
 typedef struct {
     uint64_t monotonic_ns;
-    struct timespec wall_time;
     SnooperCpuTicks *cores;
     size_t core_count;
 } SnooperCpuSample;
@@ -31,7 +31,6 @@ typedef struct {
     SnooperCpuUsage *per_core;
     size_t core_count;
     uint64_t monotonic_ns;
-    struct timespec wall_time;
 } SnooperCpuUsageReport;
 
 typedef struct {
@@ -41,7 +40,9 @@ typedef struct {
 
 SnooperStatus cpu_probe_init(CpuProbe *probe);
 void cpu_probe_destroy(CpuProbe *probe);
-SnooperStatus cpu_probe_sample(CpuProbe *probe, SnooperCpuUsageReport *report);
+SnooperStatus cpu_probe_sample(CpuProbe *probe, uint64_t monotonic_ns, SnooperCpuUsageReport *report);
+SnooperStatus cpu_probe_seed(CpuProbe *probe, const SnooperCpuSample *baseline);
+const SnooperCpuSample *cpu_probe_baseline(const CpuProbe *probe);
 void cpu_usage_report_destroy(SnooperCpuUsageReport *report);
 
 #endif
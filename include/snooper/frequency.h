@@ -0,0 +1,81 @@
+#ifndef SNOOPER_FREQUENCY_H
+#define SNOOPER_FREQUENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/cpu.h"
+#include "snooper/errors.h"
+#include "snooper/read_engine.h"
+
+#define SNOOPER_MAX_THERMAL_ZONES 32
+#define SNOOPER_THERMAL_TYPE_MAX 24
+
+typedef struct {
+    int present;
+    double current_mhz;
+    double max_mhz;
+    double effective_mhz;
+    double used_percent;
+    double normalized_used_percent;
+    uint64_t core_throttles;
+    uint64_t package_throttles;
+} SnooperFreqCore;
+
+typedef struct {
+    char type[SNOOPER_THERMAL_TYPE_MAX];
+    double celsius;
+} SnooperThermalZone;
+
+typedef struct {
+    SnooperFreqCore cores[SNOOPER_MAX_CPUS];
+    size_t core_count;
+    SnooperThermalZone zones[SNOOPER_MAX_THERMAL_ZONES];
+    size_t zone_count;
+    int has_msr;
+    uint64_t monotonic_ns;
+} SnooperFreqStats;
+
+typedef struct {
+    int cur_fd;
+    int msr_fd;
+    int core_throttle_fd;
+    int package_throttle_fd;
+    int cur_slot;
+    int core_throttle_slot;
+    int package_throttle_slot;
+    uint64_t max_khz;
+    uint64_t base_khz;
+    uint64_t previous_aperf;
+    uint64_t previous_mperf;
+    uint64_t previous_core_throttles;
+    uint64_t previous_package_throttles;
+    int has_previous;
+} SnooperFreqCpuState;
+
+typedef struct {
+    int temp_fd;
+    int temp_slot;
+    char type[SNOOPER_THERMAL_TYPE_MAX];
+} SnooperThermalZoneState;
+
+typedef struct {
+    char root[256];
+    SnooperFreqCpuState *cpus;
+    size_t cpu_count;
+    SnooperThermalZoneState zones[SNOOPER_MAX_THERMAL_ZONES];
+    size_t zone_count;
+    SnooperReadEngine reads;
+    int initialized;
+} FreqProbe;
+
+SnooperStatus freq_probe_init(FreqProbe *probe, const char *root);
+void freq_probe_destroy(FreqProbe *probe);
+// used_percent is each core's average busy percent since the previous freq
+// sample; it may be NULL.
+SnooperStatus freq_probe_sample(FreqProbe *probe,
+                                uint64_t monotonic_ns,
+                                const double *used_percent,
+                                size_t core_count,
+                                SnooperFreqStats *stats);
+
+#endif
@@ -2,14 +2,12 @@
 #define SNOOPER_GPU_H
 
 #include <stdint.h>
-#include <time.h>
 #include "snooper/errors.h"
 
 typedef struct {
     int available;
     double utilization_percent;
     uint64_t monotonic_ns;
-    struct timespec wall_time;
 } SnooperGpuSample;
 
 typedef struct {
@@ -18,6 +16,6 @@ typedef struct {
 
 SnooperStatus gpu_probe_init(GpuProbe *probe);
 void gpu_probe_destroy(GpuProbe *probe);
-SnooperStatus gpu_probe_sample(GpuProbe *probe, SnooperGpuSample *sample);
+SnooperStatus gpu_probe_sample(GpuProbe *probe, uint64_t monotonic_ns, SnooperGpuSample *sample);
 
 #endif
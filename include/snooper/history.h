@@ -0,0 +1,104 @@
+#ifndef SNOOPER_HISTORY_H
+#define SNOOPER_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+#include "snooper/tsstore.h"
+
+#define SNOOPER_HISTORY_MAGIC "SNPHIST1"
+#define SNOOPER_HISTORY_VERSION 2
+#define SNOOPER_HISTORY_INDEX_SUFFIX ".idx"
+
+// On-disk history is a log of compressed blocks after a one-page header,
+// plus an index file beside it holding each block's series name and summary
+// (the sparse time index). Both only ever grow by whole records, so a writer
+// appends each block once after it seals. Queries binary-search the
+// summaries and only touch mapped pages of blocks they cannot answer from a
+// summary.
+typedef struct {
+    uint64_t first_ns;
+    uint64_t last_ns;
+    double min;
+    double max;
+    double sum;
+    uint32_t count;
+    uint32_t bit_length;
+} SnooperHistorySummary;
+
+typedef struct {
+    char name[SNOOPER_TS_NAME_MAX];
+    uint32_t first_block;
+    uint32_t block_count;
+    uint64_t reserved;
+} SnooperHistorySeries;
+
+// Series, summaries and block pointers are rebuilt from the index on open,
+// grouped so each series' blocks are contiguous and in time order.
+typedef struct {
+    void *map;
+    size_t map_size;
+    uint64_t resolution_ns;
+    int64_t wall_offset_ns;
+    uint64_t session_id;
+    uint64_t first_ns;
+    uint64_t last_ns;
+    SnooperHistorySeries *series;
+    size_t series_count;
+    SnooperHistorySummary *summaries;
+    const SnooperTsBlock **blocks;
+    size_t block_count;
+} SnooperHistory;
+
+// Appends sealed blocks to a history as the store seals them. Each flush
+// also writes the open block of every series as a provisional tail, which
+// the next flush truncates and replaces, so a crash loses at most one flush
+// interval.
+typedef struct {
+    int data_fd;
+    int index_fd;
+    uint64_t committed_blocks;
+} SnooperHistoryWriter;
+
+typedef enum {
+    SNOOPER_AGG_AVG,
+    SNOOPER_AGG_MIN,
+    SNOOPER_AGG_MAX,
+    SNOOPER_AGG_SUM,
+    SNOOPER_AGG_COUNT,
+    SNOOPER_AGG_PERCENTILE
+} SnooperAggregation;
+
+typedef struct {
+    int series;
+    uint64_t from_ns;
+    uint64_t to_ns;
+    uint64_t bucket_ns;
+    SnooperAggregation aggregation;
+    double percentile;
+} SnooperHistoryQuery;
+
+typedef struct {
+    uint64_t start_ns;
+    size_t count;
+    double value;
+} SnooperHistoryBucket;
+
+typedef struct {
+    SnooperHistoryBucket *buckets;
+    size_t bucket_count;
+    size_t bucket_capacity;
+    size_t blocks_decoded;
+    size_t blocks_summarized;
+} SnooperHistoryResult;
+
+SnooperStatus snooper_history_writer_open(SnooperHistoryWriter *writer, const char *path, uint64_t resolution_ns, uint64_t session_id, int64_t wall_offset_ns);
+SnooperStatus snooper_history_writer_flush(SnooperHistoryWriter *writer, SnooperTsStore *store);
+SnooperStatus snooper_history_writer_close(SnooperHistoryWriter *writer);
+SnooperStatus snooper_history_open(SnooperHistory *history, const char *path);
+void snooper_history_close(SnooperHistory *history);
+int snooper_history_find_series(const SnooperHistory *history, const char *name);
+SnooperStatus snooper_history_query(const SnooperHistory *history, const SnooperHistoryQuery *query, SnooperHistoryResult *out);
+void snooper_history_result_destroy(SnooperHistoryResult *result);
+
+#endif
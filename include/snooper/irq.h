@@ -0,0 +1,64 @@
+#ifndef SNOOPER_IRQ_H
+#define SNOOPER_IRQ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/cpu.h"
+#include "snooper/errors.h"
+
+#define SNOOPER_IRQ_TOP_SOURCES 3
+#define SNOOPER_IRQ_NAME_MAX 24
+
+typedef struct {
+    char name[SNOOPER_IRQ_NAME_MAX];
+    double per_sec;
+} SnooperIrqSource;
+
+typedef struct {
+    int present;
+    double irqs_per_sec;
+    double softirqs_per_sec;
+    SnooperIrqSource top[SNOOPER_IRQ_TOP_SOURCES];
+    size_t top_count;
+} SnooperIrqCore;
+
+typedef struct {
+    SnooperIrqCore cores[SNOOPER_MAX_CPUS];
+    size_t core_count;
+    uint64_t monotonic_ns;
+} SnooperIrqStats;
+
+typedef struct {
+    const char *path;
+    int fd;
+    char *text;
+    size_t text_size;
+    uint64_t header_hash;
+    size_t column_count;
+    size_t row_count;
+    size_t row_capacity;
+    void *block;
+    int *column_cpu;
+    char (*row_names)[SNOOPER_IRQ_NAME_MAX];
+    uint64_t *row_hash;
+    unsigned char *row_active;
+    uint64_t *counts;
+    uint64_t *values;
+    double *rates;
+    int has_previous;
+} SnooperIrqTable;
+
+typedef struct {
+    char root[256];
+    SnooperIrqTable hard;
+    SnooperIrqTable soft;
+    uint64_t previous_ns;
+    int initialized;
+} IrqProbe;
+
+SnooperStatus irq_probe_init(IrqProbe *probe, const char *root);
+void irq_probe_destroy(IrqProbe *probe);
+SnooperStatus irq_probe_sample(IrqProbe *probe, uint64_t monotonic_ns, SnooperIrqStats *stats);
+const double *irq_probe_rate_matrix(const IrqProbe *probe, int softirq, size_t *rows, size_t *columns);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SNOOPER_METRICS_H
+#define SNOOPER_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+#include "snooper/telemetry.h"
+
+#define SNOOPER_METRIC_NAME_MAX 48
+#define SNOOPER_METRIC_LABEL_MAX 32
+#define SNOOPER_METRIC_ANY_INDEX (-1)
+
+typedef enum {
+    SNOOPER_METRIC_CPU_USED,
+    SNOOPER_METRIC_GPU_USED,
+    SNOOPER_METRIC_POWER_PACKAGE_WATTS,
+    SNOOPER_METRIC_POWER_JOULES_PER_BUSY_CORE_SECOND,
+    SNOOPER_METRIC_SCHED_CONTEXT_SWITCHES,
+    SNOOPER_METRIC_SCHED_PROCS_RUNNING,
+    SNOOPER_METRIC_SCHED_PROCS_BLOCKED,
+    SNOOPER_METRIC_CORE_USED,
+    SNOOPER_METRIC_CORE_USER,
+    SNOOPER_METRIC_CORE_SYSTEM,
+    SNOOPER_METRIC_CORE_RUN_MS,
+    SNOOPER_METRIC_CORE_WAIT_MS,
+    SNOOPER_METRIC_CORE_TIMESLICES,
+    SNOOPER_METRIC_CORE_IRQS,
+    SNOOPER_METRIC_CORE_SOFTIRQS,
+    SNOOPER_METRIC_CORE_MHZ,
+    SNOOPER_METRIC_CORE_EFFECTIVE_MHZ,
+    SNOOPER_METRIC_CORE_NORMALIZED_USED,
+    SNOOPER_METRIC_THERMAL_CELSIUS,
+    SNOOPER_METRIC_NET_RX_BYTES,
+    SNOOPER_METRIC_NET_TX_BYTES,
+    SNOOPER_METRIC_NET_RX_PACKETS,
+    SNOOPER_METRIC_NET_TX_PACKETS,
+    SNOOPER_METRIC_NET_RX_ERRORS,
+    SNOOPER_METRIC_NET_TX_ERRORS,
+    SNOOPER_METRIC_NET_RX_DROPS,
+    SNOOPER_METRIC_NET_TX_DROPS,
+    SNOOPER_METRIC_TOPOLOGY_USED,
+    SNOOPER_METRIC_PLUGIN_VALUE,
+    SNOOPER_METRIC_FIELD_COUNT
+} SnooperMetricField;
+
+// Names follow "cpu.used", "cpu.core[17].used", "thermal[0].celsius",
+// "net.en0.rx_bytes", "topology.package[0].used" and "plugin.<probe>.<field>".
+// An index of "*" parses to SNOOPER_METRIC_ANY_INDEX, and a "*" interface
+// name or "plugin.*" to an empty label.
+typedef struct {
+    SnooperMetricField field;
+    int index;
+    char label[SNOOPER_METRIC_LABEL_MAX];
+} SnooperMetricId;
+
+typedef void (*SnooperMetricVisitor)(void *context, const SnooperMetricId *id, double value);
+typedef void (*SnooperMetricInstanceVisitor)(void *context, const SnooperMetricId *id, size_t slot, double value);
+
+SnooperStatus snooper_metric_parse(const char *name, SnooperMetricId *out);
+int snooper_metric_format(const SnooperMetricId *id, char *buffer, size_t size);
+int snooper_metric_is_pattern(const SnooperMetricId *id);
+int snooper_metric_matches(const SnooperMetricId *pattern, const SnooperMetricId *id);
+int snooper_metric_read(const SnooperSnapshot *snapshot, const SnooperMetricId *id, double *value);
+// Monotonic time the probe behind id last sampled; 0 if it never has.
+uint64_t snooper_metric_updated_ns(const SnooperSnapshot *snapshot, const SnooperMetricId *id);
+size_t snooper_metric_slot_count(const SnooperMetricId *pattern);
+void snooper_metric_expand(const SnooperSnapshot *snapshot, const SnooperMetricId *pattern, SnooperMetricInstanceVisitor visitor, void *context);
+void snooper_metric_visit(const SnooperSnapshot *snapshot, SnooperMetricVisitor visitor, void *context);
+
+#endif
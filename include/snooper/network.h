@@ -0,0 +1,68 @@
+#ifndef SNOOPER_NETWORK_H
+#define SNOOPER_NETWORK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+
+#define SNOOPER_MAX_NET_INTERFACES 32
+#define SNOOPER_NET_NAME_MAX 16
+
+typedef struct {
+    uint64_t rx_bytes;
+    uint64_t rx_packets;
+    uint64_t rx_errors;
+    uint64_t rx_drops;
+    uint64_t tx_bytes;
+    uint64_t tx_packets;
+    uint64_t tx_errors;
+    uint64_t tx_drops;
+} SnooperNetCounters;
+
+typedef struct {
+    int index;
+    int present;
+    char name[SNOOPER_NET_NAME_MAX];
+    double rx_bytes_per_sec;
+    double tx_bytes_per_sec;
+    double rx_packets_per_sec;
+    double tx_packets_per_sec;
+    uint64_t rx_errors;
+    uint64_t tx_errors;
+    uint64_t rx_drops;
+    uint64_t tx_drops;
+    SnooperNetCounters totals;
+} SnooperNetInterface;
+
+typedef struct {
+    SnooperNetInterface interfaces[SNOOPER_MAX_NET_INTERFACES];
+    size_t interface_count;
+    uint64_t monotonic_ns;
+} SnooperNetworkStats;
+
+typedef enum {
+    SNOOPER_NET_SOURCE_PROCFS,
+    SNOOPER_NET_SOURCE_SYSFS,
+    SNOOPER_NET_SOURCE_SYSCTL
+} SnooperNetSource;
+
+typedef struct {
+    char root[256];
+    SnooperNetSource source;
+    int dev_fd;
+    char *buffer;
+    size_t buffer_size;
+    char names[SNOOPER_MAX_NET_INTERFACES][SNOOPER_NET_NAME_MAX];
+    SnooperNetCounters previous[SNOOPER_MAX_NET_INTERFACES];
+    int has_previous[SNOOPER_MAX_NET_INTERFACES];
+    uint64_t last_seen_ns[SNOOPER_MAX_NET_INTERFACES];
+    size_t slot_count;
+    uint64_t previous_ns;
+    int initialized;
+} NetProbe;
+
+SnooperStatus net_probe_init(NetProbe *probe, const char *root);
+void net_probe_destroy(NetProbe *probe);
+SnooperStatus net_probe_sample(NetProbe *probe, uint64_t monotonic_ns, SnooperNetworkStats *stats);
+
+#endif
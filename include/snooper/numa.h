@@ -0,0 +1,84 @@
+#ifndef SNOOPER_NUMA_H
+#define SNOOPER_NUMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+#include "snooper/read_engine.h"
+
+#define SNOOPER_MAX_NUMA_NODES 64
+
+typedef enum {
+    SNOOPER_NUMA_HIT,
+    SNOOPER_NUMA_MISS,
+    SNOOPER_NUMA_FOREIGN,
+    SNOOPER_NUMA_INTERLEAVE_HIT,
+    SNOOPER_NUMA_LOCAL,
+    SNOOPER_NUMA_OTHER,
+    SNOOPER_NUMA_COUNTER_COUNT
+} SnooperNumaCounter;
+
+typedef enum {
+    SNOOPER_NUMA_VM_PGMIGRATE_SUCCESS,
+    SNOOPER_NUMA_VM_PGMIGRATE_FAIL,
+    SNOOPER_NUMA_VM_PAGES_MIGRATED,
+    SNOOPER_NUMA_VM_HINT_FAULTS,
+    SNOOPER_NUMA_VM_HINT_FAULTS_LOCAL,
+    SNOOPER_NUMA_VM_COUNTER_COUNT
+} SnooperNumaVmCounter;
+
+// Allocation rates are in pages per second, from the node's numastat:
+// hit/miss count allocations that landed on this node as intended or not,
+// foreign counts allocations meant for this node that landed elsewhere.
+typedef struct {
+    int id;
+    uint64_t total_bytes;
+    uint64_t free_bytes;
+    uint64_t used_bytes;
+    double hit_per_sec;
+    double miss_per_sec;
+    double foreign_per_sec;
+    double local_per_sec;
+    double other_per_sec;
+} SnooperNumaNode;
+
+typedef struct {
+    SnooperNumaNode nodes[SNOOPER_MAX_NUMA_NODES];
+    size_t node_count;
+    double pages_migrated_per_sec;
+    double migrate_failures_per_sec;
+    double balancing_migrated_per_sec;
+    double hint_faults_per_sec;
+    double hint_faults_local_percent;
+    int has_vmstat;
+    uint64_t monotonic_ns;
+} SnooperNumaStats;
+
+typedef struct {
+    int id;
+    int meminfo_fd;
+    int numastat_fd;
+    int meminfo_slot;
+    int numastat_slot;
+    uint64_t previous[SNOOPER_NUMA_COUNTER_COUNT];
+    int has_previous;
+} SnooperNumaNodeState;
+
+typedef struct {
+    char root[256];
+    SnooperNumaNodeState nodes[SNOOPER_MAX_NUMA_NODES];
+    size_t node_count;
+    int vmstat_fd;
+    int vmstat_slot;
+    uint64_t previous_vm[SNOOPER_NUMA_VM_COUNTER_COUNT];
+    int has_previous_vm;
+    SnooperReadEngine reads;
+    uint64_t previous_ns;
+    int initialized;
+} NumaProbe;
+
+SnooperStatus numa_probe_init(NumaProbe *probe, const char *root);
+void numa_probe_destroy(NumaProbe *probe);
+SnooperStatus numa_probe_sample(NumaProbe *probe, uint64_t monotonic_ns, SnooperNumaStats *stats);
+
+#endif
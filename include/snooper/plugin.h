@@ -0,0 +1,71 @@
+#ifndef SNOOPER_PLUGIN_H
+#define SNOOPER_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+
+#define SNOOPER_PLUGIN_ABI_VERSION 1
+#define SNOOPER_PLUGIN_ENTRY "snooper_probe_descriptor"
+#define SNOOPER_PLUGIN_MAX 16
+#define SNOOPER_PLUGIN_MAX_FIELDS 64
+#define SNOOPER_PLUGIN_MAX_VALUES 256
+#define SNOOPER_PLUGIN_NAME_MAX 16
+
+typedef enum {
+    SNOOPER_FIELD_DOUBLE,
+    SNOOPER_FIELD_U64,
+    SNOOPER_FIELD_I64
+} SnooperFieldType;
+
+typedef struct {
+    const char *name;
+    SnooperFieldType type;
+} SnooperFieldDesc;
+
+typedef union {
+    double f64;
+    uint64_t u64;
+    int64_t i64;
+} SnooperFieldValue;
+
+// The stable probe interface. A shared object exports SNOOPER_PLUGIN_ENTRY as
+// a SnooperProbeEntry returning a descriptor that outlives the process.
+// Probe and field names are [a-z0-9_] and shorter than
+// SNOOPER_PLUGIN_NAME_MAX. sample() fills exactly field_count preallocated
+// values owned by the collector and must not allocate; period_ns is the
+// default schedule (0 samples on every collect).
+typedef struct {
+    uint32_t abi_version;
+    const char *name;
+    uint64_t period_ns;
+    const SnooperFieldDesc *fields;
+    size_t field_count;
+    SnooperStatus (*init)(void **state, const char *root);
+    SnooperStatus (*sample)(void *state, uint64_t monotonic_ns, SnooperFieldValue *values);
+    void (*destroy)(void *state);
+} SnooperProbeDescriptor;
+
+typedef const SnooperProbeDescriptor *(*SnooperProbeEntry)(void);
+
+typedef struct {
+    const SnooperProbeDescriptor *descriptor;
+    void *handle;
+    void *state;
+    size_t value_offset;
+    uint64_t period_ns;
+} SnooperPluginProbe;
+
+typedef struct {
+    SnooperPluginProbe probes[SNOOPER_PLUGIN_MAX];
+    size_t count;
+    size_t value_count;
+} SnooperPluginSet;
+
+SnooperStatus snooper_plugin_register(SnooperPluginSet *set, const SnooperProbeDescriptor *descriptor, void *handle, char *error, size_t error_size);
+SnooperStatus snooper_plugin_load(SnooperPluginSet *set, const char *path, char *error, size_t error_size);
+void snooper_plugin_unload_all(SnooperPluginSet *set);
+int snooper_plugin_find_field(const SnooperPluginSet *set, const char *label, size_t *value_index, size_t *probe_index);
+double snooper_plugin_value_as_double(SnooperFieldType type, SnooperFieldValue value);
+
+#endif
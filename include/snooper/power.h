@@ -0,0 +1,56 @@
+#ifndef SNOOPER_POWER_H
+#define SNOOPER_POWER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+#include "snooper/read_engine.h"
+
+#define SNOOPER_MAX_POWER_DOMAINS 16
+#define SNOOPER_POWER_NAME_MAX 32
+
+typedef struct {
+    char name[SNOOPER_POWER_NAME_MAX];
+    int is_package;
+    double watts;
+    double joules;
+} SnooperPowerDomain;
+
+typedef struct {
+    int available;
+    SnooperPowerDomain domains[SNOOPER_MAX_POWER_DOMAINS];
+    size_t domain_count;
+    double package_watts;
+    double joules_per_busy_core_second;
+    uint64_t monotonic_ns;
+} SnooperPowerSample;
+
+typedef struct {
+    int energy_fd;
+    int energy_slot;
+    char name[SNOOPER_POWER_NAME_MAX];
+    int is_package;
+    uint64_t max_energy_uj;
+    uint64_t previous_uj;
+    int has_previous;
+} SnooperPowerDomainState;
+
+typedef struct {
+    char root[256];
+    SnooperPowerDomainState domains[SNOOPER_MAX_POWER_DOMAINS];
+    size_t domain_count;
+    SnooperReadEngine reads;
+    uint64_t previous_ns;
+    int initialized;
+} PowerProbe;
+
+SnooperStatus power_probe_init(PowerProbe *probe, const char *root);
+void power_probe_destroy(PowerProbe *probe);
+// busy_core_seconds is the CPU busy time, summed over cores, since the
+// previous power sample.
+SnooperStatus power_probe_sample(PowerProbe *probe,
+                                 uint64_t monotonic_ns,
+                                 double busy_core_seconds,
+                                 SnooperPowerSample *sample);
+
+#endif
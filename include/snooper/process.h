@@ -0,0 +1,71 @@
+#ifndef SNOOPER_PROCESS_H
+#define SNOOPER_PROCESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+#include "snooper/read_engine.h"
+
+#define SNOOPER_TOP_PROCESSES 16
+#define SNOOPER_PROCESS_NAME_MAX 32
+
+typedef struct {
+    int pid;
+    char name[SNOOPER_PROCESS_NAME_MAX];
+    char state;
+    double cpu_percent;
+    uint64_t rss_bytes;
+    uint64_t threads;
+} SnooperProcess;
+
+// cpu_percent is relative to one core, as in top(1), so a process can exceed
+// 100%. Only the busiest SNOOPER_TOP_PROCESSES are kept.
+typedef struct {
+    SnooperProcess top[SNOOPER_TOP_PROCESSES];
+    size_t top_count;
+    size_t process_count;
+    uint64_t thread_count;
+    uint64_t monotonic_ns;
+} SnooperProcessStats;
+
+typedef struct {
+    int pid;
+    uint64_t start_time;
+    uint64_t ticks;
+} SnooperProcessTicks;
+
+// fd is the pid's persistent /proc/<pid>/stat, or -1 when the pid is read
+// with a plain open/read/close (over the fd budget, or its fd went stale).
+typedef struct {
+    int pid;
+    int fd;
+    int slot;
+} SnooperProcessFd;
+
+typedef struct {
+    char root[256];
+    SnooperProcessFd *fds;
+    SnooperProcessFd *next_fds;
+    size_t fd_count;
+    size_t fd_capacity;
+    size_t open_fds;
+    size_t fd_budget;
+    int *pids;
+    size_t pid_capacity;
+    SnooperReadEngine reads;
+    SnooperProcessTicks *previous;
+    size_t previous_count;
+    size_t previous_capacity;
+    SnooperProcessTicks *current;
+    size_t capacity;
+    uint64_t previous_ns;
+    double ticks_per_sec;
+    uint64_t page_size;
+    int initialized;
+} ProcessProbe;
+
+SnooperStatus process_probe_init(ProcessProbe *probe, const char *root);
+void process_probe_destroy(ProcessProbe *probe);
+SnooperStatus process_probe_sample(ProcessProbe *probe, uint64_t monotonic_ns, SnooperProcessStats *stats);
+
+#endif
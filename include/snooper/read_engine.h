@@ -0,0 +1,67 @@
+#ifndef SNOOPER_READ_ENGINE_H
+#define SNOOPER_READ_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "snooper/errors.h"
+
+typedef struct {
+    int fd;
+    size_t offset;
+    size_t capacity;
+    size_t length;
+    int ok;
+} SnooperReadSlot;
+
+typedef struct {
+    int ring_fd;
+    unsigned entries;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    void *sqes;
+    size_t sqes_size;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    void *cqes;
+    int files_registered;
+    int buffers_registered;
+} SnooperUring;
+
+// Re-reads a fixed set of persistent procfs/sysfs fds at offset 0 in one go.
+// Each slot gets its own region of a single arena. On Linux the fds and the
+// arena are registered with an io_uring once, and a submit is one
+// io_uring_enter per ring-full of slots. Elsewhere, or when io_uring is
+// unavailable or disabled with SNOOPER_READ_ENGINE=preadv, it falls back to
+// one preadv per slot. Each slot is read with a single read, which returns
+// the whole file for sysfs attributes and seq_file-backed procfs files up to
+// the slot's capacity.
+typedef struct {
+    SnooperReadSlot *slots;
+    struct iovec *iov;
+    size_t slot_count;
+    size_t slot_capacity;
+    char *arena;
+    size_t arena_used;
+    size_t arena_capacity;
+    int use_uring;
+    int dirty;
+    SnooperUring uring;
+    uint64_t syscalls;
+} SnooperReadEngine;
+
+SnooperStatus snooper_read_engine_init(SnooperReadEngine *engine, int use_uring);
+void snooper_read_engine_destroy(SnooperReadEngine *engine);
+int snooper_read_engine_add(SnooperReadEngine *engine, int fd, size_t capacity);
+void snooper_read_engine_clear(SnooperReadEngine *engine);
+SnooperStatus snooper_read_engine_submit(SnooperReadEngine *engine);
+const char *snooper_read_engine_view(const SnooperReadEngine *engine, int slot, size_t *length);
+const char *snooper_read_engine_backend(const SnooperReadEngine *engine);
+
+#endif
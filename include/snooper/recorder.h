@@ -0,0 +1,44 @@
+#ifndef SNOOPER_RECORDER_H
+#define SNOOPER_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+#include "snooper/telemetry.h"
+
+#define SNOOPER_RECORDER_MAGIC "SNPREC01"
+#define SNOOPER_RECORDER_VERSION 1
+#define SNOOPER_RECORDER_HEADER_SIZE 48
+#define SNOOPER_RECORDER_FIXED_SIZE 16
+#define SNOOPER_RECORDER_NO_VALUE 0xFFFFu
+
+typedef struct {
+    uint64_t session_id;
+    int64_t wall_offset_ns;
+    uint32_t core_count;
+    uint32_t record_size;
+    uint32_t interval_ms;
+    uint32_t record_count;
+} SnooperRecorderHeader;
+
+// Fixed-size ring of compactly encoded snapshots. Percentages and watts are
+// stored as hundredths in 16 bits, so a record costs 16 bytes plus 4 per core
+// and appending never allocates or touches the filesystem.
+typedef struct {
+    uint8_t *records;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    int has_wall_offset;
+    SnooperRecorderHeader header;
+} SnooperRecorder;
+
+SnooperStatus snooper_recorder_init(SnooperRecorder *recorder, size_t capacity, size_t core_count, uint64_t session_id, uint32_t interval_ms);
+void snooper_recorder_destroy(SnooperRecorder *recorder);
+void snooper_recorder_append(SnooperRecorder *recorder, const SnooperSnapshot *snapshot);
+SnooperStatus snooper_recorder_dump(const SnooperRecorder *recorder, const char *path);
+
+SnooperStatus snooper_recorder_header_decode(const uint8_t *bytes, size_t length, SnooperRecorderHeader *out);
+void snooper_recorder_record_decode(const SnooperRecorderHeader *header, const uint8_t *record, SnooperSnapshot *out);
+
+#endif
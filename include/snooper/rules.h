@@ -0,0 +1,85 @@
+#ifndef SNOOPER_RULES_H
+#define SNOOPER_RULES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "snooper/errors.h"
+#include "snooper/metrics.h"
+#include "snooper/telemetry.h"
+
+#define SNOOPER_RULE_NAME_MAX 64
+
+// Rule syntax, one per line:
+//   [name:] <metric | rate(metric)> <op> <threshold> [for <dur>] [clear <threshold>] [hold <dur>]
+// op is one of > >= < <=. Thresholds accept k/M/G multipliers and a trailing
+// % or ms, which are dropped. Durations take ms, s, m or h (seconds if
+// bare). "clear" sets the hysteresis level a firing rule must cross to
+// resolve; "hold" suppresses re-firing for a while after a resolve.
+typedef enum {
+    SNOOPER_RULE_FIRING,
+    SNOOPER_RULE_RESOLVED
+} SnooperRuleState;
+
+typedef enum {
+    SNOOPER_RULE_GT,
+    SNOOPER_RULE_GE,
+    SNOOPER_RULE_LT,
+    SNOOPER_RULE_LE
+} SnooperRuleOperator;
+
+typedef struct {
+    const char *rule;
+    const SnooperMetricId *metric;
+    SnooperRuleState state;
+    double value;
+    double threshold;
+    uint64_t monotonic_ns;
+    struct timespec wall_time;
+} SnooperRuleEvent;
+
+typedef void (*SnooperRuleSink)(void *context, const SnooperRuleEvent *event);
+
+typedef struct {
+    char name[SNOOPER_RULE_NAME_MAX];
+    SnooperMetricId metric;
+    SnooperRuleOperator op;
+    int is_rate;
+    double threshold;
+    double clear_threshold;
+    uint64_t for_ns;
+    uint64_t hold_ns;
+    size_t slot_offset;
+    size_t slot_count;
+} SnooperRuleOp;
+
+// id and value are the instance's last evaluation, kept so a firing
+// instance that disappears can still be reported as resolved. previous_ns is
+// the source probe's sample time, not the snapshot's.
+typedef struct {
+    SnooperMetricId id;
+    uint64_t pending_since_ns;
+    uint64_t hold_until_ns;
+    uint64_t previous_ns;
+    double previous_value;
+    double value;
+    uint8_t has_previous;
+    uint8_t pending;
+    uint8_t firing;
+    uint8_t visited;
+} SnooperRuleSlot;
+
+typedef struct {
+    SnooperRuleOp *ops;
+    size_t op_count;
+    SnooperRuleSlot *slots;
+    size_t slot_count;
+} SnooperRuleSet;
+
+void snooper_rules_init(SnooperRuleSet *rules);
+void snooper_rules_destroy(SnooperRuleSet *rules);
+SnooperStatus snooper_rules_compile(SnooperRuleSet *rules, const char *text, char *error, size_t error_size);
+SnooperStatus snooper_rules_load_file(SnooperRuleSet *rules, const char *path, char *error, size_t error_size);
+void snooper_rules_evaluate(SnooperRuleSet *rules, const SnooperSnapshot *snapshot, SnooperRuleSink sink, void *context);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SNOOPER_SCHED_H
+#define SNOOPER_SCHED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/cpu.h"
+#include "snooper/errors.h"
+
+typedef struct {
+    uint64_t run_ns;
+    uint64_t wait_ns;
+    uint64_t timeslices;
+} SnooperSchedCounters;
+
+typedef struct {
+    int present;
+    double run_ms_per_sec;
+    double wait_ms_per_sec;
+    double timeslices_per_sec;
+    double avg_wait_us_per_timeslice;
+} SnooperSchedCore;
+
+typedef struct {
+    SnooperSchedCore cores[SNOOPER_MAX_CPUS];
+    size_t core_count;
+    double context_switches_per_sec;
+    uint64_t procs_running;
+    uint64_t procs_blocked;
+    uint64_t monotonic_ns;
+} SnooperSchedStats;
+
+typedef struct {
+    char root[256];
+    int schedstat_fd;
+    int stat_fd;
+    char *buffer;
+    size_t buffer_size;
+    SnooperSchedCounters *previous;
+    uint64_t previous_ctxt;
+    uint64_t previous_ns;
+    int initialized;
+} SchedProbe;
+
+SnooperStatus sched_probe_init(SchedProbe *probe, const char *root);
+void sched_probe_destroy(SchedProbe *probe);
+SnooperStatus sched_probe_sample(SchedProbe *probe, uint64_t monotonic_ns, SnooperSchedStats *stats);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef SNOOPER_SCHEDULER_H
+#define SNOOPER_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+
+#define SNOOPER_SCHEDULE_MAX 64
+#define SNOOPER_PERIOD_EVERY 0ULL
+#define SNOOPER_PERIOD_ONCE UINT64_MAX
+
+typedef struct {
+    int id;
+    int fired;
+    uint64_t period_ns;
+    uint64_t phase_ns;
+    uint64_t deadline_ns;
+} SnooperScheduleEntry;
+
+// Min-heap of probe deadlines. Every entry fires on the first due check so
+// snapshots start complete; afterwards entries sharing a tick are spread
+// across their period by a golden-ratio phase so slow probes do not all
+// land on the same collection.
+typedef struct {
+    SnooperScheduleEntry heap[SNOOPER_SCHEDULE_MAX];
+    size_t count;
+    size_t staggered;
+} SnooperSchedule;
+
+void snooper_schedule_init(SnooperSchedule *schedule);
+SnooperStatus snooper_schedule_add(SnooperSchedule *schedule, int id, uint64_t period_ns, uint64_t start_ns);
+size_t snooper_schedule_due(SnooperSchedule *schedule, uint64_t now_ns, int *ids, size_t max_ids);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef SNOOPER_SESSION_H
+#define SNOOPER_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "snooper/errors.h"
+#include "snooper/system_info.h"
+#include "snooper/timebase.h"
+
+#define SNOOPER_BOOT_ID_MAX 64
+
+typedef struct {
+    uint64_t session_id;
+    char boot_id[SNOOPER_BOOT_ID_MAX];
+    int has_boot_id;
+    uint64_t started_monotonic_ns;
+    struct timespec started_wall_time;
+    int64_t wall_offset_ns;
+    SnooperSystemInfo system_info;
+    int has_system_info;
+} SnooperSession;
+
+SnooperStatus snooper_session_init(SnooperSession *session, const SnooperTimestamp *started, int reveal_identifiers);
+SnooperStatus snooper_read_boot_id(char *buffer, size_t size);
+
+#endif
@@ -4,31 +4,107 @@
 #include <stdint.h>
 #include <time.h>
 #include "snooper/cpu.h"
+#include "snooper/frequency.h"
 #include "snooper/gpu.h"
-#include "snooper/system_info.h"
+#include "snooper/irq.h"
+#include "snooper/network.h"
+#include "snooper/numa.h"
+#include "snooper/plugin.h"
+#include "snooper/power.h"
+#include "snooper/process.h"
+#include "snooper/sched.h"
+#include "snooper/scheduler.h"
+#include "snooper/session.h"
 #include "snooper/system_metrics.h"
+#include "snooper/timebase.h"
+#include "snooper/topology.h"
+
+typedef enum {
+    SNOOPER_PROBE_CPU,
+    SNOOPER_PROBE_GPU,
+    SNOOPER_PROBE_SYSTEM,
+    SNOOPER_PROBE_NET,
+    SNOOPER_PROBE_SCHED,
+    SNOOPER_PROBE_IRQ,
+    SNOOPER_PROBE_FREQ,
+    SNOOPER_PROBE_POWER,
+    SNOOPER_PROBE_PROCS,
+    SNOOPER_PROBE_NUMA,
+    SNOOPER_PROBE_COUNT
+} SnooperProbeId;
 
 typedef struct {
+    uint64_t session_id;
     uint64_t monotonic_ns;
     struct timespec wall_time;
+    int64_t wall_offset_ns;
     double cpu_used_percent;
+    SnooperCpuUsage per_core[SNOOPER_MAX_CPUS];
+    size_t core_count;
+    SnooperTopologyUsage topology;
+    int has_topology;
     double gpu_used_percent;
     int gpu_available;
-    SnooperSystemInfo system_info;
-    int has_system_info;
     SnooperSystemMetrics system_metrics;
+    SnooperNetworkStats network;
+    int has_network;
+    SnooperSchedStats sched;
+    int has_sched;
+    SnooperIrqStats irq;
+    int has_irq;
+    SnooperFreqStats freq;
+    int has_freq;
+    SnooperPowerSample power;
+    SnooperProcessStats processes;
+    int has_processes;
+    SnooperNumaStats numa;
+    int has_numa;
+    uint64_t updated_ns[SNOOPER_PROBE_COUNT];
+    const SnooperPluginSet *plugins;
+    SnooperFieldValue plugin_values[SNOOPER_PLUGIN_MAX_VALUES];
+    uint64_t plugin_updated_ns[SNOOPER_PLUGIN_MAX];
+    int plugin_available[SNOOPER_PLUGIN_MAX];
 } SnooperSnapshot;
 
 typedef struct {
     CpuProbe cpu_probe;
     GpuProbe gpu_probe;
-    SnooperSystemInfo system_info;
+    NetProbe net_probe;
+    SchedProbe sched_probe;
+    IrqProbe irq_probe;
+    FreqProbe freq_probe;
+    PowerProbe power_probe;
+    ProcessProbe process_probe;
+    NumaProbe numa_probe;
+    SnooperTimebase timebase;
+    SnooperSession session;
+    SnooperCpuTopology topology;
     int reveal_identifiers;
-    int system_info_loaded;
+    uint64_t period_ns[SNOOPER_PROBE_COUNT];
+    SnooperPluginSet plugins;
+    SnooperSchedule schedule;
+    // Busy time from every CPU sample since freq and power last sampled, so
+    // their per-busy-core figures cover their own period rather than only
+    // the latest CPU window.
+    uint64_t cpu_sampled_ns;
+    double freq_busy_seconds[SNOOPER_MAX_CPUS];
+    double freq_window_seconds;
+    double power_busy_core_seconds;
+    int scheduled;
+    int warmed_up;
+    SnooperSnapshot *latest;
 } SnooperTelemetry;
 
 SnooperStatus snooper_telemetry_init(SnooperTelemetry *telemetry, int reveal_identifiers);
 void snooper_telemetry_destroy(SnooperTelemetry *telemetry);
-SnooperStatus snooper_snapshot_collect(SnooperTelemetry *telemetry, SnooperSnapshot *out);
+SnooperStatus snooper_telemetry_set_period(SnooperTelemetry *telemetry, SnooperProbeId probe, uint64_t period_ns);
+SnooperStatus snooper_telemetry_parse_periods(SnooperTelemetry *telemetry, const char *spec);
+SnooperStatus snooper_telemetry_register_probe(SnooperTelemetry *telemetry, const SnooperProbeDescriptor *descriptor, char *error, size_t error_size);
+SnooperStatus snooper_telemetry_load_plugin(SnooperTelemetry *telemetry, const char *path, char *error, size_t error_size);
+SnooperStatus snooper_telemetry_seed_cpu(SnooperTelemetry *telemetry, const SnooperCpuSample *baseline);
+const char *snooper_probe_name(SnooperProbeId probe);
+// On success *out points at the telemetry's own snapshot, which stays valid
+// until the next collect or destroy.
+SnooperStatus snooper_snapshot_collect(SnooperTelemetry *telemetry, const SnooperSnapshot **out);
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef SNOOPER_TIMEBASE_H
+#define SNOOPER_TIMEBASE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "snooper/errors.h"
+
+#define SNOOPER_TIMEBASE_RESYNC_NS 1000000000ULL
+
+typedef struct {
+    uint64_t monotonic_ns;
+    struct timespec wall_time;
+    int64_t wall_offset_ns;
+} SnooperTimestamp;
+
+// Hands out one monotonic/wall pair per snapshot plus cheap monotonic
+// sub-timestamps. When an invariant cycle counter is available (TSC on x86,
+// CNTVCT on arm64) sub-timestamps are extrapolated from it, with the rate
+// calibrated against CLOCK_MONOTONIC_RAW and re-synced at most every
+// SNOOPER_TIMEBASE_RESYNC_NS by the pair captures.
+typedef struct {
+    int use_counter;
+    int calibrated;
+    uint64_t counter_base;
+    uint64_t monotonic_base;
+    double ns_per_tick;
+    uint64_t last_ns;
+} SnooperTimebase;
+
+SnooperStatus snooper_timebase_init(SnooperTimebase *timebase, int use_counter);
+SnooperStatus snooper_timebase_capture(SnooperTimebase *timebase, SnooperTimestamp *out);
+uint64_t snooper_timebase_now_ns(SnooperTimebase *timebase);
+const char *snooper_timebase_source(const SnooperTimebase *timebase);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SNOOPER_TOPOLOGY_H
+#define SNOOPER_TOPOLOGY_H
+
+#include <stddef.h>
+#include "snooper/cpu.h"
+#include "snooper/errors.h"
+
+typedef enum {
+    SNOOPER_TOPOLOGY_SMT = 0,
+    SNOOPER_TOPOLOGY_CLUSTER,
+    SNOOPER_TOPOLOGY_PACKAGE,
+    SNOOPER_TOPOLOGY_NODE,
+    SNOOPER_TOPOLOGY_CORE_TYPE,
+    SNOOPER_TOPOLOGY_LEVEL_COUNT
+} SnooperTopologyLevel;
+
+#define SNOOPER_MAX_TOPOLOGY_GROUPS (SNOOPER_MAX_CPUS * 2)
+
+typedef struct {
+    size_t group_count;
+    int *group_ids;
+    size_t *offsets;
+    size_t *members;
+} SnooperTopologyGroups;
+
+// Arrays are indexed by CPU id up to the highest id found; ids in gaps of the
+// present list have present[cpu] == 0 and belong to no group.
+typedef struct {
+    size_t cpu_count;
+    int *present;
+    int *package_id;
+    int *core_id;
+    int *cluster_id;
+    int *node_id;
+    int *core_type;
+    SnooperTopologyGroups levels[SNOOPER_TOPOLOGY_LEVEL_COUNT];
+    int available;
+} SnooperCpuTopology;
+
+typedef struct {
+    int id;
+    int cpu_count;
+    double used_percent;
+    double max_core_percent;
+} SnooperTopologyGroupUsage;
+
+typedef struct {
+    SnooperTopologyGroupUsage groups[SNOOPER_MAX_TOPOLOGY_GROUPS];
+    size_t level_offsets[SNOOPER_TOPOLOGY_LEVEL_COUNT + 1];
+} SnooperTopologyUsage;
+
+SnooperStatus snooper_topology_discover(SnooperCpuTopology *topology, const char *root);
+void snooper_topology_destroy(SnooperCpuTopology *topology);
+const char *snooper_topology_level_name(SnooperTopologyLevel level);
+SnooperStatus snooper_topology_aggregate(const SnooperCpuTopology *topology,
+                                         const SnooperCpuUsage *per_core,
+                                         size_t core_count,
+                                         SnooperTopologyUsage *usage);
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef SNOOPER_TSSTORE_H
+#define SNOOPER_TSSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "snooper/errors.h"
+
+#define SNOOPER_TS_BLOCK_SIZE 1024
+#define SNOOPER_TS_BLOCK_HEADER_SIZE 48
+#define SNOOPER_TS_PAYLOAD_SIZE (SNOOPER_TS_BLOCK_SIZE - SNOOPER_TS_BLOCK_HEADER_SIZE)
+#define SNOOPER_TS_NAME_MAX 48
+#define SNOOPER_TS_DEFAULT_RESOLUTION_NS 1000000ull
+
+// One compressed block of a series. Timestamps are delta-of-delta coded in
+// units of the store resolution and values are XOR coded against the
+// previous value, Gorilla style. The summary fields cover every point in the
+// payload so range and aggregate queries can skip or answer whole blocks
+// without decoding them.
+typedef struct {
+    uint64_t first_ns;
+    uint64_t last_ns;
+    double min;
+    double max;
+    double sum;
+    uint32_t count;
+    uint32_t bit_length;
+    uint8_t payload[SNOOPER_TS_PAYLOAD_SIZE];
+} SnooperTsBlock;
+
+typedef struct {
+    int64_t previous_units;
+    int64_t previous_delta;
+    uint64_t previous_bits;
+    int leading;
+    int trailing;
+} SnooperTsCodecState;
+
+typedef struct {
+    char name[SNOOPER_TS_NAME_MAX];
+    int32_t oldest;
+    int32_t newest;
+    size_t block_count;
+    SnooperTsCodecState encoder;
+} SnooperTsSeries;
+
+typedef struct {
+    SnooperTsBlock *blocks;
+    int32_t *next;
+    size_t block_capacity;
+    int32_t free_list;
+    size_t free_blocks;
+    SnooperTsSeries *series;
+    size_t series_count;
+    size_t series_capacity;
+    uint64_t resolution_ns;
+    uint64_t evicted_blocks;
+} SnooperTsStore;
+
+typedef struct {
+    uint64_t from_ns;
+    uint64_t to_ns;
+    double min_value;
+    double max_value;
+} SnooperTsRange;
+
+typedef struct {
+    const SnooperTsBlock *block;
+    uint64_t resolution_ns;
+    uint32_t index;
+    uint32_t bit_offset;
+    SnooperTsCodecState state;
+} SnooperTsBlockReader;
+
+typedef struct {
+    const SnooperTsStore *store;
+    SnooperTsRange range;
+    int32_t block;
+    int reading;
+    size_t blocks_skipped;
+    SnooperTsBlockReader reader;
+} SnooperTsIterator;
+
+typedef struct {
+    size_t count;
+    double min;
+    double max;
+    double sum;
+} SnooperTsAggregate;
+
+SnooperStatus snooper_tsstore_init(SnooperTsStore *store, size_t memory_budget, size_t max_series, uint64_t resolution_ns);
+void snooper_tsstore_destroy(SnooperTsStore *store);
+int snooper_tsstore_add_series(SnooperTsStore *store, const char *name);
+int snooper_tsstore_find_series(const SnooperTsStore *store, const char *name);
+SnooperStatus snooper_tsstore_append(SnooperTsStore *store, int series, uint64_t timestamp_ns, double value);
+size_t snooper_tsstore_release_sealed(SnooperTsStore *store, int series);
+size_t snooper_tsstore_memory_used(const SnooperTsStore *store);
+
+void snooper_ts_range_all(SnooperTsRange *range);
+int snooper_ts_block_overlaps(const SnooperTsBlock *block, const SnooperTsRange *range);
+void snooper_ts_block_reader_init(SnooperTsBlockReader *reader, const SnooperTsBlock *block, uint64_t resolution_ns);
+int snooper_ts_block_reader_next(SnooperTsBlockReader *reader, uint64_t *timestamp_ns, double *value);
+
+void snooper_ts_iter_init(SnooperTsIterator *iter, const SnooperTsStore *store, int series, const SnooperTsRange *range);
+const SnooperTsBlock *snooper_ts_iter_next_block(SnooperTsIterator *iter);
+int snooper_ts_iter_next(SnooperTsIterator *iter, uint64_t *timestamp_ns, double *value);
+
+SnooperStatus snooper_tsstore_aggregate(const SnooperTsStore *store, int series, uint64_t from_ns, uint64_t to_ns, SnooperTsAggregate *out);
+
+#endif
@@ -0,0 +1,98 @@
+#include "cli_alerts.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int cli_alerts_open(CliAlerts *alerts, const CliOptions *opts) {
+    if (!alerts || !opts) return -1;
+
+    memset(alerts, 0, sizeof(*alerts));
+    snooper_rules_init(&alerts->rules);
+    if (!opts->rules_path) {
+        return 0;
+    }
+
+    char error[256] = "";
+    if (snooper_rules_load_file(&alerts->rules, opts->rules_path, error, sizeof(error)) != SNOOPER_OK) {
+        fprintf(stderr, "Invalid rules: %s\n", error);
+        snooper_rules_destroy(&alerts->rules);
+        return -1;
+    }
+
+    alerts->log = stderr;
+    if (opts->alert_log_path) {
+        alerts->log = fopen(opts->alert_log_path, "a");
+        if (!alerts->log) {
+            perror(opts->alert_log_path);
+            snooper_rules_destroy(&alerts->rules);
+            return -1;
+        }
+    }
+
+    // Hooks are fire-and-forget; let the kernel reap them so a slow hook can
+    // never stall sampling.
+    if (opts->alert_hook) {
+        signal(SIGCHLD, SIG_IGN);
+    }
+    alerts->hook = opts->alert_hook;
+    alerts->enabled = 1;
+    return 0;
+}
+
+static void run_hook(const CliAlerts *alerts, const SnooperRuleEvent *event, const char *metric, const char *line) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return;
+    }
+
+    char value[64];
+    snprintf(value, sizeof(value), "%.6g", event->value);
+    setenv("SNOOPER_ALERT_RULE", event->rule, 1);
+    setenv("SNOOPER_ALERT_STATE", event->state == SNOOPER_RULE_FIRING ? "firing" : "resolved", 1);
+    setenv("SNOOPER_ALERT_METRIC", metric, 1);
+    setenv("SNOOPER_ALERT_VALUE", value, 1);
+    setenv("SNOOPER_ALERT_JSON", line, 1);
+    execl("/bin/sh", "sh", "-c", alerts->hook, (char *)NULL);
+    _exit(127);
+}
+
+static void deliver(void *context, const SnooperRuleEvent *event) {
+    CliAlerts *alerts = context;
+    char metric[SNOOPER_METRIC_NAME_MAX];
+    if (snooper_metric_format(event->metric, metric, sizeof(metric)) != 0) {
+        snprintf(metric, sizeof(metric), "?");
+    }
+
+    char line[512];
+    snprintf(line, sizeof(line), "{\"type\":\"alert\",\"state\":\"%s\",\"rule\":\"%s\",\"metric\":\"%s\",\"value\":%.3f,\"threshold\":%.3f,\"wall\":\"%ld.%09ld\",\"monotonic_ns\":%llu}"
+             , event->state == SNOOPER_RULE_FIRING ? "firing" : "resolved"
+             , event->rule
+             , metric
+             , event->value
+             , event->threshold
+             , (long)event->wall_time.tv_sec
+             , (long)event->wall_time.tv_nsec
+             , (unsigned long long)event->monotonic_ns);
+
+    fprintf(alerts->log, "%s\n", line);
+    fflush(alerts->log);
+    if (alerts->hook) {
+        run_hook(alerts, event, metric, line);
+    }
+}
+
+void cli_alerts_evaluate(CliAlerts *alerts, const SnooperSnapshot *snapshot) {
+    if (!alerts || !alerts->enabled) return;
+    snooper_rules_evaluate(&alerts->rules, snapshot, deliver, alerts);
+}
+
+void cli_alerts_close(CliAlerts *alerts) {
+    if (!alerts) return;
+    if (alerts->log && alerts->log != stderr) {
+        fclose(alerts->log);
+    }
+    snooper_rules_destroy(&alerts->rules);
+    memset(alerts, 0, sizeof(*alerts));
+}
@@ -0,0 +1,19 @@
+#ifndef SNOOPER_CLI_ALERTS_H
+#define SNOOPER_CLI_ALERTS_H
+
+#include <stdio.h>
+#include "cli_args.h"
+#include "snooper/rules.h"
+
+typedef struct {
+    SnooperRuleSet rules;
+    FILE *log;
+    const char *hook;
+    int enabled;
+} CliAlerts;
+
+int cli_alerts_open(CliAlerts *alerts, const CliOptions *opts);
+void cli_alerts_evaluate(CliAlerts *alerts, const SnooperSnapshot *snapshot);
+void cli_alerts_close(CliAlerts *alerts);
+
+#endif
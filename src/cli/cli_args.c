@@ -5,13 +5,48 @@
 
 void cli_print_usage(const char *progname) {
     printf("Usage:\n");
-    printf("  %s cpu --watch <milliseconds> [--json | --ndjson] [--show-identifiers]\n", progname);
-    printf("  %s gpu --watch <milliseconds> [--json | --ndjson] [--show-identifiers]\n", progname);
-    printf("  %s info [--show-identifiers]\n", progname);
+    printf("  %s cpu --watch <milliseconds> [--json | --ndjson | --format arrow] [--history <path>] [--rules <path>] [--show-identifiers]\n", progname);
+    printf("  %s gpu --watch <milliseconds> [--json | --ndjson | --format arrow] [--history <path>] [--rules <path>] [--show-identifiers]\n", progname);
+    printf("  %s cpu|gpu --once [--baseline <path>] [--baseline-ms <milliseconds>] [--json] [--rules <path>]\n", progname);
+    printf("  %s info [--json] [--show-identifiers]\n", progname);
+    printf("  %s serve --socket <path> --watch <milliseconds> [--show-identifiers]\n", progname);
+    printf("  %s record --output <path> --watch <milliseconds> [--window <seconds>] [--trigger-cpu <percent>] [--history <path>]\n", progname);
+    printf("  %s query --history <path> [--metric <name,...>] [--from <time>] [--to <time>]\n", progname);
+    printf("        [--agg avg|min|max|sum|count|pNN] [--bucket <seconds>] [--list] [--json]\n");
+    printf("  %s merge [--lateness <ms>] [--buffer-kb <n>] [<name>=]<path>...\n", progname);
+    printf("  %s tui --watch <milliseconds> [--refresh <milliseconds>] [--period <p=ms,...>]\n", progname);
+    printf("  %s export --listen <ip>:<port> --watch <milliseconds> [--show-identifiers]\n", progname);
     printf("\nOptions:\n");
-    printf("  --watch <ms>         Sampling interval in milliseconds (required for cpu/gpu).\n");
+    printf("  --watch <ms>         Sampling interval in milliseconds (required for all but info/query).\n");
+    printf("  --socket <path>      Unix socket to stream NDJSON to; clients may send\n");
+    printf("                       \"metrics=cpu,cores,... every=N\" to subscribe.\n");
     printf("  --json               Emit JSON output.\n");
     printf("  --ndjson             Emit newline-delimited JSON per sample.\n");
+    printf("  --format <f>         Output format: table, json, ndjson or arrow (Arrow IPC stream).\n");
+    printf("  --batch-rows <n>     Snapshots per Arrow record batch (default 256).\n");
+    printf("  --listen <ip:port>   Address to serve Prometheus text on at /metrics.\n");
+    printf("  --output <path>      Flight recorder dump file; SIGUSR1 and triggers write <path>.<n>.\n");
+    printf("  --window <seconds>   History kept by the flight recorder (default 1800).\n");
+    printf("  --trigger-cpu <pct>  Dump the flight recorder when CPU usage rises past pct.\n");
+    printf("  --history <path>     Compressed history file, appended every 10s while sampling.\n");
+    printf("  --metric <names>     Metrics to query, e.g. cpu.used,cpu.core[*].used (default cpu.used).\n");
+    printf("  --from/--to <time>   Unix seconds, local HH:MM[:SS], or -<n>[s|m|h] before the last sample.\n");
+    printf("  --agg <name>         Aggregation per bucket (default avg).\n");
+    printf("  --bucket <seconds>   Group results into time buckets (default one bucket).\n");
+    printf("  --list               List the series recorded in a history file.\n");
+    printf("  --rules <path>       Alert rules evaluated on every sample (cpu/gpu/record/serve/export).\n");
+    printf("  --alert-log <path>   Append alert events to a file instead of stderr.\n");
+    printf("  --alert-hook <cmd>   Run cmd via /bin/sh for each alert event (SNOOPER_ALERT_* env).\n");
+    printf("  --lateness <ms>      Let merge emit past an input that has stalled for this long.\n");
+    printf("  --buffer-kb <n>      Read-ahead buffer per merge input (default 64).\n");
+    printf("  --once               Print one snapshot and exit, without waiting a --watch interval.\n");
+    printf("  --baseline <path>    Tick baseline kept between --once runs; the first delta is taken\n");
+    printf("                       from it when it is from this boot, and it is rewritten on exit.\n");
+    printf("  --baseline-ms <ms>   Warmup window for --once when no usable baseline exists (default 100).\n");
+    printf("  --refresh <ms>       Dashboard redraw interval, independent of --watch (default 500).\n");
+    printf("  --period <p=ms,...>  Per-probe sampling period in ms or \"once\", e.g. net=1000,system=5000.\n");
+    printf("                       Probes: cpu gpu system net sched irq freq power procs numa\n                       (system defaults to 1000, procs to 2000).\n");
+    printf("  --plugin <so,...>    Load probe plugins (shared objects exporting snooper_probe_descriptor).\n");
     printf("  --show-identifiers   Reveal serial number and hardware UUID.\n");
     printf("  -h, --help           Show this help message.\n");
 }
@@ -29,6 +64,18 @@ int cli_parse_arguments(int argc, char **argv, CliOptions *out) {
         out->command = CLI_CMD_GPU;
     } else if (strcmp(argv[1], "info") == 0) {
         out->command = CLI_CMD_INFO;
+    } else if (strcmp(argv[1], "serve") == 0) {
+        out->command = CLI_CMD_SERVE;
+    } else if (strcmp(argv[1], "export") == 0) {
+        out->command = CLI_CMD_EXPORT;
+    } else if (strcmp(argv[1], "record") == 0) {
+        out->command = CLI_CMD_RECORD;
+    } else if (strcmp(argv[1], "query") == 0) {
+        out->command = CLI_CMD_QUERY;
+    } else if (strcmp(argv[1], "merge") == 0) {
+        out->command = CLI_CMD_MERGE;
+    } else if (strcmp(argv[1], "tui") == 0) {
+        out->command = CLI_CMD_TUI;
     } else if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) {
         return -1;
     } else {
@@ -39,6 +86,32 @@ int cli_parse_arguments(int argc, char **argv, CliOptions *out) {
     out->interval_ms = 0;
     out->format = CLI_FORMAT_TABLE;
     out->show_identifiers = 0;
+    out->socket_path = NULL;
+    out->listen_address = NULL;
+    out->output_path = NULL;
+    out->window_seconds = 1800;
+    out->trigger_cpu_percent = 0.0;
+    out->history_path = NULL;
+    out->metric_list = NULL;
+    out->from_time = NULL;
+    out->to_time = NULL;
+    out->aggregation = NULL;
+    out->bucket_seconds = 0.0;
+    out->list_series = 0;
+    out->rules_path = NULL;
+    out->alert_log_path = NULL;
+    out->alert_hook = NULL;
+    out->probe_periods = NULL;
+    out->plugin_paths = NULL;
+    out->lateness_ms = 0;
+    out->buffer_kb = 64;
+    out->refresh_ms = 500;
+    out->once = 0;
+    out->baseline_path = NULL;
+    out->baseline_ms = 100;
+    out->batch_rows = 256;
+    out->inputs = NULL;
+    out->input_count = 0;
 
     for (int i = 2; i < argc; ++i) {
         if (strcmp(argv[i], "--watch") == 0) {
@@ -55,18 +128,243 @@ int cli_parse_arguments(int argc, char **argv, CliOptions *out) {
             out->format = CLI_FORMAT_JSON;
         } else if (strcmp(argv[i], "--ndjson") == 0) {
             out->format = CLI_FORMAT_NDJSON;
+        } else if (strcmp(argv[i], "--format") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --format.\n");
+                return -1;
+            }
+            const char *format = argv[++i];
+            if (strcmp(format, "table") == 0) {
+                out->format = CLI_FORMAT_TABLE;
+            } else if (strcmp(format, "json") == 0) {
+                out->format = CLI_FORMAT_JSON;
+            } else if (strcmp(format, "ndjson") == 0) {
+                out->format = CLI_FORMAT_NDJSON;
+            } else if (strcmp(format, "arrow") == 0) {
+                out->format = CLI_FORMAT_ARROW;
+            } else {
+                fprintf(stderr, "Unknown format: %s\n", format);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--batch-rows") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --batch-rows.\n");
+                return -1;
+            }
+            out->batch_rows = atoi(argv[++i]);
+            if (out->batch_rows <= 0) {
+                fprintf(stderr, "Batch rows must be positive.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--socket") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --socket.\n");
+                return -1;
+            }
+            out->socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--listen") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --listen.\n");
+                return -1;
+            }
+            out->listen_address = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --output.\n");
+                return -1;
+            }
+            out->output_path = argv[++i];
+        } else if (strcmp(argv[i], "--window") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --window.\n");
+                return -1;
+            }
+            out->window_seconds = atoi(argv[++i]);
+            if (out->window_seconds <= 0) {
+                fprintf(stderr, "Window must be positive.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--trigger-cpu") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --trigger-cpu.\n");
+                return -1;
+            }
+            out->trigger_cpu_percent = atof(argv[++i]);
+            if (out->trigger_cpu_percent <= 0.0 || out->trigger_cpu_percent > 100.0) {
+                fprintf(stderr, "CPU trigger must be between 0 and 100.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--history") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --history.\n");
+                return -1;
+            }
+            out->history_path = argv[++i];
+        } else if (strcmp(argv[i], "--metric") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --metric.\n");
+                return -1;
+            }
+            out->metric_list = argv[++i];
+        } else if (strcmp(argv[i], "--from") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --from.\n");
+                return -1;
+            }
+            out->from_time = argv[++i];
+        } else if (strcmp(argv[i], "--to") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --to.\n");
+                return -1;
+            }
+            out->to_time = argv[++i];
+        } else if (strcmp(argv[i], "--agg") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --agg.\n");
+                return -1;
+            }
+            out->aggregation = argv[++i];
+        } else if (strcmp(argv[i], "--bucket") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --bucket.\n");
+                return -1;
+            }
+            out->bucket_seconds = atof(argv[++i]);
+            if (out->bucket_seconds <= 0.0) {
+                fprintf(stderr, "Bucket must be positive.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--list") == 0) {
+            out->list_series = 1;
+        } else if (strcmp(argv[i], "--rules") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --rules.\n");
+                return -1;
+            }
+            out->rules_path = argv[++i];
+        } else if (strcmp(argv[i], "--alert-log") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --alert-log.\n");
+                return -1;
+            }
+            out->alert_log_path = argv[++i];
+        } else if (strcmp(argv[i], "--alert-hook") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --alert-hook.\n");
+                return -1;
+            }
+            out->alert_hook = argv[++i];
+        } else if (strcmp(argv[i], "--period") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --period.\n");
+                return -1;
+            }
+            out->probe_periods = argv[++i];
+        } else if (strcmp(argv[i], "--plugin") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --plugin.\n");
+                return -1;
+            }
+            out->plugin_paths = argv[++i];
+        } else if (strcmp(argv[i], "--lateness") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --lateness.\n");
+                return -1;
+            }
+            out->lateness_ms = atoi(argv[++i]);
+            if (out->lateness_ms < 0) {
+                fprintf(stderr, "Lateness must not be negative.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--buffer-kb") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --buffer-kb.\n");
+                return -1;
+            }
+            out->buffer_kb = atoi(argv[++i]);
+            if (out->buffer_kb <= 0) {
+                fprintf(stderr, "Buffer size must be positive.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--refresh") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --refresh.\n");
+                return -1;
+            }
+            out->refresh_ms = atoi(argv[++i]);
+            if (out->refresh_ms <= 0) {
+                fprintf(stderr, "Refresh interval must be positive.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--once") == 0) {
+            out->once = 1;
+        } else if (strcmp(argv[i], "--baseline") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --baseline.\n");
+                return -1;
+            }
+            out->baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline-ms") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for --baseline-ms.\n");
+                return -1;
+            }
+            out->baseline_ms = atoi(argv[++i]);
+            if (out->baseline_ms <= 0) {
+                fprintf(stderr, "Baseline window must be positive.\n");
+                return -1;
+            }
         } else if (strcmp(argv[i], "--show-identifiers") == 0) {
             out->show_identifiers = 1;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             return -1;
+        } else if (out->command == CLI_CMD_MERGE && argv[i][0] != '-') {
+            out->inputs = &argv[i];
+            out->input_count = argc - i;
+            break;
         } else {
             fprintf(stderr, "Unknown option: %s\n", argv[i]);
             return -1;
         }
     }
 
-    if ((out->command == CLI_CMD_CPU || out->command == CLI_CMD_GPU) && out->interval_ms <= 0) {
-        fprintf(stderr, "--watch <milliseconds> is required for cpu/gpu.\n");
+    if (out->format == CLI_FORMAT_ARROW && ((out->command != CLI_CMD_CPU && out->command != CLI_CMD_GPU) || out->once)) {
+        fprintf(stderr, "--format arrow is only supported for cpu and gpu --watch.\n");
+        return -1;
+    }
+
+    if (out->once && out->command != CLI_CMD_CPU && out->command != CLI_CMD_GPU) {
+        fprintf(stderr, "--once is only supported for cpu and gpu.\n");
+        return -1;
+    }
+
+    if (out->command != CLI_CMD_INFO && out->command != CLI_CMD_QUERY && out->command != CLI_CMD_MERGE && !out->once && out->interval_ms <= 0) {
+        fprintf(stderr, "--watch <milliseconds> is required for %s.\n", argv[1]);
+        return -1;
+    }
+
+    if (out->command == CLI_CMD_SERVE && !out->socket_path) {
+        fprintf(stderr, "--socket <path> is required for serve.\n");
+        return -1;
+    }
+
+    if (out->command == CLI_CMD_EXPORT && !out->listen_address) {
+        fprintf(stderr, "--listen <ip>:<port> is required for export.\n");
+        return -1;
+    }
+
+    if (out->command == CLI_CMD_RECORD && !out->output_path) {
+        fprintf(stderr, "--output <path> is required for record.\n");
+        return -1;
+    }
+
+    if (out->command == CLI_CMD_QUERY && !out->history_path) {
+        fprintf(stderr, "--history <path> is required for query.\n");
+        return -1;
+    }
+
+    if (out->command == CLI_CMD_MERGE && out->input_count == 0) {
+        fprintf(stderr, "merge needs at least one input.\n");
         return -1;
     }
 
@@ -4,13 +4,20 @@
 typedef enum {
     CLI_CMD_CPU,
     CLI_CMD_GPU,
-    CLI_CMD_INFO
+    CLI_CMD_INFO,
+    CLI_CMD_SERVE,
+    CLI_CMD_EXPORT,
+    CLI_CMD_RECORD,
+    CLI_CMD_QUERY,
+    CLI_CMD_MERGE,
+    CLI_CMD_TUI
 } CliCommand;
 
 typedef enum {
     CLI_FORMAT_TABLE,
     CLI_FORMAT_JSON,
-    CLI_FORMAT_NDJSON
+    CLI_FORMAT_NDJSON,
+    CLI_FORMAT_ARROW
 } CliFormat;
 
 typedef struct {
@@ -18,6 +25,32 @@ typedef struct {
     int interval_ms;
     CliFormat format;
     int show_identifiers;
+    const char *socket_path;
+    const char *listen_address;
+    const char *output_path;
+    int window_seconds;
+    double trigger_cpu_percent;
+    const char *history_path;
+    const char *metric_list;
+    const char *from_time;
+    const char *to_time;
+    const char *aggregation;
+    double bucket_seconds;
+    int list_series;
+    const char *rules_path;
+    const char *alert_log_path;
+    const char *alert_hook;
+    const char *probe_periods;
+    const char *plugin_paths;
+    int lateness_ms;
+    int buffer_kb;
+    int refresh_ms;
+    int once;
+    const char *baseline_path;
+    int baseline_ms;
+    int batch_rows;
+    char **inputs;
+    int input_count;
 } CliOptions;
 
 int cli_parse_arguments(int argc, char **argv, CliOptions *out);
@@ -0,0 +1,90 @@
+#include "cli_buffer.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+int cli_buffer_init(CliBuffer *buffer, size_t capacity) {
+    if (!buffer) return -1;
+    buffer->data = malloc(capacity > 0 ? capacity : 1);
+    if (!buffer->data) {
+        return -1;
+    }
+    buffer->length = 0;
+    buffer->capacity = capacity > 0 ? capacity : 1;
+    buffer->data[0] = '\0';
+    return 0;
+}
+
+void cli_buffer_destroy(CliBuffer *buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+void cli_buffer_reset(CliBuffer *buffer) {
+    if (!buffer || !buffer->data) return;
+    buffer->length = 0;
+    buffer->data[0] = '\0';
+}
+
+int cli_buffer_reserve(CliBuffer *buffer, size_t extra) {
+    if (!buffer) return -1;
+    if (buffer->length + extra + 1 <= buffer->capacity) {
+        return 0;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 64;
+    while (buffer->length + extra + 1 > capacity) {
+        capacity *= 2;
+    }
+
+    char *grown = realloc(buffer->data, capacity);
+    if (!grown) {
+        return -1;
+    }
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+int cli_buffer_append(CliBuffer *buffer, const void *data, size_t length) {
+    if (cli_buffer_reserve(buffer, length) != 0) {
+        return -1;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+int cli_buffer_appendf(CliBuffer *buffer, const char *fmt, ...) {
+    if (!buffer || !fmt) return -1;
+
+    va_list args;
+    va_start(args, fmt);
+    int needed = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, fmt, args);
+    va_end(args);
+    if (needed < 0) {
+        return -1;
+    }
+
+    if (buffer->length + (size_t)needed + 1 > buffer->capacity) {
+        if (cli_buffer_reserve(buffer, (size_t)needed) != 0) {
+            buffer->data[buffer->length] = '\0';
+            return -1;
+        }
+        va_start(args, fmt);
+        vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, fmt, args);
+        va_end(args);
+    }
+
+    buffer->length += (size_t)needed;
+    return 0;
+}
+
+int cli_buffer_write(const CliBuffer *buffer, FILE *stream) {
+    if (!buffer || !stream) return -1;
+    return fwrite(buffer->data, 1, buffer->length, stream) == buffer->length ? 0 : -1;
+}
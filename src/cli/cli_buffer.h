@@ -0,0 +1,21 @@
+#ifndef SNOOPER_CLI_BUFFER_H
+#define SNOOPER_CLI_BUFFER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} CliBuffer;
+
+int cli_buffer_init(CliBuffer *buffer, size_t capacity);
+void cli_buffer_destroy(CliBuffer *buffer);
+void cli_buffer_reset(CliBuffer *buffer);
+int cli_buffer_reserve(CliBuffer *buffer, size_t extra);
+int cli_buffer_append(CliBuffer *buffer, const void *data, size_t length);
+int cli_buffer_appendf(CliBuffer *buffer, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+int cli_buffer_write(const CliBuffer *buffer, FILE *stream);
+
+#endif
@@ -0,0 +1,405 @@
+#include "cli_export.h"
+#include "cli_alerts.h"
+#include "cli_buffer.h"
+#include "cli_format_prometheus.h"
+#include "cli_telemetry.h"
+#include "snooper/telemetry.h"
+#include "timeutil.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define CLI_EXPORT_MAX_CONNECTIONS 256
+#define CLI_EXPORT_REQUEST_MAX 2048
+
+typedef struct {
+    CliBuffer buffer;
+    int refcount;
+} CliExportPage;
+
+typedef struct {
+    int fd;
+    char request[CLI_EXPORT_REQUEST_MAX];
+    size_t request_length;
+    CliExportPage *page;
+    const char *reply;
+    size_t reply_length;
+    size_t offset;
+    int close_after_reply;
+} CliExportConnection;
+
+typedef struct {
+    int listen_fd;
+    CliExportConnection connections[CLI_EXPORT_MAX_CONNECTIONS];
+    size_t connection_count;
+    // Pages are double-buffered: scrapes hold a reference to the page they
+    // are writing, and the next sample renders into whichever page is free.
+    CliExportPage *current;
+    CliExportPage *spare;
+    CliBuffer body;
+} CliExporter;
+
+static const char not_found_reply[] =
+    "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n\r\nnot found\n";
+static const char unavailable_reply[] =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\nContent-Length: 12\r\n\r\nwarming up.\n";
+static const char bad_request_reply[] =
+    "HTTP/1.1 400 Bad Request\r\nContent-Type: text/plain\r\nContent-Length: 12\r\nConnection: close\r\n\r\nbad request\n";
+
+static volatile sig_atomic_t export_stop = 0;
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    export_stop = 1;
+}
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static CliExportPage *page_create(void) {
+    CliExportPage *page = calloc(1, sizeof(*page));
+    if (!page) {
+        return NULL;
+    }
+    if (cli_buffer_init(&page->buffer, 65536) != 0) {
+        free(page);
+        return NULL;
+    }
+    page->refcount = 1;
+    return page;
+}
+
+static void page_release(CliExportPage *page) {
+    if (!page) return;
+    if (--page->refcount == 0) {
+        cli_buffer_destroy(&page->buffer);
+        free(page);
+    }
+}
+
+static void exporter_render(CliExporter *exporter, const SnooperSnapshot *snapshot) {
+    if (!exporter->spare || exporter->spare->refcount > 1) {
+        page_release(exporter->spare);
+        exporter->spare = page_create();
+        if (!exporter->spare) {
+            return;
+        }
+    }
+
+    cli_buffer_reset(&exporter->body);
+    cli_encode_snapshot_prometheus(snapshot, &exporter->body);
+
+    CliBuffer *out = &exporter->spare->buffer;
+    cli_buffer_reset(out);
+    cli_buffer_appendf(out, "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %zu\r\n\r\n", exporter->body.length);
+    cli_buffer_append(out, exporter->body.data, exporter->body.length);
+
+    CliExportPage *rendered = exporter->spare;
+    exporter->spare = exporter->current;
+    exporter->current = rendered;
+}
+
+static int parse_listen_address(const char *text, struct sockaddr_in *address) {
+    const char *colon = strrchr(text, ':');
+    if (!colon || colon == text || colon - text >= 64) {
+        return -1;
+    }
+
+    char host[64];
+    memcpy(host, text, (size_t)(colon - text));
+    host[colon - text] = '\0';
+
+    char *end = NULL;
+    long port = strtol(colon + 1, &end, 10);
+    if (!end || *end != '\0' || port <= 0 || port > 65535) {
+        return -1;
+    }
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_port = htons((uint16_t)port);
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1 ? 0 : -1;
+}
+
+static int exporter_listen(const char *listen_address) {
+    struct sockaddr_in address;
+    if (parse_listen_address(listen_address, &address) != 0) {
+        fprintf(stderr, "Invalid listen address: %s (expected <ipv4>:<port>)\n", listen_address);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 128) != 0 || set_nonblocking(fd) != 0) {
+        perror(listen_address);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void connection_close(CliExporter *exporter, size_t index) {
+    CliExportConnection *connection = &exporter->connections[index];
+    close(connection->fd);
+    page_release(connection->page);
+    exporter->connections[index] = exporter->connections[exporter->connection_count - 1];
+    --exporter->connection_count;
+}
+
+static void connection_set_reply(CliExportConnection *connection, CliExportPage *page, const char *reply, size_t length) {
+    if (page) {
+        ++page->refcount;
+    }
+    connection->page = page;
+    connection->reply = reply;
+    connection->reply_length = length;
+    connection->offset = 0;
+}
+
+static int header_contains(const char *headers, const char *needle) {
+    size_t length = strlen(needle);
+    for (const char *line = headers; line && *line; ) {
+        if (strncasecmp(line, needle, length) == 0) {
+            return 1;
+        }
+        line = strchr(line, '\n');
+        if (line) ++line;
+    }
+    return 0;
+}
+
+static void connection_dispatch(CliExporter *exporter, CliExportConnection *connection, size_t header_length) {
+    char *request = connection->request;
+    request[header_length] = '\0';
+
+    connection->close_after_reply = strstr(request, " HTTP/1.0\r\n") != NULL || header_contains(request, "connection: close");
+    if (strncmp(request, "GET ", 4) != 0) {
+        connection->close_after_reply = 1;
+        connection_set_reply(connection, NULL, bad_request_reply, sizeof(bad_request_reply) - 1);
+    } else if (strncmp(request + 4, "/metrics ", 9) != 0 && strncmp(request + 4, "/metrics?", 9) != 0) {
+        connection_set_reply(connection, NULL, not_found_reply, sizeof(not_found_reply) - 1);
+    } else if (!exporter->current) {
+        connection_set_reply(connection, NULL, unavailable_reply, sizeof(unavailable_reply) - 1);
+    } else {
+        CliExportPage *page = exporter->current;
+        connection_set_reply(connection, page, page->buffer.data, page->buffer.length);
+    }
+}
+
+static void connection_take_request(CliExporter *exporter, CliExportConnection *connection) {
+    char *end = strstr(connection->request, "\r\n\r\n");
+    if (!end) {
+        return;
+    }
+
+    size_t header_length = (size_t)(end - connection->request) + 4;
+    char next = connection->request[header_length];
+    connection_dispatch(exporter, connection, header_length);
+    connection->request[header_length] = next;
+
+    // Keep any pipelined request bytes for after the reply goes out.
+    memmove(connection->request, connection->request + header_length, connection->request_length - header_length + 1);
+    connection->request_length -= header_length;
+}
+
+static int connection_read(CliExporter *exporter, CliExportConnection *connection) {
+    for (;;) {
+        if (connection->reply) {
+            return 0;
+        }
+
+        size_t space = sizeof(connection->request) - 1 - connection->request_length;
+        if (space == 0) {
+            return -1;
+        }
+
+        ssize_t got = read(connection->fd, connection->request + connection->request_length, space);
+        if (got == 0) {
+            return -1;
+        } else if (got < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+
+        connection->request_length += (size_t)got;
+        connection->request[connection->request_length] = '\0';
+        connection_take_request(exporter, connection);
+    }
+}
+
+static int connection_write(CliExporter *exporter, CliExportConnection *connection) {
+    while (connection->reply) {
+        while (connection->offset < connection->reply_length) {
+            ssize_t written = write(connection->fd, connection->reply + connection->offset, connection->reply_length - connection->offset);
+            if (written > 0) {
+                connection->offset += (size_t)written;
+            } else if (written < 0 && errno == EINTR) {
+                continue;
+            } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return 0;
+            } else {
+                return -1;
+            }
+        }
+
+        page_release(connection->page);
+        connection->page = NULL;
+        connection->reply = NULL;
+        if (connection->close_after_reply) {
+            return -1;
+        }
+
+        connection_take_request(exporter, connection);
+    }
+    return 0;
+}
+
+static void exporter_accept(CliExporter *exporter) {
+    for (;;) {
+        int fd = accept(exporter->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (exporter->connection_count == CLI_EXPORT_MAX_CONNECTIONS || set_nonblocking(fd) != 0) {
+            close(fd);
+            continue;
+        }
+
+        CliExportConnection *connection = &exporter->connections[exporter->connection_count++];
+        memset(connection, 0, sizeof(*connection));
+        connection->fd = fd;
+    }
+}
+
+int cli_run_export(const CliOptions *opts) {
+    if (!opts || !opts->listen_address) return 1;
+
+    SnooperTelemetry telemetry;
+    if (cli_telemetry_open(&telemetry, opts) != 0) {
+        return 1;
+    }
+
+    CliAlerts alerts;
+    if (cli_alerts_open(&alerts, opts) != 0) {
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    static CliExporter exporter;
+    memset(&exporter, 0, sizeof(exporter));
+    if (cli_buffer_init(&exporter.body, 65536) != 0) {
+        cli_alerts_close(&alerts);
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+    exporter.listen_fd = exporter_listen(opts->listen_address);
+    if (exporter.listen_fd < 0) {
+        cli_buffer_destroy(&exporter.body);
+        cli_alerts_close(&alerts);
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+
+    uint64_t interval_ns = (uint64_t)opts->interval_ms * 1000000ull;
+    uint64_t next_sample_ns = snooper_monotonic_now_ns();
+    static struct pollfd fds[CLI_EXPORT_MAX_CONNECTIONS + 1];
+    int status = 0;
+
+    while (!export_stop) {
+        uint64_t now = snooper_monotonic_now_ns();
+        if (now >= next_sample_ns) {
+            const SnooperSnapshot *snapshot = NULL;
+            SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
+            if (rc == SNOOPER_OK) {
+                exporter_render(&exporter, snapshot);
+                cli_alerts_evaluate(&alerts, snapshot);
+            } else if (rc != SNOOPER_ERR_WARMUP) {
+                fprintf(stderr, "Failed to collect snapshot (%d).\n", rc);
+                status = 1;
+                break;
+            }
+            next_sample_ns += interval_ns;
+            if (next_sample_ns <= now) {
+                next_sample_ns = now + interval_ns;
+            }
+            continue;
+        }
+
+        fds[0].fd = exporter.listen_fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        for (size_t i = 0; i < exporter.connection_count; ++i) {
+            fds[i + 1].fd = exporter.connections[i].fd;
+            fds[i + 1].events = exporter.connections[i].reply ? POLLOUT : POLLIN;
+            fds[i + 1].revents = 0;
+        }
+
+        int timeout_ms = (int)((next_sample_ns - now + 999999ull) / 1000000ull);
+        size_t polled = exporter.connection_count;
+        int ready = poll(fds, (nfds_t)(polled + 1), timeout_ms);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            status = 1;
+            break;
+        }
+        if (ready == 0) {
+            continue;
+        }
+
+        for (size_t i = polled; i > 0; --i) {
+            short revents = fds[i].revents;
+            CliExportConnection *connection = &exporter.connections[i - 1];
+            int failed = (revents & (POLLERR | POLLNVAL)) != 0;
+            if (!failed && (revents & (POLLIN | POLLHUP))) {
+                failed = connection_read(&exporter, connection) < 0;
+            }
+            if (!failed && connection->reply) {
+                failed = connection_write(&exporter, connection) < 0;
+            }
+            if (failed) {
+                connection_close(&exporter, i - 1);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            exporter_accept(&exporter);
+        }
+    }
+
+    while (exporter.connection_count > 0) {
+        connection_close(&exporter, exporter.connection_count - 1);
+    }
+    close(exporter.listen_fd);
+    page_release(exporter.current);
+    page_release(exporter.spare);
+    cli_buffer_destroy(&exporter.body);
+    cli_alerts_close(&alerts);
+    snooper_telemetry_destroy(&telemetry);
+    return status;
+}
@@ -0,0 +1,8 @@
+#ifndef SNOOPER_CLI_EXPORT_H
+#define SNOOPER_CLI_EXPORT_H
+
+#include "cli_args.h"
+
+int cli_run_export(const CliOptions *opts);
+
+#endif
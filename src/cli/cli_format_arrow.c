@@ -0,0 +1,462 @@
+#include "cli_format_arrow.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Values from the Arrow format's Schema.fbs and Message.fbs.
+#define ARROW_METADATA_V5 4
+#define ARROW_HEADER_SCHEMA 1
+#define ARROW_HEADER_RECORD_BATCH 3
+#define ARROW_TYPE_INT 2
+#define ARROW_TYPE_FLOATING_POINT 3
+#define ARROW_TYPE_TIMESTAMP 10
+#define ARROW_PRECISION_DOUBLE 2
+#define ARROW_TIME_UNIT_NANOSECOND 3
+#define ARROW_CONTINUATION 0xFFFFFFFFu
+
+#define ARROW_FIXED_COLUMNS 10
+#define ARROW_CORE_COLUMNS 3
+#define FB_MAX_FIELDS 8
+
+// A forward-only flatbuffer builder. Tables are written vtable first, and
+// offsets to child objects are reserved as slots and patched once the child
+// has been written after them, so every uoffset points forward as the format
+// requires. Scalars are little-endian regardless of the host.
+typedef struct {
+    CliBuffer *buf;
+    int failed;
+} FbBuilder;
+
+typedef struct {
+    size_t vtable;
+    size_t table;
+} FbTable;
+
+static void put_le(uint8_t *dst, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void fb_bytes(FbBuilder *fb, const void *data, size_t length) {
+    if (!fb->failed && cli_buffer_append(fb->buf, data, length) != 0) {
+        fb->failed = 1;
+    }
+}
+
+static void fb_align(FbBuilder *fb, size_t align, size_t remainder) {
+    static const uint8_t zeros[8];
+    size_t pad = (align + remainder - fb->buf->length % align) % align;
+    fb_bytes(fb, zeros, pad);
+}
+
+static void fb_scalar(FbBuilder *fb, uint64_t value, size_t size) {
+    uint8_t bytes[8];
+    fb_align(fb, size, 0);
+    put_le(bytes, value, size);
+    fb_bytes(fb, bytes, size);
+}
+
+static void fb_patch(FbBuilder *fb, size_t position, uint64_t value, size_t size) {
+    if (fb->failed) return;
+    put_le((uint8_t *)fb->buf->data + position, value, size);
+}
+
+static void fb_link(FbBuilder *fb, size_t slot, size_t target) {
+    fb_patch(fb, slot, target - slot, 4);
+}
+
+static void fb_table_begin(FbBuilder *fb, FbTable *table, unsigned fields) {
+    uint8_t vtable[4 + 2 * FB_MAX_FIELDS];
+    memset(vtable, 0, sizeof(vtable));
+    put_le(vtable, 4 + 2 * fields, 2);
+
+    fb_align(fb, 2, 0);
+    table->vtable = fb->buf->length;
+    fb_bytes(fb, vtable, 4 + 2 * fields);
+    fb_align(fb, 8, 0);
+    table->table = fb->buf->length;
+    fb_scalar(fb, table->table - table->vtable, 4);
+}
+
+static void fb_table_field(FbBuilder *fb, FbTable *table, unsigned index, uint64_t value, size_t size) {
+    fb_align(fb, size, 0);
+    fb_patch(fb, table->vtable + 4 + 2 * index, fb->buf->length - table->table, 2);
+    fb_scalar(fb, value, size);
+}
+
+static size_t fb_table_offset(FbBuilder *fb, FbTable *table, unsigned index) {
+    fb_table_field(fb, table, index, 0, 4);
+    return fb->buf->length - 4;
+}
+
+static void fb_table_end(FbBuilder *fb, FbTable *table) {
+    fb_patch(fb, table->vtable + 2, fb->buf->length - table->table, 2);
+}
+
+static size_t fb_string(FbBuilder *fb, const char *text) {
+    size_t length = strlen(text);
+    fb_align(fb, 4, 0);
+    size_t position = fb->buf->length;
+    fb_scalar(fb, length, 4);
+    fb_bytes(fb, text, length + 1);
+    return position;
+}
+
+// Writes the length of a vector of offsets followed by zeroed slots; slot i
+// is at the returned position + 4 + 4 * i.
+static size_t fb_offset_vector(FbBuilder *fb, size_t count) {
+    fb_align(fb, 4, 0);
+    size_t position = fb->buf->length;
+    fb_scalar(fb, count, 4);
+    for (size_t i = 0; i < count; ++i) {
+        fb_scalar(fb, 0, 4);
+    }
+    return position;
+}
+
+// Starts a vector of 16-byte structs of two int64s; the caller writes the
+// 2 * count values with fb_scalar.
+static size_t fb_pair_vector(FbBuilder *fb, size_t count) {
+    fb_align(fb, 8, 4);
+    size_t position = fb->buf->length;
+    fb_scalar(fb, count, 4);
+    return position;
+}
+
+static void encode_type(FbBuilder *fb, size_t slot, CliArrowType type) {
+    FbTable table;
+    if (type == CLI_ARROW_UINT64) {
+        fb_table_begin(fb, &table, 2);
+        fb_link(fb, slot, table.table);
+        fb_table_field(fb, &table, 0, 64, 4);
+        fb_table_field(fb, &table, 1, 0, 1);
+        fb_table_end(fb, &table);
+    } else if (type == CLI_ARROW_DOUBLE) {
+        fb_table_begin(fb, &table, 1);
+        fb_link(fb, slot, table.table);
+        fb_table_field(fb, &table, 0, ARROW_PRECISION_DOUBLE, 2);
+        fb_table_end(fb, &table);
+    } else {
+        fb_table_begin(fb, &table, 2);
+        fb_link(fb, slot, table.table);
+        fb_table_field(fb, &table, 0, ARROW_TIME_UNIT_NANOSECOND, 2);
+        size_t timezone = fb_table_offset(fb, &table, 1);
+        fb_table_end(fb, &table);
+        fb_link(fb, timezone, fb_string(fb, "UTC"));
+    }
+}
+
+static uint8_t type_tag(CliArrowType type) {
+    switch (type) {
+    case CLI_ARROW_UINT64:
+        return ARROW_TYPE_INT;
+    case CLI_ARROW_TIMESTAMP:
+        return ARROW_TYPE_TIMESTAMP;
+    case CLI_ARROW_DOUBLE:
+        return ARROW_TYPE_FLOATING_POINT;
+    }
+    return ARROW_TYPE_FLOATING_POINT;
+}
+
+static void encode_field(FbBuilder *fb, size_t slot, const CliArrowColumn *column) {
+    FbTable table;
+    fb_table_begin(fb, &table, 6);
+    fb_link(fb, slot, table.table);
+    size_t name = fb_table_offset(fb, &table, 0);
+    fb_table_field(fb, &table, 1, 1, 1);
+    fb_table_field(fb, &table, 2, type_tag(column->type), 1);
+    size_t type = fb_table_offset(fb, &table, 3);
+    size_t children = fb_table_offset(fb, &table, 5);
+    fb_table_end(fb, &table);
+
+    fb_link(fb, name, fb_string(fb, column->name));
+    encode_type(fb, type, column->type);
+    fb_link(fb, children, fb_offset_vector(fb, 0));
+}
+
+static void encode_key_value(FbBuilder *fb, size_t slot, const char *key, const char *value) {
+    FbTable table;
+    fb_table_begin(fb, &table, 2);
+    fb_link(fb, slot, table.table);
+    size_t key_slot = fb_table_offset(fb, &table, 0);
+    size_t value_slot = fb_table_offset(fb, &table, 1);
+    fb_table_end(fb, &table);
+    fb_link(fb, key_slot, fb_string(fb, key));
+    fb_link(fb, value_slot, fb_string(fb, value));
+}
+
+// Writes the root offset and a Message table, and returns the slot for its
+// header union.
+static size_t encode_message(FbBuilder *fb, uint8_t header_type, uint64_t body_length) {
+    fb_scalar(fb, 0, 4);
+    FbTable table;
+    fb_table_begin(fb, &table, 4);
+    fb_link(fb, 0, table.table);
+    fb_table_field(fb, &table, 0, ARROW_METADATA_V5, 2);
+    fb_table_field(fb, &table, 1, header_type, 1);
+    size_t header = fb_table_offset(fb, &table, 2);
+    fb_table_field(fb, &table, 3, body_length, 8);
+    fb_table_end(fb, &table);
+    return header;
+}
+
+static void encode_schema(const CliArrowWriter *writer, FbBuilder *fb) {
+    size_t header = encode_message(fb, ARROW_HEADER_SCHEMA, 0);
+
+    FbTable schema;
+    fb_table_begin(fb, &schema, 3);
+    fb_link(fb, header, schema.table);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    fb_table_field(fb, &schema, 0, 1, 2);
+#else
+    fb_table_field(fb, &schema, 0, 0, 2);
+#endif
+    size_t fields = fb_table_offset(fb, &schema, 1);
+    size_t metadata = fb_table_offset(fb, &schema, 2);
+    fb_table_end(fb, &schema);
+
+    size_t vector = fb_offset_vector(fb, writer->column_count);
+    fb_link(fb, fields, vector);
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        encode_field(fb, vector + 4 + 4 * i, &writer->columns[i]);
+    }
+
+    char session_id[17];
+    snprintf(session_id, sizeof(session_id), "%016llx", (unsigned long long)writer->session_id);
+    vector = fb_offset_vector(fb, 2);
+    fb_link(fb, metadata, vector);
+    encode_key_value(fb, vector + 4, "snooper.session_id", session_id);
+    encode_key_value(fb, vector + 8, "snooper.boot_id", writer->boot_id);
+}
+
+static size_t validity_length(const CliArrowWriter *writer, const CliArrowColumn *column) {
+    return column->null_count > 0 ? (writer->rows + 7) / 8 : 0;
+}
+
+static size_t padded(size_t length) {
+    return (length + 7) & ~(size_t)7;
+}
+
+static uint64_t body_length(const CliArrowWriter *writer) {
+    uint64_t length = 0;
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        length += padded(validity_length(writer, &writer->columns[i])) + writer->rows * 8;
+    }
+    return length;
+}
+
+static void encode_record_batch(const CliArrowWriter *writer, FbBuilder *fb) {
+    size_t header = encode_message(fb, ARROW_HEADER_RECORD_BATCH, body_length(writer));
+
+    FbTable batch;
+    fb_table_begin(fb, &batch, 3);
+    fb_link(fb, header, batch.table);
+    fb_table_field(fb, &batch, 0, writer->rows, 8);
+    size_t nodes = fb_table_offset(fb, &batch, 1);
+    size_t buffers = fb_table_offset(fb, &batch, 2);
+    fb_table_end(fb, &batch);
+
+    fb_link(fb, nodes, fb_pair_vector(fb, writer->column_count));
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        fb_scalar(fb, writer->rows, 8);
+        fb_scalar(fb, writer->columns[i].null_count, 8);
+    }
+
+    fb_link(fb, buffers, fb_pair_vector(fb, writer->column_count * 2));
+    uint64_t offset = 0;
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        size_t validity = validity_length(writer, &writer->columns[i]);
+        fb_scalar(fb, offset, 8);
+        fb_scalar(fb, validity, 8);
+        offset += padded(validity);
+        fb_scalar(fb, offset, 8);
+        fb_scalar(fb, writer->rows * 8, 8);
+        offset += writer->rows * 8;
+    }
+}
+
+// Frames the flatbuffer in writer->metadata as an encapsulated IPC message:
+// continuation marker, metadata length padded so the body starts 8-aligned,
+// metadata, then the body buffers.
+static int write_message(CliArrowWriter *writer, int with_body) {
+    static const uint8_t zeros[8];
+    CliBuffer *out = &writer->message;
+    uint8_t prefix[8];
+    size_t metadata_length = padded(writer->metadata.length);
+
+    cli_buffer_reset(out);
+    put_le(prefix, ARROW_CONTINUATION, 4);
+    put_le(prefix + 4, metadata_length, 4);
+    int rc = cli_buffer_append(out, prefix, sizeof(prefix));
+    rc |= cli_buffer_append(out, writer->metadata.data, writer->metadata.length);
+    rc |= cli_buffer_append(out, zeros, metadata_length - writer->metadata.length);
+
+    for (size_t i = 0; with_body && i < writer->column_count; ++i) {
+        const CliArrowColumn *column = &writer->columns[i];
+        size_t validity = validity_length(writer, column);
+        rc |= cli_buffer_append(out, column->validity, validity);
+        rc |= cli_buffer_append(out, zeros, padded(validity) - validity);
+        rc |= cli_buffer_append(out, column->values, writer->rows * 8);
+    }
+    if (rc != 0 || cli_buffer_write(out, writer->stream) != 0 || fflush(writer->stream) != 0) {
+        writer->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+static void define_column(CliArrowWriter *writer, const char *name, CliArrowType type) {
+    CliArrowColumn *column = &writer->columns[writer->column_count++];
+    snprintf(column->name, sizeof(column->name), "%s", name);
+    column->type = type;
+}
+
+static int create_columns(CliArrowWriter *writer, size_t core_count) {
+    size_t count = ARROW_FIXED_COLUMNS + core_count * ARROW_CORE_COLUMNS;
+    writer->columns = calloc(count, sizeof(CliArrowColumn));
+    if (!writer->columns) return -1;
+
+    writer->core_count = core_count;
+    define_column(writer, "monotonic_ns", CLI_ARROW_UINT64);
+    define_column(writer, "wall_time", CLI_ARROW_TIMESTAMP);
+    define_column(writer, "cpu.used", CLI_ARROW_DOUBLE);
+    define_column(writer, "gpu.used", CLI_ARROW_DOUBLE);
+    define_column(writer, "memory.used_bytes", CLI_ARROW_UINT64);
+    define_column(writer, "memory.free_bytes", CLI_ARROW_UINT64);
+    define_column(writer, "memory.compressed_bytes", CLI_ARROW_UINT64);
+    define_column(writer, "load.avg_1", CLI_ARROW_DOUBLE);
+    define_column(writer, "load.avg_5", CLI_ARROW_DOUBLE);
+    define_column(writer, "load.avg_15", CLI_ARROW_DOUBLE);
+    for (size_t i = 0; i < core_count; ++i) {
+        char name[CLI_ARROW_NAME_MAX];
+        snprintf(name, sizeof(name), "cpu.core[%zu].user", i);
+        define_column(writer, name, CLI_ARROW_DOUBLE);
+        snprintf(name, sizeof(name), "cpu.core[%zu].system", i);
+        define_column(writer, name, CLI_ARROW_DOUBLE);
+        snprintf(name, sizeof(name), "cpu.core[%zu].idle", i);
+        define_column(writer, name, CLI_ARROW_DOUBLE);
+    }
+
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        writer->columns[i].values = malloc(writer->batch_rows * sizeof(uint64_t));
+        writer->columns[i].validity = calloc((writer->batch_rows + 7) / 8, 1);
+        if (!writer->columns[i].values || !writer->columns[i].validity) return -1;
+    }
+
+    FbBuilder fb = { &writer->metadata, 0 };
+    cli_buffer_reset(&writer->metadata);
+    encode_schema(writer, &fb);
+    if (fb.failed) return -1;
+    return write_message(writer, 0);
+}
+
+static int flush_batch(CliArrowWriter *writer) {
+    if (writer->rows == 0) return 0;
+
+    FbBuilder fb = { &writer->metadata, 0 };
+    cli_buffer_reset(&writer->metadata);
+    encode_record_batch(writer, &fb);
+    int rc = fb.failed ? -1 : write_message(writer, 1);
+
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        memset(writer->columns[i].validity, 0, (writer->batch_rows + 7) / 8);
+        writer->columns[i].null_count = 0;
+    }
+    writer->rows = 0;
+    return rc;
+}
+
+static void set_value(CliArrowWriter *writer, size_t column, uint64_t value, int valid) {
+    CliArrowColumn *target = &writer->columns[column];
+    size_t row = writer->rows;
+    target->values[row] = valid ? value : 0;
+    if (valid) {
+        target->validity[row / 8] |= (uint8_t)(1u << (row % 8));
+    } else {
+        target->null_count++;
+    }
+}
+
+static uint64_t double_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+int cli_arrow_open(CliArrowWriter *writer, const SnooperSession *session, size_t batch_rows, FILE *stream) {
+    if (!writer || !session || !stream || batch_rows == 0) return -1;
+
+    memset(writer, 0, sizeof(*writer));
+    writer->stream = stream;
+    writer->batch_rows = batch_rows;
+    writer->session_id = session->session_id;
+    snprintf(writer->boot_id, sizeof(writer->boot_id), "%s", session->boot_id);
+    if (cli_buffer_init(&writer->metadata, 4096) != 0 || cli_buffer_init(&writer->message, 4096) != 0) {
+        cli_buffer_destroy(&writer->metadata);
+        fprintf(stderr, "Failed to allocate Arrow buffers.\n");
+        return -1;
+    }
+    return 0;
+}
+
+int cli_arrow_append(CliArrowWriter *writer, const SnooperSnapshot *snapshot) {
+    if (!writer || !snapshot || writer->failed) return -1;
+
+    if (!writer->columns && create_columns(writer, snapshot->core_count) != 0) {
+        writer->failed = 1;
+        return -1;
+    }
+
+    const SnooperSystemMetrics *system = &snapshot->system_metrics;
+    int64_t wall_ns = (int64_t)snapshot->wall_time.tv_sec * 1000000000ll + snapshot->wall_time.tv_nsec;
+    set_value(writer, 0, snapshot->monotonic_ns, 1);
+    set_value(writer, 1, (uint64_t)wall_ns, 1);
+    set_value(writer, 2, double_bits(snapshot->cpu_used_percent), 1);
+    set_value(writer, 3, double_bits(snapshot->gpu_used_percent), snapshot->gpu_available);
+    set_value(writer, 4, system->memory_used_bytes, system->has_memory);
+    set_value(writer, 5, system->memory_free_bytes, system->has_memory);
+    set_value(writer, 6, system->memory_compressed_bytes, system->has_memory);
+    set_value(writer, 7, double_bits(system->load_avg_1), system->has_load);
+    set_value(writer, 8, double_bits(system->load_avg_5), system->has_load);
+    set_value(writer, 9, double_bits(system->load_avg_15), system->has_load);
+    for (size_t i = 0; i < writer->core_count; ++i) {
+        const SnooperCpuUsage *core = &snapshot->per_core[i];
+        int present = i < snapshot->core_count;
+        size_t column = ARROW_FIXED_COLUMNS + i * ARROW_CORE_COLUMNS;
+        set_value(writer, column, double_bits(core->user), present);
+        set_value(writer, column + 1, double_bits(core->system), present);
+        set_value(writer, column + 2, double_bits(core->idle), present);
+    }
+
+    if (++writer->rows == writer->batch_rows) {
+        return flush_batch(writer);
+    }
+    return 0;
+}
+
+int cli_arrow_close(CliArrowWriter *writer) {
+    if (!writer) return -1;
+
+    int rc = writer->failed ? -1 : 0;
+    if (rc == 0 && !writer->columns && create_columns(writer, 0) != 0) {
+        rc = -1;
+    }
+    if (rc == 0) {
+        uint8_t end[8];
+        put_le(end, ARROW_CONTINUATION, 4);
+        put_le(end + 4, 0, 4);
+        if (flush_batch(writer) != 0 || fwrite(end, 1, sizeof(end), writer->stream) != sizeof(end) || fflush(writer->stream) != 0) {
+            rc = -1;
+        }
+    }
+
+    for (size_t i = 0; i < writer->column_count; ++i) {
+        free(writer->columns[i].values);
+        free(writer->columns[i].validity);
+    }
+    free(writer->columns);
+    cli_buffer_destroy(&writer->metadata);
+    cli_buffer_destroy(&writer->message);
+    memset(writer, 0, sizeof(*writer));
+    return rc;
+}
@@ -0,0 +1,51 @@
+#ifndef SNOOPER_CLI_FORMAT_ARROW_H
+#define SNOOPER_CLI_FORMAT_ARROW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "snooper/session.h"
+#include "snooper/telemetry.h"
+#include "cli_buffer.h"
+
+#define CLI_ARROW_NAME_MAX 48
+
+typedef enum {
+    CLI_ARROW_UINT64,
+    CLI_ARROW_TIMESTAMP,
+    CLI_ARROW_DOUBLE
+} CliArrowType;
+
+// Every column is a nullable 8-byte primitive, so one batch is a validity
+// bitmap and a value array per column.
+typedef struct {
+    char name[CLI_ARROW_NAME_MAX];
+    CliArrowType type;
+    uint64_t *values;
+    uint8_t *validity;
+    size_t null_count;
+} CliArrowColumn;
+
+// Writes snapshots as an Arrow IPC stream. The schema is fixed by the first
+// snapshot: per-core columns are created for its core count, and cores
+// missing from later snapshots are null. Rows are buffered and written as
+// one record batch message per batch_rows snapshots.
+typedef struct {
+    FILE *stream;
+    CliArrowColumn *columns;
+    size_t column_count;
+    size_t core_count;
+    size_t batch_rows;
+    size_t rows;
+    uint64_t session_id;
+    char boot_id[SNOOPER_BOOT_ID_MAX];
+    CliBuffer metadata;
+    CliBuffer message;
+    int failed;
+} CliArrowWriter;
+
+int cli_arrow_open(CliArrowWriter *writer, const SnooperSession *session, size_t batch_rows, FILE *stream);
+int cli_arrow_append(CliArrowWriter *writer, const SnooperSnapshot *snapshot);
+int cli_arrow_close(CliArrowWriter *writer);
+
+#endif
@@ -1,40 +1,429 @@
 #include "cli_format_json.h"
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
-static void emit_snapshot_json(const SnooperSnapshot *snapshot) {
-    if (!snapshot) return;
+static const struct {
+    const char *name;
+    unsigned mask;
+} metric_names[] = {
+    { "cpu", CLI_METRIC_CPU },
+    { "cores", CLI_METRIC_CORES },
+    { "topology", CLI_METRIC_TOPOLOGY },
+    { "sched", CLI_METRIC_SCHED },
+    { "irq", CLI_METRIC_IRQ },
+    { "freq", CLI_METRIC_FREQ },
+    { "power", CLI_METRIC_POWER },
+    { "gpu", CLI_METRIC_GPU },
+    { "net", CLI_METRIC_NET },
+    { "plugins", CLI_METRIC_PLUGINS },
+    { "procs", CLI_METRIC_PROCS },
+    { "numa", CLI_METRIC_NUMA },
+    { "all", CLI_METRIC_ALL },
+};
 
-    printf("{");
-    printf("\"timestamp\":{\"wall\":\"%ld.%09ld\",\"monotonic_ns\":%llu}",
+int cli_parse_metric_list(const char *list, unsigned *mask) {
+    if (!list || !mask) return -1;
+
+    unsigned parsed = 0;
+    const char *cursor = list;
+    while (*cursor) {
+        size_t length = strcspn(cursor, ",");
+        if (length > 0) {
+            size_t i = 0;
+            for (; i < sizeof(metric_names) / sizeof(metric_names[0]); ++i) {
+                if (strlen(metric_names[i].name) == length && strncmp(metric_names[i].name, cursor, length) == 0) {
+                    parsed |= metric_names[i].mask;
+                    break;
+                }
+            }
+            if (i == sizeof(metric_names) / sizeof(metric_names[0])) {
+                return -1;
+            }
+        }
+        cursor += length;
+        if (*cursor == ',') {
+            ++cursor;
+        }
+    }
+
+    *mask = parsed ? parsed : CLI_METRIC_ALL;
+    return 0;
+}
+
+static void emit_topology_usage_json(const SnooperTopologyUsage *usage, CliBuffer *out) {
+    cli_buffer_appendf(out, ",\"topology\":{");
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        cli_buffer_appendf(out, "%s\"%s\":[", level > 0 ? "," : "", snooper_topology_level_name((SnooperTopologyLevel)level));
+        for (size_t g = usage->level_offsets[level]; g < usage->level_offsets[level + 1]; ++g) {
+            const SnooperTopologyGroupUsage *group = &usage->groups[g];
+            cli_buffer_appendf(out, "%s{\"id\":%d,\"cpus\":%d,\"used_percent\":%.2f,\"max_core_percent\":%.2f}"
+                   , g > usage->level_offsets[level] ? "," : ""
+                   , group->id
+                   , group->cpu_count
+                   , group->used_percent
+                   , group->max_core_percent);
+        }
+        cli_buffer_appendf(out, "]");
+    }
+    cli_buffer_appendf(out, "}");
+}
+
+// Strings taken from the kernel or sysctl (interface, irq, thermal zone and
+// power domain names, the boot id) are not trusted to be JSON-safe.
+static void emit_json_string(CliBuffer *out, const char *value) {
+    cli_buffer_append(out, "\"", 1);
+    for (const unsigned char *c = (const unsigned char *)value; *c; ++c) {
+        if (*c == '\\' || *c == '"') {
+            cli_buffer_appendf(out, "\\%c", *c);
+        } else if (*c == '\n') {
+            cli_buffer_append(out, "\\n", 2);
+        } else if (*c < 0x20 || *c == 0x7f) {
+            cli_buffer_appendf(out, "\\u%04x", *c);
+        } else {
+            cli_buffer_append(out, c, 1);
+        }
+    }
+    cli_buffer_append(out, "\"", 1);
+}
+
+static void emit_cores_json(const SnooperSnapshot *snapshot, unsigned metrics, CliBuffer *out) {
+    cli_buffer_appendf(out, ",\"cores\":[");
+    for (size_t i = 0; i < snapshot->core_count; ++i) {
+        const SnooperCpuUsage *core = &snapshot->per_core[i];
+        cli_buffer_appendf(out, "%s{\"user\":%.2f,\"system\":%.2f,\"idle\":%.2f", i > 0 ? "," : "", core->user, core->system, core->idle);
+        if (snapshot->has_sched && (metrics & CLI_METRIC_SCHED) && i < snapshot->sched.core_count && snapshot->sched.cores[i].present) {
+            const SnooperSchedCore *sched = &snapshot->sched.cores[i];
+            cli_buffer_appendf(out, ",\"run_ms_per_sec\":%.3f,\"wait_ms_per_sec\":%.3f,\"timeslices_per_sec\":%.2f,\"avg_wait_us_per_timeslice\":%.3f"
+                   , sched->run_ms_per_sec
+                   , sched->wait_ms_per_sec
+                   , sched->timeslices_per_sec
+                   , sched->avg_wait_us_per_timeslice);
+        }
+        if (snapshot->has_irq && (metrics & CLI_METRIC_IRQ) && i < snapshot->irq.core_count && snapshot->irq.cores[i].present) {
+            const SnooperIrqCore *irq = &snapshot->irq.cores[i];
+            cli_buffer_appendf(out, ",\"irqs_per_sec\":%.2f,\"softirqs_per_sec\":%.2f,\"top_irqs\":[", irq->irqs_per_sec, irq->softirqs_per_sec);
+            for (size_t t = 0; t < irq->top_count; ++t) {
+                cli_buffer_appendf(out, "%s{\"name\":", t > 0 ? "," : "");
+                emit_json_string(out, irq->top[t].name);
+                cli_buffer_appendf(out, ",\"per_sec\":%.2f}", irq->top[t].per_sec);
+            }
+            cli_buffer_appendf(out, "]");
+        }
+        if (snapshot->has_freq && (metrics & CLI_METRIC_FREQ) && i < snapshot->freq.core_count && snapshot->freq.cores[i].present) {
+            const SnooperFreqCore *freq = &snapshot->freq.cores[i];
+            cli_buffer_appendf(out, ",\"current_mhz\":%.0f,\"max_mhz\":%.0f,\"effective_mhz\":%.0f,\"normalized_used_percent\":%.2f,\"core_throttles\":%llu,\"package_throttles\":%llu"
+                   , freq->current_mhz
+                   , freq->max_mhz
+                   , freq->effective_mhz
+                   , freq->normalized_used_percent
+                   , (unsigned long long)freq->core_throttles
+                   , (unsigned long long)freq->package_throttles);
+        }
+        cli_buffer_appendf(out, "}");
+    }
+    cli_buffer_appendf(out, "]");
+}
+
+static void emit_power_json(const SnooperPowerSample *power, CliBuffer *out) {
+    if (!power->available) {
+        cli_buffer_appendf(out, ",\"power\":{\"available\":false}");
+        return;
+    }
+
+    cli_buffer_appendf(out, ",\"power\":{\"available\":true,\"package_watts\":%.3f,\"joules_per_busy_core_second\":%.3f,\"domains\":["
+           , power->package_watts
+           , power->joules_per_busy_core_second);
+    for (size_t i = 0; i < power->domain_count; ++i) {
+        const SnooperPowerDomain *domain = &power->domains[i];
+        cli_buffer_appendf(out, "%s{\"name\":", i > 0 ? "," : "");
+        emit_json_string(out, domain->name);
+        cli_buffer_appendf(out, ",\"watts\":%.3f,\"joules\":%.3f}", domain->watts, domain->joules);
+    }
+    cli_buffer_appendf(out, "]}");
+}
+
+static void emit_plugins_json(const SnooperSnapshot *snapshot, CliBuffer *out) {
+    const SnooperPluginSet *set = snapshot->plugins;
+    cli_buffer_appendf(out, ",\"plugins\":{");
+    for (size_t i = 0; i < set->count; ++i) {
+        const SnooperProbeDescriptor *descriptor = set->probes[i].descriptor;
+        cli_buffer_appendf(out, "%s\"%s\":", i > 0 ? "," : "", descriptor->name);
+        if (!snapshot->plugin_available[i]) {
+            cli_buffer_appendf(out, "null");
+            continue;
+        }
+        cli_buffer_appendf(out, "{");
+        for (size_t f = 0; f < descriptor->field_count; ++f) {
+            const SnooperFieldValue *value = &snapshot->plugin_values[set->probes[i].value_offset + f];
+            cli_buffer_appendf(out, "%s\"%s\":", f > 0 ? "," : "", descriptor->fields[f].name);
+            switch (descriptor->fields[f].type) {
+                case SNOOPER_FIELD_U64:
+                    cli_buffer_appendf(out, "%llu", (unsigned long long)value->u64);
+                    break;
+                case SNOOPER_FIELD_I64:
+                    cli_buffer_appendf(out, "%lld", (long long)value->i64);
+                    break;
+                default:
+                    if (isfinite(value->f64)) {
+                        cli_buffer_appendf(out, "%.6g", value->f64);
+                    } else {
+                        cli_buffer_appendf(out, "null");
+                    }
+                    break;
+            }
+        }
+        cli_buffer_appendf(out, "}");
+    }
+    cli_buffer_appendf(out, "}");
+}
+
+static void emit_processes_json(const SnooperProcessStats *processes, CliBuffer *out) {
+    cli_buffer_appendf(out, ",\"procs\":{\"count\":%zu,\"threads\":%llu,\"top\":["
+           , processes->process_count
+           , (unsigned long long)processes->thread_count);
+    for (size_t i = 0; i < processes->top_count; ++i) {
+        const SnooperProcess *process = &processes->top[i];
+        cli_buffer_appendf(out, "%s{\"pid\":%d,\"name\":", i > 0 ? "," : "", process->pid);
+        emit_json_string(out, process->name);
+        cli_buffer_appendf(out, ",\"state\":\"%c\",\"cpu_percent\":%.2f,\"rss_bytes\":%llu,\"threads\":%llu}"
+               , process->state
+               , process->cpu_percent
+               , (unsigned long long)process->rss_bytes
+               , (unsigned long long)process->threads);
+    }
+    cli_buffer_appendf(out, "]}");
+}
+
+static void emit_numa_json(const SnooperNumaStats *numa, CliBuffer *out) {
+    cli_buffer_appendf(out, ",\"numa\":{\"nodes\":[");
+    for (size_t i = 0; i < numa->node_count; ++i) {
+        const SnooperNumaNode *node = &numa->nodes[i];
+        cli_buffer_appendf(out, "%s{\"id\":%d,\"total_bytes\":%llu,\"free_bytes\":%llu,\"used_bytes\":%llu,\"hit_per_sec\":%.2f,\"miss_per_sec\":%.2f,\"foreign_per_sec\":%.2f,\"local_per_sec\":%.2f,\"other_per_sec\":%.2f}"
+               , i > 0 ? "," : ""
+               , node->id
+               , (unsigned long long)node->total_bytes
+               , (unsigned long long)node->free_bytes
+               , (unsigned long long)node->used_bytes
+               , node->hit_per_sec
+               , node->miss_per_sec
+               , node->foreign_per_sec
+               , node->local_per_sec
+               , node->other_per_sec);
+    }
+    cli_buffer_appendf(out, "]");
+    if (numa->has_vmstat) {
+        cli_buffer_appendf(out, ",\"pages_migrated_per_sec\":%.2f,\"migrate_failures_per_sec\":%.2f,\"balancing_migrated_per_sec\":%.2f,\"hint_faults_per_sec\":%.2f,\"hint_faults_local_percent\":%.2f"
+               , numa->pages_migrated_per_sec
+               , numa->migrate_failures_per_sec
+               , numa->balancing_migrated_per_sec
+               , numa->hint_faults_per_sec
+               , numa->hint_faults_local_percent);
+    }
+    cli_buffer_appendf(out, "}");
+}
+
+// Lists only probes that were not refreshed for this snapshot, with the
+// monotonic time of their last sample.
+static void emit_updated_json(const SnooperSnapshot *snapshot, CliBuffer *out) {
+    int stale = 0;
+    for (int probe = 0; probe < SNOOPER_PROBE_COUNT; ++probe) {
+        if (snapshot->updated_ns[probe] == snapshot->monotonic_ns) {
+            continue;
+        }
+        cli_buffer_appendf(out, "%s\"%s\":%llu"
+               , stale++ ? "," : ",\"updated_ns\":{"
+               , snooper_probe_name((SnooperProbeId)probe)
+               , (unsigned long long)snapshot->updated_ns[probe]);
+    }
+    for (size_t i = 0; snapshot->plugins && i < snapshot->plugins->count; ++i) {
+        if (snapshot->plugin_updated_ns[i] == snapshot->monotonic_ns) {
+            continue;
+        }
+        cli_buffer_appendf(out, "%s\"%s\":%llu"
+               , stale++ ? "," : ",\"updated_ns\":{"
+               , snapshot->plugins->probes[i].descriptor->name
+               , (unsigned long long)snapshot->plugin_updated_ns[i]);
+    }
+    if (stale) {
+        cli_buffer_appendf(out, "}");
+    }
+}
+
+void cli_encode_snapshot_json(const SnooperSnapshot *snapshot, unsigned metrics, CliBuffer *out) {
+    if (!snapshot || !out) return;
+
+    cli_buffer_appendf(out, "{\"type\":\"snapshot\",\"session_id\":\"%016llx\",", (unsigned long long)snapshot->session_id);
+    cli_buffer_appendf(out, "\"timestamp\":{\"wall\":\"%ld.%09ld\",\"monotonic_ns\":%llu,\"wall_offset_ns\":%lld}",
            (long)snapshot->wall_time.tv_sec,
            (long)snapshot->wall_time.tv_nsec,
-           (unsigned long long)snapshot->monotonic_ns);
-    printf(",\"cpu\":{\"used_percent\":%.2f}", snapshot->cpu_used_percent);
-    printf(",\"gpu\":{\"available\":%s,\"used_percent\":%.2f}",
-           snapshot->gpu_available ? "true" : "false",
-           snapshot->gpu_available ? snapshot->gpu_used_percent : 0.0);
+           (unsigned long long)snapshot->monotonic_ns,
+           (long long)snapshot->wall_offset_ns);
+    emit_updated_json(snapshot, out);
+    cli_buffer_appendf(out, ",\"cpu\":{\"used_percent\":%.2f", snapshot->cpu_used_percent);
+    if (metrics & CLI_METRIC_CORES) {
+        emit_cores_json(snapshot, metrics, out);
+    }
+    cli_buffer_appendf(out, "}");
+    if (snapshot->has_topology && (metrics & CLI_METRIC_TOPOLOGY)) {
+        emit_topology_usage_json(&snapshot->topology, out);
+    }
+    if (snapshot->has_freq && (metrics & CLI_METRIC_FREQ)) {
+        cli_buffer_appendf(out, ",\"thermal\":[");
+        for (size_t i = 0; i < snapshot->freq.zone_count; ++i) {
+            cli_buffer_appendf(out, "%s{\"type\":", i > 0 ? "," : "");
+            emit_json_string(out, snapshot->freq.zones[i].type);
+            cli_buffer_appendf(out, ",\"celsius\":%.1f}", snapshot->freq.zones[i].celsius);
+        }
+        cli_buffer_appendf(out, "]");
+    }
+    if (snapshot->has_sched && (metrics & CLI_METRIC_SCHED)) {
+        cli_buffer_appendf(out, ",\"sched\":{\"context_switches_per_sec\":%.2f,\"procs_running\":%llu,\"procs_blocked\":%llu}"
+               , snapshot->sched.context_switches_per_sec
+               , (unsigned long long)snapshot->sched.procs_running
+               , (unsigned long long)snapshot->sched.procs_blocked);
+    }
+    if (metrics & CLI_METRIC_GPU) {
+        cli_buffer_appendf(out, ",\"gpu\":{\"available\":%s,\"used_percent\":%.2f}",
+               snapshot->gpu_available ? "true" : "false",
+               snapshot->gpu_available ? snapshot->gpu_used_percent : 0.0);
+    }
+
+    if (metrics & CLI_METRIC_POWER) {
+        emit_power_json(&snapshot->power, out);
+    }
+
+    if (snapshot->has_network && (metrics & CLI_METRIC_NET)) {
+        cli_buffer_appendf(out, ",\"net\":[");
+        for (size_t i = 0; i < snapshot->network.interface_count; ++i) {
+            const SnooperNetInterface *iface = &snapshot->network.interfaces[i];
+            cli_buffer_appendf(out, "%s{\"index\":%d,\"name\":", i > 0 ? "," : "", iface->index);
+            emit_json_string(out, iface->name);
+            cli_buffer_appendf(out, ",\"present\":%s,\"rx_bytes_per_sec\":%.2f,\"tx_bytes_per_sec\":%.2f,\"rx_packets_per_sec\":%.2f,\"tx_packets_per_sec\":%.2f,\"rx_errors\":%llu,\"tx_errors\":%llu,\"rx_drops\":%llu,\"tx_drops\":%llu}"
+                   , iface->present ? "true" : "false"
+                   , iface->rx_bytes_per_sec
+                   , iface->tx_bytes_per_sec
+                   , iface->rx_packets_per_sec
+                   , iface->tx_packets_per_sec
+                   , (unsigned long long)iface->rx_errors
+                   , (unsigned long long)iface->tx_errors
+                   , (unsigned long long)iface->rx_drops
+                   , (unsigned long long)iface->tx_drops);
+        }
+        cli_buffer_appendf(out, "]");
+    }
+
+    if (snapshot->has_processes && (metrics & CLI_METRIC_PROCS)) {
+        emit_processes_json(&snapshot->processes, out);
+    }
+
+    if (snapshot->has_numa && (metrics & CLI_METRIC_NUMA)) {
+        emit_numa_json(&snapshot->numa, out);
+    }
+
+    if (snapshot->plugins && snapshot->plugins->count > 0 && (metrics & CLI_METRIC_PLUGINS)) {
+        emit_plugins_json(snapshot, out);
+    }
+
+    cli_buffer_appendf(out, "}\n");
+}
+
+static void emit_system_json(const SnooperSystemInfo *info, CliBuffer *out) {
+    cli_buffer_appendf(out, "\"system\":{\"model\":");
+    emit_json_string(out, info->cpu_model);
+    cli_buffer_appendf(out, ",\"arch\":");
+    emit_json_string(out, info->cpu_architecture);
+    cli_buffer_appendf(out, ",\"physical_cores\":%d,\"logical_cores\":%d,\"board_id\":", info->physical_cores, info->logical_cores);
+    emit_json_string(out, info->board_id);
+    cli_buffer_appendf(out, ",\"product\":");
+    emit_json_string(out, info->product_name);
+    cli_buffer_appendf(out, ",\"serial\":");
+    emit_json_string(out, info->serial_number);
+    cli_buffer_appendf(out, ",\"hardware_uuid\":");
+    emit_json_string(out, info->hardware_uuid);
+    cli_buffer_appendf(out, "}");
+}
 
-    if (snapshot->has_system_info) {
-        printf(",\"system\":{\"model\":\"%s\",\"arch\":\"%s\",\"physical_cores\":%d,\"logical_cores\":%d,\"board_id\":\"%s\",\"product\":\"%s\",\"serial\":\"%s\",\"hardware_uuid\":\"%s\"}"
-               , snapshot->system_info.cpu_model
-               , snapshot->system_info.cpu_architecture
-               , snapshot->system_info.physical_cores
-               , snapshot->system_info.logical_cores
-               , snapshot->system_info.board_id
-               , snapshot->system_info.product_name
-               , snapshot->system_info.serial_number
-               , snapshot->system_info.hardware_uuid);
+static void emit_topology_json(const SnooperCpuTopology *topology, CliBuffer *out) {
+    cli_buffer_appendf(out, "\"topology\":{");
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        const SnooperTopologyGroups *groups = &topology->levels[level];
+        cli_buffer_appendf(out, "%s\"%s\":[", level > 0 ? "," : "", snooper_topology_level_name((SnooperTopologyLevel)level));
+        for (size_t g = 0; g < groups->group_count; ++g) {
+            cli_buffer_appendf(out, "%s{\"id\":%d,\"cpus\":[", g > 0 ? "," : "", groups->group_ids[g]);
+            for (size_t k = groups->offsets[g]; k < groups->offsets[g + 1]; ++k) {
+                cli_buffer_appendf(out, "%s%zu", k > groups->offsets[g] ? "," : "", groups->members[k]);
+            }
+            cli_buffer_appendf(out, "]}");
+        }
+        cli_buffer_appendf(out, "]");
     }
+    cli_buffer_appendf(out, "}");
+}
+
+static void encode_info_json(const SnooperSystemInfo *info, const SnooperCpuTopology *topology, CliBuffer *out) {
+    cli_buffer_appendf(out, "{");
+    emit_system_json(info, out);
+    if (topology && topology->available) {
+        cli_buffer_appendf(out, ",");
+        emit_topology_json(topology, out);
+    }
+    cli_buffer_appendf(out, "}\n");
+}
+
+void cli_encode_session_json(const SnooperSession *session, const SnooperCpuTopology *topology, CliBuffer *out) {
+    if (!session || !out) return;
+
+    cli_buffer_appendf(out, "{\"type\":\"session\",\"session_id\":\"%016llx\",\"boot_id\":", (unsigned long long)session->session_id);
+    emit_json_string(out, session->boot_id);
+    cli_buffer_appendf(out, ",\"started\":{\"wall\":\"%ld.%09ld\",\"monotonic_ns\":%llu,\"wall_offset_ns\":%lld}"
+           , (long)session->started_wall_time.tv_sec
+           , (long)session->started_wall_time.tv_nsec
+           , (unsigned long long)session->started_monotonic_ns
+           , (long long)session->wall_offset_ns);
+    if (session->has_system_info) {
+        cli_buffer_appendf(out, ",");
+        emit_system_json(&session->system_info, out);
+    }
+    if (topology && topology->available) {
+        cli_buffer_appendf(out, ",");
+        emit_topology_json(topology, out);
+    }
+    cli_buffer_appendf(out, "}\n");
+}
+
+static CliBuffer *stdout_buffer(void) {
+    static CliBuffer buffer;
+    if (!buffer.data && cli_buffer_init(&buffer, 16384) != 0) {
+        return NULL;
+    }
+    cli_buffer_reset(&buffer);
+    return &buffer;
+}
+
+void cli_print_info_json(const SnooperSystemInfo *info, const SnooperCpuTopology *topology) {
+    CliBuffer *out = stdout_buffer();
+    if (!info || !out) return;
+    encode_info_json(info, topology, out);
+    cli_buffer_write(out, stdout);
+}
 
-    printf("}\n");
+void cli_print_session_json(const SnooperSession *session, const SnooperCpuTopology *topology) {
+    CliBuffer *out = stdout_buffer();
+    if (!session || !out) return;
+    cli_encode_session_json(session, topology, out);
+    cli_buffer_write(out, stdout);
 }
 
 void cli_print_json(const SnooperSnapshot *snapshot, CliFormat format) {
-    if (!snapshot) return;
+    CliBuffer *out = stdout_buffer();
+    if (!snapshot || !out) return;
 
-    emit_snapshot_json(snapshot);
+    cli_encode_snapshot_json(snapshot, CLI_METRIC_ALL, out);
+    cli_buffer_write(out, stdout);
 
-    if (format == CLI_FORMAT_JSON) {
-        // do nothing extra
+    if (format == CLI_FORMAT_NDJSON) {
+        // Keep records whole when stdout is a pipe or FIFO feeding merge.
+        fflush(stdout);
     }
 }
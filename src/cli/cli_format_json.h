@@ -3,7 +3,31 @@
 
 #include "snooper/telemetry.h"
 #include "cli_args.h"
+#include "cli_buffer.h"
+
+typedef enum {
+    CLI_METRIC_CPU = 1u << 0,
+    CLI_METRIC_CORES = 1u << 1,
+    CLI_METRIC_TOPOLOGY = 1u << 2,
+    CLI_METRIC_SCHED = 1u << 3,
+    CLI_METRIC_IRQ = 1u << 4,
+    CLI_METRIC_FREQ = 1u << 5,
+    CLI_METRIC_POWER = 1u << 6,
+    CLI_METRIC_GPU = 1u << 7,
+    CLI_METRIC_NET = 1u << 8,
+    CLI_METRIC_PLUGINS = 1u << 9,
+    CLI_METRIC_PROCS = 1u << 10,
+    CLI_METRIC_NUMA = 1u << 11,
+    CLI_METRIC_ALL = (1u << 12) - 1
+} CliMetricGroup;
+
+int cli_parse_metric_list(const char *list, unsigned *mask);
+
+void cli_encode_snapshot_json(const SnooperSnapshot *snapshot, unsigned metrics, CliBuffer *out);
+void cli_encode_session_json(const SnooperSession *session, const SnooperCpuTopology *topology, CliBuffer *out);
 
 void cli_print_json(const SnooperSnapshot *snapshot, CliFormat format);
+void cli_print_info_json(const SnooperSystemInfo *info, const SnooperCpuTopology *topology);
+void cli_print_session_json(const SnooperSession *session, const SnooperCpuTopology *topology);
 
 #endif
@@ -0,0 +1,249 @@
+#include "cli_format_prometheus.h"
+#include <stdio.h>
+
+static void emit_family(CliBuffer *out, const char *name, const char *type, const char *help) {
+    cli_buffer_appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void emit_label_value(CliBuffer *out, const char *value) {
+    for (const char *c = value; *c; ++c) {
+        if (*c == '\\' || *c == '"') {
+            cli_buffer_appendf(out, "\\%c", *c);
+        } else if (*c == '\n') {
+            cli_buffer_append(out, "\\n", 2);
+        } else {
+            cli_buffer_append(out, c, 1);
+        }
+    }
+}
+
+static void emit_cores(const SnooperSnapshot *snapshot, CliBuffer *out) {
+    emit_family(out, "snooper_cpu_core_percent", "gauge", "Per-core CPU time share by mode.");
+    for (size_t i = 0; i < snapshot->core_count; ++i) {
+        const SnooperCpuUsage *core = &snapshot->per_core[i];
+        cli_buffer_appendf(out, "snooper_cpu_core_percent{cpu=\"%zu\",mode=\"user\"} %.2f\n", i, core->user);
+        cli_buffer_appendf(out, "snooper_cpu_core_percent{cpu=\"%zu\",mode=\"system\"} %.2f\n", i, core->system);
+        cli_buffer_appendf(out, "snooper_cpu_core_percent{cpu=\"%zu\",mode=\"idle\"} %.2f\n", i, core->idle);
+    }
+}
+
+static void emit_topology(const SnooperTopologyUsage *usage, CliBuffer *out) {
+    emit_family(out, "snooper_topology_used_percent", "gauge", "Mean CPU usage per topology group.");
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        const char *name = snooper_topology_level_name((SnooperTopologyLevel)level);
+        for (size_t g = usage->level_offsets[level]; g < usage->level_offsets[level + 1]; ++g) {
+            cli_buffer_appendf(out, "snooper_topology_used_percent{level=\"%s\",group=\"%d\"} %.2f\n", name, usage->groups[g].id, usage->groups[g].used_percent);
+        }
+    }
+}
+
+static void emit_sched(const SnooperSchedStats *sched, CliBuffer *out) {
+    emit_family(out, "snooper_sched_run_ms_per_second", "gauge", "Milliseconds per second spent running tasks.");
+    for (size_t i = 0; i < sched->core_count; ++i) {
+        if (!sched->cores[i].present) continue;
+        cli_buffer_appendf(out, "snooper_sched_run_ms_per_second{cpu=\"%zu\"} %.3f\n", i, sched->cores[i].run_ms_per_sec);
+    }
+    emit_family(out, "snooper_sched_wait_ms_per_second", "gauge", "Milliseconds per second tasks spent runnable but waiting.");
+    for (size_t i = 0; i < sched->core_count; ++i) {
+        if (!sched->cores[i].present) continue;
+        cli_buffer_appendf(out, "snooper_sched_wait_ms_per_second{cpu=\"%zu\"} %.3f\n", i, sched->cores[i].wait_ms_per_sec);
+    }
+    emit_family(out, "snooper_sched_timeslices_per_second", "gauge", "Timeslices run per second.");
+    for (size_t i = 0; i < sched->core_count; ++i) {
+        if (!sched->cores[i].present) continue;
+        cli_buffer_appendf(out, "snooper_sched_timeslices_per_second{cpu=\"%zu\"} %.2f\n", i, sched->cores[i].timeslices_per_sec);
+    }
+    emit_family(out, "snooper_context_switches_per_second", "gauge", "System-wide context switches per second.");
+    cli_buffer_appendf(out, "snooper_context_switches_per_second %.2f\n", sched->context_switches_per_sec);
+    emit_family(out, "snooper_procs_running", "gauge", "Runnable tasks.");
+    cli_buffer_appendf(out, "snooper_procs_running %llu\n", (unsigned long long)sched->procs_running);
+    emit_family(out, "snooper_procs_blocked", "gauge", "Tasks blocked on I/O.");
+    cli_buffer_appendf(out, "snooper_procs_blocked %llu\n", (unsigned long long)sched->procs_blocked);
+}
+
+static void emit_irq(const SnooperIrqStats *irq, CliBuffer *out) {
+    emit_family(out, "snooper_interrupts_per_second", "gauge", "Hardware interrupts per second.");
+    for (size_t i = 0; i < irq->core_count; ++i) {
+        if (!irq->cores[i].present) continue;
+        cli_buffer_appendf(out, "snooper_interrupts_per_second{cpu=\"%zu\"} %.2f\n", i, irq->cores[i].irqs_per_sec);
+    }
+    emit_family(out, "snooper_softirqs_per_second", "gauge", "Softirqs per second.");
+    for (size_t i = 0; i < irq->core_count; ++i) {
+        if (!irq->cores[i].present) continue;
+        cli_buffer_appendf(out, "snooper_softirqs_per_second{cpu=\"%zu\"} %.2f\n", i, irq->cores[i].softirqs_per_sec);
+    }
+}
+
+static void emit_freq(const SnooperFreqStats *freq, CliBuffer *out) {
+    emit_family(out, "snooper_cpu_frequency_mhz", "gauge", "Per-core clock frequency.");
+    for (size_t i = 0; i < freq->core_count; ++i) {
+        const SnooperFreqCore *core = &freq->cores[i];
+        if (!core->present) continue;
+        cli_buffer_appendf(out, "snooper_cpu_frequency_mhz{cpu=\"%zu\",kind=\"current\"} %.0f\n", i, core->current_mhz);
+        cli_buffer_appendf(out, "snooper_cpu_frequency_mhz{cpu=\"%zu\",kind=\"max\"} %.0f\n", i, core->max_mhz);
+        if (freq->has_msr) {
+            cli_buffer_appendf(out, "snooper_cpu_frequency_mhz{cpu=\"%zu\",kind=\"effective\"} %.0f\n", i, core->effective_mhz);
+        }
+    }
+    emit_family(out, "snooper_cpu_normalized_used_percent", "gauge", "Per-core usage scaled by effective over maximum frequency.");
+    for (size_t i = 0; i < freq->core_count; ++i) {
+        if (!freq->cores[i].present) continue;
+        cli_buffer_appendf(out, "snooper_cpu_normalized_used_percent{cpu=\"%zu\"} %.2f\n", i, freq->cores[i].normalized_used_percent);
+    }
+    emit_family(out, "snooper_cpu_throttle_events", "gauge", "Thermal throttle events during the last sample interval.");
+    for (size_t i = 0; i < freq->core_count; ++i) {
+        const SnooperFreqCore *core = &freq->cores[i];
+        if (!core->present) continue;
+        cli_buffer_appendf(out, "snooper_cpu_throttle_events{cpu=\"%zu\",scope=\"core\"} %llu\n", i, (unsigned long long)core->core_throttles);
+        cli_buffer_appendf(out, "snooper_cpu_throttle_events{cpu=\"%zu\",scope=\"package\"} %llu\n", i, (unsigned long long)core->package_throttles);
+    }
+    if (freq->zone_count > 0) {
+        emit_family(out, "snooper_thermal_celsius", "gauge", "Thermal zone temperature.");
+        for (size_t i = 0; i < freq->zone_count; ++i) {
+            cli_buffer_appendf(out, "snooper_thermal_celsius{zone=\"%zu\",type=\"", i);
+            emit_label_value(out, freq->zones[i].type);
+            cli_buffer_appendf(out, "\"} %.1f\n", freq->zones[i].celsius);
+        }
+    }
+}
+
+static void emit_power(const SnooperPowerSample *power, CliBuffer *out) {
+    emit_family(out, "snooper_power_watts", "gauge", "Average power per energy domain over the last sample interval.");
+    for (size_t i = 0; i < power->domain_count; ++i) {
+        cli_buffer_appendf(out, "snooper_power_watts{domain=\"");
+        emit_label_value(out, power->domains[i].name);
+        cli_buffer_appendf(out, "\"} %.3f\n", power->domains[i].watts);
+    }
+    emit_family(out, "snooper_joules_per_busy_core_second", "gauge", "Package energy per busy core-second.");
+    cli_buffer_appendf(out, "snooper_joules_per_busy_core_second %.3f\n", power->joules_per_busy_core_second);
+}
+
+static void emit_net_rate(const SnooperNetworkStats *network, CliBuffer *out, const char *direction, const char *unit, size_t field) {
+    for (size_t i = 0; i < network->interface_count; ++i) {
+        const SnooperNetInterface *iface = &network->interfaces[i];
+        if (!iface->present) continue;
+        const double rates[4] = { iface->rx_bytes_per_sec, iface->tx_bytes_per_sec, iface->rx_packets_per_sec, iface->tx_packets_per_sec };
+        cli_buffer_appendf(out, "snooper_net_%s_per_second{interface=\"", unit);
+        emit_label_value(out, iface->name);
+        cli_buffer_appendf(out, "\",direction=\"%s\"} %.2f\n", direction, rates[field]);
+    }
+}
+
+static void emit_net_total(const SnooperNetworkStats *network, CliBuffer *out, const char *name, const char *direction, size_t field) {
+    for (size_t i = 0; i < network->interface_count; ++i) {
+        const SnooperNetInterface *iface = &network->interfaces[i];
+        if (!iface->present) continue;
+        const uint64_t totals[4] = { iface->totals.rx_errors, iface->totals.tx_errors, iface->totals.rx_drops, iface->totals.tx_drops };
+        cli_buffer_appendf(out, "snooper_net_%s_total{interface=\"", name);
+        emit_label_value(out, iface->name);
+        cli_buffer_appendf(out, "\",direction=\"%s\"} %llu\n", direction, (unsigned long long)totals[field]);
+    }
+}
+
+static void emit_network(const SnooperNetworkStats *network, CliBuffer *out) {
+    emit_family(out, "snooper_net_bytes_per_second", "gauge", "Interface throughput.");
+    emit_net_rate(network, out, "rx", "bytes", 0);
+    emit_net_rate(network, out, "tx", "bytes", 1);
+    emit_family(out, "snooper_net_packets_per_second", "gauge", "Interface packet rate.");
+    emit_net_rate(network, out, "rx", "packets", 2);
+    emit_net_rate(network, out, "tx", "packets", 3);
+    emit_family(out, "snooper_net_errors_total", "counter", "Interface errors since boot.");
+    emit_net_total(network, out, "errors", "rx", 0);
+    emit_net_total(network, out, "errors", "tx", 1);
+    emit_family(out, "snooper_net_drops_total", "counter", "Interface drops since boot.");
+    emit_net_total(network, out, "drops", "rx", 2);
+    emit_net_total(network, out, "drops", "tx", 3);
+}
+
+static void emit_numa(const SnooperNumaStats *numa, CliBuffer *out) {
+    emit_family(out, "snooper_numa_memory_bytes", "gauge", "Memory per NUMA node by state.");
+    for (size_t i = 0; i < numa->node_count; ++i) {
+        const SnooperNumaNode *node = &numa->nodes[i];
+        cli_buffer_appendf(out, "snooper_numa_memory_bytes{node=\"%d\",state=\"used\"} %llu\n", node->id, (unsigned long long)node->used_bytes);
+        cli_buffer_appendf(out, "snooper_numa_memory_bytes{node=\"%d\",state=\"free\"} %llu\n", node->id, (unsigned long long)node->free_bytes);
+    }
+    emit_family(out, "snooper_numa_allocations_per_second", "gauge", "Page allocations per second per NUMA node by numastat outcome.");
+    for (size_t i = 0; i < numa->node_count; ++i) {
+        const SnooperNumaNode *node = &numa->nodes[i];
+        cli_buffer_appendf(out, "snooper_numa_allocations_per_second{node=\"%d\",outcome=\"hit\"} %.2f\n", node->id, node->hit_per_sec);
+        cli_buffer_appendf(out, "snooper_numa_allocations_per_second{node=\"%d\",outcome=\"miss\"} %.2f\n", node->id, node->miss_per_sec);
+        cli_buffer_appendf(out, "snooper_numa_allocations_per_second{node=\"%d\",outcome=\"foreign\"} %.2f\n", node->id, node->foreign_per_sec);
+        cli_buffer_appendf(out, "snooper_numa_allocations_per_second{node=\"%d\",outcome=\"local\"} %.2f\n", node->id, node->local_per_sec);
+        cli_buffer_appendf(out, "snooper_numa_allocations_per_second{node=\"%d\",outcome=\"other\"} %.2f\n", node->id, node->other_per_sec);
+    }
+    if (!numa->has_vmstat) return;
+    emit_family(out, "snooper_numa_pages_migrated_per_second", "gauge", "Pages migrated per second, all causes.");
+    cli_buffer_appendf(out, "snooper_numa_pages_migrated_per_second %.2f\n", numa->pages_migrated_per_sec);
+    emit_family(out, "snooper_numa_migrate_failures_per_second", "gauge", "Failed page migrations per second.");
+    cli_buffer_appendf(out, "snooper_numa_migrate_failures_per_second %.2f\n", numa->migrate_failures_per_sec);
+    emit_family(out, "snooper_numa_balancing_migrated_per_second", "gauge", "Pages migrated per second by automatic NUMA balancing.");
+    cli_buffer_appendf(out, "snooper_numa_balancing_migrated_per_second %.2f\n", numa->balancing_migrated_per_sec);
+    emit_family(out, "snooper_numa_hint_faults_per_second", "gauge", "NUMA balancing hinting faults per second.");
+    cli_buffer_appendf(out, "snooper_numa_hint_faults_per_second %.2f\n", numa->hint_faults_per_sec);
+    emit_family(out, "snooper_numa_hint_faults_local_percent", "gauge", "Share of hinting faults on the accessing node.");
+    cli_buffer_appendf(out, "snooper_numa_hint_faults_local_percent %.2f\n", numa->hint_faults_local_percent);
+}
+
+static void emit_plugins(const SnooperSnapshot *snapshot, CliBuffer *out) {
+    const SnooperPluginSet *set = snapshot->plugins;
+    emit_family(out, "snooper_plugin_value", "gauge", "Fields reported by plugin probes.");
+    for (size_t i = 0; i < set->count; ++i) {
+        if (!snapshot->plugin_available[i]) continue;
+        const SnooperProbeDescriptor *descriptor = set->probes[i].descriptor;
+        for (size_t f = 0; f < descriptor->field_count; ++f) {
+            const SnooperFieldValue *value = &snapshot->plugin_values[set->probes[i].value_offset + f];
+            cli_buffer_appendf(out, "snooper_plugin_value{probe=\"%s\",field=\"%s\"} ", descriptor->name, descriptor->fields[f].name);
+            switch (descriptor->fields[f].type) {
+                case SNOOPER_FIELD_U64:
+                    cli_buffer_appendf(out, "%llu\n", (unsigned long long)value->u64);
+                    break;
+                case SNOOPER_FIELD_I64:
+                    cli_buffer_appendf(out, "%lld\n", (long long)value->i64);
+                    break;
+                default:
+                    cli_buffer_appendf(out, "%.6g\n", value->f64);
+                    break;
+            }
+        }
+    }
+}
+
+void cli_encode_snapshot_prometheus(const SnooperSnapshot *snapshot, CliBuffer *out) {
+    if (!snapshot || !out) return;
+
+    emit_family(out, "snooper_cpu_used_percent", "gauge", "Total CPU usage across all cores.");
+    cli_buffer_appendf(out, "snooper_cpu_used_percent %.2f\n", snapshot->cpu_used_percent);
+    emit_cores(snapshot, out);
+
+    if (snapshot->has_topology) {
+        emit_topology(&snapshot->topology, out);
+    }
+    if (snapshot->has_sched) {
+        emit_sched(&snapshot->sched, out);
+    }
+    if (snapshot->has_irq) {
+        emit_irq(&snapshot->irq, out);
+    }
+    if (snapshot->has_freq) {
+        emit_freq(&snapshot->freq, out);
+    }
+    if (snapshot->gpu_available) {
+        emit_family(out, "snooper_gpu_used_percent", "gauge", "GPU utilization.");
+        cli_buffer_appendf(out, "snooper_gpu_used_percent %.2f\n", snapshot->gpu_used_percent);
+    }
+    if (snapshot->power.available) {
+        emit_power(&snapshot->power, out);
+    }
+    if (snapshot->has_network) {
+        emit_network(&snapshot->network, out);
+    }
+    if (snapshot->has_numa) {
+        emit_numa(&snapshot->numa, out);
+    }
+    if (snapshot->plugins && snapshot->plugins->count > 0) {
+        emit_plugins(snapshot, out);
+    }
+
+    emit_family(out, "snooper_sample_monotonic_seconds", "gauge", "Monotonic time the sample was taken.");
+    cli_buffer_appendf(out, "snooper_sample_monotonic_seconds %.3f\n", (double)snapshot->monotonic_ns / 1e9);
+}
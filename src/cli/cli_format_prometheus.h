@@ -0,0 +1,9 @@
+#ifndef SNOOPER_CLI_FORMAT_PROMETHEUS_H
+#define SNOOPER_CLI_FORMAT_PROMETHEUS_H
+
+#include "snooper/telemetry.h"
+#include "cli_buffer.h"
+
+void cli_encode_snapshot_prometheus(const SnooperSnapshot *snapshot, CliBuffer *out);
+
+#endif
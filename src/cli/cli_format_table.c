@@ -34,13 +34,65 @@ void cli_print_system_info(const SnooperSystemInfo *info) {
     printf("Hardware UUID   : %s\n", info->hardware_uuid);
 }
 
-void cli_print_table(const SnooperSnapshot *snapshot, int print_header) {
-    if (!snapshot) return;
+static void print_cpu_ranges(const size_t *cpus, size_t count) {
+    size_t i = 0;
+    while (i < count) {
+        size_t j = i;
+        while (j + 1 < count && cpus[j + 1] == cpus[j] + 1) {
+            j++;
+        }
+        if (j > i) {
+            printf("%s%zu-%zu", i > 0 ? "," : "", cpus[i], cpus[j]);
+        } else {
+            printf("%s%zu", i > 0 ? "," : "", cpus[i]);
+        }
+        i = j + 1;
+    }
+}
+
+void cli_print_topology(const SnooperCpuTopology *topology) {
+    if (!topology || !topology->available) return;
+
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        const SnooperTopologyGroups *groups = &topology->levels[level];
+        printf("Topology %-10s: %zu group(s)\n", snooper_topology_level_name((SnooperTopologyLevel)level), groups->group_count);
+        for (size_t g = 0; g < groups->group_count; ++g) {
+            printf("  %4d: cpus ", groups->group_ids[g]);
+            print_cpu_ranges(&groups->members[groups->offsets[g]], groups->offsets[g + 1] - groups->offsets[g]);
+            printf("\n");
+        }
+    }
+}
+
+static void print_topology_usage(const SnooperSnapshot *snapshot) {
+    const SnooperTopologyUsage *usage = &snapshot->topology;
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        size_t first = usage->level_offsets[level];
+        size_t last = usage->level_offsets[level + 1];
+        size_t groups = last - first;
+        if (groups <= 1 || groups >= snapshot->core_count) continue;
 
-    if (print_header && snapshot->has_system_info) {
-        cli_print_system_info(&snapshot->system_info);
-        printf("----------------------------------------\n");
+        printf("%-10s:", snooper_topology_level_name((SnooperTopologyLevel)level));
+        for (size_t g = first; g < last; ++g) {
+            printf(" %d=%.1f%% (max %.1f%%)", usage->groups[g].id, usage->groups[g].used_percent, usage->groups[g].max_core_percent);
+        }
+        printf("\n");
     }
+}
+
+void cli_print_session(const SnooperSession *session) {
+    if (!session) return;
+
+    printf("Session ID      : %016llx\n", (unsigned long long)session->session_id);
+    printf("Boot ID         : %s\n", session->boot_id);
+    if (session->has_system_info) {
+        cli_print_system_info(&session->system_info);
+    }
+    printf("----------------------------------------\n");
+}
+
+void cli_print_table(const SnooperSnapshot *snapshot) {
+    if (!snapshot) return;
 
     char wall_buf[64];
     format_time(&snapshot->wall_time, wall_buf, sizeof(wall_buf));
@@ -49,10 +101,113 @@ void cli_print_table(const SnooperSnapshot *snapshot, int print_header) {
     printf("Time: %s | monotonic: %.3fs\n", wall_buf, monotonic_sec);
     printf("CPU Used: %6.2f%%\n", snapshot->cpu_used_percent);
 
+    for (size_t i = 0; i < snapshot->core_count; ++i) {
+        printf("  Core %3zu: %6.2f%%", i, 100.0 - snapshot->per_core[i].idle);
+        if (snapshot->has_sched && i < snapshot->sched.core_count && snapshot->sched.cores[i].present) {
+            const SnooperSchedCore *sched = &snapshot->sched.cores[i];
+            printf(" | wait %8.3f ms/s | %8.3f us/slice", sched->wait_ms_per_sec, sched->avg_wait_us_per_timeslice);
+        }
+        if (snapshot->has_irq && i < snapshot->irq.core_count && snapshot->irq.cores[i].present) {
+            const SnooperIrqCore *irq = &snapshot->irq.cores[i];
+            printf(" | irq %8.0f/s soft %8.0f/s", irq->irqs_per_sec, irq->softirqs_per_sec);
+            if (irq->top_count > 0) {
+                printf(" top %s (%.0f/s)", irq->top[0].name, irq->top[0].per_sec);
+            }
+        }
+        if (snapshot->has_freq && i < snapshot->freq.core_count && snapshot->freq.cores[i].present) {
+            const SnooperFreqCore *freq = &snapshot->freq.cores[i];
+            printf(" | %5.0f MHz norm %6.2f%%", freq->effective_mhz > 0.0 ? freq->effective_mhz : freq->current_mhz, freq->normalized_used_percent);
+            if (freq->core_throttles > 0 || freq->package_throttles > 0) {
+                printf(" THROTTLED");
+            }
+        }
+        printf("\n");
+    }
+
+    if (snapshot->has_topology) {
+        print_topology_usage(snapshot);
+    }
+
+    if (snapshot->has_freq && snapshot->freq.zone_count > 0) {
+        printf("Thermal :");
+        for (size_t i = 0; i < snapshot->freq.zone_count; ++i) {
+            printf(" %s %.1fC", snapshot->freq.zones[i].type, snapshot->freq.zones[i].celsius);
+        }
+        printf("\n");
+    }
+
+    if (snapshot->has_sched) {
+        printf("Sched   : %.0f ctxsw/s | running %llu | blocked %llu\n",
+               snapshot->sched.context_switches_per_sec,
+               (unsigned long long)snapshot->sched.procs_running,
+               (unsigned long long)snapshot->sched.procs_blocked);
+    }
+
+    if (snapshot->has_numa) {
+        for (size_t i = 0; i < snapshot->numa.node_count; ++i) {
+            const SnooperNumaNode *node = &snapshot->numa.nodes[i];
+            printf("Node %-3d: %.0f MiB used | %.0f MiB free | miss %.0f/s | foreign %.0f/s\n",
+                   node->id,
+                   (double)node->used_bytes / (1024.0 * 1024.0),
+                   (double)node->free_bytes / (1024.0 * 1024.0),
+                   node->miss_per_sec,
+                   node->foreign_per_sec);
+        }
+        if (snapshot->numa.has_vmstat) {
+            printf("Migrate : %.0f pages/s | %.0f failed/s | balancing %.0f/s | hint faults %.0f/s (%.1f%% local)\n",
+                   snapshot->numa.pages_migrated_per_sec,
+                   snapshot->numa.migrate_failures_per_sec,
+                   snapshot->numa.balancing_migrated_per_sec,
+                   snapshot->numa.hint_faults_per_sec,
+                   snapshot->numa.hint_faults_local_percent);
+        }
+    }
+
     if (snapshot->gpu_available) {
         printf("GPU Used: %6.2f%%\n", snapshot->gpu_used_percent);
     } else {
         printf("GPU Used: N/A\n");
     }
+
+    if (snapshot->power.available) {
+        printf("Power   : %.2f W package | %.3f J per busy core-second", snapshot->power.package_watts, snapshot->power.joules_per_busy_core_second);
+        for (size_t i = 0; i < snapshot->power.domain_count; ++i) {
+            printf(" | %s %.2f W", snapshot->power.domains[i].name, snapshot->power.domains[i].watts);
+        }
+        printf("\n");
+    } else {
+        printf("Power   : N/A\n");
+    }
+
+    if (snapshot->has_network) {
+        for (size_t i = 0; i < snapshot->network.interface_count; ++i) {
+            const SnooperNetInterface *iface = &snapshot->network.interfaces[i];
+            if (!iface->present) continue;
+            printf("Net %-8s: rx %12.0f B/s %9.0f pkt/s | tx %12.0f B/s %9.0f pkt/s | err %llu/%llu | drop %llu/%llu\n",
+                   iface->name,
+                   iface->rx_bytes_per_sec,
+                   iface->rx_packets_per_sec,
+                   iface->tx_bytes_per_sec,
+                   iface->tx_packets_per_sec,
+                   (unsigned long long)iface->rx_errors,
+                   (unsigned long long)iface->tx_errors,
+                   (unsigned long long)iface->rx_drops,
+                   (unsigned long long)iface->tx_drops);
+        }
+    }
+
+    for (size_t i = 0; snapshot->plugins && i < snapshot->plugins->count; ++i) {
+        const SnooperProbeDescriptor *descriptor = snapshot->plugins->probes[i].descriptor;
+        printf("Plugin %-8s:", descriptor->name);
+        if (!snapshot->plugin_available[i]) {
+            printf(" N/A\n");
+            continue;
+        }
+        for (size_t f = 0; f < descriptor->field_count; ++f) {
+            SnooperFieldValue value = snapshot->plugin_values[snapshot->plugins->probes[i].value_offset + f];
+            printf(" %s %.6g", descriptor->fields[f].name, snooper_plugin_value_as_double(descriptor->fields[f].type, value));
+        }
+        printf("\n");
+    }
     printf("\n");
 }
@@ -3,7 +3,9 @@
 
 #include "snooper/telemetry.h"
 
-void cli_print_table(const SnooperSnapshot *snapshot, int print_header);
+void cli_print_table(const SnooperSnapshot *snapshot);
+void cli_print_session(const SnooperSession *session);
 void cli_print_system_info(const SnooperSystemInfo *info);
+void cli_print_topology(const SnooperCpuTopology *topology);
 
 #endif
@@ -0,0 +1,93 @@
+#include "cli_history.h"
+#include "snooper/metrics.h"
+#include <stdio.h>
+#include <string.h>
+
+// The store only holds blocks that have not been flushed yet: at most the
+// open block per series plus whatever sealed since the last flush.
+#define CLI_HISTORY_BUDGET_BYTES (16u * 1024u * 1024u)
+#define CLI_HISTORY_MAX_SERIES 4096
+#define CLI_HISTORY_FLUSH_INTERVAL_NS (10ull * 1000000000ull)
+
+int cli_history_open(CliHistory *history, const char *path, const SnooperSession *session) {
+    if (!history || !path || !session) return -1;
+
+    memset(history, 0, sizeof(*history));
+    if (snooper_tsstore_init(&history->store, CLI_HISTORY_BUDGET_BYTES, CLI_HISTORY_MAX_SERIES, 0) != SNOOPER_OK) {
+        fprintf(stderr, "Failed to allocate history store.\n");
+        return -1;
+    }
+    if (snooper_history_writer_open(&history->writer, path, history->store.resolution_ns, session->session_id, session->wall_offset_ns) != SNOOPER_OK) {
+        fprintf(stderr, "Failed to create history %s.\n", path);
+        snooper_tsstore_destroy(&history->store);
+        return -1;
+    }
+    history->path = path;
+    return 0;
+}
+
+static void append_metric(void *context, const SnooperMetricId *id, double value) {
+    CliHistory *history = context;
+    char name[SNOOPER_METRIC_NAME_MAX];
+    if (snooper_metric_format(id, name, sizeof(name)) != 0) {
+        return;
+    }
+
+    // Metrics are visited in the same order every sample, so the next series
+    // is almost always the one after the previous hit.
+    SnooperTsStore *store = &history->store;
+    int series = -1;
+    if (history->cursor < store->series_count && strcmp(store->series[history->cursor].name, name) == 0) {
+        series = (int)history->cursor;
+    } else {
+        series = snooper_tsstore_add_series(store, name);
+    }
+    if (series < 0) {
+        return;
+    }
+
+    history->cursor = (size_t)series + 1;
+    (void)snooper_tsstore_append(store, series, history->timestamp_ns, value);
+}
+
+void cli_history_append(CliHistory *history, const SnooperSnapshot *snapshot) {
+    if (!history || !history->path || !snapshot) return;
+
+    if (!history->started) {
+        history->last_flush_ns = snapshot->monotonic_ns;
+        history->started = 1;
+    }
+
+    history->timestamp_ns = snapshot->monotonic_ns;
+    history->cursor = 0;
+    snooper_metric_visit(snapshot, append_metric, history);
+
+    // One pass opens at most one block per series, so flushing before the
+    // free blocks drop below that keeps the store from ever evicting a block
+    // that has not reached the file.
+    if (snapshot->monotonic_ns - history->last_flush_ns >= CLI_HISTORY_FLUSH_INTERVAL_NS
+        || history->store.free_blocks < history->store.series_capacity) {
+        history->last_flush_ns = snapshot->monotonic_ns;
+        cli_history_flush(history);
+    }
+}
+
+int cli_history_flush(CliHistory *history) {
+    if (!history || !history->path) return -1;
+
+    if (snooper_history_writer_flush(&history->writer, &history->store) != SNOOPER_OK) {
+        fprintf(stderr, "Failed to write history to %s.\n", history->path);
+        return -1;
+    }
+    return 0;
+}
+
+void cli_history_close(CliHistory *history) {
+    if (!history || !history->path) return;
+    cli_history_flush(history);
+    if (snooper_history_writer_close(&history->writer) != SNOOPER_OK) {
+        fprintf(stderr, "Failed to close history %s.\n", history->path);
+    }
+    snooper_tsstore_destroy(&history->store);
+    history->path = NULL;
+}
@@ -0,0 +1,25 @@
+#ifndef SNOOPER_CLI_HISTORY_H
+#define SNOOPER_CLI_HISTORY_H
+
+#include <stdint.h>
+#include "snooper/history.h"
+#include "snooper/session.h"
+#include "snooper/telemetry.h"
+#include "snooper/tsstore.h"
+
+typedef struct {
+    SnooperTsStore store;
+    SnooperHistoryWriter writer;
+    const char *path;
+    int started;
+    uint64_t last_flush_ns;
+    uint64_t timestamp_ns;
+    size_t cursor;
+} CliHistory;
+
+int cli_history_open(CliHistory *history, const char *path, const SnooperSession *session);
+void cli_history_append(CliHistory *history, const SnooperSnapshot *snapshot);
+int cli_history_flush(CliHistory *history);
+void cli_history_close(CliHistory *history);
+
+#endif
@@ -0,0 +1,482 @@
+#include "cli_merge.h"
+#include "cli_buffer.h"
+#include "cli_format_json.h"
+#include "snooper/recorder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define CLI_MERGE_SOURCE_MAX 64
+#define CLI_MERGE_POLL_MS 100
+
+typedef enum {
+    STREAM_DETECT,
+    STREAM_NDJSON,
+    STREAM_BINARY
+} StreamFormat;
+
+// Each input owns one fixed read-ahead buffer; the head record is parsed in
+// place, so memory per stream stays constant however long the input is.
+typedef struct {
+    char source[CLI_MERGE_SOURCE_MAX];
+    int fd;
+    StreamFormat format;
+    char *buffer;
+    size_t start;
+    size_t length;
+    int eof;
+    int is_fifo;
+    int attached;
+    int has_head;
+    int skipping;
+    size_t head_length;
+    int64_t head_key;
+    int64_t last_key;
+    SnooperRecorderHeader recorder;
+    size_t records_left;
+} MergeStream;
+
+typedef struct {
+    MergeStream *streams;
+    size_t stream_count;
+    size_t buffer_size;
+    size_t *heap;
+    size_t heap_count;
+    size_t *waiting;
+    size_t waiting_count;
+    size_t *woken;
+    struct pollfd *poll_fds;
+    int64_t watermark;
+    int64_t emitted_key;
+    int64_t lateness_ns;
+    unsigned long long late_records;
+    unsigned long long oversized_records;
+    CliBuffer output;
+    SnooperSnapshot decoded;
+} Merger;
+
+static int64_t parse_wall_key(const char *line, size_t length, int64_t fallback) {
+    static const char needle[] = "\"wall\":\"";
+    const char *end = line + length;
+    for (const char *cursor = line; cursor + sizeof(needle) - 1 < end; ++cursor) {
+        if (memcmp(cursor, needle, sizeof(needle) - 1) != 0) {
+            continue;
+        }
+        cursor += sizeof(needle) - 1;
+        int64_t seconds = 0;
+        int64_t nanos = 0;
+        int digits = 0;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+            seconds = seconds * 10 + (*cursor++ - '0');
+        }
+        if (cursor < end && *cursor == '.') {
+            ++cursor;
+            while (cursor < end && *cursor >= '0' && *cursor <= '9' && digits < 9) {
+                nanos = nanos * 10 + (*cursor++ - '0');
+                ++digits;
+            }
+        }
+        while (digits++ < 9) {
+            nanos *= 10;
+        }
+        return seconds * 1000000000LL + nanos;
+    }
+    return fallback;
+}
+
+static int heap_less(const Merger *merger, size_t a, size_t b) {
+    const MergeStream *x = &merger->streams[a];
+    const MergeStream *y = &merger->streams[b];
+    return x->head_key < y->head_key || (x->head_key == y->head_key && a < b);
+}
+
+static void heap_push(Merger *merger, size_t stream) {
+    size_t i = merger->heap_count++;
+    merger->heap[i] = stream;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!heap_less(merger, merger->heap[i], merger->heap[parent])) break;
+        size_t tmp = merger->heap[i];
+        merger->heap[i] = merger->heap[parent];
+        merger->heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static size_t heap_pop(Merger *merger) {
+    size_t top = merger->heap[0];
+    merger->heap[0] = merger->heap[--merger->heap_count];
+    size_t i = 0;
+    for (;;) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+        if (left < merger->heap_count && heap_less(merger, merger->heap[left], merger->heap[smallest])) smallest = left;
+        if (right < merger->heap_count && heap_less(merger, merger->heap[right], merger->heap[smallest])) smallest = right;
+        if (smallest == i) break;
+        size_t tmp = merger->heap[i];
+        merger->heap[i] = merger->heap[smallest];
+        merger->heap[smallest] = tmp;
+        i = smallest;
+    }
+    return top;
+}
+
+static int open_input(const char *path, int *is_fifo) {
+    struct stat st;
+    int exists = stat(path, &st) == 0;
+    *is_fifo = exists && S_ISFIFO(st.st_mode);
+    if (exists && S_ISSOCK(st.st_mode)) {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (strlen(path) >= sizeof(address.sun_path)) {
+            return -1;
+        }
+        strcpy(address.sun_path, path);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)) {
+            close(fd);
+            fd = -1;
+        }
+        return fd;
+    }
+    return open(path, O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+}
+
+// Tries to expose the next record of a stream as its head. Returns 1 when a
+// head is ready, 0 when more input is needed and -1 at end of stream.
+static int stream_parse_head(Merger *merger, MergeStream *stream) {
+    for (;;) {
+        char *data = stream->buffer + stream->start;
+        size_t available = stream->length - stream->start;
+
+        if (stream->format == STREAM_DETECT) {
+            if (available >= 8 || stream->eof) {
+                stream->format = available >= 8 && memcmp(data, SNOOPER_RECORDER_MAGIC, 8) == 0 ? STREAM_BINARY : STREAM_NDJSON;
+                if (stream->format == STREAM_BINARY) {
+                    if (available < SNOOPER_RECORDER_HEADER_SIZE) {
+                        stream->format = STREAM_DETECT;
+                        return stream->eof ? -1 : 0;
+                    }
+                    if (snooper_recorder_header_decode((const uint8_t *)data, available, &stream->recorder) != SNOOPER_OK
+                        || stream->recorder.record_size > merger->buffer_size) {
+                        fprintf(stderr, "%s: unsupported recorder dump.\n", stream->source);
+                        return -1;
+                    }
+                    stream->records_left = stream->recorder.record_count;
+                    stream->start += SNOOPER_RECORDER_HEADER_SIZE;
+                    continue;
+                }
+            } else {
+                return 0;
+            }
+        }
+
+        if (stream->format == STREAM_BINARY) {
+            if (stream->records_left == 0) {
+                return -1;
+            }
+            if (available < stream->recorder.record_size) {
+                return stream->eof ? -1 : 0;
+            }
+            uint64_t monotonic = 0;
+            for (int i = 7; i >= 0; --i) {
+                monotonic = (monotonic << 8) | (uint8_t)data[i];
+            }
+            stream->head_length = stream->recorder.record_size;
+            stream->head_key = (int64_t)monotonic + stream->recorder.wall_offset_ns;
+            return 1;
+        }
+
+        char *newline = memchr(data, '\n', available);
+        if (!newline) {
+            if (stream->eof && available > 0 && !stream->skipping) {
+                newline = data + available;
+            } else {
+                if (available == merger->buffer_size) {
+                    // A record larger than the read-ahead buffer is dropped
+                    // rather than growing the buffer. It spans several
+                    // full buffers, so count it only when skipping starts.
+                    if (!stream->skipping) {
+                        stream->skipping = 1;
+                        ++merger->oversized_records;
+                    }
+                    stream->start = stream->length;
+                }
+                return stream->eof ? -1 : 0;
+            }
+        }
+
+        size_t line_length = (size_t)(newline - data);
+        if (stream->skipping || line_length == 0) {
+            stream->skipping = 0;
+            stream->start += line_length + (newline < stream->buffer + stream->length ? 1 : 0);
+            continue;
+        }
+
+        stream->head_length = line_length;
+        stream->head_key = parse_wall_key(data, line_length, stream->last_key);
+        return 1;
+    }
+}
+
+static void stream_consume_head(MergeStream *stream) {
+    stream->start += stream->head_length;
+    if (stream->format == STREAM_NDJSON && stream->start < stream->length && stream->buffer[stream->start] == '\n') {
+        ++stream->start;
+    } else if (stream->format == STREAM_BINARY) {
+        --stream->records_left;
+    }
+    stream->last_key = stream->head_key;
+    stream->has_head = 0;
+}
+
+// Reads more input. Returns 1 if bytes arrived or the stream ended, 0 if it
+// would block.
+static int stream_fill(MergeStream *stream, size_t buffer_size) {
+    if (stream->start > 0) {
+        memmove(stream->buffer, stream->buffer + stream->start, stream->length - stream->start);
+        stream->length -= stream->start;
+        stream->start = 0;
+    }
+    if (stream->length == buffer_size) {
+        return 1;
+    }
+
+    for (;;) {
+        ssize_t got = read(stream->fd, stream->buffer + stream->length, buffer_size - stream->length);
+        if (got > 0) {
+            stream->length += (size_t)got;
+            stream->attached = 1;
+            return 1;
+        }
+        // A FIFO reads 0 bytes until its first writer opens it; only a
+        // writer that has come and gone ends the stream.
+        if (got == 0 && stream->is_fifo && !stream->attached) {
+            return 0;
+        }
+        if (got == 0) {
+            stream->eof = 1;
+            return 1;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        stream->eof = 1;
+        return 1;
+    }
+}
+
+static void stream_close(MergeStream *stream) {
+    if (stream->fd >= 0) {
+        close(stream->fd);
+        stream->fd = -1;
+    }
+    free(stream->buffer);
+    stream->buffer = NULL;
+}
+
+// Advances a stream that has no head: parses what is buffered, reading as
+// long as the fd has data. Leaves it in the heap, in the waiting list or
+// closed.
+static void stream_advance(Merger *merger, size_t index) {
+    MergeStream *stream = &merger->streams[index];
+    for (;;) {
+        int rc = stream_parse_head(merger, stream);
+        if (rc > 0) {
+            stream->has_head = 1;
+            if (stream->head_key > merger->watermark) {
+                merger->watermark = stream->head_key;
+            }
+            heap_push(merger, index);
+            return;
+        }
+        if (rc < 0) {
+            stream_close(stream);
+            return;
+        }
+        if (!stream_fill(stream, merger->buffer_size)) {
+            merger->waiting[merger->waiting_count++] = index;
+            return;
+        }
+    }
+}
+
+static void emit_head(Merger *merger, MergeStream *stream) {
+    CliBuffer *out = &merger->output;
+    const char *data = stream->buffer + stream->start;
+    cli_buffer_reset(out);
+
+    if (stream->format == STREAM_BINARY) {
+        snooper_recorder_record_decode(&stream->recorder, (const uint8_t *)data, &merger->decoded);
+        cli_encode_snapshot_json(&merger->decoded, CLI_METRIC_CPU | CLI_METRIC_CORES | CLI_METRIC_GPU | CLI_METRIC_POWER, out);
+        data = out->data;
+    }
+
+    if (data[0] == '{') {
+        fputs("{\"source\":\"", stdout);
+        fputs(stream->source, stdout);
+        fputs(data[1] == '}' ? "\"" : "\",", stdout);
+        if (stream->format == STREAM_BINARY) {
+            fwrite(out->data + 1, 1, out->length - 1, stdout);
+        } else {
+            fwrite(data + 1, 1, stream->head_length - 1, stdout);
+            fputc('\n', stdout);
+        }
+    }
+
+    if (stream->head_key < merger->emitted_key) {
+        ++merger->late_records;
+    } else {
+        merger->emitted_key = stream->head_key;
+    }
+}
+
+static int wait_for_input(Merger *merger, int timeout_ms) {
+    for (size_t i = 0; i < merger->waiting_count; ++i) {
+        merger->poll_fds[i].fd = merger->streams[merger->waiting[i]].fd;
+        merger->poll_fds[i].events = POLLIN;
+        merger->poll_fds[i].revents = 0;
+    }
+
+    int ready = poll(merger->poll_fds, (nfds_t)merger->waiting_count, timeout_ms);
+    if (ready < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    size_t pending = merger->waiting_count;
+    size_t woken = 0;
+    merger->waiting_count = 0;
+    for (size_t i = 0; i < pending; ++i) {
+        if (merger->poll_fds[i].revents) {
+            if (merger->poll_fds[i].revents & POLLHUP) {
+                merger->streams[merger->waiting[i]].attached = 1;
+            }
+            merger->woken[woken++] = merger->waiting[i];
+        } else {
+            merger->waiting[merger->waiting_count++] = merger->waiting[i];
+        }
+    }
+    for (size_t i = 0; i < woken; ++i) {
+        stream_advance(merger, merger->woken[i]);
+    }
+    return 0;
+}
+
+static void raise_fd_limit(size_t needed) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < needed + 16) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static int merger_open_streams(Merger *merger, const CliOptions *opts) {
+    for (size_t i = 0; i < merger->stream_count; ++i) {
+        MergeStream *stream = &merger->streams[i];
+        const char *spec = opts->inputs[i];
+        const char *equals = strchr(spec, '=');
+        const char *path = equals ? equals + 1 : spec;
+        size_t name_length = equals ? (size_t)(equals - spec) : strlen(spec);
+        if (name_length >= sizeof(stream->source)) {
+            name_length = sizeof(stream->source) - 1;
+        }
+        memcpy(stream->source, spec, name_length);
+        stream->source[name_length] = '\0';
+        for (char *c = stream->source; *c; ++c) {
+            if (*c == '"' || *c == '\\') *c = '_';
+        }
+
+        stream->fd = open_input(path, &stream->is_fifo);
+        stream->buffer = malloc(merger->buffer_size);
+        stream->last_key = INT64_MIN;
+        if (stream->fd < 0 || !stream->buffer) {
+            fprintf(stderr, "Failed to open %s.\n", path);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int cli_run_merge(const CliOptions *opts) {
+    if (!opts || opts->input_count <= 0) return 1;
+
+    static Merger merger;
+    memset(&merger, 0, sizeof(merger));
+    merger.stream_count = (size_t)opts->input_count;
+    merger.buffer_size = (size_t)opts->buffer_kb * 1024u;
+    merger.lateness_ns = (int64_t)opts->lateness_ms * 1000000LL;
+    merger.watermark = INT64_MIN;
+    merger.emitted_key = INT64_MIN;
+    raise_fd_limit(merger.stream_count);
+
+    merger.streams = calloc(merger.stream_count, sizeof(MergeStream));
+    merger.heap = calloc(merger.stream_count, sizeof(size_t));
+    merger.waiting = calloc(merger.stream_count, sizeof(size_t));
+    merger.woken = calloc(merger.stream_count, sizeof(size_t));
+    merger.poll_fds = calloc(merger.stream_count, sizeof(struct pollfd));
+    int status = 0;
+    if (!merger.streams || !merger.heap || !merger.waiting || !merger.woken || !merger.poll_fds || cli_buffer_init(&merger.output, 65536) != 0) {
+        fprintf(stderr, "Out of memory.\n");
+        status = 1;
+    } else {
+        for (size_t i = 0; i < merger.stream_count; ++i) {
+            merger.streams[i].fd = -1;
+        }
+        if (merger_open_streams(&merger, opts) != 0) {
+            status = 1;
+        }
+    }
+
+    for (size_t i = 0; status == 0 && i < merger.stream_count; ++i) {
+        stream_advance(&merger, i);
+    }
+
+    while (status == 0 && (merger.heap_count > 0 || merger.waiting_count > 0)) {
+        // Emit while the smallest head is safe: either every open stream has
+        // a head, or the head is older than the newest key by the lateness
+        // tolerance, so a stalled input cannot hold the output back forever.
+        while (merger.heap_count > 0) {
+            MergeStream *top = &merger.streams[merger.heap[0]];
+            if (merger.waiting_count > 0 && (merger.lateness_ns <= 0 || top->head_key > merger.watermark - merger.lateness_ns)) {
+                break;
+            }
+            size_t index = heap_pop(&merger);
+            emit_head(&merger, top);
+            stream_consume_head(top);
+            stream_advance(&merger, index);
+        }
+
+        if (merger.waiting_count > 0) {
+            fflush(stdout);
+            if (wait_for_input(&merger, CLI_MERGE_POLL_MS) != 0) {
+                perror("poll");
+                status = 1;
+            }
+        }
+    }
+
+    fflush(stdout);
+    if (merger.late_records > 0 || merger.oversized_records > 0) {
+        fprintf(stderr, "Merged with %llu late and %llu oversized records.\n", merger.late_records, merger.oversized_records);
+    }
+
+    for (size_t i = 0; merger.streams && i < merger.stream_count; ++i) {
+        stream_close(&merger.streams[i]);
+    }
+    free(merger.streams);
+    free(merger.heap);
+    free(merger.waiting);
+    free(merger.woken);
+    free(merger.poll_fds);
+    cli_buffer_destroy(&merger.output);
+    return status;
+}
@@ -0,0 +1,8 @@
+#ifndef SNOOPER_CLI_MERGE_H
+#define SNOOPER_CLI_MERGE_H
+
+#include "cli_args.h"
+
+int cli_run_merge(const CliOptions *opts);
+
+#endif
@@ -0,0 +1,212 @@
+#include "cli_query.h"
+#include "snooper/history.h"
+#include "snooper/metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int parse_aggregation(const char *text, SnooperAggregation *aggregation, double *percentile) {
+    *percentile = 0.0;
+    if (!text || strcmp(text, "avg") == 0) {
+        *aggregation = SNOOPER_AGG_AVG;
+    } else if (strcmp(text, "min") == 0) {
+        *aggregation = SNOOPER_AGG_MIN;
+    } else if (strcmp(text, "max") == 0) {
+        *aggregation = SNOOPER_AGG_MAX;
+    } else if (strcmp(text, "sum") == 0) {
+        *aggregation = SNOOPER_AGG_SUM;
+    } else if (strcmp(text, "count") == 0) {
+        *aggregation = SNOOPER_AGG_COUNT;
+    } else if (text[0] == 'p') {
+        char *end = NULL;
+        *percentile = strtod(text + 1, &end);
+        if (end == text + 1 || *end != '\0' || *percentile < 0.0 || *percentile > 100.0) {
+            return -1;
+        }
+        *aggregation = SNOOPER_AGG_PERCENTILE;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int64_t mono_to_wall_ns(const SnooperHistory *history, uint64_t monotonic_ns) {
+    return (int64_t)monotonic_ns + history->wall_offset_ns;
+}
+
+static uint64_t wall_to_mono_ns(const SnooperHistory *history, int64_t wall_ns) {
+    int64_t monotonic = wall_ns - history->wall_offset_ns;
+    return monotonic > 0 ? (uint64_t)monotonic : 0;
+}
+
+// Accepts unix seconds, "-10m"-style offsets from the end of the history, or
+// a local "HH:MM[:SS]" on the day of the last sample.
+static int parse_time(const SnooperHistory *history, const char *text, uint64_t *out) {
+    char *end = NULL;
+    if (text[0] == '-') {
+        double amount = strtod(text + 1, &end);
+        double scale = 1.0;
+        if (end && *end == 'm') scale = 60.0;
+        else if (end && *end == 'h') scale = 3600.0;
+        else if (end && *end != 's' && *end != '\0') return -1;
+        uint64_t offset = (uint64_t)(amount * scale * 1e9);
+        *out = offset < history->last_ns ? history->last_ns - offset : 0;
+        return 0;
+    }
+
+    if (strchr(text, ':')) {
+        int hours = 0, minutes = 0, seconds = 0;
+        if (sscanf(text, "%d:%d:%d", &hours, &minutes, &seconds) < 2) {
+            return -1;
+        }
+        time_t last_wall = (time_t)(mono_to_wall_ns(history, history->last_ns) / 1000000000LL);
+        struct tm local;
+        localtime_r(&last_wall, &local);
+        local.tm_hour = hours;
+        local.tm_min = minutes;
+        local.tm_sec = seconds;
+        local.tm_isdst = -1;
+        time_t wall = mktime(&local);
+        if (wall == (time_t)-1) {
+            return -1;
+        }
+        *out = wall_to_mono_ns(history, (int64_t)wall * 1000000000LL);
+        return 0;
+    }
+
+    double seconds = strtod(text, &end);
+    if (end == text || *end != '\0') {
+        return -1;
+    }
+    *out = wall_to_mono_ns(history, (int64_t)(seconds * 1e9));
+    return 0;
+}
+
+static void print_bucket(const SnooperHistory *history, const char *metric, const SnooperHistoryBucket *bucket, CliFormat format) {
+    int64_t wall_ns = mono_to_wall_ns(history, bucket->start_ns);
+    if (format == CLI_FORMAT_TABLE) {
+        time_t wall = (time_t)(wall_ns / 1000000000LL);
+        struct tm local;
+        char stamp[32];
+        localtime_r(&wall, &local);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+        printf("%s  %-32s %12.3f  (n=%zu)\n", stamp, metric, bucket->value, bucket->count);
+    } else {
+        printf("{\"metric\":\"%s\",\"start\":\"%lld.%09lld\",\"count\":%zu,\"value\":%.6f}\n"
+               , metric
+               , (long long)(wall_ns / 1000000000LL)
+               , (long long)(wall_ns % 1000000000LL)
+               , bucket->count
+               , bucket->value);
+    }
+}
+
+static int run_series_query(const SnooperHistory *history, int series, SnooperHistoryQuery *query, CliFormat format, size_t *decoded, size_t *summarized) {
+    SnooperHistoryResult result;
+    query->series = series;
+    if (snooper_history_query(history, query, &result) != SNOOPER_OK) {
+        fprintf(stderr, "Query failed for %s.\n", history->series[series].name);
+        return -1;
+    }
+    for (size_t i = 0; i < result.bucket_count; ++i) {
+        print_bucket(history, history->series[series].name, &result.buckets[i], format);
+    }
+    *decoded += result.blocks_decoded;
+    *summarized += result.blocks_summarized;
+    snooper_history_result_destroy(&result);
+    return 0;
+}
+
+static int run_metric(const SnooperHistory *history, const char *name, SnooperHistoryQuery *query, CliFormat format, size_t *decoded, size_t *summarized) {
+    SnooperMetricId pattern;
+    if (snooper_metric_parse(name, &pattern) != SNOOPER_OK) {
+        fprintf(stderr, "Unknown metric: %s\n", name);
+        return -1;
+    }
+
+    int matched = 0;
+    for (size_t i = 0; i < history->series_count; ++i) {
+        SnooperMetricId id;
+        char series_name[SNOOPER_TS_NAME_MAX + 1];
+        memcpy(series_name, history->series[i].name, SNOOPER_TS_NAME_MAX);
+        series_name[SNOOPER_TS_NAME_MAX] = '\0';
+        if (snooper_metric_parse(series_name, &id) != SNOOPER_OK || !snooper_metric_matches(&pattern, &id)) {
+            continue;
+        }
+        matched = 1;
+        if (run_series_query(history, (int)i, query, format, decoded, summarized) != 0) {
+            return -1;
+        }
+    }
+
+    if (!matched) {
+        fprintf(stderr, "No recorded series for %s.\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+int cli_run_query(const CliOptions *opts) {
+    if (!opts || !opts->history_path) return 1;
+
+    SnooperHistory history;
+    SnooperStatus rc = snooper_history_open(&history, opts->history_path);
+    if (rc != SNOOPER_OK) {
+        fprintf(stderr, "Failed to open history %s (%d).\n", opts->history_path, rc);
+        return 1;
+    }
+
+    if (opts->list_series) {
+        for (size_t i = 0; i < history.series_count; ++i) {
+            printf("%.*s\n", SNOOPER_TS_NAME_MAX, history.series[i].name);
+        }
+        snooper_history_close(&history);
+        return 0;
+    }
+
+    SnooperHistoryQuery query;
+    memset(&query, 0, sizeof(query));
+    query.from_ns = history.first_ns;
+    query.to_ns = history.last_ns;
+    query.bucket_ns = (uint64_t)(opts->bucket_seconds * 1e9);
+    if (parse_aggregation(opts->aggregation, &query.aggregation, &query.percentile) != 0) {
+        fprintf(stderr, "Unknown aggregation: %s (use avg, min, max, sum, count or pNN).\n", opts->aggregation);
+        snooper_history_close(&history);
+        return 1;
+    }
+    if ((opts->from_time && parse_time(&history, opts->from_time, &query.from_ns) != 0)
+        || (opts->to_time && parse_time(&history, opts->to_time, &query.to_ns) != 0)) {
+        fprintf(stderr, "Invalid time; use unix seconds, HH:MM[:SS] or -<n>[s|m|h].\n");
+        snooper_history_close(&history);
+        return 1;
+    }
+
+    int status = 0;
+    size_t decoded = 0;
+    size_t summarized = 0;
+    const char *cursor = opts->metric_list ? opts->metric_list : "cpu.used";
+    while (*cursor && status == 0) {
+        size_t length = strcspn(cursor, ",");
+        char name[SNOOPER_METRIC_NAME_MAX];
+        if (length == 0 || length >= sizeof(name)) {
+            fprintf(stderr, "Invalid metric list.\n");
+            status = 1;
+            break;
+        }
+        memcpy(name, cursor, length);
+        name[length] = '\0';
+        if (run_metric(&history, name, &query, opts->format, &decoded, &summarized) != 0) {
+            status = 1;
+        }
+        cursor += length;
+        if (*cursor == ',') ++cursor;
+    }
+
+    if (status == 0 && opts->format == CLI_FORMAT_TABLE) {
+        printf("(%zu blocks decoded, %zu answered from summaries)\n", decoded, summarized);
+    }
+
+    snooper_history_close(&history);
+    return status;
+}
@@ -0,0 +1,8 @@
+#ifndef SNOOPER_CLI_QUERY_H
+#define SNOOPER_CLI_QUERY_H
+
+#include "cli_args.h"
+
+int cli_run_query(const CliOptions *opts);
+
+#endif
@@ -0,0 +1,152 @@
+#include "cli_record.h"
+#include "cli_alerts.h"
+#include "cli_history.h"
+#include "cli_telemetry.h"
+#include "snooper/recorder.h"
+#include "snooper/telemetry.h"
+#include "timeutil.h"
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static volatile sig_atomic_t record_stop = 0;
+static volatile sig_atomic_t record_dump_requested = 0;
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    record_stop = 1;
+}
+
+static void handle_dump_signal(int signo) {
+    (void)signo;
+    record_dump_requested = 1;
+}
+
+static void sleep_until(uint64_t deadline_ns) {
+    uint64_t now = snooper_monotonic_now_ns();
+    if (now >= deadline_ns) return;
+    uint64_t remaining = deadline_ns - now;
+    struct timespec req;
+    req.tv_sec = (time_t)(remaining / 1000000000ull);
+    req.tv_nsec = (long)(remaining % 1000000000ull);
+    nanosleep(&req, NULL);
+}
+
+static void dump_recorder(const SnooperRecorder *recorder, const char *path, const char *reason) {
+    if (snooper_recorder_dump(recorder, path) == SNOOPER_OK) {
+        fprintf(stderr, "Dumped %zu records to %s (%s).\n", recorder->count, path, reason);
+    } else {
+        fprintf(stderr, "Failed to dump flight recorder to %s.\n", path);
+    }
+}
+
+static void dump_numbered(const SnooperRecorder *recorder, const char *output, unsigned *sequence, const char *reason) {
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s.%u", output, (*sequence)++);
+    if (length < 0 || (size_t)length >= sizeof(path)) {
+        fprintf(stderr, "Output path too long: %s\n", output);
+        return;
+    }
+    dump_recorder(recorder, path, reason);
+}
+
+int cli_run_record(const CliOptions *opts) {
+    if (!opts || !opts->output_path) return 1;
+
+    SnooperTelemetry telemetry;
+    if (cli_telemetry_open(&telemetry, opts) != 0) {
+        return 1;
+    }
+
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+    signal(SIGUSR1, handle_dump_signal);
+
+    size_t capacity = (size_t)opts->window_seconds * 1000u / (size_t)opts->interval_ms;
+    if (capacity == 0) {
+        capacity = 1;
+    }
+
+    CliAlerts alerts;
+    if (cli_alerts_open(&alerts, opts) != 0) {
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    CliHistory history;
+    memset(&history, 0, sizeof(history));
+    if (opts->history_path && cli_history_open(&history, opts->history_path, &telemetry.session) != 0) {
+        cli_alerts_close(&alerts);
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    SnooperRecorder recorder;
+    memset(&recorder, 0, sizeof(recorder));
+    unsigned sequence = 0;
+    int above_trigger = 0;
+    int status = 0;
+
+    uint64_t interval_ns = (uint64_t)opts->interval_ms * 1000000ull;
+    uint64_t next_sample_ns = snooper_monotonic_now_ns();
+
+    while (!record_stop) {
+        const SnooperSnapshot *snapshot = NULL;
+        SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
+        if (rc == SNOOPER_OK) {
+            if (!recorder.records) {
+                if (snooper_recorder_init(&recorder, capacity, snapshot->core_count, telemetry.session.session_id, (uint32_t)opts->interval_ms) != SNOOPER_OK) {
+                    fprintf(stderr, "Failed to allocate flight recorder.\n");
+                    status = 1;
+                    break;
+                }
+                fprintf(stderr, "Recording %zu snapshots (%zu KiB) to %s.\n"
+                        , capacity
+                        , capacity * recorder.header.record_size / 1024
+                        , opts->output_path);
+            }
+            snooper_recorder_append(&recorder, snapshot);
+            cli_alerts_evaluate(&alerts, snapshot);
+            cli_history_append(&history, snapshot);
+
+            if (opts->trigger_cpu_percent > 0.0) {
+                int above = snapshot->cpu_used_percent >= opts->trigger_cpu_percent;
+                if (above && !above_trigger) {
+                    dump_numbered(&recorder, opts->output_path, &sequence, "cpu trigger");
+                }
+                above_trigger = above;
+            }
+        } else if (rc != SNOOPER_ERR_WARMUP) {
+            fprintf(stderr, "Failed to collect snapshot (%d).\n", rc);
+            status = 1;
+            break;
+        }
+
+        if (record_dump_requested) {
+            record_dump_requested = 0;
+            if (recorder.records) {
+                dump_numbered(&recorder, opts->output_path, &sequence, "SIGUSR1");
+            }
+        }
+
+        // After a stall (slow dump, suspend) resume the cadence from now
+        // instead of firing back-to-back samples to catch up.
+        uint64_t now = snooper_monotonic_now_ns();
+        next_sample_ns += interval_ns;
+        if (next_sample_ns <= now) {
+            next_sample_ns = now + interval_ns;
+        }
+        sleep_until(next_sample_ns);
+    }
+
+    if (recorder.records) {
+        dump_recorder(&recorder, opts->output_path, "exit");
+    }
+
+    cli_history_close(&history);
+    cli_alerts_close(&alerts);
+    snooper_recorder_destroy(&recorder);
+    snooper_telemetry_destroy(&telemetry);
+    return status;
+}
@@ -0,0 +1,8 @@
+#ifndef SNOOPER_CLI_RECORD_H
+#define SNOOPER_CLI_RECORD_H
+
+#include "cli_args.h"
+
+int cli_run_record(const CliOptions *opts);
+
+#endif
@@ -0,0 +1,429 @@
+#include "cli_serve.h"
+#include "cli_alerts.h"
+#include "cli_buffer.h"
+#include "cli_format_json.h"
+#include "cli_telemetry.h"
+#include "snooper/telemetry.h"
+#include "timeutil.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define CLI_SERVE_MAX_CLIENTS 64
+#define CLI_SERVE_QUEUE_DEPTH 16
+#define CLI_SERVE_LINE_MAX 256
+
+typedef struct {
+    CliBuffer buffer;
+    unsigned metrics;
+    int refcount;
+} CliFrame;
+
+typedef struct {
+    int fd;
+    unsigned metrics;
+    unsigned every;
+    unsigned long long samples_seen;
+    char line[CLI_SERVE_LINE_MAX];
+    size_t line_length;
+    CliFrame *queue[CLI_SERVE_QUEUE_DEPTH];
+    size_t queue_head;
+    size_t queue_count;
+    size_t offset;
+    unsigned long long dropped;
+    unsigned long long dropped_reported;
+    char notice[64];
+    size_t notice_length;
+    size_t notice_offset;
+} CliClient;
+
+typedef struct {
+    int listen_fd;
+    CliClient clients[CLI_SERVE_MAX_CLIENTS];
+    size_t client_count;
+    CliFrame *header;
+    CliFrame *frames[CLI_SERVE_MAX_CLIENTS];
+    size_t frame_count;
+} CliServer;
+
+static volatile sig_atomic_t serve_stop = 0;
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    serve_stop = 1;
+}
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return -1;
+    }
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static CliFrame *frame_create(unsigned metrics) {
+    CliFrame *frame = calloc(1, sizeof(*frame));
+    if (!frame) {
+        return NULL;
+    }
+    if (cli_buffer_init(&frame->buffer, 8192) != 0) {
+        free(frame);
+        return NULL;
+    }
+    frame->metrics = metrics;
+    frame->refcount = 1;
+    return frame;
+}
+
+static void frame_release(CliFrame *frame) {
+    if (!frame) return;
+    if (--frame->refcount == 0) {
+        cli_buffer_destroy(&frame->buffer);
+        free(frame);
+    }
+}
+
+static CliFrame *frame_retain(CliFrame *frame) {
+    ++frame->refcount;
+    return frame;
+}
+
+static void client_enqueue(CliClient *client, CliFrame *frame) {
+    if (client->queue_count == CLI_SERVE_QUEUE_DEPTH) {
+        // Drop the oldest snapshot that has not started going out; a half-written
+        // head frame must finish or the stream would be corrupted, and the
+        // session header (metrics == 0) is never dropped.
+        size_t victim = client->offset > 0 ? 1 : 0;
+        size_t slot = (client->queue_head + victim) % CLI_SERVE_QUEUE_DEPTH;
+        while (client->queue[slot]->metrics == 0) {
+            slot = (client->queue_head + ++victim) % CLI_SERVE_QUEUE_DEPTH;
+        }
+        frame_release(client->queue[slot]);
+        for (size_t i = victim; i + 1 < client->queue_count; ++i) {
+            size_t from = (client->queue_head + i + 1) % CLI_SERVE_QUEUE_DEPTH;
+            size_t to = (client->queue_head + i) % CLI_SERVE_QUEUE_DEPTH;
+            client->queue[to] = client->queue[from];
+        }
+        --client->queue_count;
+        ++client->dropped;
+    }
+
+    size_t tail = (client->queue_head + client->queue_count) % CLI_SERVE_QUEUE_DEPTH;
+    client->queue[tail] = frame_retain(frame);
+    ++client->queue_count;
+}
+
+static void client_close(CliServer *server, size_t index) {
+    CliClient *client = &server->clients[index];
+    close(client->fd);
+    for (size_t i = 0; i < client->queue_count; ++i) {
+        frame_release(client->queue[(client->queue_head + i) % CLI_SERVE_QUEUE_DEPTH]);
+    }
+    server->clients[index] = server->clients[server->client_count - 1];
+    --server->client_count;
+}
+
+static int client_write_bytes(int fd, const char *data, size_t length, size_t *offset) {
+    while (*offset < length) {
+        ssize_t written = write(fd, data + *offset, length - *offset);
+        if (written > 0) {
+            *offset += (size_t)written;
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 1;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int client_flush(CliClient *client) {
+    for (;;) {
+        if (client->notice_length == 0 && client->offset == 0 && client->dropped > client->dropped_reported) {
+            int length = snprintf(client->notice, sizeof(client->notice), "{\"type\":\"dropped\",\"count\":%llu,\"total\":%llu}\n"
+                                  , client->dropped - client->dropped_reported
+                                  , client->dropped);
+            client->notice_length = length > 0 && (size_t)length < sizeof(client->notice) ? (size_t)length : 0;
+            client->notice_offset = 0;
+            client->dropped_reported = client->dropped;
+        }
+
+        if (client->notice_length > 0) {
+            int rc = client_write_bytes(client->fd, client->notice, client->notice_length, &client->notice_offset);
+            if (rc != 0) {
+                return rc;
+            }
+            client->notice_length = 0;
+        }
+
+        if (client->queue_count == 0) {
+            return 0;
+        }
+
+        CliFrame *frame = client->queue[client->queue_head];
+        int rc = client_write_bytes(client->fd, frame->buffer.data, frame->buffer.length, &client->offset);
+        if (rc != 0) {
+            return rc;
+        }
+
+        frame_release(frame);
+        client->queue_head = (client->queue_head + 1) % CLI_SERVE_QUEUE_DEPTH;
+        --client->queue_count;
+        client->offset = 0;
+    }
+}
+
+static void client_apply_subscription(CliClient *client, char *line) {
+    unsigned metrics = CLI_METRIC_ALL;
+    unsigned every = 1;
+
+    for (char *token = strtok(line, " \t\r"); token; token = strtok(NULL, " \t\r")) {
+        if (strncmp(token, "metrics=", 8) == 0) {
+            if (cli_parse_metric_list(token + 8, &metrics) != 0) {
+                return;
+            }
+        } else if (strncmp(token, "every=", 6) == 0) {
+            int value = atoi(token + 6);
+            if (value <= 0) {
+                return;
+            }
+            every = (unsigned)value;
+        } else {
+            return;
+        }
+    }
+
+    client->metrics = metrics;
+    client->every = every;
+}
+
+static int client_read(CliClient *client) {
+    char chunk[CLI_SERVE_LINE_MAX];
+    for (;;) {
+        ssize_t got = read(client->fd, chunk, sizeof(chunk));
+        if (got == 0) {
+            return -1;
+        } else if (got < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+
+        for (ssize_t i = 0; i < got; ++i) {
+            if (chunk[i] == '\n') {
+                client->line[client->line_length] = '\0';
+                client_apply_subscription(client, client->line);
+                client->line_length = 0;
+            } else if (client->line_length + 1 < sizeof(client->line)) {
+                client->line[client->line_length++] = chunk[i];
+            }
+        }
+    }
+}
+
+static void server_accept(CliServer *server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (server->client_count == CLI_SERVE_MAX_CLIENTS || set_nonblocking(fd) != 0) {
+            close(fd);
+            continue;
+        }
+
+        CliClient *client = &server->clients[server->client_count++];
+        memset(client, 0, sizeof(*client));
+        client->fd = fd;
+        client->metrics = CLI_METRIC_ALL;
+        client->every = 1;
+        client_enqueue(client, server->header);
+    }
+}
+
+static CliFrame *server_frame_for(CliServer *server, const SnooperSnapshot *snapshot, unsigned metrics) {
+    for (size_t i = 0; i < server->frame_count; ++i) {
+        if (server->frames[i]->metrics == metrics) {
+            return server->frames[i];
+        }
+    }
+
+    CliFrame *frame = frame_create(metrics);
+    if (!frame) {
+        return NULL;
+    }
+    cli_encode_snapshot_json(snapshot, metrics, &frame->buffer);
+    server->frames[server->frame_count++] = frame;
+    return frame;
+}
+
+static void server_publish(CliServer *server, const SnooperSnapshot *snapshot) {
+    for (size_t i = 0; i < server->client_count; ++i) {
+        CliClient *client = &server->clients[i];
+        if (client->samples_seen++ % client->every != 0) {
+            continue;
+        }
+        CliFrame *frame = server_frame_for(server, snapshot, client->metrics);
+        if (frame) {
+            client_enqueue(client, frame);
+        }
+    }
+
+    for (size_t i = 0; i < server->frame_count; ++i) {
+        frame_release(server->frames[i]);
+    }
+    server->frame_count = 0;
+}
+
+static int server_listen(const char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 16) != 0 || set_nonblocking(fd) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int cli_run_serve(const CliOptions *opts) {
+    if (!opts || !opts->socket_path) return 1;
+
+    SnooperTelemetry telemetry;
+    if (cli_telemetry_open(&telemetry, opts) != 0) {
+        return 1;
+    }
+
+    CliAlerts alerts;
+    if (cli_alerts_open(&alerts, opts) != 0) {
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    CliServer server;
+    memset(&server, 0, sizeof(server));
+    server.header = frame_create(0);
+    server.listen_fd = server.header ? server_listen(opts->socket_path) : -1;
+    if (server.listen_fd < 0) {
+        frame_release(server.header);
+        cli_alerts_close(&alerts);
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+    cli_encode_session_json(&telemetry.session, &telemetry.topology, &server.header->buffer);
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+
+    uint64_t interval_ns = (uint64_t)opts->interval_ms * 1000000ull;
+    uint64_t next_sample_ns = snooper_monotonic_now_ns();
+    struct pollfd fds[CLI_SERVE_MAX_CLIENTS + 1];
+    int status = 0;
+
+    while (!serve_stop) {
+        uint64_t now = snooper_monotonic_now_ns();
+        if (now >= next_sample_ns) {
+            const SnooperSnapshot *snapshot = NULL;
+            SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
+            if (rc == SNOOPER_OK) {
+                server_publish(&server, snapshot);
+                cli_alerts_evaluate(&alerts, snapshot);
+            } else if (rc != SNOOPER_ERR_WARMUP) {
+                fprintf(stderr, "Failed to collect snapshot (%d).\n", rc);
+                status = 1;
+                break;
+            }
+            next_sample_ns += interval_ns;
+            if (next_sample_ns <= now) {
+                next_sample_ns = now + interval_ns;
+            }
+
+            for (size_t i = 0; i < server.client_count;) {
+                if (client_flush(&server.clients[i]) < 0) {
+                    client_close(&server, i);
+                } else {
+                    ++i;
+                }
+            }
+            continue;
+        }
+
+        fds[0].fd = server.listen_fd;
+        fds[0].events = POLLIN;
+        for (size_t i = 0; i < server.client_count; ++i) {
+            const CliClient *client = &server.clients[i];
+            fds[i + 1].fd = client->fd;
+            fds[i + 1].events = POLLIN;
+            if (client->queue_count > 0 || client->notice_length > 0) {
+                fds[i + 1].events |= POLLOUT;
+            }
+            fds[i + 1].revents = 0;
+        }
+
+        int timeout_ms = (int)((next_sample_ns - now + 999999ull) / 1000000ull);
+        size_t polled = server.client_count;
+        int ready = poll(fds, (nfds_t)(polled + 1), timeout_ms);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            status = 1;
+            break;
+        }
+        if (ready == 0) {
+            continue;
+        }
+
+        for (size_t i = polled; i > 0; --i) {
+            short revents = fds[i].revents;
+            CliClient *client = &server.clients[i - 1];
+            int failed = (revents & (POLLERR | POLLNVAL)) != 0;
+            if (!failed && (revents & (POLLIN | POLLHUP))) {
+                failed = client_read(client) < 0;
+            }
+            if (!failed && (revents & POLLOUT)) {
+                failed = client_flush(client) < 0;
+            }
+            if (failed) {
+                client_close(&server, i - 1);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            server_accept(&server);
+        }
+    }
+
+    while (server.client_count > 0) {
+        client_close(&server, server.client_count - 1);
+    }
+    close(server.listen_fd);
+    unlink(opts->socket_path);
+    frame_release(server.header);
+    cli_alerts_close(&alerts);
+    snooper_telemetry_destroy(&telemetry);
+    return status;
+}
@@ -0,0 +1,8 @@
+#ifndef SNOOPER_CLI_SERVE_H
+#define SNOOPER_CLI_SERVE_H
+
+#include "cli_args.h"
+
+int cli_run_serve(const CliOptions *opts);
+
+#endif
@@ -0,0 +1,48 @@
+#include "cli_telemetry.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+static int load_plugins(SnooperTelemetry *telemetry, const char *list) {
+    const char *cursor = list;
+    while (*cursor) {
+        size_t length = strcspn(cursor, ",");
+        if (length > 0) {
+            char path[PATH_MAX];
+            if (length >= sizeof(path)) {
+                fprintf(stderr, "Plugin path too long.\n");
+                return -1;
+            }
+            memcpy(path, cursor, length);
+            path[length] = '\0';
+
+            char error[256];
+            if (snooper_telemetry_load_plugin(telemetry, path, error, sizeof(error)) != SNOOPER_OK) {
+                fprintf(stderr, "Failed to load plugin %s: %s\n", path, error);
+                return -1;
+            }
+        }
+        cursor += length;
+        if (*cursor == ',') {
+            ++cursor;
+        }
+    }
+    return 0;
+}
+
+int cli_telemetry_open(SnooperTelemetry *telemetry, const CliOptions *opts) {
+    if (snooper_telemetry_init(telemetry, opts->show_identifiers) != SNOOPER_OK) {
+        fprintf(stderr, "Failed to initialize telemetry.\n");
+        return -1;
+    }
+    if (opts->plugin_paths && load_plugins(telemetry, opts->plugin_paths) != 0) {
+        snooper_telemetry_destroy(telemetry);
+        return -1;
+    }
+    if (opts->probe_periods && snooper_telemetry_parse_periods(telemetry, opts->probe_periods) != SNOOPER_OK) {
+        fprintf(stderr, "Invalid --period: %s\n", opts->probe_periods);
+        snooper_telemetry_destroy(telemetry);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef SNOOPER_CLI_TELEMETRY_H
+#define SNOOPER_CLI_TELEMETRY_H
+
+#include "snooper/telemetry.h"
+#include "cli_args.h"
+
+int cli_telemetry_open(SnooperTelemetry *telemetry, const CliOptions *opts);
+
+#endif
@@ -0,0 +1,676 @@
+#include "cli_tui.h"
+#include "cli_buffer.h"
+#include "cli_telemetry.h"
+#include "snooper/telemetry.h"
+#include "timeutil.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TUI_HISTORY 512
+#define TUI_GAP_CELLS 3
+#define TUI_MIN_WIDTH 40
+#define TUI_MIN_HEIGHT 10
+#define TUI_CORE_COLUMN 24
+#define TUI_CORE_BAR 12
+
+// Low nibble is an ANSI color (30 + n), 0 meaning the terminal default.
+enum {
+    TUI_RED = 1,
+    TUI_GREEN = 2,
+    TUI_YELLOW = 3,
+    TUI_BLUE = 4,
+    TUI_MAGENTA = 5,
+    TUI_CYAN = 6,
+    TUI_BOLD = 0x10,
+    TUI_DIM = 0x20,
+    TUI_REVERSE = 0x40
+};
+
+typedef struct {
+    uint32_t glyph;
+    uint8_t style;
+} TuiCell;
+
+// front mirrors what the terminal currently shows; frames are composed into
+// back and only the differing cells are written out.
+typedef struct {
+    int width;
+    int height;
+    TuiCell *front;
+    TuiCell *back;
+    int clear_pending;
+    int cursor_x;
+    int cursor_y;
+    uint8_t style;
+    int unicode;
+    CliBuffer out;
+    uint64_t bytes_written;
+} TuiScreen;
+
+typedef struct {
+    double cpu[TUI_HISTORY];
+    size_t head;
+    size_t count;
+} TuiHistory;
+
+static volatile sig_atomic_t tui_stop = 0;
+static volatile sig_atomic_t tui_resized = 0;
+
+static const uint32_t bar_glyphs[9] = { ' ', 0x258F, 0x258E, 0x258D, 0x258C, 0x258B, 0x258A, 0x2589, 0x2588 };
+static const uint32_t bar_ascii[9] = { ' ', ' ', ' ', ' ', ':', ':', ':', ':', '#' };
+static const uint32_t spark_glyphs[8] = { 0x2581, 0x2582, 0x2583, 0x2584, 0x2585, 0x2586, 0x2587, 0x2588 };
+static const uint32_t spark_ascii[8] = { '_', '.', ',', '-', '=', '+', '*', '#' };
+static const uint32_t heat_glyphs[5] = { 0x00B7, 0x2591, 0x2592, 0x2593, 0x2588 };
+static const uint32_t heat_ascii[5] = { '.', ':', '*', '%', '#' };
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    tui_stop = 1;
+}
+
+static void handle_resize_signal(int signo) {
+    (void)signo;
+    tui_resized = 1;
+}
+
+static int locale_is_utf8(void) {
+    const char *names[] = { "LC_ALL", "LC_CTYPE", "LANG" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        const char *value = getenv(names[i]);
+        if (value && *value) {
+            return strstr(value, "UTF-8") || strstr(value, "utf8") || strstr(value, "UTF8") || strstr(value, "utf-8");
+        }
+    }
+    return 0;
+}
+
+static void terminal_size(int *width, int *height) {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        *width = size.ws_col;
+        *height = size.ws_row;
+        return;
+    }
+    const char *columns = getenv("COLUMNS");
+    const char *lines = getenv("LINES");
+    *width = columns && atoi(columns) > 0 ? atoi(columns) : 80;
+    *height = lines && atoi(lines) > 0 ? atoi(lines) : 24;
+}
+
+static void fill_cells(TuiCell *cells, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        cells[i].glyph = ' ';
+        cells[i].style = 0;
+    }
+}
+
+static int screen_resize(TuiScreen *screen) {
+    int width = 0;
+    int height = 0;
+    terminal_size(&width, &height);
+    size_t count = (size_t)width * (size_t)height;
+    TuiCell *front = malloc(count * sizeof(TuiCell));
+    TuiCell *back = malloc(count * sizeof(TuiCell));
+    if (!front || !back) {
+        free(front);
+        free(back);
+        return -1;
+    }
+    free(screen->front);
+    free(screen->back);
+    screen->front = front;
+    screen->back = back;
+    screen->width = width;
+    screen->height = height;
+    // The clear below leaves the terminal blank, which is what front holds.
+    fill_cells(front, count);
+    screen->clear_pending = 1;
+    return 0;
+}
+
+static int screen_open(TuiScreen *screen) {
+    memset(screen, 0, sizeof(*screen));
+    screen->unicode = locale_is_utf8();
+    if (cli_buffer_init(&screen->out, 16384) != 0) {
+        return -1;
+    }
+    if (screen_resize(screen) != 0) {
+        cli_buffer_destroy(&screen->out);
+        return -1;
+    }
+    return 0;
+}
+
+static void screen_close(TuiScreen *screen) {
+    free(screen->front);
+    free(screen->back);
+    cli_buffer_destroy(&screen->out);
+    memset(screen, 0, sizeof(*screen));
+}
+
+static int write_all(const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+static void append_glyph(CliBuffer *out, uint32_t glyph) {
+    char bytes[4];
+    size_t length;
+    if (glyph < 0x80) {
+        bytes[0] = (char)glyph;
+        length = 1;
+    } else if (glyph < 0x800) {
+        bytes[0] = (char)(0xC0 | (glyph >> 6));
+        bytes[1] = (char)(0x80 | (glyph & 0x3F));
+        length = 2;
+    } else {
+        bytes[0] = (char)(0xE0 | (glyph >> 12));
+        bytes[1] = (char)(0x80 | ((glyph >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (glyph & 0x3F));
+        length = 3;
+    }
+    cli_buffer_append(out, bytes, length);
+}
+
+static void append_style(TuiScreen *screen, uint8_t style) {
+    if (style == screen->style) {
+        return;
+    }
+    if (style == 0) {
+        cli_buffer_appendf(&screen->out, "\033[m");
+    } else {
+        cli_buffer_appendf(&screen->out, "\033[0%s%s%s"
+               , (style & TUI_BOLD) ? ";1" : ""
+               , (style & TUI_DIM) ? ";2" : ""
+               , (style & TUI_REVERSE) ? ";7" : "");
+        if (style & 0x0F) {
+            cli_buffer_appendf(&screen->out, ";%d", 30 + (style & 0x0F));
+        }
+        cli_buffer_appendf(&screen->out, "m");
+    }
+    screen->style = style;
+}
+
+// Picks the shortest of a relative move, a carriage return and an absolute
+// position; cursor_x is -1 when the terminal's cursor column is unknown.
+static void append_move(TuiScreen *screen, int x, int y) {
+    if (screen->cursor_y == y && screen->cursor_x == x) {
+        return;
+    }
+    if (screen->cursor_y == y && screen->cursor_x >= 0 && x > screen->cursor_x) {
+        int distance = x - screen->cursor_x;
+        if (distance == 1) {
+            cli_buffer_appendf(&screen->out, "\033[C");
+        } else {
+            cli_buffer_appendf(&screen->out, "\033[%dC", distance);
+        }
+    } else if (screen->cursor_y == y && x == 0) {
+        cli_buffer_appendf(&screen->out, "\r");
+    } else if (x == 0) {
+        cli_buffer_appendf(&screen->out, "\033[%dH", y + 1);
+    } else {
+        cli_buffer_appendf(&screen->out, "\033[%d;%dH", y + 1, x + 1);
+    }
+    screen->cursor_x = x;
+    screen->cursor_y = y;
+}
+
+static int cells_equal(const TuiCell *a, const TuiCell *b) {
+    return a->glyph == b->glyph && a->style == b->style;
+}
+
+// Writes the cells that differ between back and front. Unchanged gaps of up to
+// TUI_GAP_CELLS inside a changed run are rewritten rather than skipped, as that
+// is no longer than the escape sequence needed to jump over them.
+static int screen_flush(TuiScreen *screen) {
+    CliBuffer *out = &screen->out;
+    cli_buffer_reset(out);
+    if (screen->clear_pending) {
+        cli_buffer_appendf(out, "\033[m\033[2J");
+        screen->style = 0;
+        screen->cursor_x = -1;
+        screen->cursor_y = -1;
+        screen->clear_pending = 0;
+    }
+
+    int width = screen->width;
+    for (int y = 0; y < screen->height; ++y) {
+        TuiCell *front = screen->front + (size_t)y * (size_t)width;
+        const TuiCell *back = screen->back + (size_t)y * (size_t)width;
+        int x = 0;
+        while (x < width) {
+            if (cells_equal(&front[x], &back[x])) {
+                ++x;
+                continue;
+            }
+            int end = x + 1;
+            for (int probe = end; probe < width && probe - end < TUI_GAP_CELLS; ++probe) {
+                if (!cells_equal(&front[probe], &back[probe])) {
+                    end = probe + 1;
+                }
+            }
+
+            append_move(screen, x, y);
+            for (int i = x; i < end; ++i) {
+                append_style(screen, back[i].style);
+                append_glyph(out, back[i].glyph);
+                front[i] = back[i];
+            }
+            // Autowrap is off, so the cursor sticks on the last column.
+            screen->cursor_x = end < width ? end : -1;
+            x = end;
+        }
+    }
+
+    if (out->length == 0) {
+        return 0;
+    }
+    screen->bytes_written += out->length;
+    return write_all(out->data, out->length);
+}
+
+static void put_glyph(TuiScreen *screen, int x, int y, uint32_t glyph, uint8_t style) {
+    if (x < 0 || y < 0 || x >= screen->width || y >= screen->height) {
+        return;
+    }
+    TuiCell *cell = &screen->back[(size_t)y * (size_t)screen->width + (size_t)x];
+    cell->glyph = glyph;
+    cell->style = style;
+}
+
+static int put_text(TuiScreen *screen, int x, int y, uint8_t style, const char *text) {
+    for (; *text; ++text, ++x) {
+        unsigned char c = (unsigned char)*text;
+        put_glyph(screen, x, y, c < 0x80 ? c : '?', style);
+    }
+    return x;
+}
+
+static int put_textf(TuiScreen *screen, int x, int y, uint8_t style, const char *fmt, ...) __attribute__((format(printf, 5, 6)));
+
+static int put_textf(TuiScreen *screen, int x, int y, uint8_t style, const char *fmt, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    return put_text(screen, x, y, style, text);
+}
+
+static uint8_t level_color(double percent) {
+    if (percent >= 80.0) return TUI_RED;
+    if (percent >= 50.0) return TUI_YELLOW;
+    return TUI_GREEN;
+}
+
+static double clamp_percent(double percent) {
+    if (percent < 0.0) return 0.0;
+    if (percent > 100.0) return 100.0;
+    return percent;
+}
+
+// Draws "[bar]" with eighth-cell resolution; width counts the brackets.
+static void draw_bar(TuiScreen *screen, int x, int y, int width, double percent) {
+    int inner = width - 2;
+    if (inner <= 0) return;
+    const uint32_t *glyphs = screen->unicode ? bar_glyphs : bar_ascii;
+    uint8_t color = level_color(percent);
+    int eighths = (int)(clamp_percent(percent) / 100.0 * inner * 8.0 + 0.5);
+    put_glyph(screen, x, y, '[', TUI_DIM);
+    for (int i = 0; i < inner; ++i) {
+        int fill = eighths - i * 8;
+        if (fill > 8) fill = 8;
+        if (fill < 0) fill = 0;
+        put_glyph(screen, x + 1 + i, y, glyphs[fill], color);
+    }
+    put_glyph(screen, x + width - 1, y, ']', TUI_DIM);
+}
+
+static void draw_sparkline(TuiScreen *screen, int x, int y, int width, const TuiHistory *history) {
+    const uint32_t *glyphs = screen->unicode ? spark_glyphs : spark_ascii;
+    size_t shown = history->count < (size_t)width ? history->count : (size_t)width;
+    int start = x + width - (int)shown;
+    for (size_t i = 0; i < shown; ++i) {
+        size_t index = (history->head + TUI_HISTORY - shown + i) % TUI_HISTORY;
+        double percent = clamp_percent(history->cpu[index]);
+        int level = (int)(percent / 100.0 * 7.0 + 0.5);
+        put_glyph(screen, start + (int)i, y, glyphs[level], TUI_CYAN);
+    }
+}
+
+static void format_bytes(char *out, size_t size, uint64_t bytes) {
+    static const char units[] = "BKMGTP";
+    double value = (double)bytes;
+    size_t unit = 0;
+    while (value >= 1024.0 && unit + 1 < sizeof(units) - 1) {
+        value /= 1024.0;
+        ++unit;
+    }
+    if (unit == 0) {
+        snprintf(out, size, "%lluB", (unsigned long long)bytes);
+    } else {
+        snprintf(out, size, value < 10.0 ? "%.1f%c" : "%.0f%c", value, units[unit]);
+    }
+}
+
+static void draw_header(TuiScreen *screen, const SnooperSnapshot *snapshot) {
+    for (int x = 0; x < screen->width; ++x) {
+        put_glyph(screen, x, 0, ' ', TUI_REVERSE);
+    }
+    int x = put_text(screen, 1, 0, TUI_REVERSE | TUI_BOLD, "silicon-snooper");
+    x = put_textf(screen, x + 2, 0, TUI_REVERSE, "%zu cores", snapshot->core_count);
+    const SnooperSystemMetrics *system = &snapshot->system_metrics;
+    if (system->has_uptime) {
+        uint64_t uptime = system->uptime_seconds;
+        put_textf(screen, x + 2, 0, TUI_REVERSE, "up %llud %02llu:%02llu"
+               , (unsigned long long)(uptime / 86400)
+               , (unsigned long long)(uptime / 3600 % 24)
+               , (unsigned long long)(uptime / 60 % 60));
+    }
+
+    struct tm local;
+    time_t now = snapshot->wall_time.tv_sec;
+    if (localtime_r(&now, &local)) {
+        char clock[16];
+        strftime(clock, sizeof(clock), "%H:%M:%S", &local);
+        put_text(screen, screen->width - 1 - (int)strlen(clock), 0, TUI_REVERSE, clock);
+    }
+}
+
+static int draw_summary(TuiScreen *screen, const SnooperSnapshot *snapshot, const TuiHistory *history, int y) {
+    int bar_width = screen->width * 2 / 5;
+    int value_x = 5 + bar_width + 1;
+
+    put_text(screen, 1, y, TUI_BOLD, "CPU");
+    draw_bar(screen, 5, y, bar_width, snapshot->cpu_used_percent);
+    put_textf(screen, value_x, y, 0, "%5.1f%%", snapshot->cpu_used_percent);
+    int spark_x = value_x + 8;
+    if (screen->width - 1 - spark_x > 0) {
+        draw_sparkline(screen, spark_x, y, screen->width - 1 - spark_x, history);
+    }
+    ++y;
+
+    put_text(screen, 1, y, TUI_BOLD, "GPU");
+    if (snapshot->gpu_available) {
+        draw_bar(screen, 5, y, bar_width, snapshot->gpu_used_percent);
+        put_textf(screen, value_x, y, 0, "%5.1f%%", snapshot->gpu_used_percent);
+    } else {
+        put_text(screen, 5, y, TUI_DIM, "n/a");
+    }
+    ++y;
+
+    const SnooperSystemMetrics *system = &snapshot->system_metrics;
+    put_text(screen, 1, y, TUI_BOLD, "MEM");
+    uint64_t total = system->memory_used_bytes + system->memory_free_bytes;
+    if (system->has_memory && total > 0) {
+        char used[16];
+        char capacity[16];
+        format_bytes(used, sizeof(used), system->memory_used_bytes);
+        format_bytes(capacity, sizeof(capacity), total);
+        double percent = 100.0 * (double)system->memory_used_bytes / (double)total;
+        draw_bar(screen, 5, y, bar_width, percent);
+        put_textf(screen, value_x, y, 0, "%5.1f%%  %s/%s", percent, used, capacity);
+    } else {
+        put_text(screen, 5, y, TUI_DIM, "n/a");
+    }
+    ++y;
+
+    int x = 1;
+    if (system->has_load) {
+        x = put_text(screen, x, y, TUI_BOLD, "Load ");
+        x = put_textf(screen, x, y, 0, "%.2f %.2f %.2f", system->load_avg_1, system->load_avg_5, system->load_avg_15) + 3;
+    }
+    if (system->has_process_info) {
+        x = put_text(screen, x, y, TUI_BOLD, "Tasks ");
+        x = put_textf(screen, x, y, 0, "%d, %d thr", system->process_count, system->thread_count) + 3;
+    }
+    if (snapshot->has_sched) {
+        x = put_text(screen, x, y, TUI_BOLD, "Ctx ");
+        x = put_textf(screen, x, y, 0, "%.0f/s", snapshot->sched.context_switches_per_sec) + 3;
+    }
+    if (snapshot->power.available) {
+        x = put_text(screen, x, y, TUI_BOLD, "Power ");
+        put_textf(screen, x, y, 0, "%.1f W", snapshot->power.package_watts);
+    }
+    return y + 1;
+}
+
+// Cores run down each column first so neighbouring ids stay together.
+static int draw_core_bars(TuiScreen *screen, const SnooperSnapshot *snapshot, int y, int rows) {
+    for (size_t i = 0; i < snapshot->core_count; ++i) {
+        int row = (int)(i % (size_t)rows);
+        int x = 1 + (int)(i / (size_t)rows) * TUI_CORE_COLUMN;
+        double percent = 100.0 - snapshot->per_core[i].idle;
+        put_textf(screen, x, y + row, TUI_DIM, "%3zu", i);
+        draw_bar(screen, x + 4, y + row, TUI_CORE_BAR + 2, percent);
+        put_textf(screen, x + 5 + TUI_CORE_BAR + 1, y + row, 0, "%3.0f%%", percent);
+    }
+    return y + rows;
+}
+
+// One cell per core, shaded by load, for machines with more cores than fit
+// as bars.
+static int draw_core_heat(TuiScreen *screen, const SnooperSnapshot *snapshot, int y, int max_rows) {
+    const uint32_t *glyphs = screen->unicode ? heat_glyphs : heat_ascii;
+    int per_row = screen->width - 8;
+    put_text(screen, 1, y, TUI_BOLD, "Cores");
+    int rows = 0;
+    for (size_t i = 0; i < snapshot->core_count; ++i) {
+        int row = (int)(i / (size_t)per_row);
+        if (row >= max_rows) break;
+        double percent = clamp_percent(100.0 - snapshot->per_core[i].idle);
+        int level = (int)(percent / 100.0 * 4.0 + 0.5);
+        put_glyph(screen, 7 + (int)(i % (size_t)per_row), y + row, glyphs[level], level_color(percent));
+        rows = row + 1;
+    }
+    return y + rows;
+}
+
+static void draw_processes(TuiScreen *screen, const SnooperProcessStats *processes, int y, int last_row) {
+    int name_width = screen->width - 40;
+    if (name_width > 24) name_width = 24;
+    if (name_width < 8) name_width = 8;
+    put_textf(screen, 1, y, TUI_BOLD, "%7s  %-*s %6s %7s %4s %s", "PID", name_width, "NAME", "CPU%", "RSS", "THR", "S");
+    put_textf(screen, 1 + 7 + 2 + name_width + 1 + 6 + 1 + 7 + 1 + 4 + 1 + 4, y, TUI_DIM, "%zu procs", processes->process_count);
+    ++y;
+    for (size_t i = 0; i < processes->top_count && y < last_row; ++i, ++y) {
+        const SnooperProcess *process = &processes->top[i];
+        char rss[16];
+        format_bytes(rss, sizeof(rss), process->rss_bytes);
+        int x = put_textf(screen, 1, y, 0, "%7d  %-*.*s ", process->pid, name_width, name_width, process->name);
+        x = put_textf(screen, x, y, level_color(process->cpu_percent), "%6.1f", process->cpu_percent);
+        put_textf(screen, x, y, 0, " %7s %4llu %c", rss, (unsigned long long)process->threads, process->state);
+    }
+}
+
+static void draw_footer(TuiScreen *screen, const CliOptions *opts, int refresh_ms, double output_rate) {
+    int y = screen->height - 1;
+    int x = put_text(screen, 1, y, TUI_BOLD, "q");
+    put_textf(screen, x, y, TUI_DIM, " quit   sample %dms   redraw %dms   output %.1f KB/s", opts->interval_ms, refresh_ms, output_rate / 1024.0);
+}
+
+static void compose_frame(TuiScreen *screen, const CliOptions *opts, int refresh_ms, const SnooperSnapshot *snapshot, const TuiHistory *history, double output_rate) {
+    fill_cells(screen->back, (size_t)screen->width * (size_t)screen->height);
+    if (screen->width < TUI_MIN_WIDTH || screen->height < TUI_MIN_HEIGHT) {
+        put_text(screen, 0, 0, TUI_BOLD, "Terminal too small.");
+        return;
+    }
+    if (!snapshot) {
+        put_text(screen, 1, 0, TUI_BOLD, "silicon-snooper");
+        put_text(screen, 1, 2, TUI_DIM, "Waiting for the first sample...");
+        draw_footer(screen, opts, refresh_ms, output_rate);
+        return;
+    }
+
+    draw_header(screen, snapshot);
+    int y = draw_summary(screen, snapshot, history, 2) + 1;
+
+    int footer = screen->height - 1;
+    int process_rows = snapshot->has_processes ? 4 : 0;
+    int core_space = footer - y - (process_rows ? process_rows + 1 : 0);
+    int columns = (screen->width - 1) / TUI_CORE_COLUMN;
+    if (columns < 1) columns = 1;
+    int bar_rows = (int)((snapshot->core_count + (size_t)columns - 1) / (size_t)columns);
+    if (bar_rows <= core_space) {
+        y = draw_core_bars(screen, snapshot, y, bar_rows);
+    } else if (core_space > 0) {
+        y = draw_core_heat(screen, snapshot, y, core_space);
+    }
+
+    if (snapshot->has_processes && footer - (y + 1) >= 2) {
+        draw_processes(screen, &snapshot->processes, y + 1, footer);
+    }
+    draw_footer(screen, opts, refresh_ms, output_rate);
+}
+
+static int read_keys(void) {
+    char keys[32];
+    ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+    for (ssize_t i = 0; i < count; ++i) {
+        if (keys[i] == 'q' || keys[i] == 'Q') {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int cli_run_tui(const CliOptions *opts) {
+    SnooperTelemetry telemetry;
+    if (cli_telemetry_open(&telemetry, opts) != 0) {
+        return 1;
+    }
+
+    const SnooperSnapshot *snapshot = NULL;
+    TuiHistory *history = calloc(1, sizeof(*history));
+    TuiScreen screen;
+    if (!history || screen_open(&screen) != 0) {
+        fprintf(stderr, "Failed to allocate the dashboard.\n");
+        free(history);
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    struct termios saved;
+    int raw = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+    if (raw) {
+        struct termios settings = saved;
+        settings.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+        settings.c_cc[VMIN] = 0;
+        settings.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &settings);
+    }
+
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+    signal(SIGWINCH, handle_resize_signal);
+
+    // Alternate screen, hidden cursor, autowrap off.
+    const char enter[] = "\033[?1049h\033[?25l\033[?7l";
+    write_all(enter, sizeof(enter) - 1);
+
+    int refresh_ms = opts->refresh_ms;
+    uint64_t interval_ns = (uint64_t)opts->interval_ms * 1000000ull;
+    uint64_t refresh_ns = (uint64_t)refresh_ms * 1000000ull;
+    uint64_t next_sample_ns = snooper_monotonic_now_ns();
+    uint64_t next_draw_ns = next_sample_ns;
+    uint64_t rate_start_ns = next_sample_ns;
+    uint64_t rate_start_bytes = 0;
+    double output_rate = 0.0;
+    int have_snapshot = 0;
+    int status = 0;
+    SnooperStatus failure = SNOOPER_OK;
+
+    while (!tui_stop) {
+        uint64_t now = snooper_monotonic_now_ns();
+        if (now >= next_sample_ns) {
+            SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
+            if (rc == SNOOPER_OK) {
+                history->cpu[history->head] = snapshot->cpu_used_percent;
+                history->head = (history->head + 1) % TUI_HISTORY;
+                if (history->count < TUI_HISTORY) history->count++;
+                have_snapshot = 1;
+            } else if (rc != SNOOPER_ERR_WARMUP) {
+                failure = rc;
+                status = 1;
+                break;
+            }
+            next_sample_ns += interval_ns;
+            if (next_sample_ns <= now) {
+                next_sample_ns = now + interval_ns;
+            }
+        }
+
+        if (tui_resized) {
+            tui_resized = 0;
+            if (screen_resize(&screen) != 0) {
+                status = 1;
+                break;
+            }
+            next_draw_ns = now;
+        }
+
+        if (now >= next_draw_ns) {
+            if (now - rate_start_ns >= 1000000000ull) {
+                output_rate = (double)(screen.bytes_written - rate_start_bytes) * 1e9 / (double)(now - rate_start_ns);
+                rate_start_ns = now;
+                rate_start_bytes = screen.bytes_written;
+            }
+            compose_frame(&screen, opts, refresh_ms, have_snapshot ? snapshot : NULL, history, output_rate);
+            if (screen_flush(&screen) != 0) {
+                status = 1;
+                break;
+            }
+            next_draw_ns += refresh_ns;
+            if (next_draw_ns <= now) {
+                next_draw_ns = now + refresh_ns;
+            }
+        }
+
+        uint64_t deadline = next_sample_ns < next_draw_ns ? next_sample_ns : next_draw_ns;
+        now = snooper_monotonic_now_ns();
+        int timeout_ms = deadline > now ? (int)((deadline - now + 999999ull) / 1000000ull) : 0;
+        struct pollfd input = { .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 };
+        int ready = poll(&input, raw ? 1 : 0, timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            status = 1;
+            break;
+        }
+        if (ready > 0 && (input.revents & POLLIN) && read_keys()) {
+            break;
+        }
+    }
+
+    const char leave[] = "\033[m\033[?7h\033[?25h\033[?1049l";
+    write_all(leave, sizeof(leave) - 1);
+    if (raw) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+    if (failure != SNOOPER_OK) {
+        fprintf(stderr, "Failed to collect snapshot (%d).\n", failure);
+    } else if (status != 0) {
+        fprintf(stderr, "Failed to update the terminal.\n");
+    }
+
+    screen_close(&screen);
+    free(history);
+    snooper_telemetry_destroy(&telemetry);
+    return status;
+}
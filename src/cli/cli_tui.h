@@ -0,0 +1,8 @@
+#ifndef SNOOPER_CLI_TUI_H
+#define SNOOPER_CLI_TUI_H
+
+#include "cli_args.h"
+
+int cli_run_tui(const CliOptions *opts);
+
+#endif
@@ -1,12 +1,33 @@
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "cli_args.h"
 #include "cli_format_table.h"
 #include "cli_format_json.h"
+#include "cli_format_arrow.h"
+#include "cli_serve.h"
+#include "cli_export.h"
+#include "cli_record.h"
+#include "cli_alerts.h"
+#include "cli_history.h"
+#include "cli_query.h"
+#include "cli_merge.h"
+#include "cli_telemetry.h"
+#include "cli_tui.h"
+#include "snooper/baseline.h"
 #include "snooper/telemetry.h"
 #include "snooper/system_info.h"
+#include "snooper/topology.h"
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    watch_stop = 1;
+}
 
 static void sleep_for_interval(int interval_ms) {
     if (interval_ms <= 0) return;
@@ -16,49 +37,184 @@ static void sleep_for_interval(int interval_ms) {
     nanosleep(&req, NULL);
 }
 
-static int handle_info(int show_identifiers) {
+static int handle_info(const CliOptions *opts) {
     SnooperSystemInfo info;
-    if (snooper_system_info_read(&info, show_identifiers) != SNOOPER_OK) {
+    if (snooper_system_info_read(&info, opts->show_identifiers) != SNOOPER_OK) {
         fprintf(stderr, "Failed to read system info.\n");
         return 1;
     }
-    cli_print_system_info(&info);
+
+    SnooperCpuTopology topology;
+    (void)snooper_topology_discover(&topology, NULL);
+
+    if (opts->format == CLI_FORMAT_TABLE) {
+        cli_print_system_info(&info);
+        cli_print_topology(&topology);
+    } else {
+        cli_print_info_json(&info, &topology);
+    }
+
+    snooper_topology_destroy(&topology);
     return 0;
 }
 
+static void seed_from_baseline(SnooperTelemetry *telemetry, const CliOptions *opts) {
+    SnooperCpuSample baseline;
+    uint64_t now = snooper_timebase_now_ns(&telemetry->timebase);
+    if (!telemetry->session.has_boot_id ||
+        snooper_baseline_load(opts->baseline_path, telemetry->session.boot_id, now, &baseline) != SNOOPER_OK) {
+        return;
+    }
+    // A baseline younger than the internal window would give a near-empty
+    // delta, so it is treated as missing.
+    uint64_t min_age_ns = (uint64_t)opts->baseline_ms * 1000000ull;
+    if (now - baseline.monotonic_ns >= min_age_ns) {
+        (void)snooper_telemetry_seed_cpu(telemetry, &baseline);
+    }
+    snooper_baseline_free(&baseline);
+}
+
+// Prints a single snapshot and exits. The first delta comes from the
+// --baseline file when it holds ticks from earlier in this boot, otherwise
+// from a warmup sample taken --baseline-ms before the reported one.
+static int run_once(const CliOptions *opts) {
+    SnooperTelemetry telemetry;
+    if (cli_telemetry_open(&telemetry, opts) != 0) {
+        return 1;
+    }
+
+    CliAlerts alerts;
+    if (cli_alerts_open(&alerts, opts) != 0) {
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
+
+    if (opts->baseline_path) {
+        seed_from_baseline(&telemetry, opts);
+    }
+
+    const SnooperSnapshot *snapshot = NULL;
+    SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
+    for (int attempt = 0; rc == SNOOPER_ERR_WARMUP && attempt < 3; ++attempt) {
+        sleep_for_interval(opts->baseline_ms);
+        rc = snooper_snapshot_collect(&telemetry, &snapshot);
+    }
+
+    int status = 0;
+    if (rc != SNOOPER_OK) {
+        fprintf(stderr, "Failed to collect snapshot (%d).\n", rc);
+        status = 1;
+    } else {
+        if (opts->format == CLI_FORMAT_TABLE) {
+            cli_print_session(&telemetry.session);
+            cli_print_table(snapshot);
+        } else {
+            cli_print_session_json(&telemetry.session, &telemetry.topology);
+            cli_print_json(snapshot, opts->format);
+        }
+        cli_alerts_evaluate(&alerts, snapshot);
+
+        const SnooperCpuSample *ticks = cpu_probe_baseline(&telemetry.cpu_probe);
+        if (opts->baseline_path && ticks && telemetry.session.has_boot_id && snooper_baseline_save(opts->baseline_path, telemetry.session.boot_id, ticks) != SNOOPER_OK) {
+            fprintf(stderr, "Failed to write baseline %s.\n", opts->baseline_path);
+        }
+    }
+
+    cli_alerts_close(&alerts);
+    snooper_telemetry_destroy(&telemetry);
+    return status;
+}
+
 static int run_watch(const CliOptions *opts) {
     SnooperTelemetry telemetry;
-    if (snooper_telemetry_init(&telemetry, opts->show_identifiers) != SNOOPER_OK) {
-        fprintf(stderr, "Failed to initialize telemetry.\n");
+    if (cli_telemetry_open(&telemetry, opts) != 0) {
         return 1;
     }
 
-    int printed_header = 0;
+    CliAlerts alerts;
+    if (cli_alerts_open(&alerts, opts) != 0) {
+        snooper_telemetry_destroy(&telemetry);
+        return 1;
+    }
 
-    for (;;) {
-        SnooperSnapshot snapshot;
+    CliHistory history;
+    memset(&history, 0, sizeof(history));
+    if (opts->history_path) {
+        if (cli_history_open(&history, opts->history_path, &telemetry.session) != 0) {
+            cli_alerts_close(&alerts);
+            snooper_telemetry_destroy(&telemetry);
+            return 1;
+        }
+        signal(SIGINT, handle_stop_signal);
+        signal(SIGTERM, handle_stop_signal);
+    }
+
+    // The session goes into the Arrow schema metadata instead of a header
+    // line, and the last partial batch is written on SIGINT/SIGTERM.
+    CliArrowWriter arrow;
+    memset(&arrow, 0, sizeof(arrow));
+    if (opts->format == CLI_FORMAT_ARROW) {
+        if (isatty(STDOUT_FILENO)) {
+            fprintf(stderr, "Refusing to write Arrow IPC to a terminal; redirect stdout.\n");
+            cli_history_close(&history);
+            cli_alerts_close(&alerts);
+            snooper_telemetry_destroy(&telemetry);
+            return 1;
+        }
+        if (cli_arrow_open(&arrow, &telemetry.session, (size_t)opts->batch_rows, stdout) != 0) {
+            cli_history_close(&history);
+            cli_alerts_close(&alerts);
+            snooper_telemetry_destroy(&telemetry);
+            return 1;
+        }
+        signal(SIGINT, handle_stop_signal);
+        signal(SIGTERM, handle_stop_signal);
+    }
+
+    if (opts->format == CLI_FORMAT_TABLE) {
+        cli_print_session(&telemetry.session);
+    } else if (opts->format != CLI_FORMAT_ARROW) {
+        cli_print_session_json(&telemetry.session, &telemetry.topology);
+    }
+
+    int status = 0;
+    while (!watch_stop) {
+        const SnooperSnapshot *snapshot = NULL;
         SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
         if (rc == SNOOPER_ERR_WARMUP) {
             sleep_for_interval(opts->interval_ms);
             continue;
         } else if (rc != SNOOPER_OK) {
             fprintf(stderr, "Failed to collect snapshot (%d).\n", rc);
-            snooper_telemetry_destroy(&telemetry);
-            return 1;
+            status = 1;
+            break;
         }
 
         if (opts->format == CLI_FORMAT_TABLE) {
-            cli_print_table(&snapshot, !printed_header);
-            printed_header = 1;
+            cli_print_table(snapshot);
+        } else if (opts->format == CLI_FORMAT_ARROW) {
+            if (cli_arrow_append(&arrow, snapshot) != 0) {
+                fprintf(stderr, "Failed to write Arrow batch.\n");
+                status = 1;
+                break;
+            }
         } else {
-            cli_print_json(&snapshot, opts->format);
+            cli_print_json(snapshot, opts->format);
         }
+        cli_alerts_evaluate(&alerts, snapshot);
+        cli_history_append(&history, snapshot);
 
         sleep_for_interval(opts->interval_ms);
     }
 
+    if (opts->format == CLI_FORMAT_ARROW && cli_arrow_close(&arrow) != 0 && status == 0) {
+        fprintf(stderr, "Failed to finish Arrow stream.\n");
+        status = 1;
+    }
+    cli_history_close(&history);
+    cli_alerts_close(&alerts);
     snooper_telemetry_destroy(&telemetry);
-    return 0;
+    return status;
 }
 
 int main(int argc, char **argv) {
@@ -69,7 +225,35 @@ int main(int argc, char **argv) {
     }
 
     if (opts.command == CLI_CMD_INFO) {
-        return handle_info(opts.show_identifiers);
+        return handle_info(&opts);
+    }
+
+    if (opts.command == CLI_CMD_SERVE) {
+        return cli_run_serve(&opts);
+    }
+
+    if (opts.command == CLI_CMD_EXPORT) {
+        return cli_run_export(&opts);
+    }
+
+    if (opts.command == CLI_CMD_RECORD) {
+        return cli_run_record(&opts);
+    }
+
+    if (opts.command == CLI_CMD_QUERY) {
+        return cli_run_query(&opts);
+    }
+
+    if (opts.command == CLI_CMD_MERGE) {
+        return cli_run_merge(&opts);
+    }
+
+    if (opts.command == CLI_CMD_TUI) {
+        return cli_run_tui(&opts);
+    }
+
+    if (opts.once) {
+        return run_once(&opts);
     }
 
     return run_watch(&opts);
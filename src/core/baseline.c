@@ -0,0 +1,84 @@
+#include "snooper/baseline.h"
+#include "snooper/session.h"
+#include "procfs.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BASELINE_ENDIAN_MARKER 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_marker;
+    uint32_t core_count;
+    uint32_t reserved;
+    uint64_t monotonic_ns;
+    char boot_id[SNOOPER_BOOT_ID_MAX];
+} BaselineHeader;
+
+SnooperStatus snooper_baseline_save(const char *path, const char *boot_id, const SnooperCpuSample *sample) {
+    if (!path || !boot_id || boot_id[0] == '\0' || !sample || !sample->cores || sample->core_count == 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    BaselineHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNOOPER_BASELINE_MAGIC, 8);
+    header.version = SNOOPER_BASELINE_VERSION;
+    header.endian_marker = BASELINE_ENDIAN_MARKER;
+    header.core_count = (uint32_t)sample->core_count;
+    header.monotonic_ns = sample->monotonic_ns;
+    strncpy(header.boot_id, boot_id, sizeof(header.boot_id) - 1);
+
+    struct iovec parts[2] = {
+        { &header, sizeof(header) },
+        { sample->cores, sample->core_count * sizeof(SnooperCpuTicks) },
+    };
+    return snooper_write_file_atomic(path, parts, 2);
+}
+
+SnooperStatus snooper_baseline_load(const char *path, const char *boot_id, uint64_t now_ns, SnooperCpuSample *out) {
+    if (!path || !boot_id || boot_id[0] == '\0' || !out) {
+        return SNOOPER_ERR_INVALID;
+    }
+    memset(out, 0, sizeof(*out));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    BaselineHeader header;
+    SnooperStatus status = SNOOPER_ERR_INVALID;
+    if (read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)
+        && memcmp(header.magic, SNOOPER_BASELINE_MAGIC, 8) == 0
+        && header.version == SNOOPER_BASELINE_VERSION
+        && header.endian_marker == BASELINE_ENDIAN_MARKER
+        && header.core_count > 0
+        && header.core_count <= SNOOPER_MAX_CPUS
+        && header.monotonic_ns <= now_ns
+        && strncmp(header.boot_id, boot_id, sizeof(header.boot_id)) == 0) {
+        size_t size = header.core_count * sizeof(SnooperCpuTicks);
+        out->cores = malloc(size);
+        if (!out->cores) {
+            status = SNOOPER_ERR_NOMEM;
+        } else if (read(fd, out->cores, size) == (ssize_t)size) {
+            out->core_count = header.core_count;
+            out->monotonic_ns = header.monotonic_ns;
+            status = SNOOPER_OK;
+        } else {
+            snooper_baseline_free(out);
+        }
+    }
+    close(fd);
+    return status;
+}
+
+void snooper_baseline_free(SnooperCpuSample *sample) {
+    if (!sample) return;
+    free(sample->cores);
+    sample->cores = NULL;
+    sample->core_count = 0;
+}
@@ -1,21 +1,17 @@
 #include "snooper/cpu.h"
-#include "timeutil.h"
 #include <mach/mach.h>
 #include <mach/mach_host.h>
 #include <mach/processor_info.h>
 #include <stdlib.h>
 #include <string.h>
 
-static SnooperStatus cpu_sample_collect(SnooperCpuSample *sample) {
+static SnooperStatus cpu_sample_collect(SnooperCpuSample *sample, uint64_t monotonic_ns) {
     if (!sample) {
         return SNOOPER_ERR_INVALID;
     }
 
     memset(sample, 0, sizeof(*sample));
-
-    if (snooper_capture_timestamps(&sample->monotonic_ns, &sample->wall_time) != SNOOPER_OK) {
-        return SNOOPER_ERR_UNAVAILABLE;
-    }
+    sample->monotonic_ns = monotonic_ns;
 
     natural_t cpu_count = 0;
     processor_info_array_t cpu_info = NULL;
@@ -107,7 +103,6 @@ static SnooperStatus cpu_usage_from_delta(const SnooperCpuSample *previous, cons
 
     report->core_count = cores;
     report->monotonic_ns = current->monotonic_ns;
-    report->wall_time = current->wall_time;
 
     return SNOOPER_OK;
 }
@@ -135,18 +130,22 @@ void cpu_usage_report_destroy(SnooperCpuUsageReport *report) {
     report->core_count = 0;
 }
 
-SnooperStatus cpu_probe_sample(CpuProbe *probe, SnooperCpuUsageReport *report) {
+SnooperStatus cpu_probe_sample(CpuProbe *probe, uint64_t monotonic_ns, SnooperCpuUsageReport *report) {
     if (!probe || !report) {
         return SNOOPER_ERR_INVALID;
     }
 
     SnooperCpuSample current = {0};
-    SnooperStatus status = cpu_sample_collect(&current);
+    SnooperStatus status = cpu_sample_collect(&current, monotonic_ns);
     if (status != SNOOPER_OK) {
         return status;
     }
 
-    if (!probe->has_previous) {
+    // A seeded baseline from a different core count cannot be compared.
+    if (!probe->has_previous || probe->previous.core_count != current.core_count) {
+        if (probe->has_previous) {
+            cpu_sample_destroy(&probe->previous);
+        }
         probe->previous = current;
         probe->has_previous = 1;
         return SNOOPER_ERR_WARMUP;
@@ -158,3 +157,30 @@ SnooperStatus cpu_probe_sample(CpuProbe *probe, SnooperCpuUsageReport *report) {
 
     return status;
 }
+
+// Installs ticks captured earlier (e.g. by a previous process) as the
+// previous sample, so the next cpu_probe_sample reports a delta right away.
+SnooperStatus cpu_probe_seed(CpuProbe *probe, const SnooperCpuSample *baseline) {
+    if (!probe || !baseline || baseline->core_count == 0 || !baseline->cores) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    SnooperCpuTicks *cores = calloc(baseline->core_count, sizeof(SnooperCpuTicks));
+    if (!cores) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    memcpy(cores, baseline->cores, baseline->core_count * sizeof(SnooperCpuTicks));
+
+    if (probe->has_previous) {
+        cpu_sample_destroy(&probe->previous);
+    }
+    probe->previous.cores = cores;
+    probe->previous.core_count = baseline->core_count;
+    probe->previous.monotonic_ns = baseline->monotonic_ns;
+    probe->has_previous = 1;
+    return SNOOPER_OK;
+}
+
+const SnooperCpuSample *cpu_probe_baseline(const CpuProbe *probe) {
+    return probe && probe->has_previous ? &probe->previous : NULL;
+}
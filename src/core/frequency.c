@@ -0,0 +1,252 @@
+#include "snooper/frequency.h"
+#include "procfs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MSR_IA32_MPERF 0xE7
+#define MSR_IA32_APERF 0xE8
+#define FREQ_VALUE_SIZE 32
+
+static uint64_t counter_delta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+static int freq_open(const char *root, const char *fmt, size_t index) {
+    char path[256];
+    if (snooper_path_format(path, sizeof(path), NULL, fmt, index) != 0) {
+        return -1;
+    }
+    return snooper_open_readonly(root, path);
+}
+
+static uint64_t freq_read_once(const char *root, const char *fmt, size_t index) {
+    char path[256];
+    uint64_t value = 0;
+    if (snooper_path_format(path, sizeof(path), NULL, fmt, index) != 0) {
+        return 0;
+    }
+    if (snooper_read_file_u64(root, path, &value) != SNOOPER_OK) {
+        return 0;
+    }
+    return value;
+}
+
+static int freq_view_u64(const FreqProbe *probe, int slot, uint64_t *value) {
+    size_t length = 0;
+    const char *view = snooper_read_engine_view(&probe->reads, slot, &length);
+    if (!view) {
+        return -1;
+    }
+    return snooper_parse_u64(view, view + length, value) ? 0 : -1;
+}
+
+// Thermal zones report signed millidegrees; sensors below freezing are
+// negative.
+static int freq_view_millidegrees(const FreqProbe *probe, int slot, int64_t *value) {
+    size_t length = 0;
+    const char *view = snooper_read_engine_view(&probe->reads, slot, &length);
+    if (!view) {
+        return -1;
+    }
+    const char *end = view + length;
+    while (view < end && (*view == ' ' || *view == '\t')) view++;
+    int negative = view < end && *view == '-';
+    uint64_t magnitude = 0;
+    if (!snooper_parse_u64(view + negative, end, &magnitude) || magnitude > INT64_MAX) {
+        return -1;
+    }
+    *value = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+    return 0;
+}
+
+static int freq_read_msr(int fd, off_t reg, uint64_t *value) {
+    return pread(fd, value, sizeof(*value), reg) == (ssize_t)sizeof(*value) ? 0 : -1;
+}
+
+static void close_fd(int *fd) {
+    if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+static void freq_open_zones(FreqProbe *probe) {
+    for (size_t zone = 0; zone < SNOOPER_MAX_THERMAL_ZONES; ++zone) {
+        int fd = freq_open(probe->root, "/sys/class/thermal/thermal_zone%zu/temp", zone);
+        if (fd < 0) {
+            continue;
+        }
+
+        SnooperThermalZoneState *state = &probe->zones[probe->zone_count++];
+        state->temp_fd = fd;
+        state->temp_slot = snooper_read_engine_add(&probe->reads, fd, FREQ_VALUE_SIZE);
+
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%zu/type", zone);
+        size_t length = 0;
+        if (snooper_read_file(probe->root, path, state->type, sizeof(state->type), &length) == SNOOPER_OK) {
+            while (length > 0 && (state->type[length - 1] == '\n' || state->type[length - 1] == ' ')) {
+                state->type[--length] = '\0';
+            }
+        } else {
+            snprintf(state->type, sizeof(state->type), "zone%zu", zone);
+        }
+    }
+}
+
+SnooperStatus freq_probe_init(FreqProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+
+    // Every per-core cpufreq and throttle file plus each thermal zone is
+    // re-read as one batch per sample.
+    (void)snooper_read_engine_init(&probe->reads, 1);
+
+    probe->cpus = calloc(SNOOPER_MAX_CPUS, sizeof(SnooperFreqCpuState));
+    if (!probe->cpus) {
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    for (size_t cpu = 0; cpu < SNOOPER_MAX_CPUS; ++cpu) {
+        SnooperFreqCpuState *state = &probe->cpus[cpu];
+        state->cur_fd = freq_open(probe->root, "/sys/devices/system/cpu/cpu%zu/cpufreq/scaling_cur_freq", cpu);
+        if (state->cur_fd < 0) {
+            // Offline CPUs and gaps in the id space keep an empty slot so
+            // later CPUs still line up with their ids.
+            state->msr_fd = -1;
+            state->core_throttle_fd = -1;
+            state->package_throttle_fd = -1;
+            state->cur_slot = -1;
+            state->core_throttle_slot = -1;
+            state->package_throttle_slot = -1;
+            continue;
+        }
+        state->msr_fd = freq_open(probe->root, "/dev/cpu/%zu/msr", cpu);
+        state->core_throttle_fd = freq_open(probe->root, "/sys/devices/system/cpu/cpu%zu/thermal_throttle/core_throttle_count", cpu);
+        state->package_throttle_fd = freq_open(probe->root, "/sys/devices/system/cpu/cpu%zu/thermal_throttle/package_throttle_count", cpu);
+        state->cur_slot = snooper_read_engine_add(&probe->reads, state->cur_fd, FREQ_VALUE_SIZE);
+        state->core_throttle_slot = snooper_read_engine_add(&probe->reads, state->core_throttle_fd, FREQ_VALUE_SIZE);
+        state->package_throttle_slot = snooper_read_engine_add(&probe->reads, state->package_throttle_fd, FREQ_VALUE_SIZE);
+        state->max_khz = freq_read_once(probe->root, "/sys/devices/system/cpu/cpu%zu/cpufreq/cpuinfo_max_freq", cpu);
+        state->base_khz = freq_read_once(probe->root, "/sys/devices/system/cpu/cpu%zu/cpufreq/base_frequency", cpu);
+        if (state->base_khz == 0) {
+            state->base_khz = state->max_khz;
+        }
+        probe->cpu_count = cpu + 1;
+    }
+
+    for (size_t zone = 0; zone < SNOOPER_MAX_THERMAL_ZONES; ++zone) {
+        probe->zones[zone].temp_fd = -1;
+    }
+    freq_open_zones(probe);
+
+    probe->initialized = 1;
+    return SNOOPER_OK;
+}
+
+void freq_probe_destroy(FreqProbe *probe) {
+    if (!probe) return;
+    if (probe->cpus) {
+        for (size_t cpu = 0; cpu < probe->cpu_count; ++cpu) {
+            close_fd(&probe->cpus[cpu].cur_fd);
+            close_fd(&probe->cpus[cpu].msr_fd);
+            close_fd(&probe->cpus[cpu].core_throttle_fd);
+            close_fd(&probe->cpus[cpu].package_throttle_fd);
+        }
+    }
+    for (size_t zone = 0; zone < probe->zone_count; ++zone) {
+        close_fd(&probe->zones[zone].temp_fd);
+    }
+    snooper_read_engine_destroy(&probe->reads);
+    free(probe->cpus);
+    probe->cpus = NULL;
+    probe->cpu_count = 0;
+    probe->zone_count = 0;
+    probe->initialized = 0;
+}
+
+SnooperStatus freq_probe_sample(FreqProbe *probe,
+                                uint64_t monotonic_ns,
+                                const double *used_percent,
+                                size_t core_count,
+                                SnooperFreqStats *stats) {
+    if (!probe || !stats || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+    if (probe->cpu_count == 0 && probe->zone_count == 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->monotonic_ns = monotonic_ns;
+    (void)snooper_read_engine_submit(&probe->reads);
+
+    for (size_t cpu = 0; cpu < probe->cpu_count; ++cpu) {
+        SnooperFreqCpuState *state = &probe->cpus[cpu];
+        SnooperFreqCore *core = &stats->cores[cpu];
+        uint64_t cur_khz = 0;
+        if (freq_view_u64(probe, state->cur_slot, &cur_khz) != 0) {
+            continue;
+        }
+
+        core->present = 1;
+        core->current_mhz = (double)cur_khz / 1000.0;
+        core->max_mhz = (double)state->max_khz / 1000.0;
+
+        uint64_t aperf = 0;
+        uint64_t mperf = 0;
+        if (state->msr_fd >= 0 &&
+            freq_read_msr(state->msr_fd, MSR_IA32_APERF, &aperf) == 0 &&
+            freq_read_msr(state->msr_fd, MSR_IA32_MPERF, &mperf) == 0) {
+            uint64_t aperf_delta = counter_delta(aperf, state->previous_aperf);
+            uint64_t mperf_delta = counter_delta(mperf, state->previous_mperf);
+            if (state->has_previous && mperf_delta > 0) {
+                core->effective_mhz = (double)state->base_khz / 1000.0 * (double)aperf_delta / (double)mperf_delta;
+                stats->has_msr = 1;
+            }
+            state->previous_aperf = aperf;
+            state->previous_mperf = mperf;
+        }
+
+        uint64_t throttles = 0;
+        if (freq_view_u64(probe, state->core_throttle_slot, &throttles) == 0) {
+            if (state->has_previous) {
+                core->core_throttles = counter_delta(throttles, state->previous_core_throttles);
+            }
+            state->previous_core_throttles = throttles;
+        }
+        if (freq_view_u64(probe, state->package_throttle_slot, &throttles) == 0) {
+            if (state->has_previous) {
+                core->package_throttles = counter_delta(throttles, state->previous_package_throttles);
+            }
+            state->previous_package_throttles = throttles;
+        }
+        state->has_previous = 1;
+
+        if (used_percent && cpu < core_count) {
+            double used = used_percent[cpu];
+            double running_mhz = core->effective_mhz > 0.0 ? core->effective_mhz : core->current_mhz;
+            core->used_percent = used;
+            core->normalized_used_percent = core->max_mhz > 0.0 ? used * running_mhz / core->max_mhz : used;
+        }
+        stats->core_count = cpu + 1;
+    }
+
+    for (size_t zone = 0; zone < probe->zone_count; ++zone) {
+        int64_t millidegrees = 0;
+        if (freq_view_millidegrees(probe, probe->zones[zone].temp_slot, &millidegrees) != 0) {
+            continue;
+        }
+        SnooperThermalZone *out = &stats->zones[stats->zone_count++];
+        memcpy(out->type, probe->zones[zone].type, sizeof(out->type));
+        out->celsius = (double)millidegrees / 1000.0;
+    }
+
+    return SNOOPER_OK;
+}
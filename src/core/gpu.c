@@ -1,5 +1,4 @@
 #include "snooper/gpu.h"
-#include "timeutil.h"
 #include <CoreFoundation/CoreFoundation.h>
 #include <IOKit/IOKitLib.h>
 #include <string.h>
@@ -57,16 +56,13 @@ void gpu_probe_destroy(GpuProbe *probe) {
     probe->initialized = 0;
 }
 
-SnooperStatus gpu_probe_sample(GpuProbe *probe, SnooperGpuSample *sample) {
+SnooperStatus gpu_probe_sample(GpuProbe *probe, uint64_t monotonic_ns, SnooperGpuSample *sample) {
     if (!probe || !sample || !probe->initialized) {
         return SNOOPER_ERR_INVALID;
     }
 
     memset(sample, 0, sizeof(*sample));
-
-    if (snooper_capture_timestamps(&sample->monotonic_ns, &sample->wall_time) != SNOOPER_OK) {
-        return SNOOPER_ERR_UNAVAILABLE;
-    }
+    sample->monotonic_ns = monotonic_ns;
 
     io_service_t service = IOServiceGetMatchingService(kIOMainPortDefault, IOServiceMatching("IOAccelerator"));
     if (!service) {
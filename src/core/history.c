@@ -0,0 +1,547 @@
+#include "snooper/history.h"
+#include "procfs.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HISTORY_ENDIAN_MARKER 0x01020304u
+#define HISTORY_PAGE_SIZE 4096
+#define HISTORY_PATH_MAX 1024
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_marker;
+    uint64_t resolution_ns;
+    int64_t wall_offset_ns;
+    uint64_t session_id;
+} HistoryHeader;
+
+typedef struct {
+    char name[SNOOPER_TS_NAME_MAX];
+    SnooperHistorySummary summary;
+} HistoryIndexEntry;
+
+typedef struct {
+    const HistoryIndexEntry *entry;
+    size_t position;
+} HistoryIndexRef;
+
+_Static_assert(sizeof(SnooperHistorySummary) == SNOOPER_TS_BLOCK_HEADER_SIZE, "summary must mirror the block header");
+_Static_assert(sizeof(SnooperTsBlock) == SNOOPER_TS_BLOCK_SIZE, "blocks are stored verbatim");
+_Static_assert(sizeof(HistoryIndexEntry) == SNOOPER_TS_NAME_MAX + SNOOPER_TS_BLOCK_HEADER_SIZE, "index entries are packed");
+
+static int index_path(char *out, size_t size, const char *path) {
+    int length = snprintf(out, size, "%s%s", path, SNOOPER_HISTORY_INDEX_SUFFIX);
+    return length < 0 || (size_t)length >= size ? -1 : 0;
+}
+
+static SnooperStatus write_all(int fd, const void *data, size_t length) {
+    const char *cursor = data;
+    while (length > 0) {
+        ssize_t n = write(fd, cursor, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return SNOOPER_ERR_UNAVAILABLE;
+        }
+        cursor += n;
+        length -= (size_t)n;
+    }
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_history_writer_open(SnooperHistoryWriter *writer, const char *path, uint64_t resolution_ns, uint64_t session_id, int64_t wall_offset_ns) {
+    if (!writer || !path || resolution_ns == 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+    memset(writer, 0, sizeof(*writer));
+    writer->data_fd = -1;
+    writer->index_fd = -1;
+
+    char index[HISTORY_PATH_MAX];
+    if (index_path(index, sizeof(index), path) != 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    // Timestamps are monotonic within one boot, so every recording starts a
+    // fresh history rather than appending to an older one.
+    writer->data_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    writer->index_fd = open(index, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (writer->data_fd < 0 || writer->index_fd < 0) {
+        (void)snooper_history_writer_close(writer);
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    HistoryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNOOPER_HISTORY_MAGIC, 8);
+    header.version = SNOOPER_HISTORY_VERSION;
+    header.endian_marker = HISTORY_ENDIAN_MARKER;
+    header.resolution_ns = resolution_ns;
+    header.wall_offset_ns = wall_offset_ns;
+    header.session_id = session_id;
+
+    uint8_t page[HISTORY_PAGE_SIZE];
+    memset(page, 0, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+    if (write_all(writer->data_fd, page, sizeof(page)) != SNOOPER_OK) {
+        (void)snooper_history_writer_close(writer);
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    return SNOOPER_OK;
+}
+
+static void stage_block(const SnooperTsStore *store, const SnooperTsSeries *series, int32_t block, SnooperTsBlock *data, HistoryIndexEntry *entry) {
+    memcpy(data, &store->blocks[block], sizeof(*data));
+    memcpy(entry->name, series->name, sizeof(entry->name));
+    memcpy(&entry->summary, data, sizeof(entry->summary));
+}
+
+SnooperStatus snooper_history_writer_flush(SnooperHistoryWriter *writer, SnooperTsStore *store) {
+    if (!writer || !store || writer->data_fd < 0 || writer->index_fd < 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    size_t sealed = 0;
+    size_t open = 0;
+    for (size_t i = 0; i < store->series_count; ++i) {
+        if (store->series[i].block_count > 0) {
+            sealed += store->series[i].block_count - 1;
+            ++open;
+        }
+    }
+
+    // The previous flush's open blocks were a provisional tail; cut them off
+    // so the committed prefix of both files only ever holds sealed blocks.
+    off_t data_end = (off_t)(HISTORY_PAGE_SIZE + writer->committed_blocks * sizeof(SnooperTsBlock));
+    off_t index_end = (off_t)(writer->committed_blocks * sizeof(HistoryIndexEntry));
+    if (ftruncate(writer->data_fd, data_end) != 0 || ftruncate(writer->index_fd, index_end) != 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    if (sealed + open == 0) {
+        return SNOOPER_OK;
+    }
+
+    SnooperTsBlock *blocks = malloc((sealed + open) * sizeof(*blocks));
+    HistoryIndexEntry *entries = calloc(sealed + open, sizeof(*entries));
+    if (!blocks || !entries) {
+        free(blocks);
+        free(entries);
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    size_t next = 0;
+    for (size_t i = 0; i < store->series_count; ++i) {
+        const SnooperTsSeries *series = &store->series[i];
+        for (int32_t block = series->oldest; block >= 0 && block != series->newest; block = store->next[block]) {
+            stage_block(store, series, block, &blocks[next], &entries[next]);
+            ++next;
+        }
+    }
+    for (size_t i = 0; i < store->series_count; ++i) {
+        const SnooperTsSeries *series = &store->series[i];
+        if (series->newest >= 0) {
+            stage_block(store, series, series->newest, &blocks[next], &entries[next]);
+            ++next;
+        }
+    }
+
+    // Blocks land before their index entries, so a reader never indexes a
+    // block that is not on disk yet.
+    SnooperStatus status = write_all(writer->data_fd, blocks, next * sizeof(*blocks));
+    if (status == SNOOPER_OK) {
+        status = write_all(writer->index_fd, entries, next * sizeof(*entries));
+    }
+    free(blocks);
+    free(entries);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    writer->committed_blocks += sealed;
+    for (size_t i = 0; i < store->series_count; ++i) {
+        (void)snooper_tsstore_release_sealed(store, (int)i);
+    }
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_history_writer_close(SnooperHistoryWriter *writer) {
+    if (!writer) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    int failed = 0;
+    if (writer->data_fd >= 0) {
+        failed |= fsync(writer->data_fd) != 0;
+        failed |= close(writer->data_fd) != 0;
+    }
+    if (writer->index_fd >= 0) {
+        failed |= fsync(writer->index_fd) != 0;
+        failed |= close(writer->index_fd) != 0;
+    }
+    writer->data_fd = -1;
+    writer->index_fd = -1;
+    return failed ? SNOOPER_ERR_UNAVAILABLE : SNOOPER_OK;
+}
+
+static int compare_refs(const void *a, const void *b) {
+    const HistoryIndexRef *x = a;
+    const HistoryIndexRef *y = b;
+    int order = strncmp(x->entry->name, y->entry->name, SNOOPER_TS_NAME_MAX);
+    if (order != 0) {
+        return order;
+    }
+    return (x->position > y->position) - (x->position < y->position);
+}
+
+// Groups index entries by series, keeping each series' blocks in the order
+// they were appended, which is time order.
+static SnooperStatus build_index(SnooperHistory *history, const HistoryIndexEntry *entries, size_t count) {
+    size_t capacity = count ? count : 1;
+    HistoryIndexRef *refs = calloc(capacity, sizeof(*refs));
+    history->series = calloc(capacity, sizeof(*history->series));
+    history->summaries = calloc(capacity, sizeof(*history->summaries));
+    history->blocks = calloc(capacity, sizeof(*history->blocks));
+    if (!refs || !history->series || !history->summaries || !history->blocks) {
+        free(refs);
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        refs[i].entry = &entries[i];
+        refs[i].position = i;
+    }
+    qsort(refs, count, sizeof(*refs), compare_refs);
+
+    const SnooperTsBlock *blocks = (const SnooperTsBlock *)((const uint8_t *)history->map + HISTORY_PAGE_SIZE);
+    SnooperHistorySeries *series = NULL;
+    for (size_t i = 0; i < count; ++i) {
+        const HistoryIndexEntry *entry = refs[i].entry;
+        if (!series || strncmp(series->name, entry->name, SNOOPER_TS_NAME_MAX) != 0) {
+            series = &history->series[history->series_count++];
+            memcpy(series->name, entry->name, sizeof(series->name));
+            series->first_block = (uint32_t)i;
+        }
+        ++series->block_count;
+        history->summaries[i] = entry->summary;
+        history->blocks[i] = &blocks[refs[i].position];
+    }
+    history->block_count = count;
+    free(refs);
+    return SNOOPER_OK;
+}
+
+static SnooperStatus read_index(const char *path, size_t block_limit, HistoryIndexEntry **entries, size_t *count) {
+    *entries = NULL;
+    *count = 0;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    size_t length = 0;
+    char *buffer = malloc((size_t)st.st_size + 1);
+    SnooperStatus status = buffer ? snooper_read_fd(fd, buffer, (size_t)st.st_size + 1, &length) : SNOOPER_ERR_NOMEM;
+    close(fd);
+    if (status != SNOOPER_OK) {
+        free(buffer);
+        return status;
+    }
+
+    // Only whole records that have both a block and an index entry count; a
+    // writer caught mid-flush leaves a partial record at the end.
+    *count = length / sizeof(HistoryIndexEntry);
+    if (*count > block_limit) {
+        *count = block_limit;
+    }
+    *entries = (HistoryIndexEntry *)buffer;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_history_open(SnooperHistory *history, const char *path) {
+    if (!history || !path) {
+        return SNOOPER_ERR_INVALID;
+    }
+    memset(history, 0, sizeof(*history));
+
+    char index[HISTORY_PATH_MAX];
+    if (index_path(index, sizeof(index), path) != 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < HISTORY_PAGE_SIZE) {
+        close(fd);
+        return SNOOPER_ERR_INVALID;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    HistoryHeader header;
+    memcpy(&header, map, sizeof(header));
+    size_t size = (size_t)st.st_size;
+    if (memcmp(header.magic, SNOOPER_HISTORY_MAGIC, 8) != 0
+        || header.version != SNOOPER_HISTORY_VERSION
+        || header.endian_marker != HISTORY_ENDIAN_MARKER
+        || header.resolution_ns == 0) {
+        munmap(map, size);
+        return SNOOPER_ERR_INVALID;
+    }
+
+    history->map = map;
+    history->map_size = size;
+    history->resolution_ns = header.resolution_ns;
+    history->wall_offset_ns = header.wall_offset_ns;
+    history->session_id = header.session_id;
+
+    HistoryIndexEntry *entries = NULL;
+    size_t entry_count = 0;
+    SnooperStatus status = read_index(index, (size - HISTORY_PAGE_SIZE) / sizeof(SnooperTsBlock), &entries, &entry_count);
+    if (status == SNOOPER_OK) {
+        status = build_index(history, entries, entry_count);
+    }
+    free(entries);
+    if (status != SNOOPER_OK) {
+        snooper_history_close(history);
+        return status;
+    }
+
+    history->first_ns = UINT64_MAX;
+    for (size_t i = 0; i < history->series_count; ++i) {
+        const SnooperHistorySeries *series = &history->series[i];
+        const SnooperHistorySummary *first = &history->summaries[series->first_block];
+        const SnooperHistorySummary *last = &history->summaries[series->first_block + series->block_count - 1];
+        if (first->first_ns < history->first_ns) history->first_ns = first->first_ns;
+        if (last->last_ns > history->last_ns) history->last_ns = last->last_ns;
+    }
+    if (history->first_ns == UINT64_MAX) {
+        history->first_ns = 0;
+    }
+    return SNOOPER_OK;
+}
+
+void snooper_history_close(SnooperHistory *history) {
+    if (!history) return;
+    if (history->map) {
+        munmap(history->map, history->map_size);
+    }
+    free(history->series);
+    free(history->summaries);
+    free(history->blocks);
+    memset(history, 0, sizeof(*history));
+}
+
+int snooper_history_find_series(const SnooperHistory *history, const char *name) {
+    if (!history || !name) return -1;
+    for (size_t i = 0; i < history->series_count; ++i) {
+        if (strncmp(history->series[i].name, name, SNOOPER_TS_NAME_MAX) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+typedef struct {
+    const SnooperHistoryQuery *query;
+    SnooperHistoryResult *result;
+    size_t bucket;
+    int open;
+    size_t count;
+    double sum;
+    double min;
+    double max;
+    double *values;
+    size_t value_count;
+    size_t value_capacity;
+} QueryState;
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static SnooperStatus finish_bucket(QueryState *state) {
+    if (!state->open || state->count == 0) {
+        state->open = 0;
+        return SNOOPER_OK;
+    }
+
+    SnooperHistoryResult *result = state->result;
+    if (result->bucket_count == result->bucket_capacity) {
+        size_t capacity = result->bucket_capacity ? result->bucket_capacity * 2 : 64;
+        SnooperHistoryBucket *grown = realloc(result->buckets, capacity * sizeof(*grown));
+        if (!grown) {
+            return SNOOPER_ERR_NOMEM;
+        }
+        result->buckets = grown;
+        result->bucket_capacity = capacity;
+    }
+
+    const SnooperHistoryQuery *query = state->query;
+    SnooperHistoryBucket *bucket = &result->buckets[result->bucket_count++];
+    bucket->start_ns = query->bucket_ns ? query->from_ns + state->bucket * query->bucket_ns : query->from_ns;
+    bucket->count = state->count;
+    switch (query->aggregation) {
+        case SNOOPER_AGG_AVG: bucket->value = state->sum / (double)state->count; break;
+        case SNOOPER_AGG_MIN: bucket->value = state->min; break;
+        case SNOOPER_AGG_MAX: bucket->value = state->max; break;
+        case SNOOPER_AGG_SUM: bucket->value = state->sum; break;
+        case SNOOPER_AGG_COUNT: bucket->value = (double)state->count; break;
+        case SNOOPER_AGG_PERCENTILE: {
+            qsort(state->values, state->value_count, sizeof(double), compare_doubles);
+            double rank = ceil(query->percentile / 100.0 * (double)state->value_count);
+            size_t index = rank < 1.0 ? 0 : (size_t)rank - 1;
+            if (index >= state->value_count) index = state->value_count - 1;
+            bucket->value = state->values[index];
+            break;
+        }
+    }
+
+    state->open = 0;
+    return SNOOPER_OK;
+}
+
+static SnooperStatus enter_bucket(QueryState *state, size_t bucket) {
+    if (state->open && state->bucket == bucket) {
+        return SNOOPER_OK;
+    }
+    SnooperStatus status = finish_bucket(state);
+    state->open = 1;
+    state->bucket = bucket;
+    state->count = 0;
+    state->sum = 0.0;
+    state->min = DBL_MAX;
+    state->max = -DBL_MAX;
+    state->value_count = 0;
+    return status;
+}
+
+static size_t bucket_for(const SnooperHistoryQuery *query, uint64_t timestamp_ns) {
+    return query->bucket_ns ? (size_t)((timestamp_ns - query->from_ns) / query->bucket_ns) : 0;
+}
+
+static SnooperStatus add_point(QueryState *state, uint64_t timestamp_ns, double value) {
+    SnooperStatus status = enter_bucket(state, bucket_for(state->query, timestamp_ns));
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    if (state->query->aggregation == SNOOPER_AGG_PERCENTILE) {
+        if (state->value_count == state->value_capacity) {
+            size_t capacity = state->value_capacity ? state->value_capacity * 2 : 1024;
+            double *grown = realloc(state->values, capacity * sizeof(*grown));
+            if (!grown) {
+                return SNOOPER_ERR_NOMEM;
+            }
+            state->values = grown;
+            state->value_capacity = capacity;
+        }
+        state->values[state->value_count++] = value;
+    }
+
+    ++state->count;
+    state->sum += value;
+    if (value < state->min) state->min = value;
+    if (value > state->max) state->max = value;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_history_query(const SnooperHistory *history, const SnooperHistoryQuery *query, SnooperHistoryResult *out) {
+    if (!history || !query || !out || query->series < 0 || (size_t)query->series >= history->series_count || query->from_ns > query->to_ns) {
+        return SNOOPER_ERR_INVALID;
+    }
+    if (query->aggregation == SNOOPER_AGG_PERCENTILE && (query->percentile < 0.0 || query->percentile > 100.0)) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(out, 0, sizeof(*out));
+    const SnooperHistorySeries *series = &history->series[query->series];
+    const SnooperHistorySummary *summaries = history->summaries + series->first_block;
+
+    size_t low = 0;
+    size_t high = series->block_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (summaries[middle].last_ns < query->from_ns) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    QueryState state;
+    memset(&state, 0, sizeof(state));
+    state.query = query;
+    state.result = out;
+
+    SnooperStatus status = SNOOPER_OK;
+    for (size_t i = low; i < series->block_count && status == SNOOPER_OK; ++i) {
+        const SnooperHistorySummary *summary = &summaries[i];
+        if (summary->first_ns > query->to_ns) {
+            break;
+        }
+        if (summary->count == 0) {
+            continue;
+        }
+
+        int inside = summary->first_ns >= query->from_ns && summary->last_ns <= query->to_ns;
+        if (inside && query->aggregation != SNOOPER_AGG_PERCENTILE
+            && bucket_for(query, summary->first_ns) == bucket_for(query, summary->last_ns)) {
+            status = enter_bucket(&state, bucket_for(query, summary->first_ns));
+            state.count += summary->count;
+            state.sum += summary->sum;
+            if (summary->min < state.min) state.min = summary->min;
+            if (summary->max > state.max) state.max = summary->max;
+            ++out->blocks_summarized;
+            continue;
+        }
+
+        SnooperTsBlockReader reader;
+        snooper_ts_block_reader_init(&reader, history->blocks[series->first_block + i], history->resolution_ns);
+        uint64_t timestamp;
+        double value;
+        while (status == SNOOPER_OK && snooper_ts_block_reader_next(&reader, &timestamp, &value)) {
+            if (timestamp < query->from_ns) continue;
+            if (timestamp > query->to_ns) break;
+            status = add_point(&state, timestamp, value);
+        }
+        ++out->blocks_decoded;
+    }
+
+    if (status == SNOOPER_OK) {
+        status = finish_bucket(&state);
+    }
+    free(state.values);
+    if (status != SNOOPER_OK) {
+        snooper_history_result_destroy(out);
+    }
+    return status;
+}
+
+void snooper_history_result_destroy(SnooperHistoryResult *result) {
+    if (!result) return;
+    free(result->buckets);
+    memset(result, 0, sizeof(*result));
+}
@@ -0,0 +1,399 @@
+#include "snooper/irq.h"
+#include "procfs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define IRQ_TEXT_INITIAL_SIZE (256 * 1024)
+#define IRQ_ROW_SLACK 16
+
+static uint64_t hash_bytes(const char *cursor, const char *end) {
+    uint64_t hash = 1469598103934665603ULL;
+    while (cursor < end) {
+        hash ^= (unsigned char)*cursor++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static const char *line_end_of(const char *cursor, const char *end) {
+    const char *newline = memchr(cursor, '\n', (size_t)(end - cursor));
+    return newline ? newline : end;
+}
+
+static void irq_table_release_layout(SnooperIrqTable *table) {
+    free(table->block);
+    table->block = NULL;
+    table->column_cpu = NULL;
+    table->row_names = NULL;
+    table->row_hash = NULL;
+    table->row_active = NULL;
+    table->counts = NULL;
+    table->values = NULL;
+    table->rates = NULL;
+    table->column_count = 0;
+    table->row_count = 0;
+    table->row_capacity = 0;
+    table->header_hash = 0;
+    table->has_previous = 0;
+}
+
+static SnooperStatus irq_table_read(SnooperIrqTable *table, size_t *length) {
+    for (;;) {
+        if (snooper_read_fd(table->fd, table->text, table->text_size, length) != SNOOPER_OK) {
+            return SNOOPER_ERR_UNAVAILABLE;
+        }
+        if (*length + 1 < table->text_size) {
+            return SNOOPER_OK;
+        }
+
+        char *grown = realloc(table->text, table->text_size * 2);
+        if (!grown) {
+            return SNOOPER_ERR_NOMEM;
+        }
+        table->text = grown;
+        table->text_size *= 2;
+    }
+}
+
+static size_t irq_parse_header(const char *cursor, const char *end, int *column_cpu) {
+    size_t columns = 0;
+    while (cursor < end) {
+        while (cursor < end && *cursor == ' ') cursor++;
+        if ((size_t)(end - cursor) > 3 && memcmp(cursor, "CPU", 3) == 0) {
+            uint64_t cpu = 0;
+            const char *next = snooper_parse_u64(cursor + 3, end, &cpu);
+            if (next) {
+                if (column_cpu) column_cpu[columns] = (int)cpu;
+                columns++;
+                cursor = next;
+                continue;
+            }
+        }
+        while (cursor < end && *cursor != ' ') cursor++;
+    }
+    return columns;
+}
+
+static SnooperStatus irq_table_build_layout(SnooperIrqTable *table, const char *header, const char *header_end, const char *body, const char *end) {
+    irq_table_release_layout(table);
+
+    size_t columns = irq_parse_header(header, header_end, NULL);
+    if (columns == 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    size_t rows = IRQ_ROW_SLACK;
+    for (const char *cursor = body; cursor < end; cursor = line_end_of(cursor, end) + 1) {
+        rows++;
+    }
+
+    size_t cells = rows * columns;
+    size_t counts_bytes = cells * sizeof(uint64_t);
+    size_t rates_bytes = cells * sizeof(double);
+    size_t hash_bytes_total = rows * sizeof(uint64_t);
+    size_t values_bytes = columns * sizeof(uint64_t);
+    size_t column_bytes = columns * sizeof(int);
+    size_t name_bytes = rows * SNOOPER_IRQ_NAME_MAX;
+
+    char *block = calloc(1, counts_bytes + rates_bytes + hash_bytes_total + values_bytes + column_bytes + name_bytes + rows);
+    if (!block) {
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    char *cursor = block;
+    table->block = block;
+    table->counts = (uint64_t *)cursor;
+    cursor += counts_bytes;
+    table->rates = (double *)cursor;
+    cursor += rates_bytes;
+    table->row_hash = (uint64_t *)cursor;
+    cursor += hash_bytes_total;
+    table->values = (uint64_t *)cursor;
+    cursor += values_bytes;
+    table->column_cpu = (int *)cursor;
+    cursor += column_bytes;
+    table->row_names = (char (*)[SNOOPER_IRQ_NAME_MAX])cursor;
+    cursor += name_bytes;
+    table->row_active = (unsigned char *)cursor;
+    table->column_count = columns;
+    table->row_capacity = rows;
+    table->header_hash = hash_bytes(header, header_end);
+    irq_parse_header(header, header_end, table->column_cpu);
+    return SNOOPER_OK;
+}
+
+static void irq_row_name(const char *label, size_t label_len, const char *line_end, char *out) {
+    size_t len = label_len < SNOOPER_IRQ_NAME_MAX - 1 ? label_len : SNOOPER_IRQ_NAME_MAX - 1;
+    memcpy(out, label, len);
+    out[len] = '\0';
+
+    if (label_len == 0 || label[0] < '0' || label[0] > '9') {
+        return;
+    }
+
+    const char *tail = line_end;
+    while (tail > label && (tail[-1] == ' ' || tail[-1] == '\r')) tail--;
+    const char *device = tail;
+    while (device > label && device[-1] != ' ') device--;
+
+    if (device < tail && device > label + label_len && len + 1 < SNOOPER_IRQ_NAME_MAX - 1) {
+        size_t room = SNOOPER_IRQ_NAME_MAX - 1 - len - 1;
+        size_t device_len = (size_t)(tail - device) < room ? (size_t)(tail - device) : room;
+        out[len] = ' ';
+        memcpy(out + len + 1, device, device_len);
+        out[len + 1 + device_len] = '\0';
+    }
+}
+
+static int irq_label_matches(const char *name, const char *label, size_t label_len) {
+    return strncmp(name, label, label_len) == 0 && (name[label_len] == '\0' || name[label_len] == ' ');
+}
+
+static void irq_insert_top(SnooperIrqCore *core, const char *name, double per_sec) {
+    size_t position = core->top_count;
+    while (position > 0 && core->top[position - 1].per_sec < per_sec) {
+        position--;
+    }
+    if (position >= SNOOPER_IRQ_TOP_SOURCES) {
+        return;
+    }
+
+    size_t last = core->top_count < SNOOPER_IRQ_TOP_SOURCES ? core->top_count : SNOOPER_IRQ_TOP_SOURCES - 1;
+    memmove(&core->top[position + 1], &core->top[position], (last - position) * sizeof(SnooperIrqSource));
+    snprintf(core->top[position].name, sizeof(core->top[position].name), "%s", name);
+    core->top[position].per_sec = per_sec;
+    if (core->top_count < SNOOPER_IRQ_TOP_SOURCES) {
+        core->top_count++;
+    }
+}
+
+// Drops what one table added to stats, leaving the other table's share.
+static void irq_clear_stats(SnooperIrqStats *stats, int softirq) {
+    for (size_t cpu = 0; cpu < SNOOPER_MAX_CPUS; ++cpu) {
+        SnooperIrqCore *core = &stats->cores[cpu];
+        if (softirq) {
+            core->softirqs_per_sec = 0.0;
+        } else {
+            core->irqs_per_sec = 0.0;
+            core->top_count = 0;
+            memset(core->top, 0, sizeof(core->top));
+        }
+    }
+}
+
+static SnooperStatus irq_table_sample(SnooperIrqTable *table, double scale, int softirq, SnooperIrqStats *stats) {
+    if (table->fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    size_t length = 0;
+    SnooperStatus status = irq_table_read(table, &length);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    const char *end = table->text + length;
+    const char *header_end = line_end_of(table->text, end);
+    const char *body = header_end < end ? header_end + 1 : end;
+
+    if (!table->block || hash_bytes(table->text, header_end) != table->header_hash) {
+        status = irq_table_build_layout(table, table->text, header_end, body, end);
+        if (status != SNOOPER_OK) {
+            return status;
+        }
+    }
+
+    size_t columns = table->column_count;
+    size_t previous_rows = table->has_previous ? table->row_count : 0;
+    size_t row = 0;
+    int relayout = 0;
+
+    for (const char *cursor = body; cursor < end; ) {
+        const char *line_end = line_end_of(cursor, end);
+        const char *next = line_end < end ? line_end + 1 : end;
+
+        const char *label = cursor;
+        while (label < line_end && *label == ' ') label++;
+        const char *colon = memchr(label, ':', (size_t)(line_end - label));
+        if (!colon) {
+            cursor = next;
+            continue;
+        }
+        if (row >= table->row_capacity) {
+            relayout = 1;
+            break;
+        }
+
+        uint64_t hash = hash_bytes(cursor, line_end);
+        if (row < previous_rows && table->row_hash[row] == hash) {
+            if (table->row_active[row]) {
+                memset(&table->rates[row * columns], 0, columns * sizeof(double));
+                table->row_active[row] = 0;
+            }
+            row++;
+            cursor = next;
+            continue;
+        }
+
+        size_t label_len = (size_t)(colon - label);
+        int has_delta = row < previous_rows && scale > 0.0;
+        if (row < previous_rows && !irq_label_matches(table->row_names[row], label, label_len)) {
+            relayout = 1;
+            break;
+        }
+        if (row >= previous_rows) {
+            irq_row_name(label, label_len, line_end, table->row_names[row]);
+        }
+
+        uint64_t *counts = &table->counts[row * columns];
+        double *rates = &table->rates[row * columns];
+        uint64_t *values = table->values;
+        const char *field = colon + 1;
+        size_t parsed = 0;
+        while (parsed < columns && (field = snooper_parse_u64(field, line_end, &values[parsed])) != NULL) {
+            parsed++;
+        }
+
+        // ERR: and MIS: carry a single total rather than a count per CPU.
+        if (parsed != columns) {
+            memset(rates, 0, columns * sizeof(double));
+            table->row_active[row] = 0;
+            table->row_hash[row] = hash;
+            row++;
+            cursor = next;
+            continue;
+        }
+
+        int active = 0;
+        for (size_t col = 0; col < columns; ++col) {
+            uint64_t value = values[col];
+            double rate = 0.0;
+            if (has_delta && value > counts[col]) {
+                rate = (double)(value - counts[col]) * scale;
+                active = 1;
+            }
+            rates[col] = rate;
+            counts[col] = value;
+
+            int cpu = table->column_cpu[col];
+            if (rate > 0.0 && cpu >= 0 && cpu < SNOOPER_MAX_CPUS) {
+                SnooperIrqCore *core = &stats->cores[cpu];
+                if (softirq) {
+                    core->softirqs_per_sec += rate;
+                } else {
+                    core->irqs_per_sec += rate;
+                    irq_insert_top(core, table->row_names[row], rate);
+                }
+            }
+        }
+
+        table->row_active[row] = (unsigned char)active;
+        table->row_hash[row] = hash;
+        row++;
+        cursor = next;
+    }
+
+    if (relayout) {
+        irq_clear_stats(stats, softirq);
+        irq_table_release_layout(table);
+        status = irq_table_sample(table, 0.0, softirq, stats);
+        return status == SNOOPER_OK ? SNOOPER_ERR_WARMUP : status;
+    }
+
+    for (size_t col = 0; col < columns; ++col) {
+        int cpu = table->column_cpu[col];
+        if (cpu >= 0 && cpu < SNOOPER_MAX_CPUS) {
+            stats->cores[cpu].present = 1;
+            if ((size_t)cpu + 1 > stats->core_count) {
+                stats->core_count = (size_t)cpu + 1;
+            }
+        }
+    }
+
+    int warm = table->has_previous && scale > 0.0;
+    table->row_count = row;
+    table->has_previous = 1;
+    return warm ? SNOOPER_OK : SNOOPER_ERR_WARMUP;
+}
+
+static SnooperStatus irq_table_open(SnooperIrqTable *table, const char *root, const char *path) {
+    table->path = path;
+    table->fd = snooper_open_readonly(root, path);
+    table->text = malloc(IRQ_TEXT_INITIAL_SIZE);
+    if (!table->text) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    table->text_size = IRQ_TEXT_INITIAL_SIZE;
+    return SNOOPER_OK;
+}
+
+static void irq_table_close(SnooperIrqTable *table) {
+    irq_table_release_layout(table);
+    if (table->fd >= 0) {
+        close(table->fd);
+    }
+    table->fd = -1;
+    free(table->text);
+    table->text = NULL;
+    table->text_size = 0;
+}
+
+SnooperStatus irq_probe_init(IrqProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    probe->hard.fd = -1;
+    probe->soft.fd = -1;
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+
+    if (irq_table_open(&probe->hard, probe->root, "/proc/interrupts") != SNOOPER_OK ||
+        irq_table_open(&probe->soft, probe->root, "/proc/softirqs") != SNOOPER_OK) {
+        irq_probe_destroy(probe);
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    probe->initialized = 1;
+    return SNOOPER_OK;
+}
+
+void irq_probe_destroy(IrqProbe *probe) {
+    if (!probe) return;
+    irq_table_close(&probe->hard);
+    irq_table_close(&probe->soft);
+    probe->initialized = 0;
+}
+
+SnooperStatus irq_probe_sample(IrqProbe *probe, uint64_t monotonic_ns, SnooperIrqStats *stats) {
+    if (!probe || !stats || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->monotonic_ns = monotonic_ns;
+
+    double scale = 0.0;
+    if (probe->previous_ns != 0 && monotonic_ns > probe->previous_ns) {
+        scale = 1e9 / (double)(monotonic_ns - probe->previous_ns);
+    }
+
+    SnooperStatus status = irq_table_sample(&probe->hard, scale, 0, stats);
+    if (status != SNOOPER_OK && status != SNOOPER_ERR_WARMUP) {
+        return status;
+    }
+    (void)irq_table_sample(&probe->soft, scale, 1, stats);
+
+    probe->previous_ns = monotonic_ns;
+    return status;
+}
+
+const double *irq_probe_rate_matrix(const IrqProbe *probe, int softirq, size_t *rows, size_t *columns) {
+    if (!probe) return NULL;
+    const SnooperIrqTable *table = softirq ? &probe->soft : &probe->hard;
+    if (rows) *rows = table->row_count;
+    if (columns) *columns = table->column_count;
+    return table->rates;
+}
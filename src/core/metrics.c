@@ -0,0 +1,514 @@
+#include "snooper/metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    SCOPE_GLOBAL,
+    SCOPE_CORE,
+    SCOPE_ZONE,
+    SCOPE_INTERFACE,
+    SCOPE_GROUP,
+    SCOPE_PLUGIN
+} MetricScope;
+
+// probe is the telemetry probe whose sample the value comes from, or
+// SNOOPER_PROBE_COUNT for plugin values.
+typedef struct {
+    SnooperMetricField field;
+    MetricScope scope;
+    SnooperProbeId probe;
+    const char *name;
+} MetricDescriptor;
+
+static const MetricDescriptor kMetrics[SNOOPER_METRIC_FIELD_COUNT] = {
+    { SNOOPER_METRIC_CPU_USED, SCOPE_GLOBAL, SNOOPER_PROBE_CPU, "cpu.used" },
+    { SNOOPER_METRIC_GPU_USED, SCOPE_GLOBAL, SNOOPER_PROBE_GPU, "gpu.used" },
+    { SNOOPER_METRIC_POWER_PACKAGE_WATTS, SCOPE_GLOBAL, SNOOPER_PROBE_POWER, "power.package_watts" },
+    { SNOOPER_METRIC_POWER_JOULES_PER_BUSY_CORE_SECOND, SCOPE_GLOBAL, SNOOPER_PROBE_POWER, "power.joules_per_busy_core_second" },
+    { SNOOPER_METRIC_SCHED_CONTEXT_SWITCHES, SCOPE_GLOBAL, SNOOPER_PROBE_SCHED, "sched.context_switches" },
+    { SNOOPER_METRIC_SCHED_PROCS_RUNNING, SCOPE_GLOBAL, SNOOPER_PROBE_SCHED, "sched.procs_running" },
+    { SNOOPER_METRIC_SCHED_PROCS_BLOCKED, SCOPE_GLOBAL, SNOOPER_PROBE_SCHED, "sched.procs_blocked" },
+    { SNOOPER_METRIC_CORE_USED, SCOPE_CORE, SNOOPER_PROBE_CPU, "used" },
+    { SNOOPER_METRIC_CORE_USER, SCOPE_CORE, SNOOPER_PROBE_CPU, "user" },
+    { SNOOPER_METRIC_CORE_SYSTEM, SCOPE_CORE, SNOOPER_PROBE_CPU, "system" },
+    { SNOOPER_METRIC_CORE_RUN_MS, SCOPE_CORE, SNOOPER_PROBE_SCHED, "run_ms" },
+    { SNOOPER_METRIC_CORE_WAIT_MS, SCOPE_CORE, SNOOPER_PROBE_SCHED, "wait_ms" },
+    { SNOOPER_METRIC_CORE_TIMESLICES, SCOPE_CORE, SNOOPER_PROBE_SCHED, "timeslices" },
+    { SNOOPER_METRIC_CORE_IRQS, SCOPE_CORE, SNOOPER_PROBE_IRQ, "irqs" },
+    { SNOOPER_METRIC_CORE_SOFTIRQS, SCOPE_CORE, SNOOPER_PROBE_IRQ, "softirqs" },
+    { SNOOPER_METRIC_CORE_MHZ, SCOPE_CORE, SNOOPER_PROBE_FREQ, "mhz" },
+    { SNOOPER_METRIC_CORE_EFFECTIVE_MHZ, SCOPE_CORE, SNOOPER_PROBE_FREQ, "effective_mhz" },
+    { SNOOPER_METRIC_CORE_NORMALIZED_USED, SCOPE_CORE, SNOOPER_PROBE_FREQ, "normalized_used" },
+    { SNOOPER_METRIC_THERMAL_CELSIUS, SCOPE_ZONE, SNOOPER_PROBE_FREQ, "celsius" },
+    { SNOOPER_METRIC_NET_RX_BYTES, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "rx_bytes" },
+    { SNOOPER_METRIC_NET_TX_BYTES, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "tx_bytes" },
+    { SNOOPER_METRIC_NET_RX_PACKETS, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "rx_packets" },
+    { SNOOPER_METRIC_NET_TX_PACKETS, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "tx_packets" },
+    { SNOOPER_METRIC_NET_RX_ERRORS, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "rx_errors" },
+    { SNOOPER_METRIC_NET_TX_ERRORS, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "tx_errors" },
+    { SNOOPER_METRIC_NET_RX_DROPS, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "rx_drops" },
+    { SNOOPER_METRIC_NET_TX_DROPS, SCOPE_INTERFACE, SNOOPER_PROBE_NET, "tx_drops" },
+    { SNOOPER_METRIC_TOPOLOGY_USED, SCOPE_GROUP, SNOOPER_PROBE_CPU, "used" },
+    { SNOOPER_METRIC_PLUGIN_VALUE, SCOPE_PLUGIN, SNOOPER_PROBE_COUNT, "value" },
+};
+
+static int find_descriptor(MetricScope scope, const char *name, size_t length, SnooperMetricField *field) {
+    for (size_t i = 0; i < SNOOPER_METRIC_FIELD_COUNT; ++i) {
+        if (kMetrics[i].scope == scope && strlen(kMetrics[i].name) == length && strncmp(kMetrics[i].name, name, length) == 0) {
+            *field = kMetrics[i].field;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const char *parse_index(const char *cursor, int *index) {
+    if (*cursor++ != '[') {
+        return NULL;
+    }
+    if (cursor[0] == '*' && cursor[1] == ']') {
+        *index = SNOOPER_METRIC_ANY_INDEX;
+        return cursor + 2;
+    }
+
+    char *end = NULL;
+    long value = strtol(cursor, &end, 10);
+    if (end == cursor || *end != ']' || value < 0 || value > 1 << 20) {
+        return NULL;
+    }
+    *index = (int)value;
+    return end + 1;
+}
+
+static int copy_label(SnooperMetricId *out, const char *label, size_t length) {
+    if (length == 0 || length >= sizeof(out->label)) {
+        return 0;
+    }
+    memcpy(out->label, label, length);
+    out->label[length] = '\0';
+    if (strcmp(out->label, "*") == 0) {
+        out->label[0] = '\0';
+    }
+    return 1;
+}
+
+SnooperStatus snooper_metric_parse(const char *name, SnooperMetricId *out) {
+    if (!name || !out) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(out, 0, sizeof(*out));
+    if (find_descriptor(SCOPE_GLOBAL, name, strlen(name), &out->field)) {
+        return SNOOPER_OK;
+    }
+
+    const char *rest = NULL;
+    if (strncmp(name, "cpu.core", 8) == 0) {
+        rest = parse_index(name + 8, &out->index);
+        if (rest && *rest == '.' && find_descriptor(SCOPE_CORE, rest + 1, strlen(rest + 1), &out->field)) {
+            return SNOOPER_OK;
+        }
+    } else if (strncmp(name, "thermal", 7) == 0) {
+        rest = parse_index(name + 7, &out->index);
+        if (rest && *rest == '.' && find_descriptor(SCOPE_ZONE, rest + 1, strlen(rest + 1), &out->field)) {
+            return SNOOPER_OK;
+        }
+    } else if (strncmp(name, "net.", 4) == 0) {
+        const char *dot = strrchr(name + 4, '.');
+        if (dot && copy_label(out, name + 4, (size_t)(dot - name - 4))
+            && find_descriptor(SCOPE_INTERFACE, dot + 1, strlen(dot + 1), &out->field)) {
+            return SNOOPER_OK;
+        }
+    } else if (strncmp(name, "plugin.", 7) == 0) {
+        out->field = SNOOPER_METRIC_PLUGIN_VALUE;
+        if (copy_label(out, name + 7, strlen(name + 7)) && (out->label[0] == '\0' || strchr(out->label, '.'))) {
+            return SNOOPER_OK;
+        }
+    } else if (strncmp(name, "topology.", 9) == 0) {
+        const char *bracket = strchr(name + 9, '[');
+        if (bracket && copy_label(out, name + 9, (size_t)(bracket - name - 9))) {
+            rest = parse_index(bracket, &out->index);
+            if (rest && *rest == '.' && find_descriptor(SCOPE_GROUP, rest + 1, strlen(rest + 1), &out->field)) {
+                return SNOOPER_OK;
+            }
+        }
+    }
+
+    return SNOOPER_ERR_INVALID;
+}
+
+int snooper_metric_format(const SnooperMetricId *id, char *buffer, size_t size) {
+    if (!id || !buffer || size == 0 || id->field >= SNOOPER_METRIC_FIELD_COUNT) {
+        return -1;
+    }
+
+    const MetricDescriptor *descriptor = &kMetrics[id->field];
+    char index[16];
+    if (id->index == SNOOPER_METRIC_ANY_INDEX) {
+        snprintf(index, sizeof(index), "*");
+    } else {
+        snprintf(index, sizeof(index), "%d", id->index);
+    }
+
+    int written = -1;
+    switch (descriptor->scope) {
+        case SCOPE_GLOBAL:
+            written = snprintf(buffer, size, "%s", descriptor->name);
+            break;
+        case SCOPE_CORE:
+            written = snprintf(buffer, size, "cpu.core[%s].%s", index, descriptor->name);
+            break;
+        case SCOPE_ZONE:
+            written = snprintf(buffer, size, "thermal[%s].%s", index, descriptor->name);
+            break;
+        case SCOPE_INTERFACE:
+            written = snprintf(buffer, size, "net.%s.%s", id->label[0] ? id->label : "*", descriptor->name);
+            break;
+        case SCOPE_GROUP:
+            written = snprintf(buffer, size, "topology.%s[%s].%s", id->label[0] ? id->label : "*", index, descriptor->name);
+            break;
+        case SCOPE_PLUGIN:
+            written = snprintf(buffer, size, "plugin.%s", id->label[0] ? id->label : "*");
+            break;
+    }
+    return written >= 0 && (size_t)written < size ? 0 : -1;
+}
+
+int snooper_metric_is_pattern(const SnooperMetricId *id) {
+    if (!id) return 0;
+    switch (kMetrics[id->field].scope) {
+        case SCOPE_CORE:
+        case SCOPE_ZONE:
+            return id->index == SNOOPER_METRIC_ANY_INDEX;
+        case SCOPE_INTERFACE:
+        case SCOPE_PLUGIN:
+            return id->label[0] == '\0';
+        case SCOPE_GROUP:
+            return id->index == SNOOPER_METRIC_ANY_INDEX || id->label[0] == '\0';
+        default:
+            return 0;
+    }
+}
+
+int snooper_metric_matches(const SnooperMetricId *pattern, const SnooperMetricId *id) {
+    if (!pattern || !id || pattern->field != id->field) {
+        return 0;
+    }
+    if (pattern->index != SNOOPER_METRIC_ANY_INDEX && pattern->index != id->index) {
+        return 0;
+    }
+    return pattern->label[0] == '\0' || strcmp(pattern->label, id->label) == 0;
+}
+
+static int read_core(const SnooperSnapshot *snapshot, SnooperMetricField field, size_t core, double *value) {
+    switch (field) {
+        case SNOOPER_METRIC_CORE_USED:
+        case SNOOPER_METRIC_CORE_USER:
+        case SNOOPER_METRIC_CORE_SYSTEM: {
+            if (core >= snapshot->core_count) return 0;
+            const SnooperCpuUsage *usage = &snapshot->per_core[core];
+            *value = field == SNOOPER_METRIC_CORE_USER ? usage->user
+                   : field == SNOOPER_METRIC_CORE_SYSTEM ? usage->system
+                   : usage->user + usage->system;
+            return 1;
+        }
+        case SNOOPER_METRIC_CORE_RUN_MS:
+        case SNOOPER_METRIC_CORE_WAIT_MS:
+        case SNOOPER_METRIC_CORE_TIMESLICES: {
+            if (!snapshot->has_sched || core >= snapshot->sched.core_count || !snapshot->sched.cores[core].present) return 0;
+            const SnooperSchedCore *sched = &snapshot->sched.cores[core];
+            *value = field == SNOOPER_METRIC_CORE_RUN_MS ? sched->run_ms_per_sec
+                   : field == SNOOPER_METRIC_CORE_WAIT_MS ? sched->wait_ms_per_sec
+                   : sched->timeslices_per_sec;
+            return 1;
+        }
+        case SNOOPER_METRIC_CORE_IRQS:
+        case SNOOPER_METRIC_CORE_SOFTIRQS: {
+            if (!snapshot->has_irq || core >= snapshot->irq.core_count || !snapshot->irq.cores[core].present) return 0;
+            const SnooperIrqCore *irq = &snapshot->irq.cores[core];
+            *value = field == SNOOPER_METRIC_CORE_IRQS ? irq->irqs_per_sec : irq->softirqs_per_sec;
+            return 1;
+        }
+        case SNOOPER_METRIC_CORE_MHZ:
+        case SNOOPER_METRIC_CORE_EFFECTIVE_MHZ:
+        case SNOOPER_METRIC_CORE_NORMALIZED_USED: {
+            if (!snapshot->has_freq || core >= snapshot->freq.core_count || !snapshot->freq.cores[core].present) return 0;
+            const SnooperFreqCore *freq = &snapshot->freq.cores[core];
+            if (field == SNOOPER_METRIC_CORE_EFFECTIVE_MHZ && !snapshot->freq.has_msr) return 0;
+            *value = field == SNOOPER_METRIC_CORE_MHZ ? freq->current_mhz
+                   : field == SNOOPER_METRIC_CORE_EFFECTIVE_MHZ ? freq->effective_mhz
+                   : freq->normalized_used_percent;
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int read_interface(const SnooperNetInterface *iface, SnooperMetricField field, double *value) {
+    switch (field) {
+        case SNOOPER_METRIC_NET_RX_BYTES: *value = iface->rx_bytes_per_sec; return 1;
+        case SNOOPER_METRIC_NET_TX_BYTES: *value = iface->tx_bytes_per_sec; return 1;
+        case SNOOPER_METRIC_NET_RX_PACKETS: *value = iface->rx_packets_per_sec; return 1;
+        case SNOOPER_METRIC_NET_TX_PACKETS: *value = iface->tx_packets_per_sec; return 1;
+        case SNOOPER_METRIC_NET_RX_ERRORS: *value = (double)iface->rx_errors; return 1;
+        case SNOOPER_METRIC_NET_TX_ERRORS: *value = (double)iface->tx_errors; return 1;
+        case SNOOPER_METRIC_NET_RX_DROPS: *value = (double)iface->rx_drops; return 1;
+        case SNOOPER_METRIC_NET_TX_DROPS: *value = (double)iface->tx_drops; return 1;
+        default: return 0;
+    }
+}
+
+// Calls visitor for each available plugin value, with its slot in the
+// snapshot's value array; an empty label matches every field.
+static void each_plugin_value(const SnooperSnapshot *snapshot, const char *label, SnooperMetricInstanceVisitor visitor, void *context) {
+    const SnooperPluginSet *set = snapshot->plugins;
+    SnooperMetricId id;
+    memset(&id, 0, sizeof(id));
+    id.field = SNOOPER_METRIC_PLUGIN_VALUE;
+    for (size_t i = 0; set && i < set->count; ++i) {
+        if (!snapshot->plugin_available[i]) continue;
+        const SnooperProbeDescriptor *descriptor = set->probes[i].descriptor;
+        for (size_t f = 0; f < descriptor->field_count; ++f) {
+            snprintf(id.label, sizeof(id.label), "%s.%s", descriptor->name, descriptor->fields[f].name);
+            if (label[0] && strcmp(label, id.label) != 0) continue;
+            size_t slot = set->probes[i].value_offset + f;
+            visitor(context, &id, slot, snooper_plugin_value_as_double(descriptor->fields[f].type, snapshot->plugin_values[slot]));
+        }
+    }
+}
+
+typedef struct {
+    SnooperMetricVisitor visitor;
+    void *context;
+} PlainVisitor;
+
+static void visit_plain(void *context, const SnooperMetricId *id, size_t slot, double value) {
+    (void)slot;
+    const PlainVisitor *plain = context;
+    plain->visitor(plain->context, id, value);
+}
+
+static int find_topology_level(const char *name) {
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        if (strcmp(snooper_topology_level_name((SnooperTopologyLevel)level), name) == 0) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+int snooper_metric_read(const SnooperSnapshot *snapshot, const SnooperMetricId *id, double *value) {
+    if (!snapshot || !id || !value || snooper_metric_is_pattern(id)) {
+        return 0;
+    }
+
+    switch (id->field) {
+        case SNOOPER_METRIC_CPU_USED:
+            *value = snapshot->cpu_used_percent;
+            return 1;
+        case SNOOPER_METRIC_GPU_USED:
+            *value = snapshot->gpu_used_percent;
+            return snapshot->gpu_available;
+        case SNOOPER_METRIC_POWER_PACKAGE_WATTS:
+            *value = snapshot->power.package_watts;
+            return snapshot->power.available;
+        case SNOOPER_METRIC_POWER_JOULES_PER_BUSY_CORE_SECOND:
+            *value = snapshot->power.joules_per_busy_core_second;
+            return snapshot->power.available;
+        case SNOOPER_METRIC_SCHED_CONTEXT_SWITCHES:
+            *value = snapshot->sched.context_switches_per_sec;
+            return snapshot->has_sched;
+        case SNOOPER_METRIC_SCHED_PROCS_RUNNING:
+            *value = (double)snapshot->sched.procs_running;
+            return snapshot->has_sched;
+        case SNOOPER_METRIC_SCHED_PROCS_BLOCKED:
+            *value = (double)snapshot->sched.procs_blocked;
+            return snapshot->has_sched;
+        case SNOOPER_METRIC_THERMAL_CELSIUS:
+            if (!snapshot->has_freq || (size_t)id->index >= snapshot->freq.zone_count) return 0;
+            *value = snapshot->freq.zones[id->index].celsius;
+            return 1;
+        case SNOOPER_METRIC_PLUGIN_VALUE: {
+            size_t slot = 0;
+            size_t probe = 0;
+            if (!snooper_plugin_find_field(snapshot->plugins, id->label, &slot, &probe) || !snapshot->plugin_available[probe]) return 0;
+            const SnooperProbeDescriptor *descriptor = snapshot->plugins->probes[probe].descriptor;
+            *value = snooper_plugin_value_as_double(descriptor->fields[slot - snapshot->plugins->probes[probe].value_offset].type, snapshot->plugin_values[slot]);
+            return 1;
+        }
+        case SNOOPER_METRIC_TOPOLOGY_USED: {
+            int level = find_topology_level(id->label);
+            if (!snapshot->has_topology || level < 0) return 0;
+            const SnooperTopologyUsage *usage = &snapshot->topology;
+            for (size_t g = usage->level_offsets[level]; g < usage->level_offsets[level + 1]; ++g) {
+                if (usage->groups[g].id == id->index) {
+                    *value = usage->groups[g].used_percent;
+                    return 1;
+                }
+            }
+            return 0;
+        }
+        default:
+            break;
+    }
+
+    switch (kMetrics[id->field].scope) {
+        case SCOPE_CORE:
+            return read_core(snapshot, id->field, (size_t)id->index, value);
+        case SCOPE_INTERFACE:
+            if (!snapshot->has_network) return 0;
+            for (size_t i = 0; i < snapshot->network.interface_count; ++i) {
+                const SnooperNetInterface *iface = &snapshot->network.interfaces[i];
+                if (iface->present && strcmp(iface->name, id->label) == 0) {
+                    return read_interface(iface, id->field, value);
+                }
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+uint64_t snooper_metric_updated_ns(const SnooperSnapshot *snapshot, const SnooperMetricId *id) {
+    if (!snapshot || !id || id->field >= SNOOPER_METRIC_FIELD_COUNT) return 0;
+
+    SnooperProbeId probe = kMetrics[id->field].probe;
+    if (probe != SNOOPER_PROBE_COUNT) {
+        return snapshot->updated_ns[probe];
+    }
+    size_t slot = 0;
+    size_t plugin = 0;
+    if (!snooper_plugin_find_field(snapshot->plugins, id->label, &slot, &plugin)) return 0;
+    return snapshot->plugin_updated_ns[plugin];
+}
+
+// Slots are stable per instance for the life of a telemetry session: core and
+// zone slots are their indices, interface slots follow the network probe's
+// stable slot order and group slots follow the topology usage layout.
+size_t snooper_metric_slot_count(const SnooperMetricId *pattern) {
+    if (!pattern || pattern->field >= SNOOPER_METRIC_FIELD_COUNT) return 0;
+    switch (kMetrics[pattern->field].scope) {
+        case SCOPE_CORE: return SNOOPER_MAX_CPUS;
+        case SCOPE_ZONE: return SNOOPER_MAX_THERMAL_ZONES;
+        case SCOPE_INTERFACE: return SNOOPER_MAX_NET_INTERFACES;
+        case SCOPE_GROUP: return SNOOPER_MAX_CPUS * 2;
+        case SCOPE_PLUGIN: return SNOOPER_PLUGIN_MAX_VALUES;
+        default: return 1;
+    }
+}
+
+void snooper_metric_expand(const SnooperSnapshot *snapshot, const SnooperMetricId *pattern, SnooperMetricInstanceVisitor visitor, void *context) {
+    if (!snapshot || !pattern || !visitor || pattern->field >= SNOOPER_METRIC_FIELD_COUNT) return;
+
+    SnooperMetricId id = *pattern;
+    double value;
+    switch (kMetrics[pattern->field].scope) {
+        case SCOPE_GLOBAL:
+            if (snooper_metric_read(snapshot, &id, &value)) {
+                visitor(context, &id, 0, value);
+            }
+            break;
+        case SCOPE_CORE:
+        case SCOPE_ZONE: {
+            size_t count = kMetrics[pattern->field].scope == SCOPE_CORE ? snapshot->core_count : snapshot->freq.zone_count;
+            size_t first = pattern->index == SNOOPER_METRIC_ANY_INDEX ? 0 : (size_t)pattern->index;
+            size_t last = pattern->index == SNOOPER_METRIC_ANY_INDEX ? count : first + 1;
+            for (size_t i = first; i < last && i < snooper_metric_slot_count(pattern); ++i) {
+                id.index = (int)i;
+                if (snooper_metric_read(snapshot, &id, &value)) {
+                    visitor(context, &id, i, value);
+                }
+            }
+            break;
+        }
+        case SCOPE_INTERFACE:
+            for (size_t i = 0; snapshot->has_network && i < snapshot->network.interface_count; ++i) {
+                const SnooperNetInterface *iface = &snapshot->network.interfaces[i];
+                if (!iface->present || strlen(iface->name) >= sizeof(id.label)) continue;
+                if (pattern->label[0] && strcmp(pattern->label, iface->name) != 0) continue;
+                strcpy(id.label, iface->name);
+                if (read_interface(iface, id.field, &value)) {
+                    visitor(context, &id, i, value);
+                }
+            }
+            break;
+        case SCOPE_GROUP:
+            for (int level = 0; snapshot->has_topology && level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+                const char *name = snooper_topology_level_name((SnooperTopologyLevel)level);
+                if (pattern->label[0] && strcmp(pattern->label, name) != 0) continue;
+                snprintf(id.label, sizeof(id.label), "%s", name);
+                const SnooperTopologyUsage *usage = &snapshot->topology;
+                for (size_t g = usage->level_offsets[level]; g < usage->level_offsets[level + 1]; ++g) {
+                    if (pattern->index != SNOOPER_METRIC_ANY_INDEX && pattern->index != usage->groups[g].id) continue;
+                    id.index = usage->groups[g].id;
+                    visitor(context, &id, g, usage->groups[g].used_percent);
+                }
+            }
+            break;
+        case SCOPE_PLUGIN:
+            each_plugin_value(snapshot, pattern->label, visitor, context);
+            break;
+    }
+}
+
+void snooper_metric_visit(const SnooperSnapshot *snapshot, SnooperMetricVisitor visitor, void *context) {
+    if (!snapshot || !visitor) return;
+
+    SnooperMetricId id;
+    double value;
+    memset(&id, 0, sizeof(id));
+    for (size_t f = 0; f < SNOOPER_METRIC_FIELD_COUNT; ++f) {
+        id.field = (SnooperMetricField)f;
+        id.index = 0;
+        id.label[0] = '\0';
+
+        switch (kMetrics[f].scope) {
+            case SCOPE_GLOBAL:
+                if (snooper_metric_read(snapshot, &id, &value)) {
+                    visitor(context, &id, value);
+                }
+                break;
+            case SCOPE_CORE:
+                for (size_t core = 0; core < snapshot->core_count; ++core) {
+                    if (read_core(snapshot, id.field, core, &value)) {
+                        id.index = (int)core;
+                        visitor(context, &id, value);
+                    }
+                }
+                break;
+            case SCOPE_ZONE:
+                for (size_t zone = 0; snapshot->has_freq && zone < snapshot->freq.zone_count; ++zone) {
+                    id.index = (int)zone;
+                    visitor(context, &id, snapshot->freq.zones[zone].celsius);
+                }
+                break;
+            case SCOPE_INTERFACE:
+                for (size_t i = 0; snapshot->has_network && i < snapshot->network.interface_count; ++i) {
+                    const SnooperNetInterface *iface = &snapshot->network.interfaces[i];
+                    if (!iface->present || strlen(iface->name) >= sizeof(id.label)) continue;
+                    strcpy(id.label, iface->name);
+                    if (read_interface(iface, id.field, &value)) {
+                        visitor(context, &id, value);
+                    }
+                }
+                break;
+            case SCOPE_GROUP:
+                for (int level = 0; snapshot->has_topology && level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+                    const SnooperTopologyUsage *usage = &snapshot->topology;
+                    snprintf(id.label, sizeof(id.label), "%s", snooper_topology_level_name((SnooperTopologyLevel)level));
+                    for (size_t g = usage->level_offsets[level]; g < usage->level_offsets[level + 1]; ++g) {
+                        id.index = usage->groups[g].id;
+                        visitor(context, &id, usage->groups[g].used_percent);
+                    }
+                }
+                break;
+            case SCOPE_PLUGIN: {
+                PlainVisitor plain = { visitor, context };
+                each_plugin_value(snapshot, "", visit_plain, &plain);
+                break;
+            }
+        }
+    }
+}
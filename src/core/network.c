@@ -0,0 +1,319 @@
+#include "snooper/network.h"
+#include "procfs.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <errno.h>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#endif
+
+#define NET_BUFFER_SIZE 65536
+#define NET_PROCFS_FIELDS 16
+
+static uint64_t counter_delta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+static int net_find_slot(NetProbe *probe, const int *seen, const char *name) {
+    for (size_t i = 0; i < probe->slot_count; ++i) {
+        if (strncmp(probe->names[i], name, SNOOPER_NET_NAME_MAX) == 0) {
+            return (int)i;
+        }
+    }
+
+    // Once every slot is taken, hand over the one whose interface has been
+    // gone the longest; an interface seen in the last sample keeps its slot.
+    int slot = -1;
+    if (probe->slot_count < SNOOPER_MAX_NET_INTERFACES) {
+        slot = (int)probe->slot_count++;
+    } else {
+        for (size_t i = 0; i < probe->slot_count; ++i) {
+            if (seen[i] || probe->has_previous[i]) continue;
+            if (slot < 0 || probe->last_seen_ns[i] < probe->last_seen_ns[slot]) {
+                slot = (int)i;
+            }
+        }
+        if (slot < 0) {
+            return -1;
+        }
+    }
+
+    snprintf(probe->names[slot], sizeof(probe->names[slot]), "%s", name);
+    probe->has_previous[slot] = 0;
+    return slot;
+}
+
+static void net_record(NetProbe *probe,
+                       SnooperNetworkStats *stats,
+                       int *seen,
+                       const char *name,
+                       const SnooperNetCounters *counters,
+                       uint64_t elapsed_ns) {
+    int slot = net_find_slot(probe, seen, name);
+    if (slot < 0) {
+        return;
+    }
+
+    SnooperNetInterface *iface = &stats->interfaces[slot];
+    iface->present = 1;
+    iface->totals = *counters;
+    seen[slot] = 1;
+
+    if (probe->has_previous[slot] && elapsed_ns > 0) {
+        const SnooperNetCounters *prev = &probe->previous[slot];
+        double scale = 1e9 / (double)elapsed_ns;
+        iface->rx_bytes_per_sec = (double)counter_delta(counters->rx_bytes, prev->rx_bytes) * scale;
+        iface->tx_bytes_per_sec = (double)counter_delta(counters->tx_bytes, prev->tx_bytes) * scale;
+        iface->rx_packets_per_sec = (double)counter_delta(counters->rx_packets, prev->rx_packets) * scale;
+        iface->tx_packets_per_sec = (double)counter_delta(counters->tx_packets, prev->tx_packets) * scale;
+        iface->rx_errors = counter_delta(counters->rx_errors, prev->rx_errors);
+        iface->tx_errors = counter_delta(counters->tx_errors, prev->tx_errors);
+        iface->rx_drops = counter_delta(counters->rx_drops, prev->rx_drops);
+        iface->tx_drops = counter_delta(counters->tx_drops, prev->tx_drops);
+    }
+
+    probe->previous[slot] = *counters;
+    probe->has_previous[slot] = 1;
+}
+
+static SnooperStatus net_sample_procfs(NetProbe *probe, SnooperNetworkStats *stats, int *seen, uint64_t elapsed_ns) {
+    size_t length = 0;
+    if (snooper_read_fd(probe->dev_fd, probe->buffer, probe->buffer_size, &length) != SNOOPER_OK) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    const char *end = probe->buffer + length;
+    const char *cursor = snooper_skip_line(snooper_skip_line(probe->buffer, end), end);
+
+    while (cursor < end) {
+        const char *line_end = memchr(cursor, '\n', (size_t)(end - cursor));
+        if (!line_end) line_end = end;
+
+        while (cursor < line_end && *cursor == ' ') {
+            cursor++;
+        }
+
+        const char *colon = memchr(cursor, ':', (size_t)(line_end - cursor));
+        if (colon) {
+            char name[SNOOPER_NET_NAME_MAX];
+            size_t name_len = (size_t)(colon - cursor);
+            if (name_len >= sizeof(name)) name_len = sizeof(name) - 1;
+            memcpy(name, cursor, name_len);
+            name[name_len] = '\0';
+
+            uint64_t fields[NET_PROCFS_FIELDS];
+            const char *field = colon + 1;
+            size_t parsed = 0;
+            while (parsed < NET_PROCFS_FIELDS && field) {
+                field = snooper_parse_u64(field, line_end, &fields[parsed]);
+                if (field) parsed++;
+            }
+
+            if (parsed == NET_PROCFS_FIELDS) {
+                SnooperNetCounters counters = {
+                    .rx_bytes = fields[0],
+                    .rx_packets = fields[1],
+                    .rx_errors = fields[2],
+                    .rx_drops = fields[3],
+                    .tx_bytes = fields[8],
+                    .tx_packets = fields[9],
+                    .tx_errors = fields[10],
+                    .tx_drops = fields[11]
+                };
+                net_record(probe, stats, seen, name, &counters, elapsed_ns);
+            }
+        }
+
+        cursor = line_end < end ? line_end + 1 : end;
+    }
+
+    return SNOOPER_OK;
+}
+
+static int net_read_statistic(const NetProbe *probe, const char *name, const char *counter, uint64_t *value) {
+    char path[256];
+    if (snooper_path_format(path, sizeof(path), NULL, "/sys/class/net/%s/statistics/%s", name, counter) != 0) {
+        return -1;
+    }
+    return snooper_read_file_u64(probe->root, path, value) == SNOOPER_OK ? 0 : -1;
+}
+
+static SnooperStatus net_sample_sysfs(NetProbe *probe, SnooperNetworkStats *stats, int *seen, uint64_t elapsed_ns) {
+    char path[512];
+    if (snooper_path_format(path, sizeof(path), probe->root, "/sys/class/net") != 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        SnooperNetCounters counters = {0};
+        if (net_read_statistic(probe, entry->d_name, "rx_bytes", &counters.rx_bytes) != 0) continue;
+        net_read_statistic(probe, entry->d_name, "rx_packets", &counters.rx_packets);
+        net_read_statistic(probe, entry->d_name, "rx_errors", &counters.rx_errors);
+        net_read_statistic(probe, entry->d_name, "rx_dropped", &counters.rx_drops);
+        net_read_statistic(probe, entry->d_name, "tx_bytes", &counters.tx_bytes);
+        net_read_statistic(probe, entry->d_name, "tx_packets", &counters.tx_packets);
+        net_read_statistic(probe, entry->d_name, "tx_errors", &counters.tx_errors);
+        net_read_statistic(probe, entry->d_name, "tx_dropped", &counters.tx_drops);
+
+        net_record(probe, stats, seen, entry->d_name, &counters, elapsed_ns);
+    }
+
+    closedir(dir);
+    return SNOOPER_OK;
+}
+
+#if defined(__APPLE__)
+static SnooperStatus net_sample_sysctl(NetProbe *probe, SnooperNetworkStats *stats, int *seen, uint64_t elapsed_ns) {
+    int mib[6] = {CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST2, 0};
+    size_t length = probe->buffer_size;
+
+    while (sysctl(mib, 6, probe->buffer, &length, NULL, 0) != 0) {
+        if (errno != ENOMEM) {
+            return SNOOPER_ERR_UNAVAILABLE;
+        }
+        char *grown = realloc(probe->buffer, probe->buffer_size * 2);
+        if (!grown) {
+            return SNOOPER_ERR_NOMEM;
+        }
+        probe->buffer = grown;
+        probe->buffer_size *= 2;
+        length = probe->buffer_size;
+    }
+
+    const char *cursor = probe->buffer;
+    const char *end = probe->buffer + length;
+
+    while (cursor + sizeof(struct if_msghdr) <= end) {
+        const struct if_msghdr *header = (const struct if_msghdr *)cursor;
+        if (header->ifm_msglen == 0) break;
+
+        if (header->ifm_type == RTM_IFINFO2) {
+            const struct if_msghdr2 *info = (const struct if_msghdr2 *)cursor;
+            const struct sockaddr_dl *link = (const struct sockaddr_dl *)(info + 1);
+
+            char name[SNOOPER_NET_NAME_MAX];
+            size_t name_len = link->sdl_nlen < sizeof(name) ? link->sdl_nlen : sizeof(name) - 1;
+            memcpy(name, link->sdl_data, name_len);
+            name[name_len] = '\0';
+
+            SnooperNetCounters counters = {
+                .rx_bytes = info->ifm_data.ifi_ibytes,
+                .rx_packets = info->ifm_data.ifi_ipackets,
+                .rx_errors = info->ifm_data.ifi_ierrors,
+                .rx_drops = info->ifm_data.ifi_iqdrops,
+                .tx_bytes = info->ifm_data.ifi_obytes,
+                .tx_packets = info->ifm_data.ifi_opackets,
+                .tx_errors = info->ifm_data.ifi_oerrors,
+                .tx_drops = 0
+            };
+            net_record(probe, stats, seen, name, &counters, elapsed_ns);
+        }
+
+        cursor += header->ifm_msglen;
+    }
+
+    return SNOOPER_OK;
+}
+#endif
+
+SnooperStatus net_probe_init(NetProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    probe->dev_fd = -1;
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+
+    probe->buffer = malloc(NET_BUFFER_SIZE);
+    if (!probe->buffer) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    probe->buffer_size = NET_BUFFER_SIZE;
+
+#if defined(__APPLE__)
+    if (probe->root[0] == '\0') {
+        probe->source = SNOOPER_NET_SOURCE_SYSCTL;
+        probe->initialized = 1;
+        return SNOOPER_OK;
+    }
+#endif
+
+    probe->dev_fd = snooper_open_readonly(probe->root, "/proc/net/dev");
+    probe->source = probe->dev_fd >= 0 ? SNOOPER_NET_SOURCE_PROCFS : SNOOPER_NET_SOURCE_SYSFS;
+    probe->initialized = 1;
+    return SNOOPER_OK;
+}
+
+void net_probe_destroy(NetProbe *probe) {
+    if (!probe) return;
+    if (probe->dev_fd >= 0) {
+        close(probe->dev_fd);
+        probe->dev_fd = -1;
+    }
+    free(probe->buffer);
+    probe->buffer = NULL;
+    probe->buffer_size = 0;
+    probe->initialized = 0;
+}
+
+SnooperStatus net_probe_sample(NetProbe *probe, uint64_t monotonic_ns, SnooperNetworkStats *stats) {
+    if (!probe || !stats || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->monotonic_ns = monotonic_ns;
+
+    int warmup = probe->previous_ns == 0;
+    uint64_t elapsed_ns = warmup || monotonic_ns < probe->previous_ns ? 0 : monotonic_ns - probe->previous_ns;
+    int seen[SNOOPER_MAX_NET_INTERFACES] = {0};
+
+    SnooperStatus status = SNOOPER_ERR_UNAVAILABLE;
+    switch (probe->source) {
+        case SNOOPER_NET_SOURCE_PROCFS:
+            status = net_sample_procfs(probe, stats, seen, elapsed_ns);
+            break;
+        case SNOOPER_NET_SOURCE_SYSFS:
+            status = net_sample_sysfs(probe, stats, seen, elapsed_ns);
+            break;
+        case SNOOPER_NET_SOURCE_SYSCTL:
+#if defined(__APPLE__)
+            status = net_sample_sysctl(probe, stats, seen, elapsed_ns);
+#endif
+            break;
+    }
+
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    for (size_t i = 0; i < probe->slot_count; ++i) {
+        stats->interfaces[i].index = (int)i;
+        snprintf(stats->interfaces[i].name, sizeof(stats->interfaces[i].name), "%s", probe->names[i]);
+        if (seen[i]) {
+            probe->last_seen_ns[i] = monotonic_ns;
+        } else {
+            probe->has_previous[i] = 0;
+        }
+    }
+    stats->interface_count = probe->slot_count;
+    probe->previous_ns = monotonic_ns;
+
+    return warmup ? SNOOPER_ERR_WARMUP : SNOOPER_OK;
+}
@@ -0,0 +1,220 @@
+#include "snooper/numa.h"
+#include "procfs.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUMA_MEMINFO_SIZE 4096
+#define NUMA_NUMASTAT_SIZE 512
+#define NUMA_VMSTAT_SIZE (16 * 1024)
+
+static const char *const numastat_keys[SNOOPER_NUMA_COUNTER_COUNT] = {
+    "numa_hit", "numa_miss", "numa_foreign", "interleave_hit", "local_node", "other_node"
+};
+
+static const char *const vmstat_keys[SNOOPER_NUMA_VM_COUNTER_COUNT] = {
+    "pgmigrate_success", "pgmigrate_fail", "numa_pages_migrated", "numa_hint_faults", "numa_hint_faults_local"
+};
+
+static const char *const meminfo_keys[2] = { "MemTotal", "MemFree" };
+
+static uint64_t counter_delta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+static int compare_ids(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Fills values[k] for each "key value" or "key: value" line whose key is
+// keys[k]. Node meminfo lines carry a "Node <n> " prefix before the key.
+static size_t numa_parse_keys(const char *text, size_t length, const char *const *keys, size_t key_count, uint64_t *values) {
+    const char *cursor = text;
+    const char *end = text + length;
+    size_t found = 0;
+
+    while (cursor < end) {
+        const char *line_end = snooper_skip_line(cursor, end);
+        if (line_end - cursor > 5 && memcmp(cursor, "Node ", 5) == 0) {
+            uint64_t node = 0;
+            const char *after = snooper_parse_u64(cursor + 5, line_end, &node);
+            cursor = after ? after : line_end;
+            while (cursor < line_end && *cursor == ' ') cursor++;
+        }
+
+        const char *key_end = cursor;
+        while (key_end < line_end && *key_end != ':' && *key_end != ' ' && *key_end != '\n') key_end++;
+        size_t key_length = (size_t)(key_end - cursor);
+        for (size_t k = 0; k < key_count; ++k) {
+            if (strlen(keys[k]) == key_length && memcmp(cursor, keys[k], key_length) == 0) {
+                const char *value = key_end < line_end && *key_end == ':' ? key_end + 1 : key_end;
+                if (snooper_parse_u64(value, line_end, &values[k])) found++;
+                break;
+            }
+        }
+
+        cursor = line_end;
+    }
+    return found;
+}
+
+static size_t numa_view_keys(const NumaProbe *probe, int slot, const char *const *keys, size_t key_count, uint64_t *values) {
+    size_t length = 0;
+    const char *view = snooper_read_engine_view(&probe->reads, slot, &length);
+    return view ? numa_parse_keys(view, length, keys, key_count, values) : 0;
+}
+
+static void numa_add_node(NumaProbe *probe, int id) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/meminfo", id);
+    int meminfo_fd = snooper_open_readonly(probe->root, path);
+    if (meminfo_fd < 0) {
+        return;
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/numastat", id);
+
+    SnooperNumaNodeState *state = &probe->nodes[probe->node_count++];
+    state->id = id;
+    state->meminfo_fd = meminfo_fd;
+    state->numastat_fd = snooper_open_readonly(probe->root, path);
+    state->meminfo_slot = snooper_read_engine_add(&probe->reads, state->meminfo_fd, NUMA_MEMINFO_SIZE);
+    state->numastat_slot = snooper_read_engine_add(&probe->reads, state->numastat_fd, NUMA_NUMASTAT_SIZE);
+}
+
+SnooperStatus numa_probe_init(NumaProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+    (void)snooper_read_engine_init(&probe->reads, 1);
+    probe->vmstat_fd = -1;
+    probe->vmstat_slot = -1;
+    probe->initialized = 1;
+
+    char path[512];
+    if (snooper_path_format(path, sizeof(path), probe->root, "/sys/devices/system/node") != 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    // Hosts without CONFIG_NUMA have no node directory; the probe then
+    // reports unavailable.
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return SNOOPER_OK;
+    }
+
+    int ids[SNOOPER_MAX_NUMA_NODES];
+    size_t id_count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && id_count < SNOOPER_MAX_NUMA_NODES) {
+        uint64_t id = 0;
+        const char *name_end = entry->d_name + strlen(entry->d_name);
+        if (strncmp(entry->d_name, "node", 4) == 0 && snooper_parse_u64(entry->d_name + 4, name_end, &id) == name_end && id < 4096) {
+            ids[id_count++] = (int)id;
+        }
+    }
+    closedir(dir);
+
+    qsort(ids, id_count, sizeof(ids[0]), compare_ids);
+    for (size_t i = 0; i < id_count; ++i) {
+        numa_add_node(probe, ids[i]);
+    }
+    if (probe->node_count > 0) {
+        probe->vmstat_fd = snooper_open_readonly(probe->root, "/proc/vmstat");
+        probe->vmstat_slot = snooper_read_engine_add(&probe->reads, probe->vmstat_fd, NUMA_VMSTAT_SIZE);
+    }
+    return SNOOPER_OK;
+}
+
+void numa_probe_destroy(NumaProbe *probe) {
+    if (!probe) return;
+    for (size_t i = 0; i < probe->node_count; ++i) {
+        if (probe->nodes[i].meminfo_fd >= 0) close(probe->nodes[i].meminfo_fd);
+        if (probe->nodes[i].numastat_fd >= 0) close(probe->nodes[i].numastat_fd);
+        probe->nodes[i].meminfo_fd = -1;
+        probe->nodes[i].numastat_fd = -1;
+    }
+    if (probe->vmstat_fd >= 0) close(probe->vmstat_fd);
+    probe->vmstat_fd = -1;
+    snooper_read_engine_destroy(&probe->reads);
+    probe->node_count = 0;
+    probe->initialized = 0;
+}
+
+static void numa_sample_node(SnooperNumaNodeState *state, const NumaProbe *probe, double scale, SnooperNumaNode *node) {
+    node->id = state->id;
+
+    uint64_t memory[2] = {0, 0};
+    if (numa_view_keys(probe, state->meminfo_slot, meminfo_keys, 2, memory) == 2) {
+        node->total_bytes = memory[0] * 1024u;
+        node->free_bytes = memory[1] * 1024u;
+        node->used_bytes = node->total_bytes >= node->free_bytes ? node->total_bytes - node->free_bytes : 0;
+    }
+
+    uint64_t counters[SNOOPER_NUMA_COUNTER_COUNT] = {0};
+    if (numa_view_keys(probe, state->numastat_slot, numastat_keys, SNOOPER_NUMA_COUNTER_COUNT, counters) == 0) {
+        state->has_previous = 0;
+        return;
+    }
+    if (state->has_previous && scale > 0.0) {
+        node->hit_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_HIT], state->previous[SNOOPER_NUMA_HIT]) * scale;
+        node->miss_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_MISS], state->previous[SNOOPER_NUMA_MISS]) * scale;
+        node->foreign_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_FOREIGN], state->previous[SNOOPER_NUMA_FOREIGN]) * scale;
+        node->local_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_LOCAL], state->previous[SNOOPER_NUMA_LOCAL]) * scale;
+        node->other_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_OTHER], state->previous[SNOOPER_NUMA_OTHER]) * scale;
+    }
+    memcpy(state->previous, counters, sizeof(counters));
+    state->has_previous = 1;
+}
+
+static void numa_sample_vmstat(NumaProbe *probe, double scale, SnooperNumaStats *stats) {
+    uint64_t counters[SNOOPER_NUMA_VM_COUNTER_COUNT] = {0};
+    if (numa_view_keys(probe, probe->vmstat_slot, vmstat_keys, SNOOPER_NUMA_VM_COUNTER_COUNT, counters) == 0) {
+        probe->has_previous_vm = 0;
+        return;
+    }
+
+    stats->has_vmstat = 1;
+    if (probe->has_previous_vm && scale > 0.0) {
+        uint64_t *previous = probe->previous_vm;
+        uint64_t faults = counter_delta(counters[SNOOPER_NUMA_VM_HINT_FAULTS], previous[SNOOPER_NUMA_VM_HINT_FAULTS]);
+        uint64_t local = counter_delta(counters[SNOOPER_NUMA_VM_HINT_FAULTS_LOCAL], previous[SNOOPER_NUMA_VM_HINT_FAULTS_LOCAL]);
+        stats->pages_migrated_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_VM_PGMIGRATE_SUCCESS], previous[SNOOPER_NUMA_VM_PGMIGRATE_SUCCESS]) * scale;
+        stats->migrate_failures_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_VM_PGMIGRATE_FAIL], previous[SNOOPER_NUMA_VM_PGMIGRATE_FAIL]) * scale;
+        stats->balancing_migrated_per_sec = (double)counter_delta(counters[SNOOPER_NUMA_VM_PAGES_MIGRATED], previous[SNOOPER_NUMA_VM_PAGES_MIGRATED]) * scale;
+        stats->hint_faults_per_sec = (double)faults * scale;
+        stats->hint_faults_local_percent = faults > 0 ? 100.0 * (double)local / (double)faults : 0.0;
+    }
+    memcpy(probe->previous_vm, counters, sizeof(counters));
+    probe->has_previous_vm = 1;
+}
+
+SnooperStatus numa_probe_sample(NumaProbe *probe, uint64_t monotonic_ns, SnooperNumaStats *stats) {
+    if (!probe || !stats || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+    if (probe->node_count == 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->monotonic_ns = monotonic_ns;
+
+    int warmup = probe->previous_ns == 0 || monotonic_ns <= probe->previous_ns;
+    double scale = warmup ? 0.0 : 1e9 / (double)(monotonic_ns - probe->previous_ns);
+
+    (void)snooper_read_engine_submit(&probe->reads);
+    for (size_t i = 0; i < probe->node_count; ++i) {
+        numa_sample_node(&probe->nodes[i], probe, scale, &stats->nodes[stats->node_count++]);
+    }
+    numa_sample_vmstat(probe, scale, stats);
+
+    probe->previous_ns = monotonic_ns;
+    return warmup ? SNOOPER_ERR_WARMUP : SNOOPER_OK;
+}
@@ -0,0 +1,158 @@
+#include "snooper/plugin.h"
+#include "snooper/telemetry.h"
+#include "procfs.h"
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+
+static int valid_name(const char *name) {
+    if (!name || !name[0] || strlen(name) >= SNOOPER_PLUGIN_NAME_MAX) {
+        return 0;
+    }
+    for (const char *c = name; *c; ++c) {
+        if (!((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static SnooperStatus validate(const SnooperPluginSet *set, const SnooperProbeDescriptor *descriptor, char *error, size_t error_size) {
+    if (descriptor->abi_version != SNOOPER_PLUGIN_ABI_VERSION) {
+        snprintf(error, error_size, "ABI version %u, expected %u", descriptor->abi_version, SNOOPER_PLUGIN_ABI_VERSION);
+        return SNOOPER_ERR_INVALID;
+    }
+    if (!valid_name(descriptor->name) || !descriptor->sample) {
+        snprintf(error, error_size, "invalid probe name or missing sample()");
+        return SNOOPER_ERR_INVALID;
+    }
+    if (descriptor->field_count == 0 || descriptor->field_count > SNOOPER_PLUGIN_MAX_FIELDS || !descriptor->fields) {
+        snprintf(error, error_size, "%s: needs 1..%d fields", descriptor->name, SNOOPER_PLUGIN_MAX_FIELDS);
+        return SNOOPER_ERR_INVALID;
+    }
+    if (set->count >= SNOOPER_PLUGIN_MAX || set->value_count + descriptor->field_count > SNOOPER_PLUGIN_MAX_VALUES) {
+        snprintf(error, error_size, "%s: too many plugin probes or fields", descriptor->name);
+        return SNOOPER_ERR_NOMEM;
+    }
+    for (int i = 0; i < SNOOPER_PROBE_COUNT; ++i) {
+        if (strcmp(snooper_probe_name((SnooperProbeId)i), descriptor->name) == 0) {
+            snprintf(error, error_size, "%s: clashes with a built-in probe", descriptor->name);
+            return SNOOPER_ERR_INVALID;
+        }
+    }
+    for (size_t i = 0; i < set->count; ++i) {
+        if (strcmp(set->probes[i].descriptor->name, descriptor->name) == 0) {
+            snprintf(error, error_size, "%s: already registered", descriptor->name);
+            return SNOOPER_ERR_INVALID;
+        }
+    }
+    for (size_t f = 0; f < descriptor->field_count; ++f) {
+        const SnooperFieldDesc *field = &descriptor->fields[f];
+        if (!valid_name(field->name) || field->type > SNOOPER_FIELD_I64) {
+            snprintf(error, error_size, "%s: invalid field %zu", descriptor->name, f);
+            return SNOOPER_ERR_INVALID;
+        }
+    }
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_plugin_register(SnooperPluginSet *set, const SnooperProbeDescriptor *descriptor, void *handle, char *error, size_t error_size) {
+    char scratch[8];
+    if (!error || error_size == 0) {
+        error = scratch;
+        error_size = sizeof(scratch);
+    }
+    error[0] = '\0';
+    if (!set || !descriptor) return SNOOPER_ERR_INVALID;
+
+    SnooperStatus status = validate(set, descriptor, error, error_size);
+    if (status != SNOOPER_OK) return status;
+
+    SnooperPluginProbe *probe = &set->probes[set->count];
+    memset(probe, 0, sizeof(*probe));
+    if (descriptor->init) {
+        status = descriptor->init(&probe->state, snooper_fs_root());
+        if (status != SNOOPER_OK) {
+            snprintf(error, error_size, "%s: init failed (%d)", descriptor->name, status);
+            return status;
+        }
+    }
+
+    probe->descriptor = descriptor;
+    probe->handle = handle;
+    probe->value_offset = set->value_count;
+    probe->period_ns = descriptor->period_ns;
+    set->value_count += descriptor->field_count;
+    set->count++;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_plugin_load(SnooperPluginSet *set, const char *path, char *error, size_t error_size) {
+    if (!set || !path || !error || error_size == 0) return SNOOPER_ERR_INVALID;
+
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        snprintf(error, error_size, "%s", dlerror());
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    SnooperProbeEntry entry;
+    *(void **)&entry = dlsym(handle, SNOOPER_PLUGIN_ENTRY);
+    const SnooperProbeDescriptor *descriptor = entry ? entry() : NULL;
+    if (!descriptor) {
+        snprintf(error, error_size, "%s: no %s()", path, SNOOPER_PLUGIN_ENTRY);
+        dlclose(handle);
+        return SNOOPER_ERR_INVALID;
+    }
+
+    SnooperStatus status = snooper_plugin_register(set, descriptor, handle, error, error_size);
+    if (status != SNOOPER_OK) {
+        dlclose(handle);
+    }
+    return status;
+}
+
+void snooper_plugin_unload_all(SnooperPluginSet *set) {
+    if (!set) return;
+    for (size_t i = 0; i < set->count; ++i) {
+        SnooperPluginProbe *probe = &set->probes[i];
+        if (probe->descriptor->destroy) {
+            probe->descriptor->destroy(probe->state);
+        }
+        if (probe->handle) {
+            dlclose(probe->handle);
+        }
+    }
+    memset(set, 0, sizeof(*set));
+}
+
+// Looks up "<probe>.<field>" and returns its slot in the value array.
+int snooper_plugin_find_field(const SnooperPluginSet *set, const char *label, size_t *value_index, size_t *probe_index) {
+    if (!set || !label) return 0;
+    const char *dot = strchr(label, '.');
+    if (!dot) return 0;
+
+    size_t name_length = (size_t)(dot - label);
+    for (size_t i = 0; i < set->count; ++i) {
+        const SnooperProbeDescriptor *descriptor = set->probes[i].descriptor;
+        if (strlen(descriptor->name) != name_length || strncmp(descriptor->name, label, name_length) != 0) {
+            continue;
+        }
+        for (size_t f = 0; f < descriptor->field_count; ++f) {
+            if (strcmp(descriptor->fields[f].name, dot + 1) == 0) {
+                if (value_index) *value_index = set->probes[i].value_offset + f;
+                if (probe_index) *probe_index = i;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+double snooper_plugin_value_as_double(SnooperFieldType type, SnooperFieldValue value) {
+    switch (type) {
+        case SNOOPER_FIELD_U64: return (double)value.u64;
+        case SNOOPER_FIELD_I64: return (double)value.i64;
+        default: return value.f64;
+    }
+}
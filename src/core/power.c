@@ -0,0 +1,190 @@
+#include "snooper/power.h"
+#include "procfs.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define RAPL_PREFIX "intel-rapl:"
+#define POWER_VALUE_SIZE 32
+
+static uint64_t energy_delta(uint64_t current, uint64_t previous, uint64_t max_range) {
+    if (current >= previous) {
+        return current - previous;
+    }
+    if (max_range == 0 || previous > max_range) {
+        return 0;
+    }
+    return (max_range - previous) + current;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+static void power_read_name(const char *root, const char *zone, char *out, size_t size) {
+    char path[256];
+    size_t length = 0;
+    if (snooper_path_format(path, sizeof(path), NULL, "/sys/class/powercap/%s/name", zone) != 0 ||
+        snooper_read_file(root, path, out, size, &length) != SNOOPER_OK) {
+        snprintf(out, size, "%s", zone);
+        return;
+    }
+    while (length > 0 && (out[length - 1] == '\n' || out[length - 1] == ' ')) {
+        out[--length] = '\0';
+    }
+}
+
+static void power_add_domain(PowerProbe *probe, const char *zone) {
+    char path[256];
+    if (snooper_path_format(path, sizeof(path), NULL, "/sys/class/powercap/%s/energy_uj", zone) != 0) {
+        return;
+    }
+    int fd = snooper_open_readonly(probe->root, path);
+    if (fd < 0) {
+        return;
+    }
+
+    SnooperPowerDomainState *domain = &probe->domains[probe->domain_count++];
+    domain->energy_fd = fd;
+    domain->energy_slot = snooper_read_engine_add(&probe->reads, fd, POWER_VALUE_SIZE);
+
+    if (snooper_path_format(path, sizeof(path), NULL, "/sys/class/powercap/%s/max_energy_range_uj", zone) == 0) {
+        (void)snooper_read_file_u64(probe->root, path, &domain->max_energy_uj);
+    }
+
+    char name[SNOOPER_POWER_NAME_MAX];
+    power_read_name(probe->root, zone, name, sizeof(name));
+
+    const char *subzone = strchr(zone + strlen(RAPL_PREFIX), ':');
+    if (subzone) {
+        char parent_zone[64];
+        char parent[SNOOPER_POWER_NAME_MAX];
+        size_t parent_len = (size_t)(subzone - zone);
+        if (parent_len >= sizeof(parent_zone)) parent_len = sizeof(parent_zone) - 1;
+        memcpy(parent_zone, zone, parent_len);
+        parent_zone[parent_len] = '\0';
+        power_read_name(probe->root, parent_zone, parent, sizeof(parent));
+        snprintf(domain->name, sizeof(domain->name), "%.15s/%.15s", parent, name);
+    } else {
+        snprintf(domain->name, sizeof(domain->name), "%s", name);
+        domain->is_package = strncmp(name, "package", 7) == 0;
+    }
+}
+
+SnooperStatus power_probe_init(PowerProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+    (void)snooper_read_engine_init(&probe->reads, 1);
+
+    char path[512];
+    if (snooper_path_format(path, sizeof(path), probe->root, "/sys/class/powercap") != 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        probe->initialized = 1;
+        return SNOOPER_OK;
+    }
+
+    char zones[SNOOPER_MAX_POWER_DOMAINS][64];
+    size_t zone_count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && zone_count < SNOOPER_MAX_POWER_DOMAINS) {
+        if (strncmp(entry->d_name, RAPL_PREFIX, strlen(RAPL_PREFIX)) == 0 && strlen(entry->d_name) < sizeof(zones[0])) {
+            snprintf(zones[zone_count++], sizeof(zones[0]), "%s", entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    qsort(zones, zone_count, sizeof(zones[0]), compare_names);
+    for (size_t i = 0; i < zone_count; ++i) {
+        power_add_domain(probe, zones[i]);
+    }
+
+    probe->initialized = 1;
+    return SNOOPER_OK;
+}
+
+void power_probe_destroy(PowerProbe *probe) {
+    if (!probe) return;
+    for (size_t i = 0; i < probe->domain_count; ++i) {
+        if (probe->domains[i].energy_fd >= 0) {
+            close(probe->domains[i].energy_fd);
+        }
+        probe->domains[i].energy_fd = -1;
+    }
+    snooper_read_engine_destroy(&probe->reads);
+    probe->domain_count = 0;
+    probe->initialized = 0;
+}
+
+SnooperStatus power_probe_sample(PowerProbe *probe,
+                                 uint64_t monotonic_ns,
+                                 double busy_core_seconds,
+                                 SnooperPowerSample *sample) {
+    if (!probe || !sample || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(sample, 0, sizeof(*sample));
+    sample->monotonic_ns = monotonic_ns;
+
+    if (probe->domain_count == 0) {
+        sample->available = 0;
+        return SNOOPER_OK;
+    }
+
+    double seconds = 0.0;
+    if (probe->previous_ns != 0 && monotonic_ns > probe->previous_ns) {
+        seconds = (double)(monotonic_ns - probe->previous_ns) / 1e9;
+    }
+
+    (void)snooper_read_engine_submit(&probe->reads);
+    double package_joules = 0.0;
+    for (size_t i = 0; i < probe->domain_count; ++i) {
+        SnooperPowerDomainState *state = &probe->domains[i];
+        SnooperPowerDomain *domain = &sample->domains[sample->domain_count];
+
+        size_t length = 0;
+        uint64_t energy_uj = 0;
+        const char *view = snooper_read_engine_view(&probe->reads, state->energy_slot, &length);
+        if (!view || !snooper_parse_u64(view, view + length, &energy_uj)) {
+            continue;
+        }
+
+        memcpy(domain->name, state->name, sizeof(domain->name));
+        domain->is_package = state->is_package;
+        if (state->has_previous && seconds > 0.0) {
+            domain->joules = (double)energy_delta(energy_uj, state->previous_uj, state->max_energy_uj) / 1e6;
+            domain->watts = domain->joules / seconds;
+            if (domain->is_package) {
+                package_joules += domain->joules;
+                sample->package_watts += domain->watts;
+            }
+        }
+        state->previous_uj = energy_uj;
+        state->has_previous = 1;
+        sample->domain_count++;
+    }
+
+    int warmup = seconds <= 0.0;
+    probe->previous_ns = monotonic_ns;
+    if (sample->domain_count == 0) {
+        sample->available = 0;
+        return SNOOPER_OK;
+    }
+
+    if (busy_core_seconds > 0.0) {
+        sample->joules_per_busy_core_second = package_joules / busy_core_seconds;
+    }
+
+    sample->available = 1;
+    return warmup ? SNOOPER_ERR_WARMUP : SNOOPER_OK;
+}
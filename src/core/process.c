@@ -0,0 +1,374 @@
+#include "snooper/process.h"
+#include "procfs.h"
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define PROCESS_STAT_SIZE 1024
+#define PROCESS_MAX_FDS 65536
+// Field positions after the ")" closing comm in /proc/<pid>/stat, counting
+// the state field as 0.
+#define STAT_UTIME 11
+#define STAT_STIME 12
+#define STAT_THREADS 17
+#define STAT_START_TIME 19
+#define STAT_RSS 21
+
+static int compare_pids(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static const SnooperProcessTicks *find_previous(const ProcessProbe *probe, int pid) {
+    size_t low = 0;
+    size_t high = probe->previous_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (probe->previous[mid].pid < pid) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < probe->previous_count && probe->previous[low].pid == pid ? &probe->previous[low] : NULL;
+}
+
+static void copy_name(char *out, const char *name, size_t length) {
+    if (length >= SNOOPER_PROCESS_NAME_MAX) {
+        length = SNOOPER_PROCESS_NAME_MAX - 1;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        char c = name[i];
+        out[i] = (c < 0x20 || c == 0x7f || c == '"' || c == '\\') ? '?' : c;
+    }
+    out[length] = '\0';
+}
+
+static void keep_top(SnooperProcessStats *stats, const SnooperProcess *process) {
+    size_t position = stats->top_count;
+    while (position > 0 && stats->top[position - 1].cpu_percent < process->cpu_percent) {
+        --position;
+    }
+    if (position >= SNOOPER_TOP_PROCESSES) {
+        return;
+    }
+    size_t last = stats->top_count < SNOOPER_TOP_PROCESSES ? stats->top_count : SNOOPER_TOP_PROCESSES - 1;
+    memmove(&stats->top[position + 1], &stats->top[position], (last - position) * sizeof(SnooperProcess));
+    stats->top[position] = *process;
+    if (stats->top_count < SNOOPER_TOP_PROCESSES) {
+        stats->top_count++;
+    }
+}
+
+static const char *skip_field(const char *cursor, const char *end) {
+    while (cursor < end && *cursor == ' ') {
+        cursor++;
+    }
+    while (cursor < end && *cursor != ' ') {
+        cursor++;
+    }
+    return cursor;
+}
+
+static int parse_stat(const char *buffer, size_t length, SnooperProcess *process, SnooperProcessTicks *ticks) {
+    const char *end = buffer + length;
+    const char *open = memchr(buffer, '(', length);
+    const char *close = NULL;
+    for (const char *c = end; c > buffer; --c) {
+        if (c[-1] == ')') {
+            close = c - 1;
+            break;
+        }
+    }
+    if (!open || !close || close < open || close + 2 >= end) {
+        return 0;
+    }
+    copy_name(process->name, open + 1, (size_t)(close - open - 1));
+    char state = close[2];
+    process->state = (state >= 'A' && state <= 'Z') || (state >= 'a' && state <= 'z') ? state : '?';
+
+    // Some skipped fields (tpgid, nice) can be negative, so only the ones
+    // kept are parsed as numbers.
+    uint64_t fields[STAT_RSS + 1] = {0};
+    const char *cursor = close + 3;
+    for (int field = 1; field <= STAT_RSS; ++field) {
+        if (field == STAT_UTIME || field == STAT_STIME || field == STAT_THREADS || field == STAT_START_TIME || field == STAT_RSS) {
+            cursor = snooper_parse_u64(cursor, end, &fields[field]);
+            if (!cursor) return 0;
+        } else {
+            cursor = skip_field(cursor, end);
+        }
+    }
+
+    ticks->ticks = fields[STAT_UTIME] + fields[STAT_STIME];
+    ticks->start_time = fields[STAT_START_TIME];
+    process->threads = fields[STAT_THREADS];
+    process->rss_bytes = fields[STAT_RSS];
+    return 1;
+}
+
+// Lists the numeric /proc entries into probe->pids, sorted.
+static SnooperStatus process_scan_pids(ProcessProbe *probe, size_t *count) {
+    char path[512];
+    if (snooper_path_format(path, sizeof(path), probe->root, "/proc") != 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    size_t found = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        char *name_end = NULL;
+        long pid = strtol(entry->d_name, &name_end, 10);
+        if (pid <= 0 || pid > INT_MAX || *name_end != '\0') {
+            continue;
+        }
+        if (found == probe->pid_capacity) {
+            size_t capacity = probe->pid_capacity ? probe->pid_capacity * 2 : 1024;
+            int *grown = realloc(probe->pids, capacity * sizeof(*grown));
+            if (!grown) {
+                closedir(dir);
+                return SNOOPER_ERR_NOMEM;
+            }
+            probe->pids = grown;
+            probe->pid_capacity = capacity;
+        }
+        probe->pids[found++] = (int)pid;
+    }
+    closedir(dir);
+
+    qsort(probe->pids, found, sizeof(*probe->pids), compare_pids);
+    *count = found;
+    return SNOOPER_OK;
+}
+
+static int process_open_stat(ProcessProbe *probe, int pid) {
+    if (probe->open_fds >= probe->fd_budget) {
+        return -1;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    int fd = snooper_open_readonly(probe->root, path);
+    if (fd >= 0) {
+        probe->open_fds++;
+    }
+    return fd;
+}
+
+static void process_close_stat(ProcessProbe *probe, SnooperProcessFd *entry) {
+    if (entry->fd >= 0) {
+        close(entry->fd);
+        probe->open_fds--;
+    }
+    entry->fd = -1;
+}
+
+// Matches the persistent stat fds to this scan's pids: fds of pids that are
+// gone are closed, new pids and ones whose fd went stale are opened, and the
+// read engine is rebuilt only when the fd set changed.
+static SnooperStatus process_sync_fds(ProcessProbe *probe, size_t pid_count) {
+    if (pid_count > probe->fd_capacity) {
+        size_t capacity = probe->fd_capacity ? probe->fd_capacity : 1024;
+        while (capacity < pid_count) capacity *= 2;
+        SnooperProcessFd *next = realloc(probe->next_fds, capacity * sizeof(*next));
+        if (!next) {
+            return SNOOPER_ERR_NOMEM;
+        }
+        probe->next_fds = next;
+        SnooperProcessFd *fds = realloc(probe->fds, capacity * sizeof(*fds));
+        if (!fds) {
+            return SNOOPER_ERR_NOMEM;
+        }
+        probe->fds = fds;
+        probe->fd_capacity = capacity;
+    }
+
+    size_t old = 0;
+    size_t count = 0;
+    int changed = 0;
+    for (size_t i = 0; i < pid_count; ++i) {
+        int pid = probe->pids[i];
+        for (; old < probe->fd_count && probe->fds[old].pid < pid; ++old) {
+            changed |= probe->fds[old].slot >= 0;
+            process_close_stat(probe, &probe->fds[old]);
+        }
+
+        SnooperProcessFd entry = { pid, -1, -1 };
+        if (old < probe->fd_count && probe->fds[old].pid == pid) {
+            entry = probe->fds[old++];
+        }
+        if (entry.fd < 0) {
+            changed |= entry.slot >= 0;
+            entry.fd = process_open_stat(probe, pid);
+            changed |= entry.fd >= 0;
+        }
+        probe->next_fds[count++] = entry;
+    }
+    for (; old < probe->fd_count; ++old) {
+        changed |= probe->fds[old].slot >= 0;
+        process_close_stat(probe, &probe->fds[old]);
+    }
+
+    SnooperProcessFd *swap = probe->fds;
+    probe->fds = probe->next_fds;
+    probe->next_fds = swap;
+    probe->fd_count = count;
+
+    if (changed) {
+        snooper_read_engine_clear(&probe->reads);
+        for (size_t i = 0; i < count; ++i) {
+            SnooperProcessFd *entry = &probe->fds[i];
+            entry->slot = entry->fd >= 0 ? snooper_read_engine_add(&probe->reads, entry->fd, PROCESS_STAT_SIZE) : -1;
+        }
+    }
+    return SNOOPER_OK;
+}
+
+SnooperStatus process_probe_init(ProcessProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+    long hz = sysconf(_SC_CLK_TCK);
+    long page = sysconf(_SC_PAGESIZE);
+    probe->ticks_per_sec = hz > 0 ? (double)hz : 100.0;
+    probe->page_size = page > 0 ? (uint64_t)page : 4096;
+
+    // Each pid keeps its stat fd open between samples, within half the fd
+    // limit so the rest of the process still has room. Pids past the budget
+    // are read with open/read/close.
+    struct rlimit limit;
+    probe->fd_budget = PROCESS_MAX_FDS;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur / 2 < PROCESS_MAX_FDS) {
+        probe->fd_budget = (size_t)(limit.rlim_cur / 2);
+    }
+    (void)snooper_read_engine_init(&probe->reads, 1);
+    probe->initialized = 1;
+    return SNOOPER_OK;
+}
+
+void process_probe_destroy(ProcessProbe *probe) {
+    if (!probe) return;
+    for (size_t i = 0; i < probe->fd_count; ++i) {
+        process_close_stat(probe, &probe->fds[i]);
+    }
+    snooper_read_engine_destroy(&probe->reads);
+    free(probe->fds);
+    free(probe->next_fds);
+    free(probe->pids);
+    probe->fds = NULL;
+    probe->next_fds = NULL;
+    probe->pids = NULL;
+    probe->fd_count = 0;
+    probe->fd_capacity = 0;
+    probe->pid_capacity = 0;
+    free(probe->previous);
+    free(probe->current);
+    probe->previous = NULL;
+    probe->current = NULL;
+    probe->previous_count = 0;
+    probe->previous_capacity = 0;
+    probe->capacity = 0;
+    probe->initialized = 0;
+}
+
+SnooperStatus process_probe_sample(ProcessProbe *probe, uint64_t monotonic_ns, SnooperProcessStats *stats) {
+    if (!probe || !stats || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    size_t pid_count = 0;
+    SnooperStatus status = process_scan_pids(probe, &pid_count);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+    status = process_sync_fds(probe, pid_count);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->monotonic_ns = monotonic_ns;
+
+    int warmup = probe->previous_ns == 0 || monotonic_ns <= probe->previous_ns;
+    double scale = warmup ? 0.0 : 100.0 * 1e9 / ((double)(monotonic_ns - probe->previous_ns) * probe->ticks_per_sec);
+
+    (void)snooper_read_engine_submit(&probe->reads);
+
+    size_t count = 0;
+    char buffer[PROCESS_STAT_SIZE];
+    for (size_t i = 0; i < probe->fd_count; ++i) {
+        SnooperProcessFd *entry = &probe->fds[i];
+        size_t length = 0;
+        const char *view = NULL;
+        if (entry->fd >= 0) {
+            view = snooper_read_engine_view(&probe->reads, entry->slot, &length);
+            if (!view) {
+                // The process exited, possibly with its pid reused; the old
+                // fd never reads again, so reopen it on the next sample.
+                process_close_stat(probe, entry);
+            }
+        }
+        if (!view) {
+            // Processes can exit between the scan and the read; skip them.
+            char stat_path[64];
+            snprintf(stat_path, sizeof(stat_path), "/proc/%d/stat", entry->pid);
+            if (snooper_read_file(probe->root, stat_path, buffer, sizeof(buffer), &length) != SNOOPER_OK) {
+                continue;
+            }
+            view = buffer;
+        }
+
+        SnooperProcess process;
+        SnooperProcessTicks ticks;
+        memset(&process, 0, sizeof(process));
+        if (!parse_stat(view, length, &process, &ticks)) {
+            continue;
+        }
+        process.pid = entry->pid;
+        process.rss_bytes *= probe->page_size;
+        ticks.pid = entry->pid;
+
+        if (count == probe->capacity) {
+            size_t capacity = probe->capacity ? probe->capacity * 2 : 1024;
+            SnooperProcessTicks *grown = realloc(probe->current, capacity * sizeof(*grown));
+            if (!grown) {
+                return SNOOPER_ERR_NOMEM;
+            }
+            probe->current = grown;
+            probe->capacity = capacity;
+        }
+        probe->current[count++] = ticks;
+
+        const SnooperProcessTicks *previous = find_previous(probe, process.pid);
+        if (scale > 0.0 && previous && previous->start_time == ticks.start_time && ticks.ticks >= previous->ticks) {
+            process.cpu_percent = (double)(ticks.ticks - previous->ticks) * scale;
+        }
+        keep_top(stats, &process);
+        stats->process_count++;
+        stats->thread_count += process.threads;
+    }
+
+    // fds are kept in pid order, so current is already sorted for
+    // find_previous.
+    SnooperProcessTicks *swap = probe->previous;
+    size_t swap_capacity = probe->previous_capacity;
+    probe->previous = probe->current;
+    probe->previous_capacity = probe->capacity;
+    probe->previous_count = count;
+    probe->current = swap;
+    probe->capacity = swap_capacity;
+
+    probe->previous_ns = monotonic_ns;
+    return warmup ? SNOOPER_ERR_WARMUP : SNOOPER_OK;
+}
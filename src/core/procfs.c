@@ -0,0 +1,163 @@
+#include "procfs.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const char *snooper_fs_root(void) {
+    const char *root = getenv("SNOOPER_FS_ROOT");
+    return root ? root : "";
+}
+
+int snooper_path_format(char *out, size_t size, const char *root, const char *fmt, ...) {
+    if (!out || size == 0 || !fmt) {
+        return -1;
+    }
+
+    int prefix = snprintf(out, size, "%s", root ? root : "");
+    if (prefix < 0 || (size_t)prefix >= size) {
+        return -1;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(out + prefix, size - (size_t)prefix, fmt, args);
+    va_end(args);
+
+    if (written < 0 || (size_t)(prefix + written) >= size) {
+        return -1;
+    }
+    return 0;
+}
+
+int snooper_open_readonly(const char *root, const char *path) {
+    char full[512];
+    if (snooper_path_format(full, sizeof(full), root, "%s", path) != 0) {
+        return -1;
+    }
+    return open(full, O_RDONLY | O_CLOEXEC);
+}
+
+SnooperStatus snooper_read_fd(int fd, char *buffer, size_t capacity, size_t *length) {
+    if (fd < 0 || !buffer || capacity == 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    // procfs and sysfs regenerate their contents on a read at offset 0, so a
+    // persistent fd can be re-read with pread instead of being reopened.
+    size_t used = 0;
+    while (used + 1 < capacity) {
+        ssize_t n = pread(fd, buffer + used, capacity - 1 - used, (off_t)used);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return SNOOPER_ERR_UNAVAILABLE;
+        }
+        if (n == 0) break;
+        used += (size_t)n;
+    }
+
+    buffer[used] = '\0';
+    if (length) *length = used;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_read_file(const char *root, const char *path, char *buffer, size_t capacity, size_t *length) {
+    int fd = snooper_open_readonly(root, path);
+    if (fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    SnooperStatus status = snooper_read_fd(fd, buffer, capacity, length);
+    close(fd);
+    return status;
+}
+
+SnooperStatus snooper_read_file_u64(const char *root, const char *path, uint64_t *value) {
+    char buffer[64];
+    size_t length = 0;
+    SnooperStatus status = snooper_read_file(root, path, buffer, sizeof(buffer), &length);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+    if (!snooper_parse_u64(buffer, buffer + length, value)) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    return SNOOPER_OK;
+}
+
+const char *snooper_parse_u64(const char *cursor, const char *end, uint64_t *value) {
+    if (!cursor || !value) {
+        return NULL;
+    }
+
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+        cursor++;
+    }
+    if (cursor >= end || *cursor < '0' || *cursor > '9') {
+        return NULL;
+    }
+
+    uint64_t result = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        result = result * 10u + (uint64_t)(*cursor - '0');
+        cursor++;
+    }
+
+    *value = result;
+    return cursor;
+}
+
+const char *snooper_skip_line(const char *cursor, const char *end) {
+    while (cursor < end && *cursor != '\n') {
+        cursor++;
+    }
+    return cursor < end ? cursor + 1 : end;
+}
+
+SnooperStatus snooper_write_file_atomic(const char *path, const struct iovec *parts, int part_count) {
+    if (!path || (!parts && part_count > 0)) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    char temporary[1024];
+    int length = snprintf(temporary, sizeof(temporary), "%s.tmp.%ld", path, (long)getpid());
+    if (length < 0 || (size_t)length >= sizeof(temporary)) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    for (int i = 0; i < part_count; ++i) {
+        const char *data = parts[i].iov_base;
+        size_t remaining = parts[i].iov_len;
+        while (remaining > 0) {
+            ssize_t n = write(fd, data, remaining);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                close(fd);
+                unlink(temporary);
+                return SNOOPER_ERR_UNAVAILABLE;
+            }
+            data += n;
+            remaining -= (size_t)n;
+        }
+    }
+
+    // The rename only publishes the file once its contents are durable, so a
+    // reader never observes a torn dump.
+    int failed = fsync(fd) != 0;
+    if (close(fd) != 0 || failed) {
+        unlink(temporary);
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    if (rename(temporary, path) != 0) {
+        unlink(temporary);
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    return SNOOPER_OK;
+}
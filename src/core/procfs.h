@@ -0,0 +1,19 @@
+#ifndef SNOOPER_PROCFS_H
+#define SNOOPER_PROCFS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "snooper/errors.h"
+
+const char *snooper_fs_root(void);
+int snooper_path_format(char *out, size_t size, const char *root, const char *fmt, ...);
+int snooper_open_readonly(const char *root, const char *path);
+SnooperStatus snooper_read_fd(int fd, char *buffer, size_t capacity, size_t *length);
+SnooperStatus snooper_read_file(const char *root, const char *path, char *buffer, size_t capacity, size_t *length);
+SnooperStatus snooper_read_file_u64(const char *root, const char *path, uint64_t *value);
+const char *snooper_parse_u64(const char *cursor, const char *end, uint64_t *value);
+SnooperStatus snooper_write_file_atomic(const char *path, const struct iovec *parts, int part_count);
+const char *snooper_skip_line(const char *cursor, const char *end);
+
+#endif
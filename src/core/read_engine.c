@@ -0,0 +1,346 @@
+#include "snooper/read_engine.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define SNOOPER_HAVE_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#define READ_ENGINE_RING_ENTRIES 256
+
+#ifdef SNOOPER_HAVE_URING
+
+static int uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, const void *arg, unsigned count) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+static unsigned *ring_field(void *ring, uint32_t offset) {
+    return (unsigned *)((char *)ring + offset);
+}
+
+static void uring_close(SnooperUring *uring) {
+    if (uring->sqes) munmap(uring->sqes, uring->sqes_size);
+    if (uring->cq_ring && uring->cq_ring != uring->sq_ring) munmap(uring->cq_ring, uring->cq_ring_size);
+    if (uring->sq_ring) munmap(uring->sq_ring, uring->sq_ring_size);
+    if (uring->ring_fd >= 0) close(uring->ring_fd);
+    memset(uring, 0, sizeof(*uring));
+    uring->ring_fd = -1;
+}
+
+static int uring_open(SnooperUring *uring) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    uring->ring_fd = uring_setup(READ_ENGINE_RING_ENTRIES, &params);
+    if (uring->ring_fd < 0) {
+        uring->ring_fd = -1;
+        return -1;
+    }
+
+    uring->entries = params.sq_entries;
+    uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (uring->cq_ring_size > uring->sq_ring_size) uring->sq_ring_size = uring->cq_ring_size;
+        uring->cq_ring_size = uring->sq_ring_size;
+    }
+    uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQ_RING);
+    if (uring->sq_ring == MAP_FAILED) {
+        uring->sq_ring = NULL;
+        uring_close(uring);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        uring->cq_ring = uring->sq_ring;
+    } else {
+        uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_CQ_RING);
+        if (uring->cq_ring == MAP_FAILED) {
+            uring->cq_ring = NULL;
+            uring_close(uring);
+            return -1;
+        }
+    }
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        uring->sqes = NULL;
+        uring_close(uring);
+        return -1;
+    }
+    uring->sq_tail = ring_field(uring->sq_ring, params.sq_off.tail);
+    uring->sq_mask = ring_field(uring->sq_ring, params.sq_off.ring_mask);
+    uring->sq_array = ring_field(uring->sq_ring, params.sq_off.array);
+    uring->cq_head = ring_field(uring->cq_ring, params.cq_off.head);
+    uring->cq_tail = ring_field(uring->cq_ring, params.cq_off.tail);
+    uring->cq_mask = ring_field(uring->cq_ring, params.cq_off.ring_mask);
+    uring->cqes = (char *)uring->cq_ring + params.cq_off.cqes;
+    return 0;
+}
+
+// Registration lets the kernel skip the fd table lookup and the page pinning
+// of the destination on every read. Either step failing (old kernel, memlock
+// limit) only drops back to plain READV with ordinary fds.
+static void uring_register_slots(SnooperReadEngine *engine) {
+    SnooperUring *uring = &engine->uring;
+    if (uring->files_registered) {
+        uring_register(uring->ring_fd, IORING_UNREGISTER_FILES, NULL, 0);
+        uring->files_registered = 0;
+    }
+    if (uring->buffers_registered) {
+        uring_register(uring->ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+        uring->buffers_registered = 0;
+    }
+    if (engine->slot_count == 0) {
+        return;
+    }
+
+    int *fds = malloc(engine->slot_count * sizeof(int));
+    if (fds) {
+        for (size_t i = 0; i < engine->slot_count; ++i) {
+            fds[i] = engine->slots[i].fd;
+        }
+        uring->files_registered = uring_register(uring->ring_fd, IORING_REGISTER_FILES, fds, (unsigned)engine->slot_count) == 0;
+        free(fds);
+    }
+
+    struct iovec arena = { engine->arena, engine->arena_capacity };
+    uring->buffers_registered = uring_register(uring->ring_fd, IORING_REGISTER_BUFFERS, &arena, 1) == 0;
+}
+
+static int uring_submit(SnooperReadEngine *engine) {
+    SnooperUring *uring = &engine->uring;
+    unsigned *sq_tail = uring->sq_tail;
+    unsigned sq_mask = *uring->sq_mask;
+    unsigned *sq_array = uring->sq_array;
+    unsigned *cq_head = uring->cq_head;
+    unsigned *cq_tail = uring->cq_tail;
+    unsigned cq_mask = *uring->cq_mask;
+    struct io_uring_sqe *sqes = uring->sqes;
+    const struct io_uring_cqe *cqes = uring->cqes;
+
+    size_t next = 0;
+    while (next < engine->slot_count) {
+        unsigned tail = *sq_tail;
+        unsigned batch = 0;
+        while (next < engine->slot_count && batch < uring->entries) {
+            SnooperReadSlot *slot = &engine->slots[next];
+            unsigned index = tail & sq_mask;
+            struct io_uring_sqe *sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            if (uring->files_registered) {
+                sqe->fd = (int)next;
+                sqe->flags = IOSQE_FIXED_FILE;
+            } else {
+                sqe->fd = slot->fd;
+            }
+            if (uring->buffers_registered) {
+                sqe->opcode = IORING_OP_READ_FIXED;
+                sqe->addr = (uint64_t)(uintptr_t)(engine->arena + slot->offset);
+                sqe->len = (uint32_t)slot->capacity;
+                sqe->buf_index = 0;
+            } else {
+                sqe->opcode = IORING_OP_READV;
+                sqe->addr = (uint64_t)(uintptr_t)&engine->iov[next];
+                sqe->len = 1;
+            }
+            sqe->off = 0;
+            sqe->user_data = next;
+            sq_array[index] = index;
+            ++tail;
+            ++batch;
+            ++next;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        unsigned submitted = 0;
+        while (submitted < batch) {
+            int rc = uring_enter(uring->ring_fd, batch - submitted, batch - submitted, IORING_ENTER_GETEVENTS);
+            engine->syscalls++;
+            if (rc < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            submitted += (unsigned)rc;
+        }
+
+        unsigned completed = 0;
+        while (completed < batch) {
+            unsigned head = *cq_head;
+            unsigned ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            if (head == ready) {
+                int rc = uring_enter(uring->ring_fd, 0, batch - completed, IORING_ENTER_GETEVENTS);
+                engine->syscalls++;
+                if (rc < 0 && errno != EINTR) return -1;
+                continue;
+            }
+            for (; head != ready; ++head, ++completed) {
+                const struct io_uring_cqe *cqe = &cqes[head & cq_mask];
+                SnooperReadSlot *slot = &engine->slots[cqe->user_data];
+                slot->ok = cqe->res >= 0;
+                slot->length = cqe->res >= 0 ? (size_t)cqe->res : 0;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+    }
+    return 0;
+}
+
+#endif
+
+static void submit_preadv(SnooperReadEngine *engine) {
+    for (size_t i = 0; i < engine->slot_count; ++i) {
+        SnooperReadSlot *slot = &engine->slots[i];
+        ssize_t n;
+        do {
+            n = preadv(slot->fd, &engine->iov[i], 1, 0);
+        } while (n < 0 && errno == EINTR);
+        engine->syscalls++;
+        slot->ok = n >= 0;
+        slot->length = n >= 0 ? (size_t)n : 0;
+    }
+}
+
+SnooperStatus snooper_read_engine_init(SnooperReadEngine *engine, int use_uring) {
+    if (!engine) return SNOOPER_ERR_INVALID;
+    memset(engine, 0, sizeof(*engine));
+    engine->uring.ring_fd = -1;
+
+    const char *mode = getenv("SNOOPER_READ_ENGINE");
+    if (mode && strcmp(mode, "preadv") == 0) {
+        use_uring = 0;
+    }
+#ifdef SNOOPER_HAVE_URING
+    // The ring itself is set up on the first submit that has slots.
+    engine->use_uring = use_uring ? 1 : 0;
+#else
+    (void)use_uring;
+#endif
+    return SNOOPER_OK;
+}
+
+void snooper_read_engine_destroy(SnooperReadEngine *engine) {
+    if (!engine) return;
+#ifdef SNOOPER_HAVE_URING
+    if (engine->uring.ring_fd >= 0) {
+        uring_close(&engine->uring);
+    }
+#endif
+    free(engine->slots);
+    free(engine->iov);
+    free(engine->arena);
+    memset(engine, 0, sizeof(*engine));
+    engine->uring.ring_fd = -1;
+}
+
+// The engine does not own fd; the caller keeps it open while the slot is in
+// use and closes it afterwards. Returns the slot index, or -1.
+int snooper_read_engine_add(SnooperReadEngine *engine, int fd, size_t capacity) {
+    if (!engine || fd < 0 || capacity == 0) return -1;
+
+    if (engine->slot_count == engine->slot_capacity) {
+        size_t slot_capacity = engine->slot_capacity ? engine->slot_capacity * 2 : 16;
+        SnooperReadSlot *slots = realloc(engine->slots, slot_capacity * sizeof(*slots));
+        if (!slots) return -1;
+        engine->slots = slots;
+        struct iovec *iov = realloc(engine->iov, slot_capacity * sizeof(*iov));
+        if (!iov) return -1;
+        engine->iov = iov;
+        engine->slot_capacity = slot_capacity;
+    }
+
+    // One spare byte per slot keeps every view NUL-terminated.
+    size_t needed = engine->arena_used + capacity + 1;
+    if (needed > engine->arena_capacity) {
+        size_t arena_capacity = engine->arena_capacity ? engine->arena_capacity : 4096;
+        while (arena_capacity < needed) arena_capacity *= 2;
+        char *arena = realloc(engine->arena, arena_capacity);
+        if (!arena) return -1;
+        engine->arena = arena;
+        engine->arena_capacity = arena_capacity;
+        for (size_t i = 0; i < engine->slot_count; ++i) {
+            engine->iov[i].iov_base = engine->arena + engine->slots[i].offset;
+        }
+    }
+
+    size_t index = engine->slot_count++;
+    SnooperReadSlot *slot = &engine->slots[index];
+    slot->fd = fd;
+    slot->offset = engine->arena_used;
+    slot->capacity = capacity;
+    slot->length = 0;
+    slot->ok = 0;
+    engine->iov[index].iov_base = engine->arena + slot->offset;
+    engine->iov[index].iov_len = capacity;
+    engine->arena_used = needed;
+    engine->dirty = 1;
+    return (int)index;
+}
+
+// Drops every slot but keeps the allocations, for callers whose fd set
+// changes (e.g. one fd per pid). Slots added afterwards are registered again
+// on the next submit.
+void snooper_read_engine_clear(SnooperReadEngine *engine) {
+    if (!engine) return;
+    engine->slot_count = 0;
+    engine->arena_used = 0;
+    engine->dirty = 1;
+}
+
+SnooperStatus snooper_read_engine_submit(SnooperReadEngine *engine) {
+    if (!engine) return SNOOPER_ERR_INVALID;
+    if (engine->slot_count == 0) return SNOOPER_OK;
+
+#ifdef SNOOPER_HAVE_URING
+    if (engine->use_uring && engine->uring.ring_fd < 0 && uring_open(&engine->uring) != 0) {
+        engine->use_uring = 0;
+    }
+    if (engine->use_uring) {
+        if (engine->dirty) {
+            uring_register_slots(engine);
+            engine->dirty = 0;
+        }
+        if (uring_submit(engine) != 0) {
+            // A ring that fails mid-flight (e.g. seccomp) is dropped for good.
+            uring_close(&engine->uring);
+            engine->use_uring = 0;
+            submit_preadv(engine);
+        }
+    } else {
+        submit_preadv(engine);
+    }
+#else
+    submit_preadv(engine);
+#endif
+
+    for (size_t i = 0; i < engine->slot_count; ++i) {
+        const SnooperReadSlot *slot = &engine->slots[i];
+        engine->arena[slot->offset + slot->length] = '\0';
+    }
+    return SNOOPER_OK;
+}
+
+const char *snooper_read_engine_view(const SnooperReadEngine *engine, int slot, size_t *length) {
+    if (!engine || slot < 0 || (size_t)slot >= engine->slot_count || !engine->slots[slot].ok) {
+        return NULL;
+    }
+    if (length) *length = engine->slots[slot].length;
+    return engine->arena + engine->slots[slot].offset;
+}
+
+const char *snooper_read_engine_backend(const SnooperReadEngine *engine) {
+    return engine && engine->use_uring ? "io_uring" : "preadv";
+}
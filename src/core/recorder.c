@@ -0,0 +1,184 @@
+#include "snooper/recorder.h"
+#include "procfs.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t *out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static uint64_t get_u64(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static uint16_t quantize(double value) {
+    if (value <= 0.0) return 0;
+    double scaled = value * 100.0 + 0.5;
+    return scaled >= (double)(SNOOPER_RECORDER_NO_VALUE - 1) ? (uint16_t)(SNOOPER_RECORDER_NO_VALUE - 1) : (uint16_t)scaled;
+}
+
+static double dequantize(uint16_t value) {
+    return (double)value / 100.0;
+}
+
+SnooperStatus snooper_recorder_init(SnooperRecorder *recorder, size_t capacity, size_t core_count, uint64_t session_id, uint32_t interval_ms) {
+    if (!recorder || capacity == 0 || core_count > SNOOPER_MAX_CPUS) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->header.session_id = session_id;
+    recorder->header.core_count = (uint32_t)core_count;
+    recorder->header.record_size = (uint32_t)(SNOOPER_RECORDER_FIXED_SIZE + 4 * core_count);
+    recorder->header.interval_ms = interval_ms;
+
+    recorder->records = calloc(capacity, recorder->header.record_size);
+    if (!recorder->records) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    recorder->capacity = capacity;
+    return SNOOPER_OK;
+}
+
+void snooper_recorder_destroy(SnooperRecorder *recorder) {
+    if (!recorder) return;
+    free(recorder->records);
+    memset(recorder, 0, sizeof(*recorder));
+}
+
+void snooper_recorder_append(SnooperRecorder *recorder, const SnooperSnapshot *snapshot) {
+    if (!recorder || !recorder->records || !snapshot) return;
+
+    if (!recorder->has_wall_offset) {
+        recorder->header.wall_offset_ns = snapshot->wall_offset_ns;
+        recorder->has_wall_offset = 1;
+    }
+
+    uint8_t *record = recorder->records + recorder->head * recorder->header.record_size;
+    put_u64(record, snapshot->monotonic_ns);
+    put_u16(record + 8, quantize(snapshot->cpu_used_percent));
+    put_u16(record + 10, snapshot->gpu_available ? quantize(snapshot->gpu_used_percent) : SNOOPER_RECORDER_NO_VALUE);
+    put_u16(record + 12, snapshot->power.available ? quantize(snapshot->power.package_watts) : SNOOPER_RECORDER_NO_VALUE);
+    put_u16(record + 14, 0);
+
+    uint8_t *cores = record + SNOOPER_RECORDER_FIXED_SIZE;
+    for (size_t i = 0; i < recorder->header.core_count; ++i) {
+        const SnooperCpuUsage *core = i < snapshot->core_count ? &snapshot->per_core[i] : NULL;
+        put_u16(cores + 4 * i, core ? quantize(core->user) : 0);
+        put_u16(cores + 4 * i + 2, core ? quantize(core->system) : 0);
+    }
+
+    recorder->head = (recorder->head + 1) % recorder->capacity;
+    if (recorder->count < recorder->capacity) {
+        ++recorder->count;
+    }
+}
+
+SnooperStatus snooper_recorder_dump(const SnooperRecorder *recorder, const char *path) {
+    if (!recorder || !recorder->records || !path) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    uint8_t header[SNOOPER_RECORDER_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, SNOOPER_RECORDER_MAGIC, 8);
+    put_u32(header + 8, SNOOPER_RECORDER_VERSION);
+    put_u32(header + 12, recorder->header.core_count);
+    put_u32(header + 16, recorder->header.record_size);
+    put_u32(header + 20, recorder->header.interval_ms);
+    put_u32(header + 24, (uint32_t)recorder->count);
+    put_u64(header + 32, recorder->header.session_id);
+    put_u64(header + 40, (uint64_t)recorder->header.wall_offset_ns);
+
+    size_t record_size = recorder->header.record_size;
+    size_t oldest = (recorder->head + recorder->capacity - recorder->count) % recorder->capacity;
+    size_t first_run = recorder->capacity - oldest < recorder->count ? recorder->capacity - oldest : recorder->count;
+
+    struct iovec parts[3];
+    parts[0].iov_base = header;
+    parts[0].iov_len = sizeof(header);
+    parts[1].iov_base = recorder->records + oldest * record_size;
+    parts[1].iov_len = first_run * record_size;
+    parts[2].iov_base = recorder->records;
+    parts[2].iov_len = (recorder->count - first_run) * record_size;
+    return snooper_write_file_atomic(path, parts, 3);
+}
+
+SnooperStatus snooper_recorder_header_decode(const uint8_t *bytes, size_t length, SnooperRecorderHeader *out) {
+    if (!bytes || !out || length < SNOOPER_RECORDER_HEADER_SIZE) {
+        return SNOOPER_ERR_INVALID;
+    }
+    if (memcmp(bytes, SNOOPER_RECORDER_MAGIC, 8) != 0 || get_u32(bytes + 8) != SNOOPER_RECORDER_VERSION) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    out->core_count = get_u32(bytes + 12);
+    out->record_size = get_u32(bytes + 16);
+    out->interval_ms = get_u32(bytes + 20);
+    out->record_count = get_u32(bytes + 24);
+    out->session_id = get_u64(bytes + 32);
+    out->wall_offset_ns = (int64_t)get_u64(bytes + 40);
+    if (out->core_count > SNOOPER_MAX_CPUS || out->record_size != SNOOPER_RECORDER_FIXED_SIZE + 4 * out->core_count) {
+        return SNOOPER_ERR_INVALID;
+    }
+    return SNOOPER_OK;
+}
+
+void snooper_recorder_record_decode(const SnooperRecorderHeader *header, const uint8_t *record, SnooperSnapshot *out) {
+    if (!header || !record || !out) return;
+
+    memset(out, 0, sizeof(*out));
+    out->session_id = header->session_id;
+    out->monotonic_ns = get_u64(record);
+    out->wall_offset_ns = header->wall_offset_ns;
+    int64_t wall_ns = (int64_t)out->monotonic_ns + header->wall_offset_ns;
+    out->wall_time.tv_sec = (time_t)(wall_ns / 1000000000LL);
+    out->wall_time.tv_nsec = (long)(wall_ns % 1000000000LL);
+    out->cpu_used_percent = dequantize(get_u16(record + 8));
+
+    uint16_t gpu = get_u16(record + 10);
+    out->gpu_available = gpu != SNOOPER_RECORDER_NO_VALUE;
+    out->gpu_used_percent = out->gpu_available ? dequantize(gpu) : 0.0;
+
+    uint16_t watts = get_u16(record + 12);
+    out->power.available = watts != SNOOPER_RECORDER_NO_VALUE;
+    out->power.package_watts = out->power.available ? dequantize(watts) : 0.0;
+
+    const uint8_t *cores = record + SNOOPER_RECORDER_FIXED_SIZE;
+    out->core_count = header->core_count;
+    for (size_t i = 0; i < header->core_count; ++i) {
+        SnooperCpuUsage *core = &out->per_core[i];
+        core->user = dequantize(get_u16(cores + 4 * i));
+        core->system = dequantize(get_u16(cores + 4 * i + 2));
+        core->idle = core->user + core->system < 100.0 ? 100.0 - core->user - core->system : 0.0;
+    }
+}
@@ -0,0 +1,334 @@
+#include "snooper/rules.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RULE_TOKEN_MAX 16
+
+static SnooperStatus compile_error(char *error, size_t error_size, const char *fmt, ...) {
+    if (error && error_size > 0) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(error, error_size, fmt, args);
+        va_end(args);
+    }
+    return SNOOPER_ERR_INVALID;
+}
+
+static int parse_threshold(const char *text, double *out) {
+    char *end = NULL;
+    double value = strtod(text, &end);
+    if (end == text) {
+        return -1;
+    }
+    if (*end == 'k') { value *= 1e3; ++end; }
+    else if (*end == 'M') { value *= 1e6; ++end; }
+    else if (*end == 'G') { value *= 1e9; ++end; }
+    if (*end == '%') ++end;
+    else if (strcmp(end, "ms") == 0) end += 2;
+    if (*end != '\0') {
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+static int parse_duration(const char *text, uint64_t *out) {
+    char *end = NULL;
+    double value = strtod(text, &end);
+    if (end == text || value < 0.0) {
+        return -1;
+    }
+    double scale = 1e9;
+    if (strcmp(end, "ms") == 0) scale = 1e6;
+    else if (strcmp(end, "m") == 0) scale = 60e9;
+    else if (strcmp(end, "h") == 0) scale = 3600e9;
+    else if (*end != '\0' && strcmp(end, "s") != 0) return -1;
+    *out = (uint64_t)(value * scale);
+    return 0;
+}
+
+static int parse_operator(const char *text, SnooperRuleOperator *op) {
+    if (strcmp(text, ">") == 0) *op = SNOOPER_RULE_GT;
+    else if (strcmp(text, ">=") == 0) *op = SNOOPER_RULE_GE;
+    else if (strcmp(text, "<") == 0) *op = SNOOPER_RULE_LT;
+    else if (strcmp(text, "<=") == 0) *op = SNOOPER_RULE_LE;
+    else return -1;
+    return 0;
+}
+
+static int compare(SnooperRuleOperator op, double value, double threshold) {
+    switch (op) {
+        case SNOOPER_RULE_GT: return value > threshold;
+        case SNOOPER_RULE_GE: return value >= threshold;
+        case SNOOPER_RULE_LT: return value < threshold;
+        case SNOOPER_RULE_LE: return value <= threshold;
+    }
+    return 0;
+}
+
+void snooper_rules_init(SnooperRuleSet *rules) {
+    if (!rules) return;
+    memset(rules, 0, sizeof(*rules));
+}
+
+void snooper_rules_destroy(SnooperRuleSet *rules) {
+    if (!rules) return;
+    free(rules->ops);
+    free(rules->slots);
+    memset(rules, 0, sizeof(*rules));
+}
+
+SnooperStatus snooper_rules_compile(SnooperRuleSet *rules, const char *text, char *error, size_t error_size) {
+    if (!rules || !text) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    char line[512];
+    if (strlen(text) >= sizeof(line)) {
+        return compile_error(error, error_size, "rule too long");
+    }
+    strcpy(line, text);
+
+    char *tokens[RULE_TOKEN_MAX];
+    size_t count = 0;
+    for (char *token = strtok(line, " \t\r\n"); token; token = strtok(NULL, " \t\r\n")) {
+        if (count == RULE_TOKEN_MAX) {
+            return compile_error(error, error_size, "too many tokens");
+        }
+        tokens[count++] = token;
+    }
+
+    SnooperRuleOp op;
+    memset(&op, 0, sizeof(op));
+    size_t t = 0;
+    if (count > 0 && tokens[0][strlen(tokens[0]) - 1] == ':') {
+        tokens[0][strlen(tokens[0]) - 1] = '\0';
+        snprintf(op.name, sizeof(op.name), "%s", tokens[0]);
+        ++t;
+    }
+    if (count - t < 3) {
+        return compile_error(error, error_size, "expected <metric> <op> <threshold>");
+    }
+
+    char *metric = tokens[t++];
+    size_t metric_length = strlen(metric);
+    if (strncmp(metric, "rate(", 5) == 0 && metric[metric_length - 1] == ')') {
+        metric[metric_length - 1] = '\0';
+        metric += 5;
+        op.is_rate = 1;
+    }
+    if (snooper_metric_parse(metric, &op.metric) != SNOOPER_OK) {
+        return compile_error(error, error_size, "unknown metric '%s'", metric);
+    }
+    if (parse_operator(tokens[t++], &op.op) != 0) {
+        return compile_error(error, error_size, "unknown operator '%s'", tokens[t - 1]);
+    }
+    if (parse_threshold(tokens[t++], &op.threshold) != 0) {
+        return compile_error(error, error_size, "invalid threshold '%s'", tokens[t - 1]);
+    }
+    op.clear_threshold = op.threshold;
+
+    while (t < count) {
+        const char *keyword = tokens[t++];
+        if (t == count) {
+            return compile_error(error, error_size, "missing value after '%s'", keyword);
+        }
+        const char *value = tokens[t++];
+        int rc;
+        if (strcmp(keyword, "for") == 0) {
+            rc = parse_duration(value, &op.for_ns);
+        } else if (strcmp(keyword, "hold") == 0) {
+            rc = parse_duration(value, &op.hold_ns);
+        } else if (strcmp(keyword, "clear") == 0) {
+            rc = parse_threshold(value, &op.clear_threshold);
+        } else {
+            return compile_error(error, error_size, "unknown keyword '%s'", keyword);
+        }
+        if (rc != 0) {
+            return compile_error(error, error_size, "invalid value '%s' for '%s'", value, keyword);
+        }
+    }
+
+    if (op.name[0] == '\0') {
+        snprintf(op.name, sizeof(op.name), "%s", text);
+        for (char *c = op.name; *c; ++c) {
+            if (*c == '\n' || *c == '\r') *c = '\0';
+        }
+    }
+
+    op.slot_offset = rules->slot_count;
+    op.slot_count = snooper_metric_is_pattern(&op.metric) ? snooper_metric_slot_count(&op.metric) : 1;
+
+    SnooperRuleOp *ops = realloc(rules->ops, (rules->op_count + 1) * sizeof(*ops));
+    if (!ops) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    rules->ops = ops;
+    SnooperRuleSlot *slots = realloc(rules->slots, (rules->slot_count + op.slot_count) * sizeof(*slots));
+    if (!slots) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    rules->slots = slots;
+    memset(&rules->slots[rules->slot_count], 0, op.slot_count * sizeof(*slots));
+    rules->slot_count += op.slot_count;
+    rules->ops[rules->op_count++] = op;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_rules_load_file(SnooperRuleSet *rules, const char *path, char *error, size_t error_size) {
+    if (!rules || !path) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return compile_error(error, error_size, "cannot open %s", path);
+    }
+
+    char line[512];
+    int number = 0;
+    SnooperStatus status = SNOOPER_OK;
+    while (status == SNOOPER_OK && fgets(line, sizeof(line), file)) {
+        ++number;
+        char *start = line;
+        while (isspace((unsigned char)*start)) ++start;
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+
+        char detail[256] = "";
+        status = snooper_rules_compile(rules, start, detail, sizeof(detail));
+        if (status != SNOOPER_OK) {
+            compile_error(error, error_size, "%s:%d: %s", path, number, detail);
+        }
+    }
+
+    fclose(file);
+    return status;
+}
+
+typedef struct {
+    SnooperRuleSet *rules;
+    const SnooperRuleOp *op;
+    const SnooperSnapshot *snapshot;
+    SnooperRuleSink sink;
+    void *context;
+} EvaluationContext;
+
+static void emit(EvaluationContext *ctx, const SnooperMetricId *id, SnooperRuleState state, double value, double threshold) {
+    if (!ctx->sink) return;
+
+    SnooperRuleEvent event;
+    event.rule = ctx->op->name;
+    event.metric = id;
+    event.state = state;
+    event.value = value;
+    event.threshold = threshold;
+    event.monotonic_ns = ctx->snapshot->monotonic_ns;
+    event.wall_time = ctx->snapshot->wall_time;
+    ctx->sink(ctx->context, &event);
+}
+
+static void evaluate_instance(void *context, const SnooperMetricId *id, size_t slot_index, double value) {
+    EvaluationContext *ctx = context;
+    const SnooperRuleOp *op = ctx->op;
+    if (op->slot_count == 1) {
+        slot_index = 0;
+    } else if (slot_index >= op->slot_count) {
+        return;
+    }
+
+    SnooperRuleSlot *slot = &ctx->rules->slots[op->slot_offset + slot_index];
+    uint64_t now = ctx->snapshot->monotonic_ns;
+    slot->visited = 1;
+    slot->id = *id;
+
+    if (op->is_rate) {
+        // Probes on a slower period repeat their last value between samples;
+        // only a fresh sample moves the rate.
+        uint64_t sampled = snooper_metric_updated_ns(ctx->snapshot, id);
+        if (sampled == 0) {
+            sampled = now;
+        }
+        if (slot->has_previous && sampled == slot->previous_ns) {
+            return;
+        }
+        int ready = slot->has_previous && sampled > slot->previous_ns;
+        double raw = value;
+        if (ready) {
+            value = (raw - slot->previous_value) * 1e9 / (double)(sampled - slot->previous_ns);
+        }
+        slot->previous_value = raw;
+        slot->previous_ns = sampled;
+        slot->has_previous = 1;
+        if (!ready) {
+            return;
+        }
+    }
+    slot->value = value;
+
+    if (slot->firing) {
+        if (!compare(op->op, value, op->clear_threshold)) {
+            slot->firing = 0;
+            slot->pending = 0;
+            slot->hold_until_ns = now + op->hold_ns;
+            emit(ctx, id, SNOOPER_RULE_RESOLVED, value, op->clear_threshold);
+        }
+        return;
+    }
+
+    if (!compare(op->op, value, op->threshold) || now < slot->hold_until_ns) {
+        slot->pending = 0;
+        return;
+    }
+
+    if (!slot->pending) {
+        slot->pending = 1;
+        slot->pending_since_ns = now;
+    }
+    if (now - slot->pending_since_ns >= op->for_ns) {
+        slot->firing = 1;
+        emit(ctx, id, SNOOPER_RULE_FIRING, value, op->threshold);
+    }
+}
+
+// Instances that were not visited this pass have gone away (an interface
+// removed, a plugin unavailable). A firing one is resolved with its last
+// value, and any pending or rate state is dropped so a later instance in the
+// same slot starts fresh.
+static void resolve_missing(EvaluationContext *ctx) {
+    const SnooperRuleOp *op = ctx->op;
+    uint64_t now = ctx->snapshot->monotonic_ns;
+    for (size_t i = 0; i < op->slot_count; ++i) {
+        SnooperRuleSlot *slot = &ctx->rules->slots[op->slot_offset + i];
+        if (slot->visited) {
+            slot->visited = 0;
+            continue;
+        }
+        if (slot->firing) {
+            slot->firing = 0;
+            slot->hold_until_ns = now + op->hold_ns;
+            emit(ctx, &slot->id, SNOOPER_RULE_RESOLVED, slot->value, op->clear_threshold);
+        }
+        slot->pending = 0;
+        slot->has_previous = 0;
+    }
+}
+
+void snooper_rules_evaluate(SnooperRuleSet *rules, const SnooperSnapshot *snapshot, SnooperRuleSink sink, void *context) {
+    if (!rules || !snapshot) return;
+
+    EvaluationContext ctx;
+    ctx.rules = rules;
+    ctx.snapshot = snapshot;
+    ctx.sink = sink;
+    ctx.context = context;
+    for (size_t i = 0; i < rules->op_count; ++i) {
+        ctx.op = &rules->ops[i];
+        snooper_metric_expand(snapshot, &ctx.op->metric, evaluate_instance, &ctx);
+        resolve_missing(&ctx);
+    }
+}
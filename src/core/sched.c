@@ -0,0 +1,174 @@
+#include "snooper/sched.h"
+#include "procfs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SCHED_BUFFER_SIZE (256 * 1024)
+#define SCHEDSTAT_CPU_FIELDS 9
+
+static uint64_t counter_delta(uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : 0;
+}
+
+static int line_starts_with(const char *cursor, const char *end, const char *prefix) {
+    size_t len = strlen(prefix);
+    return (size_t)(end - cursor) >= len && memcmp(cursor, prefix, len) == 0;
+}
+
+static SnooperStatus sched_read_schedstat(SchedProbe *probe, SnooperSchedStats *stats, double scale) {
+    size_t length = 0;
+    if (snooper_read_fd(probe->schedstat_fd, probe->buffer, probe->buffer_size, &length) != SNOOPER_OK) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    const char *cursor = probe->buffer;
+    const char *end = probe->buffer + length;
+
+    while (cursor < end) {
+        const char *line_end = snooper_skip_line(cursor, end);
+        if (!line_starts_with(cursor, line_end, "cpu")) {
+            cursor = line_end;
+            continue;
+        }
+
+        uint64_t cpu = 0;
+        const char *field = snooper_parse_u64(cursor + 3, line_end, &cpu);
+        uint64_t values[SCHEDSTAT_CPU_FIELDS];
+        size_t parsed = 0;
+        while (field && parsed < SCHEDSTAT_CPU_FIELDS) {
+            field = snooper_parse_u64(field, line_end, &values[parsed]);
+            if (field) parsed++;
+        }
+
+        if (parsed == SCHEDSTAT_CPU_FIELDS && cpu < SNOOPER_MAX_CPUS) {
+            SnooperSchedCounters current = {
+                .run_ns = values[6],
+                .wait_ns = values[7],
+                .timeslices = values[8]
+            };
+            SnooperSchedCounters *prev = &probe->previous[cpu];
+            SnooperSchedCore *core = &stats->cores[cpu];
+
+            if (scale > 0.0) {
+                uint64_t run = counter_delta(current.run_ns, prev->run_ns);
+                uint64_t wait = counter_delta(current.wait_ns, prev->wait_ns);
+                uint64_t slices = counter_delta(current.timeslices, prev->timeslices);
+                core->present = 1;
+                core->run_ms_per_sec = (double)run / 1e6 * scale;
+                core->wait_ms_per_sec = (double)wait / 1e6 * scale;
+                core->timeslices_per_sec = (double)slices * scale;
+                core->avg_wait_us_per_timeslice = slices > 0 ? (double)wait / 1e3 / (double)slices : 0.0;
+            }
+
+            *prev = current;
+            if (cpu + 1 > stats->core_count) {
+                stats->core_count = (size_t)cpu + 1;
+            }
+        }
+
+        cursor = line_end;
+    }
+
+    return SNOOPER_OK;
+}
+
+static SnooperStatus sched_read_stat(SchedProbe *probe, SnooperSchedStats *stats, double scale) {
+    size_t length = 0;
+    if (snooper_read_fd(probe->stat_fd, probe->buffer, probe->buffer_size, &length) != SNOOPER_OK) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    const char *cursor = probe->buffer;
+    const char *end = probe->buffer + length;
+
+    while (cursor < end) {
+        const char *line_end = snooper_skip_line(cursor, end);
+        uint64_t value = 0;
+
+        if (line_starts_with(cursor, line_end, "ctxt ")) {
+            if (snooper_parse_u64(cursor + 5, line_end, &value)) {
+                if (scale > 0.0) {
+                    stats->context_switches_per_sec = (double)counter_delta(value, probe->previous_ctxt) * scale;
+                }
+                probe->previous_ctxt = value;
+            }
+        } else if (line_starts_with(cursor, line_end, "procs_running ")) {
+            if (snooper_parse_u64(cursor + 14, line_end, &value)) {
+                stats->procs_running = value;
+            }
+        } else if (line_starts_with(cursor, line_end, "procs_blocked ")) {
+            if (snooper_parse_u64(cursor + 14, line_end, &value)) {
+                stats->procs_blocked = value;
+            }
+        }
+
+        cursor = line_end;
+    }
+
+    return SNOOPER_OK;
+}
+
+SnooperStatus sched_probe_init(SchedProbe *probe, const char *root) {
+    if (!probe) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    snprintf(probe->root, sizeof(probe->root), "%s", root ? root : snooper_fs_root());
+    probe->schedstat_fd = snooper_open_readonly(probe->root, "/proc/schedstat");
+    probe->stat_fd = snooper_open_readonly(probe->root, "/proc/stat");
+
+    probe->buffer = malloc(SCHED_BUFFER_SIZE);
+    probe->previous = calloc(SNOOPER_MAX_CPUS, sizeof(SnooperSchedCounters));
+    if (!probe->buffer || !probe->previous) {
+        sched_probe_destroy(probe);
+        return SNOOPER_ERR_NOMEM;
+    }
+    probe->buffer_size = SCHED_BUFFER_SIZE;
+    probe->initialized = 1;
+    return SNOOPER_OK;
+}
+
+void sched_probe_destroy(SchedProbe *probe) {
+    if (!probe) return;
+    if (probe->schedstat_fd >= 0) close(probe->schedstat_fd);
+    if (probe->stat_fd >= 0) close(probe->stat_fd);
+    probe->schedstat_fd = -1;
+    probe->stat_fd = -1;
+    free(probe->buffer);
+    free(probe->previous);
+    probe->buffer = NULL;
+    probe->previous = NULL;
+    probe->buffer_size = 0;
+    probe->initialized = 0;
+}
+
+SnooperStatus sched_probe_sample(SchedProbe *probe, uint64_t monotonic_ns, SnooperSchedStats *stats) {
+    if (!probe || !stats || !probe->initialized) {
+        return SNOOPER_ERR_INVALID;
+    }
+    if (probe->stat_fd < 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->monotonic_ns = monotonic_ns;
+
+    int warmup = probe->previous_ns == 0 || monotonic_ns <= probe->previous_ns;
+    double scale = warmup ? 0.0 : 1e9 / (double)(monotonic_ns - probe->previous_ns);
+
+    // Kernels without CONFIG_SCHEDSTATS have no /proc/schedstat; the
+    // context switch and run queue counts from /proc/stat still apply, and
+    // every core's run/wait is reported as not present.
+    if (probe->schedstat_fd >= 0) {
+        (void)sched_read_schedstat(probe, stats, scale);
+    }
+
+    SnooperStatus status = sched_read_stat(probe, stats, scale);
+    if (status != SNOOPER_OK) return status;
+
+    probe->previous_ns = monotonic_ns;
+    return warmup ? SNOOPER_ERR_WARMUP : SNOOPER_OK;
+}
@@ -0,0 +1,100 @@
+#include "snooper/scheduler.h"
+#include <string.h>
+
+// Entries are due a little early so a deadline just after a collector tick
+// does not slip a whole tick.
+static uint64_t entry_key(const SnooperScheduleEntry *entry) {
+    if (entry->period_ns == SNOOPER_PERIOD_ONCE) {
+        return entry->deadline_ns;
+    }
+    uint64_t slack = entry->period_ns / 8;
+    return entry->deadline_ns > slack ? entry->deadline_ns - slack : 0;
+}
+
+static void sift_up(SnooperSchedule *schedule, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (entry_key(&schedule->heap[parent]) <= entry_key(&schedule->heap[i])) break;
+        SnooperScheduleEntry tmp = schedule->heap[i];
+        schedule->heap[i] = schedule->heap[parent];
+        schedule->heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static void sift_down(SnooperSchedule *schedule, size_t i) {
+    for (;;) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+        if (left < schedule->count && entry_key(&schedule->heap[left]) < entry_key(&schedule->heap[smallest])) smallest = left;
+        if (right < schedule->count && entry_key(&schedule->heap[right]) < entry_key(&schedule->heap[smallest])) smallest = right;
+        if (smallest == i) break;
+        SnooperScheduleEntry tmp = schedule->heap[i];
+        schedule->heap[i] = schedule->heap[smallest];
+        schedule->heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void entry_advance(SnooperScheduleEntry *entry, uint64_t now_ns) {
+    if (!entry->fired) {
+        entry->fired = 1;
+        entry->deadline_ns = now_ns + (entry->phase_ns ? entry->phase_ns : entry->period_ns);
+        return;
+    }
+    entry->deadline_ns += entry->period_ns;
+    if (entry->deadline_ns <= now_ns) {
+        // Missed deadlines are dropped rather than replayed in a burst.
+        entry->deadline_ns = now_ns + entry->period_ns;
+    }
+}
+
+void snooper_schedule_init(SnooperSchedule *schedule) {
+    if (!schedule) return;
+    memset(schedule, 0, sizeof(*schedule));
+}
+
+SnooperStatus snooper_schedule_add(SnooperSchedule *schedule, int id, uint64_t period_ns, uint64_t start_ns) {
+    if (!schedule) return SNOOPER_ERR_INVALID;
+    if (schedule->count >= SNOOPER_SCHEDULE_MAX) return SNOOPER_ERR_NOMEM;
+
+    SnooperScheduleEntry *entry = &schedule->heap[schedule->count];
+    memset(entry, 0, sizeof(*entry));
+    entry->id = id;
+    entry->period_ns = period_ns;
+    entry->deadline_ns = start_ns;
+    if (period_ns != SNOOPER_PERIOD_EVERY && period_ns != SNOOPER_PERIOD_ONCE) {
+        double phase = (double)(++schedule->staggered) * 0.6180339887498949;
+        phase -= (double)(uint64_t)phase;
+        entry->phase_ns = (uint64_t)(phase * (double)period_ns);
+    }
+    sift_up(schedule, schedule->count++);
+    return SNOOPER_OK;
+}
+
+size_t snooper_schedule_due(SnooperSchedule *schedule, uint64_t now_ns, int *ids, size_t max_ids) {
+    if (!schedule || !ids) return 0;
+
+    // Due entries are popped first and pushed back afterwards, so an entry
+    // that is due again immediately is still reported once per call.
+    SnooperScheduleEntry fired[SNOOPER_SCHEDULE_MAX];
+    size_t count = 0;
+    while (schedule->count > 0 && count < max_ids && entry_key(&schedule->heap[0]) <= now_ns) {
+        fired[count] = schedule->heap[0];
+        ids[count] = fired[count].id;
+        ++count;
+        schedule->heap[0] = schedule->heap[--schedule->count];
+        sift_down(schedule, 0);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (fired[i].period_ns == SNOOPER_PERIOD_ONCE) {
+            continue;
+        }
+        entry_advance(&fired[i], now_ns);
+        schedule->heap[schedule->count] = fired[i];
+        sift_up(schedule, schedule->count++);
+    }
+    return count;
+}
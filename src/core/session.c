@@ -0,0 +1,79 @@
+#include "snooper/session.h"
+#include "procfs.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+static uint64_t session_random_id(uint64_t monotonic_ns) {
+    uint64_t id = 0;
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ssize_t n = read(fd, &id, sizeof(id));
+        close(fd);
+        if (n == (ssize_t)sizeof(id) && id != 0) {
+            return id;
+        }
+    }
+
+    id = monotonic_ns ^ ((uint64_t)getpid() << 32);
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    return id ? id : 1;
+}
+
+SnooperStatus snooper_read_boot_id(char *buffer, size_t size) {
+    if (!buffer || size == 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+    buffer[0] = '\0';
+
+#if defined(__APPLE__)
+    size_t length = size;
+    if (sysctlbyname("kern.bootsessionuuid", buffer, &length, NULL, 0) == 0) {
+        buffer[size - 1] = '\0';
+        return SNOOPER_OK;
+    }
+#endif
+
+    size_t length_read = 0;
+    if (snooper_read_file(snooper_fs_root(), "/proc/sys/kernel/random/boot_id", buffer, size, &length_read) != SNOOPER_OK) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    while (length_read > 0 && (buffer[length_read - 1] == '\n' || buffer[length_read - 1] == ' ')) {
+        buffer[--length_read] = '\0';
+    }
+    return length_read > 0 ? SNOOPER_OK : SNOOPER_ERR_UNAVAILABLE;
+}
+
+SnooperStatus snooper_session_init(SnooperSession *session, const SnooperTimestamp *started, int reveal_identifiers) {
+    if (!session || !started) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(session, 0, sizeof(*session));
+
+    session->started_monotonic_ns = started->monotonic_ns;
+    session->started_wall_time = started->wall_time;
+    session->wall_offset_ns = started->wall_offset_ns;
+
+    session->session_id = session_random_id(session->started_monotonic_ns);
+
+    // The placeholder is for display only; has_boot_id stays 0 so nothing
+    // keyed by boot (the --baseline file) treats it as a real id.
+    if (snooper_read_boot_id(session->boot_id, sizeof(session->boot_id)) == SNOOPER_OK) {
+        session->has_boot_id = 1;
+    } else {
+        snprintf(session->boot_id, sizeof(session->boot_id), "<unavailable>");
+    }
+
+    if (snooper_system_info_read(&session->system_info, reveal_identifiers) == SNOOPER_OK) {
+        session->has_system_info = 1;
+    }
+
+    return SNOOPER_OK;
+}
@@ -1,5 +1,8 @@
 #include "snooper/telemetry.h"
 #include "snooper/errors.h"
+#include "procfs.h"
+#include <stdlib.h>
+#include <string.h>
 
 SnooperStatus snooper_telemetry_init(SnooperTelemetry *telemetry, int reveal_identifiers) {
     if (!telemetry) return SNOOPER_ERR_INVALID;
@@ -7,15 +10,56 @@ SnooperStatus snooper_telemetry_init(SnooperTelemetry *telemetry, int reveal_ide
 
     telemetry->reveal_identifiers = reveal_identifiers ? 1 : 0;
 
-    SnooperStatus status = cpu_probe_init(&telemetry->cpu_probe);
+    // SNOOPER_TIMEBASE=clock opts out of the cycle counter fast path.
+    const char *timebase_mode = getenv("SNOOPER_TIMEBASE");
+    int use_counter = !timebase_mode || strcmp(timebase_mode, "clock") != 0;
+    SnooperStatus status = snooper_timebase_init(&telemetry->timebase, use_counter);
+    if (status != SNOOPER_OK) return status;
+
+    status = cpu_probe_init(&telemetry->cpu_probe);
     if (status != SNOOPER_OK) return status;
 
     status = gpu_probe_init(&telemetry->gpu_probe);
     if (status != SNOOPER_OK) return status;
 
-    if (snooper_system_info_read(&telemetry->system_info, telemetry->reveal_identifiers) == SNOOPER_OK) {
-        telemetry->system_info_loaded = 1;
-    }
+    status = net_probe_init(&telemetry->net_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    status = sched_probe_init(&telemetry->sched_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    status = irq_probe_init(&telemetry->irq_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    status = freq_probe_init(&telemetry->freq_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    status = power_probe_init(&telemetry->power_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    status = process_probe_init(&telemetry->process_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    status = numa_probe_init(&telemetry->numa_probe, snooper_fs_root());
+    if (status != SNOOPER_OK) return status;
+
+    SnooperTimestamp started;
+    status = snooper_timebase_capture(&telemetry->timebase, &started);
+    if (status != SNOOPER_OK) return status;
+
+    status = snooper_session_init(&telemetry->session, &started, telemetry->reveal_identifiers);
+    if (status != SNOOPER_OK) return status;
+
+    (void)snooper_topology_discover(&telemetry->topology, snooper_fs_root());
+
+    // Slow-changing system metrics (process and thread counts) default to
+    // once a second; everything else follows the collector's own rate.
+    telemetry->period_ns[SNOOPER_PROBE_SYSTEM] = 1000000000ULL;
+    // The process table walks every /proc/<pid>/stat, so it refreshes slower.
+    telemetry->period_ns[SNOOPER_PROBE_PROCS] = 2000000000ULL;
+
+    telemetry->latest = calloc(1, sizeof(SnooperSnapshot));
+    if (!telemetry->latest) return SNOOPER_ERR_NOMEM;
 
     return SNOOPER_OK;
 }
@@ -24,47 +68,293 @@ void snooper_telemetry_destroy(SnooperTelemetry *telemetry) {
     if (!telemetry) return;
     cpu_probe_destroy(&telemetry->cpu_probe);
     gpu_probe_destroy(&telemetry->gpu_probe);
-    telemetry->system_info_loaded = 0;
+    net_probe_destroy(&telemetry->net_probe);
+    sched_probe_destroy(&telemetry->sched_probe);
+    irq_probe_destroy(&telemetry->irq_probe);
+    freq_probe_destroy(&telemetry->freq_probe);
+    power_probe_destroy(&telemetry->power_probe);
+    process_probe_destroy(&telemetry->process_probe);
+    numa_probe_destroy(&telemetry->numa_probe);
+    snooper_topology_destroy(&telemetry->topology);
+    snooper_plugin_unload_all(&telemetry->plugins);
+    free(telemetry->latest);
+    telemetry->latest = NULL;
+    telemetry->session.has_system_info = 0;
 }
 
-SnooperStatus snooper_snapshot_collect(SnooperTelemetry *telemetry, SnooperSnapshot *out) {
-    if (!telemetry || !out) return SNOOPER_ERR_INVALID;
-
-    memset(out, 0, sizeof(*out));
+static void prime_rate_probes(SnooperTelemetry *telemetry, SnooperSnapshot *scratch) {
+    SnooperTimebase *timebase = &telemetry->timebase;
+    (void)net_probe_sample(&telemetry->net_probe, snooper_timebase_now_ns(timebase), &scratch->network);
+    (void)sched_probe_sample(&telemetry->sched_probe, snooper_timebase_now_ns(timebase), &scratch->sched);
+    (void)irq_probe_sample(&telemetry->irq_probe, snooper_timebase_now_ns(timebase), &scratch->irq);
+    (void)freq_probe_sample(&telemetry->freq_probe, snooper_timebase_now_ns(timebase), NULL, 0, &scratch->freq);
+    (void)power_probe_sample(&telemetry->power_probe, snooper_timebase_now_ns(timebase), 0.0, &scratch->power);
+    (void)process_probe_sample(&telemetry->process_probe, snooper_timebase_now_ns(timebase), &scratch->processes);
+    (void)numa_probe_sample(&telemetry->numa_probe, snooper_timebase_now_ns(timebase), &scratch->numa);
+}
 
+static SnooperStatus sample_cpu(SnooperTelemetry *telemetry, uint64_t monotonic_ns) {
+    SnooperSnapshot *latest = telemetry->latest;
     SnooperCpuUsageReport cpu_report = {0};
-    SnooperStatus status = cpu_probe_sample(&telemetry->cpu_probe, &cpu_report);
+    SnooperStatus status = cpu_probe_sample(&telemetry->cpu_probe, monotonic_ns, &cpu_report);
+    uint64_t previous_ns = telemetry->cpu_sampled_ns;
+    if (status == SNOOPER_OK || status == SNOOPER_ERR_WARMUP) {
+        telemetry->cpu_sampled_ns = monotonic_ns;
+    }
     if (status != SNOOPER_OK) {
+        cpu_usage_report_destroy(&cpu_report);
+        return status;
+    }
+
+    latest->cpu_used_percent = 100.0 - cpu_report.overall.idle;
+    latest->core_count = cpu_report.core_count < SNOOPER_MAX_CPUS ? cpu_report.core_count : SNOOPER_MAX_CPUS;
+    memcpy(latest->per_core, cpu_report.per_core, latest->core_count * sizeof(SnooperCpuUsage));
+    if (previous_ns != 0 && monotonic_ns > previous_ns) {
+        double seconds = (double)(monotonic_ns - previous_ns) / 1e9;
+        for (size_t core = 0; core < latest->core_count; ++core) {
+            telemetry->freq_busy_seconds[core] += (100.0 - latest->per_core[core].idle) / 100.0 * seconds;
+        }
+        telemetry->freq_window_seconds += seconds;
+        telemetry->power_busy_core_seconds += latest->cpu_used_percent / 100.0 * (double)latest->core_count * seconds;
+    }
+    latest->has_topology = snooper_topology_aggregate(&telemetry->topology, latest->per_core, latest->core_count, &latest->topology) == SNOOPER_OK;
+    cpu_usage_report_destroy(&cpu_report);
+    return SNOOPER_OK;
+}
+
+static void sample_plugin(SnooperTelemetry *telemetry, size_t index, uint64_t monotonic_ns) {
+    SnooperSnapshot *latest = telemetry->latest;
+    const SnooperPluginProbe *plugin = &telemetry->plugins.probes[index];
+    SnooperFieldValue *values = latest->plugin_values + plugin->value_offset;
+    latest->plugin_available[index] = plugin->descriptor->sample(plugin->state, monotonic_ns, values) == SNOOPER_OK;
+    latest->plugin_updated_ns[index] = monotonic_ns;
+}
+
+// Average busy percent per core since the last freq sample; falls back to
+// the latest CPU window when no CPU sample has landed since.
+static size_t take_freq_busy(SnooperTelemetry *telemetry, double *used_percent) {
+    const SnooperSnapshot *latest = telemetry->latest;
+    double window = telemetry->freq_window_seconds;
+    for (size_t core = 0; core < latest->core_count; ++core) {
+        used_percent[core] = window > 0.0 ? 100.0 * telemetry->freq_busy_seconds[core] / window
+                                          : 100.0 - latest->per_core[core].idle;
+    }
+    memset(telemetry->freq_busy_seconds, 0, sizeof(telemetry->freq_busy_seconds));
+    telemetry->freq_window_seconds = 0.0;
+    return latest->core_count;
+}
+
+static SnooperStatus sample_probe(SnooperTelemetry *telemetry, SnooperProbeId probe, uint64_t monotonic_ns) {
+    SnooperSnapshot *latest = telemetry->latest;
+    SnooperTimebase *timebase = &telemetry->timebase;
+
+    switch (probe) {
+    case SNOOPER_PROBE_CPU: {
+        SnooperStatus status = sample_cpu(telemetry, monotonic_ns);
+        if (status != SNOOPER_OK) return status;
+        break;
+    }
+    case SNOOPER_PROBE_GPU: {
+        SnooperGpuSample gpu_sample = {0};
+        if (gpu_probe_sample(&telemetry->gpu_probe, monotonic_ns, &gpu_sample) == SNOOPER_OK) {
+            latest->gpu_available = gpu_sample.available;
+            latest->gpu_used_percent = gpu_sample.utilization_percent;
+        } else {
+            latest->gpu_available = 0;
+            latest->gpu_used_percent = 0.0;
+        }
+        break;
+    }
+    case SNOOPER_PROBE_SYSTEM:
+        memset(&latest->system_metrics, 0, sizeof(latest->system_metrics));
+        (void)snooper_system_metrics_read(&latest->system_metrics);
+        break;
+    case SNOOPER_PROBE_NET:
+        latest->has_network = net_probe_sample(&telemetry->net_probe, snooper_timebase_now_ns(timebase), &latest->network) == SNOOPER_OK;
+        break;
+    case SNOOPER_PROBE_SCHED:
+        latest->has_sched = sched_probe_sample(&telemetry->sched_probe, snooper_timebase_now_ns(timebase), &latest->sched) == SNOOPER_OK;
+        break;
+    case SNOOPER_PROBE_IRQ:
+        latest->has_irq = irq_probe_sample(&telemetry->irq_probe, snooper_timebase_now_ns(timebase), &latest->irq) == SNOOPER_OK;
+        break;
+    case SNOOPER_PROBE_FREQ: {
+        double used_percent[SNOOPER_MAX_CPUS];
+        size_t used_count = take_freq_busy(telemetry, used_percent);
+        latest->has_freq = freq_probe_sample(&telemetry->freq_probe, snooper_timebase_now_ns(timebase), used_percent, used_count, &latest->freq) == SNOOPER_OK;
+        break;
+    }
+    case SNOOPER_PROBE_POWER: {
+        double busy_core_seconds = telemetry->power_busy_core_seconds;
+        telemetry->power_busy_core_seconds = 0.0;
+        if (power_probe_sample(&telemetry->power_probe, snooper_timebase_now_ns(timebase), busy_core_seconds, &latest->power) != SNOOPER_OK) {
+            latest->power.available = 0;
+        }
+        break;
+    }
+    case SNOOPER_PROBE_PROCS:
+        latest->has_processes = process_probe_sample(&telemetry->process_probe, snooper_timebase_now_ns(timebase), &latest->processes) == SNOOPER_OK;
+        break;
+    case SNOOPER_PROBE_NUMA:
+        latest->has_numa = numa_probe_sample(&telemetry->numa_probe, snooper_timebase_now_ns(timebase), &latest->numa) == SNOOPER_OK;
+        break;
+    default:
+        return SNOOPER_ERR_INVALID;
+    }
+    latest->updated_ns[probe] = monotonic_ns;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_snapshot_collect(SnooperTelemetry *telemetry, const SnooperSnapshot **out) {
+    if (!telemetry || !out || !telemetry->latest) return SNOOPER_ERR_INVALID;
+
+    // One wall/monotonic pair stamps the whole snapshot; rate probes get
+    // their own cheap sub-timestamps so their deltas match when they read.
+    SnooperTimestamp timestamp;
+    SnooperStatus status = snooper_timebase_capture(&telemetry->timebase, &timestamp);
+    if (status != SNOOPER_OK) return status;
+
+    SnooperSnapshot *latest = telemetry->latest;
+    if (!telemetry->warmed_up) {
+        status = sample_cpu(telemetry, timestamp.monotonic_ns);
         if (status == SNOOPER_ERR_WARMUP) {
-            cpu_usage_report_destroy(&cpu_report);
-            return SNOOPER_ERR_WARMUP;
+            prime_rate_probes(telemetry, latest);
+            telemetry->warmed_up = 1;
         }
-        cpu_usage_report_destroy(&cpu_report);
         return status;
     }
 
-    out->cpu_used_percent = 100.0 - cpu_report.overall.idle;
-    out->monotonic_ns = cpu_report.monotonic_ns;
-    out->wall_time = cpu_report.wall_time;
+    if (!telemetry->scheduled) {
+        snooper_schedule_init(&telemetry->schedule);
+        for (int probe = 0; probe < SNOOPER_PROBE_COUNT; ++probe) {
+            (void)snooper_schedule_add(&telemetry->schedule, probe, telemetry->period_ns[probe], timestamp.monotonic_ns);
+        }
+        for (size_t i = 0; i < telemetry->plugins.count; ++i) {
+            (void)snooper_schedule_add(&telemetry->schedule, SNOOPER_PROBE_COUNT + (int)i, telemetry->plugins.probes[i].period_ns, timestamp.monotonic_ns);
+        }
+        telemetry->scheduled = 1;
+    }
 
-    SnooperGpuSample gpu_sample = {0};
-    SnooperStatus gpu_status = gpu_probe_sample(&telemetry->gpu_probe, &gpu_sample);
-    if (gpu_status == SNOOPER_OK) {
-        out->gpu_available = gpu_sample.available;
-        out->gpu_used_percent = gpu_sample.utilization_percent;
-    } else {
-        out->gpu_available = 0;
-        out->gpu_used_percent = 0.0;
+    // Probes that are not due keep their previous values; updated_ns tells
+    // consumers how fresh each one is.
+    // A CPU failure fails the collect, but only after the other due probes
+    // have sampled, so they do not lose a whole period to it.
+    int due[SNOOPER_SCHEDULE_MAX];
+    size_t due_count = snooper_schedule_due(&telemetry->schedule, timestamp.monotonic_ns, due, SNOOPER_SCHEDULE_MAX);
+    // The heap hands out equal deadlines in no particular order, but freq
+    // and power read this tick's CPU usage, so dispatch in probe id order
+    // (CPU first, plugins last).
+    for (size_t i = 1; i < due_count; ++i) {
+        int id = due[i];
+        size_t j = i;
+        while (j > 0 && due[j - 1] > id) {
+            due[j] = due[j - 1];
+            --j;
+        }
+        due[j] = id;
+    }
+    SnooperStatus cpu_status = SNOOPER_OK;
+    for (size_t i = 0; i < due_count; ++i) {
+        if (due[i] >= SNOOPER_PROBE_COUNT) {
+            sample_plugin(telemetry, (size_t)(due[i] - SNOOPER_PROBE_COUNT), timestamp.monotonic_ns);
+            continue;
+        }
+        status = sample_probe(telemetry, (SnooperProbeId)due[i], timestamp.monotonic_ns);
+        if (status != SNOOPER_OK && due[i] == SNOOPER_PROBE_CPU) {
+            cpu_status = status;
+        }
+    }
+    if (cpu_status != SNOOPER_OK) {
+        return cpu_status;
+    }
+    if (latest->updated_ns[SNOOPER_PROBE_CPU] == 0) {
+        return SNOOPER_ERR_WARMUP;
     }
 
-    cpu_usage_report_destroy(&cpu_report);
+    latest->session_id = telemetry->session.session_id;
+    latest->plugins = &telemetry->plugins;
+    latest->monotonic_ns = timestamp.monotonic_ns;
+    latest->wall_time = timestamp.wall_time;
+    latest->wall_offset_ns = timestamp.wall_offset_ns;
+    *out = latest;
+    return SNOOPER_OK;
+}
 
-    if (telemetry->system_info_loaded) {
-        out->system_info = telemetry->system_info;
-        out->has_system_info = 1;
+// Skips the warmup sample: the next collect reports CPU usage since the
+// baseline. Rate probes are not primed and warm up on their first due sample.
+SnooperStatus snooper_telemetry_seed_cpu(SnooperTelemetry *telemetry, const SnooperCpuSample *baseline) {
+    if (!telemetry) return SNOOPER_ERR_INVALID;
+    SnooperStatus status = cpu_probe_seed(&telemetry->cpu_probe, baseline);
+    if (status == SNOOPER_OK) {
+        telemetry->warmed_up = 1;
     }
+    return status;
+}
+
+SnooperStatus snooper_telemetry_set_period(SnooperTelemetry *telemetry, SnooperProbeId probe, uint64_t period_ns) {
+    if (!telemetry || probe < 0 || probe >= SNOOPER_PROBE_COUNT) return SNOOPER_ERR_INVALID;
+    telemetry->period_ns[probe] = period_ns;
+    telemetry->scheduled = 0;
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_telemetry_parse_periods(SnooperTelemetry *telemetry, const char *spec) {
+    if (!telemetry || !spec) return SNOOPER_ERR_INVALID;
+
+    const char *cursor = spec;
+    while (*cursor) {
+        const char *end = strchr(cursor, ',');
+        size_t length = end ? (size_t)(end - cursor) : strlen(cursor);
+        const char *equals = memchr(cursor, '=', length);
+        if (!equals) return SNOOPER_ERR_INVALID;
+
+        int probe = -1;
+        for (int i = 0; i < SNOOPER_PROBE_COUNT + (int)telemetry->plugins.count; ++i) {
+            const char *name = i < SNOOPER_PROBE_COUNT ? snooper_probe_name((SnooperProbeId)i) : telemetry->plugins.probes[i - SNOOPER_PROBE_COUNT].descriptor->name;
+            if (strlen(name) == (size_t)(equals - cursor) && strncmp(cursor, name, strlen(name)) == 0) {
+                probe = i;
+                break;
+            }
+        }
+        if (probe < 0) return SNOOPER_ERR_INVALID;
 
-    (void)snooper_system_metrics_read(&out->system_metrics);
+        const char *value = equals + 1;
+        size_t value_length = length - (size_t)(value - cursor);
+        uint64_t period_ns = 0;
+        if (value_length == 4 && strncmp(value, "once", 4) == 0) {
+            period_ns = SNOOPER_PERIOD_ONCE;
+        } else {
+            char *parsed_end = NULL;
+            double ms = strtod(value, &parsed_end);
+            if (parsed_end != value + value_length || value_length == 0 || ms < 0.0) return SNOOPER_ERR_INVALID;
+            period_ns = (uint64_t)(ms * 1e6);
+        }
+        if (probe < SNOOPER_PROBE_COUNT) {
+            (void)snooper_telemetry_set_period(telemetry, (SnooperProbeId)probe, period_ns);
+        } else {
+            telemetry->plugins.probes[probe - SNOOPER_PROBE_COUNT].period_ns = period_ns;
+            telemetry->scheduled = 0;
+        }
 
+        cursor += length;
+        if (*cursor == ',') ++cursor;
+    }
     return SNOOPER_OK;
 }
+
+SnooperStatus snooper_telemetry_register_probe(SnooperTelemetry *telemetry, const SnooperProbeDescriptor *descriptor, char *error, size_t error_size) {
+    if (!telemetry) return SNOOPER_ERR_INVALID;
+    telemetry->scheduled = 0;
+    return snooper_plugin_register(&telemetry->plugins, descriptor, NULL, error, error_size);
+}
+
+SnooperStatus snooper_telemetry_load_plugin(SnooperTelemetry *telemetry, const char *path, char *error, size_t error_size) {
+    if (!telemetry) return SNOOPER_ERR_INVALID;
+    telemetry->scheduled = 0;
+    return snooper_plugin_load(&telemetry->plugins, path, error, error_size);
+}
+
+const char *snooper_probe_name(SnooperProbeId probe) {
+    static const char *names[SNOOPER_PROBE_COUNT] = {"cpu", "gpu", "system", "net", "sched", "irq", "freq", "power", "procs", "numa"};
+    return probe >= 0 && probe < SNOOPER_PROBE_COUNT ? names[probe] : "unknown";
+}
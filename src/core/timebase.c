@@ -0,0 +1,135 @@
+#include "snooper/timebase.h"
+#include "timeutil.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#define TIMEBASE_CALIBRATE_MIN_NS 10000000ULL
+
+#if defined(__x86_64__) || defined(__i386__)
+static int counter_supported(void) {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (edx >> 8) & 1u;
+}
+
+static uint64_t counter_read(void) {
+    return (uint64_t)__rdtsc();
+}
+
+static const char *counter_name = "tsc";
+#elif defined(__aarch64__)
+static int counter_supported(void) {
+    return 1;
+}
+
+static uint64_t counter_read(void) {
+    uint64_t value;
+    __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(value) : : "memory");
+    return value;
+}
+
+static const char *counter_name = "cntvct";
+#else
+static int counter_supported(void) {
+    return 0;
+}
+
+static uint64_t counter_read(void) {
+    return 0;
+}
+
+static const char *counter_name = "clock";
+#endif
+
+static int read_raw(struct timespec *ts) {
+    if (clock_gettime(CLOCK_MONOTONIC_RAW, ts) == 0) {
+        return 0;
+    }
+    return clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+SnooperStatus snooper_timebase_init(SnooperTimebase *timebase, int use_counter) {
+    if (!timebase) return SNOOPER_ERR_INVALID;
+    memset(timebase, 0, sizeof(*timebase));
+
+    struct timespec now;
+    if (read_raw(&now) != 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    timebase->last_ns = snooper_timespec_to_ns(&now);
+
+    if (use_counter && counter_supported()) {
+        timebase->use_counter = 1;
+        timebase->counter_base = counter_read();
+        timebase->monotonic_base = timebase->last_ns;
+    }
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_timebase_capture(SnooperTimebase *timebase, SnooperTimestamp *out) {
+    if (!timebase || !out) return SNOOPER_ERR_INVALID;
+
+    // The wall read is bracketed by two raw reads so the recorded offset is
+    // off by at most half the bracket, not a whole clock_gettime call.
+    struct timespec before;
+    struct timespec after;
+    if (read_raw(&before) != 0 || clock_gettime(CLOCK_REALTIME, &out->wall_time) != 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    uint64_t counter = timebase->use_counter ? counter_read() : 0;
+    if (read_raw(&after) != 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    uint64_t first = snooper_timespec_to_ns(&before);
+    uint64_t monotonic = first + (snooper_timespec_to_ns(&after) - first) / 2;
+    out->monotonic_ns = monotonic;
+    out->wall_offset_ns = (int64_t)snooper_timespec_to_ns(&out->wall_time) - (int64_t)monotonic;
+
+    if (timebase->use_counter && monotonic > timebase->monotonic_base) {
+        uint64_t elapsed = monotonic - timebase->monotonic_base;
+        uint64_t threshold = timebase->calibrated ? SNOOPER_TIMEBASE_RESYNC_NS : TIMEBASE_CALIBRATE_MIN_NS;
+        if (elapsed >= threshold && counter > timebase->counter_base) {
+            timebase->ns_per_tick = (double)elapsed / (double)(counter - timebase->counter_base);
+            timebase->counter_base = counter;
+            timebase->monotonic_base = monotonic;
+            timebase->calibrated = 1;
+        }
+    }
+
+    if (monotonic > timebase->last_ns) {
+        timebase->last_ns = monotonic;
+    }
+    return SNOOPER_OK;
+}
+
+uint64_t snooper_timebase_now_ns(SnooperTimebase *timebase) {
+    if (!timebase) return 0;
+
+    uint64_t now = 0;
+    if (timebase->calibrated) {
+        uint64_t ticks = counter_read() - timebase->counter_base;
+        now = timebase->monotonic_base + (uint64_t)((double)ticks * timebase->ns_per_tick);
+    } else {
+        struct timespec ts;
+        if (read_raw(&ts) == 0) {
+            now = snooper_timespec_to_ns(&ts);
+        }
+    }
+
+    // Extrapolation error must never make a probe see time run backwards.
+    if (now < timebase->last_ns) {
+        now = timebase->last_ns;
+    }
+    timebase->last_ns = now;
+    return now;
+}
+
+const char *snooper_timebase_source(const SnooperTimebase *timebase) {
+    return timebase && timebase->use_counter ? counter_name : "clock";
+}
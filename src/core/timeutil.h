@@ -3,9 +3,9 @@
 
 #include <stdint.h>
 #include <time.h>
-#include "snooper/errors.h"
 
 uint64_t snooper_timespec_to_ns(const struct timespec *ts);
-SnooperStatus snooper_capture_timestamps(uint64_t *monotonic_ns, struct timespec *wall);
+// CLOCK_MONOTONIC in nanoseconds, or 0 if the clock cannot be read.
+uint64_t snooper_monotonic_now_ns(void);
 
 #endif
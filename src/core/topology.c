@@ -0,0 +1,359 @@
+#include "snooper/topology.h"
+#include "procfs.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#define TOPOLOGY_MAX_NODES 64
+
+static const char *const kLevelNames[SNOOPER_TOPOLOGY_LEVEL_COUNT] = {
+    "smt",
+    "cluster",
+    "package",
+    "node",
+    "core_type"
+};
+
+const char *snooper_topology_level_name(SnooperTopologyLevel level) {
+    if (level < 0 || level >= SNOOPER_TOPOLOGY_LEVEL_COUNT) {
+        return "unknown";
+    }
+    return kLevelNames[level];
+}
+
+static SnooperStatus topology_alloc_cpus(SnooperCpuTopology *topology, size_t count) {
+    int *ids = calloc(count * 6, sizeof(int));
+    if (!ids) {
+        return SNOOPER_ERR_NOMEM;
+    }
+    topology->cpu_count = count;
+    topology->package_id = ids;
+    topology->core_id = ids + count;
+    topology->cluster_id = ids + count * 2;
+    topology->node_id = ids + count * 3;
+    topology->core_type = ids + count * 4;
+    topology->present = ids + count * 5;
+    return SNOOPER_OK;
+}
+
+static int topology_read_int(const char *root, const char *fmt, size_t index, int fallback) {
+    char path[256];
+    uint64_t value = 0;
+    if (snooper_path_format(path, sizeof(path), NULL, fmt, index) != 0) {
+        return fallback;
+    }
+    if (snooper_read_file_u64(root, path, &value) != SNOOPER_OK) {
+        return fallback;
+    }
+    return (int)value;
+}
+
+// Sets values[cpu] for every CPU in a list such as "0-3,8-11".
+static void topology_apply_cpulist(const char *list, int *values, size_t limit, int value) {
+    const char *cursor = list;
+    const char *end = list + strlen(list);
+
+    while (cursor < end) {
+        uint64_t first = 0;
+        uint64_t last = 0;
+        cursor = snooper_parse_u64(cursor, end, &first);
+        if (!cursor) return;
+        last = first;
+        if (cursor < end && *cursor == '-') {
+            cursor = snooper_parse_u64(cursor + 1, end, &last);
+            if (!cursor) return;
+        }
+        for (uint64_t cpu = first; cpu <= last && cpu < limit; ++cpu) {
+            values[cpu] = value;
+        }
+        if (cursor < end && *cursor == ',') cursor++;
+        else break;
+    }
+}
+
+static void topology_scan_cpus(const char *root, int *candidates) {
+    char path[512];
+    if (snooper_path_format(path, sizeof(path), root, "/sys/devices/system/cpu") != 0) {
+        return;
+    }
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        uint64_t cpu = 0;
+        const char *name_end = entry->d_name + strlen(entry->d_name);
+        if (strncmp(entry->d_name, "cpu", 3) == 0 && snooper_parse_u64(entry->d_name + 3, name_end, &cpu) == name_end && cpu < SNOOPER_MAX_CPUS) {
+            candidates[cpu] = 1;
+        }
+    }
+    closedir(dir);
+}
+
+static SnooperStatus topology_discover_sysfs(SnooperCpuTopology *topology, const char *root) {
+    // CPU ids can have gaps (offlined or never-populated sockets), so the
+    // present list decides which ids to look at rather than counting up to
+    // the first missing one.
+    int candidates[SNOOPER_MAX_CPUS] = {0};
+    char list[1024];
+    if (snooper_read_file(root, "/sys/devices/system/cpu/present", list, sizeof(list), NULL) == SNOOPER_OK) {
+        topology_apply_cpulist(list, candidates, SNOOPER_MAX_CPUS, 1);
+    } else {
+        topology_scan_cpus(root, candidates);
+    }
+
+    size_t count = 0;
+    char path[512];
+    for (size_t cpu = 0; cpu < SNOOPER_MAX_CPUS; ++cpu) {
+        if (!candidates[cpu]) continue;
+        if (snooper_path_format(path, sizeof(path), root, "/sys/devices/system/cpu/cpu%zu/topology", cpu) != 0 ||
+            access(path, F_OK) != 0) {
+            candidates[cpu] = 0;
+            continue;
+        }
+        count = cpu + 1;
+    }
+    if (count == 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    SnooperStatus status = topology_alloc_cpus(topology, count);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    for (size_t cpu = 0; cpu < count; ++cpu) {
+        topology->present[cpu] = candidates[cpu];
+        if (!candidates[cpu]) continue;
+        int package = topology_read_int(root, "/sys/devices/system/cpu/cpu%zu/topology/physical_package_id", cpu, 0);
+        int die = topology_read_int(root, "/sys/devices/system/cpu/cpu%zu/topology/die_id", cpu, 0);
+        topology->package_id[cpu] = package;
+        topology->core_id[cpu] = topology_read_int(root, "/sys/devices/system/cpu/cpu%zu/topology/core_id", cpu, (int)cpu);
+        topology->cluster_id[cpu] = topology_read_int(root, "/sys/devices/system/cpu/cpu%zu/topology/cluster_id", cpu, die);
+        topology->core_type[cpu] = topology_read_int(root, "/sys/devices/system/cpu/cpu%zu/cpu_capacity", cpu, 0);
+    }
+
+    for (int node = 0; node < TOPOLOGY_MAX_NODES; ++node) {
+        char node_path[128];
+        snprintf(node_path, sizeof(node_path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (snooper_read_file(root, node_path, list, sizeof(list), NULL) == SNOOPER_OK) {
+            topology_apply_cpulist(list, topology->node_id, topology->cpu_count, node);
+        }
+    }
+
+    return SNOOPER_OK;
+}
+
+#if defined(__APPLE__)
+static int topology_sysctl_int(const char *name, int fallback) {
+    int value = 0;
+    size_t size = sizeof(value);
+    if (sysctlbyname(name, &value, &size, NULL, 0) != 0) {
+        return fallback;
+    }
+    return value;
+}
+
+static SnooperStatus topology_discover_sysctl(SnooperCpuTopology *topology) {
+    int logical = topology_sysctl_int("hw.logicalcpu", 0);
+    int physical = topology_sysctl_int("hw.physicalcpu", logical);
+    int packages = topology_sysctl_int("hw.packages", 1);
+    int perflevels = topology_sysctl_int("hw.nperflevels", 0);
+    if (logical <= 0) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+    if (logical > SNOOPER_MAX_CPUS) logical = SNOOPER_MAX_CPUS;
+    if (packages <= 0) packages = 1;
+
+    SnooperStatus status = topology_alloc_cpus(topology, (size_t)logical);
+    if (status != SNOOPER_OK) {
+        return status;
+    }
+
+    int threads_per_core = physical > 0 && logical >= physical ? logical / physical : 1;
+    for (int cpu = 0; cpu < logical; ++cpu) {
+        topology->present[cpu] = 1;
+        topology->package_id[cpu] = cpu * packages / logical;
+        topology->core_id[cpu] = cpu / threads_per_core;
+    }
+
+    // XNU numbers the efficiency cores (highest perflevel) first.
+    int cpu = 0;
+    int cluster_base = 0;
+    for (int level = perflevels - 1; level >= 0 && cpu < logical; --level) {
+        char name[64];
+        snprintf(name, sizeof(name), "hw.perflevel%d.logicalcpu", level);
+        int level_cpus = topology_sysctl_int(name, 0);
+        snprintf(name, sizeof(name), "hw.perflevel%d.cpusperl2", level);
+        int per_cluster = topology_sysctl_int(name, level_cpus);
+        if (per_cluster <= 0) per_cluster = level_cpus > 0 ? level_cpus : 1;
+
+        for (int j = 0; j < level_cpus && cpu < logical; ++j, ++cpu) {
+            topology->core_type[cpu] = level;
+            topology->cluster_id[cpu] = cluster_base + j / per_cluster;
+        }
+        cluster_base += (level_cpus + per_cluster - 1) / per_cluster;
+    }
+
+    return SNOOPER_OK;
+}
+#endif
+
+static SnooperStatus topology_build_level(SnooperTopologyGroups *groups, size_t cpu_count, const int *present, const int *major, const int *minor) {
+    size_t *representative = malloc(cpu_count * sizeof(size_t));
+    size_t *group_of = malloc(cpu_count * sizeof(size_t));
+    groups->group_ids = malloc(cpu_count * sizeof(int));
+    groups->offsets = calloc(cpu_count + 1, sizeof(size_t));
+    groups->members = malloc(cpu_count * sizeof(size_t));
+    if (!representative || !group_of || !groups->group_ids || !groups->offsets || !groups->members) {
+        free(representative);
+        free(group_of);
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    size_t group_count = 0;
+    for (size_t cpu = 0; cpu < cpu_count; ++cpu) {
+        if (!present[cpu]) continue;
+        size_t group = 0;
+        while (group < group_count) {
+            size_t rep = representative[group];
+            if (major[rep] == major[cpu] && (!minor || minor[rep] == minor[cpu])) break;
+            group++;
+        }
+        if (group == group_count) {
+            representative[group_count] = cpu;
+            groups->group_ids[group_count] = minor ? (int)group_count : major[cpu];
+            group_count++;
+        }
+        group_of[cpu] = group;
+        groups->offsets[group + 1]++;
+    }
+
+    for (size_t group = 0; group < group_count; ++group) {
+        groups->offsets[group + 1] += groups->offsets[group];
+    }
+
+    for (size_t group = 0; group < group_count; ++group) {
+        representative[group] = groups->offsets[group];
+    }
+    for (size_t cpu = 0; cpu < cpu_count; ++cpu) {
+        if (!present[cpu]) continue;
+        groups->members[representative[group_of[cpu]]++] = cpu;
+    }
+
+    groups->group_count = group_count;
+    free(representative);
+    free(group_of);
+    return SNOOPER_OK;
+}
+
+SnooperStatus snooper_topology_discover(SnooperCpuTopology *topology, const char *root) {
+    if (!topology) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(topology, 0, sizeof(*topology));
+    if (!root) {
+        root = snooper_fs_root();
+    }
+
+    SnooperStatus status = SNOOPER_ERR_UNAVAILABLE;
+#if defined(__APPLE__)
+    if (root[0] == '\0') {
+        status = topology_discover_sysctl(topology);
+    }
+#endif
+    if (status != SNOOPER_OK && topology->cpu_count == 0) {
+        status = topology_discover_sysfs(topology, root);
+    }
+    if (status != SNOOPER_OK) {
+        snooper_topology_destroy(topology);
+        return status;
+    }
+
+    size_t count = topology->cpu_count;
+    const int *majors[SNOOPER_TOPOLOGY_LEVEL_COUNT] = {
+        topology->package_id,
+        topology->package_id,
+        topology->package_id,
+        topology->node_id,
+        topology->core_type
+    };
+    const int *minors[SNOOPER_TOPOLOGY_LEVEL_COUNT] = {
+        topology->core_id,
+        topology->cluster_id,
+        NULL,
+        NULL,
+        NULL
+    };
+
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        status = topology_build_level(&topology->levels[level], count, topology->present, majors[level], minors[level]);
+        if (status != SNOOPER_OK) {
+            snooper_topology_destroy(topology);
+            return status;
+        }
+    }
+
+    topology->available = 1;
+    return SNOOPER_OK;
+}
+
+void snooper_topology_destroy(SnooperCpuTopology *topology) {
+    if (!topology) return;
+    free(topology->package_id);
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        free(topology->levels[level].group_ids);
+        free(topology->levels[level].offsets);
+        free(topology->levels[level].members);
+    }
+    memset(topology, 0, sizeof(*topology));
+}
+
+SnooperStatus snooper_topology_aggregate(const SnooperCpuTopology *topology,
+                                         const SnooperCpuUsage *per_core,
+                                         size_t core_count,
+                                         SnooperTopologyUsage *usage) {
+    if (!topology || !per_core || !usage) {
+        return SNOOPER_ERR_INVALID;
+    }
+    if (!topology->available) {
+        return SNOOPER_ERR_UNAVAILABLE;
+    }
+
+    size_t out = 0;
+    for (int level = 0; level < SNOOPER_TOPOLOGY_LEVEL_COUNT; ++level) {
+        const SnooperTopologyGroups *groups = &topology->levels[level];
+        usage->level_offsets[level] = out;
+
+        for (size_t group = 0; group < groups->group_count && out < SNOOPER_MAX_TOPOLOGY_GROUPS; ++group) {
+            double sum = 0.0;
+            double max = 0.0;
+            int cpus = 0;
+            for (size_t k = groups->offsets[group]; k < groups->offsets[group + 1]; ++k) {
+                size_t cpu = groups->members[k];
+                if (cpu >= core_count) continue;
+                double used = 100.0 - per_core[cpu].idle;
+                sum += used;
+                if (used > max) max = used;
+                cpus++;
+            }
+
+            SnooperTopologyGroupUsage *entry = &usage->groups[out++];
+            entry->id = groups->group_ids[group];
+            entry->cpu_count = cpus;
+            entry->used_percent = cpus > 0 ? sum / (double)cpus : 0.0;
+            entry->max_core_percent = max;
+        }
+    }
+    usage->level_offsets[SNOOPER_TOPOLOGY_LEVEL_COUNT] = out;
+
+    return SNOOPER_OK;
+}
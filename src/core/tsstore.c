@@ -0,0 +1,483 @@
+#include "snooper/tsstore.h"
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Worst case for one point: 5-bit prefix plus a 64-bit delta-of-delta, and a
+// 2-bit control plus 5-bit leading, 6-bit length and 64 meaningful bits.
+#define TS_MAX_POINT_BITS (5 + 64 + 2 + 5 + 6 + 64)
+
+static uint64_t low_mask(int bits) {
+    return bits >= 64 ? ~0ull : ((1ull << bits) - 1ull);
+}
+
+static void write_bits(SnooperTsBlock *block, uint64_t value, int bits) {
+    while (bits > 0) {
+        uint32_t byte = block->bit_length / 8;
+        int free_bits = 8 - (int)(block->bit_length % 8);
+        int take = bits < free_bits ? bits : free_bits;
+        uint64_t chunk = (value >> (bits - take)) & low_mask(take);
+        block->payload[byte] |= (uint8_t)(chunk << (free_bits - take));
+        block->bit_length += (uint32_t)take;
+        bits -= take;
+    }
+}
+
+static uint64_t read_bits(SnooperTsBlockReader *reader, int bits) {
+    uint64_t value = 0;
+    while (bits > 0) {
+        uint32_t byte = reader->bit_offset / 8;
+        int free_bits = 8 - (int)(reader->bit_offset % 8);
+        int take = bits < free_bits ? bits : free_bits;
+        uint64_t chunk = ((uint64_t)reader->block->payload[byte] >> (free_bits - take)) & low_mask(take);
+        value = (value << take) | chunk;
+        reader->bit_offset += (uint32_t)take;
+        bits -= take;
+    }
+    return value;
+}
+
+static int64_t sign_extend(uint64_t value, int bits) {
+    if (bits < 64 && (value & (1ull << (bits - 1)))) {
+        value |= ~low_mask(bits);
+    }
+    return (int64_t)value;
+}
+
+static uint64_t double_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bits_double(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void encode_timestamp(SnooperTsBlock *block, int64_t dod) {
+    if (dod == 0) {
+        write_bits(block, 0, 1);
+    } else if (dod >= -64 && dod <= 63) {
+        write_bits(block, 0x2, 2);
+        write_bits(block, (uint64_t)dod, 7);
+    } else if (dod >= -256 && dod <= 255) {
+        write_bits(block, 0x6, 3);
+        write_bits(block, (uint64_t)dod, 9);
+    } else if (dod >= -2048 && dod <= 2047) {
+        write_bits(block, 0xE, 4);
+        write_bits(block, (uint64_t)dod, 12);
+    } else if (dod >= INT32_MIN && dod <= INT32_MAX) {
+        write_bits(block, 0x1E, 5);
+        write_bits(block, (uint64_t)dod, 32);
+    } else {
+        write_bits(block, 0x1F, 5);
+        write_bits(block, (uint64_t)dod, 64);
+    }
+}
+
+static int64_t decode_timestamp(SnooperTsBlockReader *reader) {
+    static const int widths[] = { 7, 9, 12, 32 };
+    int prefix = 0;
+    while (prefix < 5 && read_bits(reader, 1)) {
+        ++prefix;
+    }
+    if (prefix == 0) {
+        return 0;
+    }
+    int bits = prefix < 5 ? widths[prefix - 1] : 64;
+    return sign_extend(read_bits(reader, bits), bits);
+}
+
+static void encode_value(SnooperTsBlock *block, SnooperTsCodecState *state, uint64_t bits) {
+    uint64_t xor_bits = bits ^ state->previous_bits;
+    state->previous_bits = bits;
+    if (xor_bits == 0) {
+        write_bits(block, 0, 1);
+        return;
+    }
+
+    int leading = __builtin_clzll(xor_bits);
+    int trailing = __builtin_ctzll(xor_bits);
+    if (leading > 31) {
+        leading = 31;
+    }
+
+    if (state->leading >= 0 && leading >= state->leading && trailing >= state->trailing) {
+        int meaningful = 64 - state->leading - state->trailing;
+        write_bits(block, 0x2, 2);
+        write_bits(block, xor_bits >> state->trailing, meaningful);
+        return;
+    }
+
+    int meaningful = 64 - leading - trailing;
+    write_bits(block, 0x3, 2);
+    write_bits(block, (uint64_t)leading, 5);
+    write_bits(block, (uint64_t)(meaningful & 63), 6);
+    write_bits(block, xor_bits >> trailing, meaningful);
+    state->leading = leading;
+    state->trailing = trailing;
+}
+
+static uint64_t decode_value(SnooperTsBlockReader *reader) {
+    SnooperTsCodecState *state = &reader->state;
+    if (!read_bits(reader, 1)) {
+        return state->previous_bits;
+    }
+
+    if (read_bits(reader, 1)) {
+        state->leading = (int)read_bits(reader, 5);
+        int meaningful = (int)read_bits(reader, 6);
+        if (meaningful == 0) {
+            meaningful = 64;
+        }
+        state->trailing = 64 - state->leading - meaningful;
+    }
+
+    int meaningful = 64 - state->leading - state->trailing;
+    state->previous_bits ^= read_bits(reader, meaningful) << state->trailing;
+    return state->previous_bits;
+}
+
+SnooperStatus snooper_tsstore_init(SnooperTsStore *store, size_t memory_budget, size_t max_series, uint64_t resolution_ns) {
+    if (!store || max_series == 0) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    memset(store, 0, sizeof(*store));
+    size_t series_bytes = max_series * sizeof(SnooperTsSeries);
+    size_t per_block = sizeof(SnooperTsBlock) + sizeof(int32_t);
+    size_t block_capacity = memory_budget > series_bytes ? (memory_budget - series_bytes) / per_block : 0;
+    // Every series needs its open block plus one sealed block to evict.
+    if (block_capacity < 2 * max_series || block_capacity > INT32_MAX) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    store->blocks = malloc(block_capacity * sizeof(SnooperTsBlock));
+    store->next = malloc(block_capacity * sizeof(int32_t));
+    store->series = calloc(max_series, sizeof(SnooperTsSeries));
+    if (!store->blocks || !store->next || !store->series) {
+        snooper_tsstore_destroy(store);
+        return SNOOPER_ERR_NOMEM;
+    }
+
+    for (size_t i = 0; i < block_capacity; ++i) {
+        store->next[i] = i + 1 < block_capacity ? (int32_t)(i + 1) : -1;
+    }
+    store->block_capacity = block_capacity;
+    store->free_list = 0;
+    store->free_blocks = block_capacity;
+    store->series_capacity = max_series;
+    store->resolution_ns = resolution_ns ? resolution_ns : SNOOPER_TS_DEFAULT_RESOLUTION_NS;
+    return SNOOPER_OK;
+}
+
+void snooper_tsstore_destroy(SnooperTsStore *store) {
+    if (!store) return;
+    free(store->blocks);
+    free(store->next);
+    free(store->series);
+    memset(store, 0, sizeof(*store));
+}
+
+int snooper_tsstore_add_series(SnooperTsStore *store, const char *name) {
+    if (!store || !name || strlen(name) >= SNOOPER_TS_NAME_MAX) {
+        return -1;
+    }
+    int existing = snooper_tsstore_find_series(store, name);
+    if (existing >= 0) {
+        return existing;
+    }
+    if (store->series_count == store->series_capacity) {
+        return -1;
+    }
+
+    SnooperTsSeries *series = &store->series[store->series_count];
+    memset(series, 0, sizeof(*series));
+    strcpy(series->name, name);
+    series->oldest = -1;
+    series->newest = -1;
+    return (int)store->series_count++;
+}
+
+int snooper_tsstore_find_series(const SnooperTsStore *store, const char *name) {
+    if (!store || !name) return -1;
+    for (size_t i = 0; i < store->series_count; ++i) {
+        if (strcmp(store->series[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int32_t evict_oldest_block(SnooperTsStore *store) {
+    SnooperTsSeries *victim = NULL;
+    for (size_t i = 0; i < store->series_count; ++i) {
+        SnooperTsSeries *series = &store->series[i];
+        if (series->oldest < 0 || series->oldest == series->newest) {
+            continue;
+        }
+        if (!victim || store->blocks[series->oldest].last_ns < store->blocks[victim->oldest].last_ns) {
+            victim = series;
+        }
+    }
+    if (!victim) {
+        return -1;
+    }
+
+    int32_t block = victim->oldest;
+    victim->oldest = store->next[block];
+    --victim->block_count;
+    ++store->evicted_blocks;
+    return block;
+}
+
+static SnooperTsBlock *open_block(SnooperTsStore *store, SnooperTsSeries *series) {
+    int32_t block = store->free_list;
+    if (block >= 0) {
+        store->free_list = store->next[block];
+        --store->free_blocks;
+    } else {
+        block = evict_oldest_block(store);
+        if (block < 0) {
+            return NULL;
+        }
+    }
+
+    memset(&store->blocks[block], 0, sizeof(SnooperTsBlock));
+    store->next[block] = -1;
+    if (series->newest >= 0) {
+        store->next[series->newest] = block;
+    } else {
+        series->oldest = block;
+    }
+    series->newest = block;
+    ++series->block_count;
+    return &store->blocks[block];
+}
+
+SnooperStatus snooper_tsstore_append(SnooperTsStore *store, int series_index, uint64_t timestamp_ns, double value) {
+    if (!store || series_index < 0 || (size_t)series_index >= store->series_count) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    SnooperTsSeries *series = &store->series[series_index];
+    SnooperTsCodecState *state = &series->encoder;
+    int64_t units = (int64_t)(timestamp_ns / store->resolution_ns);
+    SnooperTsBlock *block = series->newest >= 0 ? &store->blocks[series->newest] : NULL;
+    if (block && units < state->previous_units) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    if (!block || block->bit_length + TS_MAX_POINT_BITS > SNOOPER_TS_PAYLOAD_SIZE * 8) {
+        block = open_block(store, series);
+        if (!block) {
+            return SNOOPER_ERR_NOMEM;
+        }
+    }
+
+    uint64_t bits = double_bits(value);
+    if (block->count == 0) {
+        write_bits(block, bits, 64);
+        state->previous_delta = 0;
+        state->previous_bits = bits;
+        state->leading = -1;
+        state->trailing = 0;
+        block->first_ns = (uint64_t)units * store->resolution_ns;
+        block->min = value;
+        block->max = value;
+    } else {
+        int64_t delta = units - state->previous_units;
+        encode_timestamp(block, delta - state->previous_delta);
+        encode_value(block, state, bits);
+        state->previous_delta = delta;
+        if (value < block->min) block->min = value;
+        if (value > block->max) block->max = value;
+    }
+
+    state->previous_units = units;
+    block->last_ns = (uint64_t)units * store->resolution_ns;
+    block->sum += value;
+    ++block->count;
+    return SNOOPER_OK;
+}
+
+// Hands every block of a series but the open one back to the free list, for
+// writers that have persisted them. Returns the number of blocks released.
+size_t snooper_tsstore_release_sealed(SnooperTsStore *store, int series_index) {
+    if (!store || series_index < 0 || (size_t)series_index >= store->series_count) {
+        return 0;
+    }
+
+    SnooperTsSeries *series = &store->series[series_index];
+    size_t released = 0;
+    while (series->oldest >= 0 && series->oldest != series->newest) {
+        int32_t block = series->oldest;
+        series->oldest = store->next[block];
+        store->next[block] = store->free_list;
+        store->free_list = block;
+        ++store->free_blocks;
+        --series->block_count;
+        ++released;
+    }
+    return released;
+}
+
+size_t snooper_tsstore_memory_used(const SnooperTsStore *store) {
+    if (!store) return 0;
+    return store->block_capacity * (sizeof(SnooperTsBlock) + sizeof(int32_t)) + store->series_capacity * sizeof(SnooperTsSeries);
+}
+
+void snooper_ts_range_all(SnooperTsRange *range) {
+    if (!range) return;
+    range->from_ns = 0;
+    range->to_ns = UINT64_MAX;
+    range->min_value = -DBL_MAX;
+    range->max_value = DBL_MAX;
+}
+
+int snooper_ts_block_overlaps(const SnooperTsBlock *block, const SnooperTsRange *range) {
+    return block->count > 0
+        && block->last_ns >= range->from_ns && block->first_ns <= range->to_ns
+        && block->max >= range->min_value && block->min <= range->max_value;
+}
+
+void snooper_ts_block_reader_init(SnooperTsBlockReader *reader, const SnooperTsBlock *block, uint64_t resolution_ns) {
+    if (!reader) return;
+    memset(reader, 0, sizeof(*reader));
+    reader->block = block;
+    reader->resolution_ns = resolution_ns ? resolution_ns : SNOOPER_TS_DEFAULT_RESOLUTION_NS;
+}
+
+int snooper_ts_block_reader_next(SnooperTsBlockReader *reader, uint64_t *timestamp_ns, double *value) {
+    if (!reader || !reader->block || reader->index >= reader->block->count) {
+        return 0;
+    }
+
+    SnooperTsCodecState *state = &reader->state;
+    if (reader->index == 0) {
+        state->previous_units = (int64_t)(reader->block->first_ns / reader->resolution_ns);
+        state->previous_delta = 0;
+        state->previous_bits = read_bits(reader, 64);
+        state->leading = -1;
+        state->trailing = 0;
+    } else {
+        state->previous_delta += decode_timestamp(reader);
+        state->previous_units += state->previous_delta;
+        decode_value(reader);
+    }
+
+    ++reader->index;
+    if (timestamp_ns) *timestamp_ns = (uint64_t)state->previous_units * reader->resolution_ns;
+    if (value) *value = bits_double(state->previous_bits);
+    return 1;
+}
+
+void snooper_ts_iter_init(SnooperTsIterator *iter, const SnooperTsStore *store, int series, const SnooperTsRange *range) {
+    if (!iter) return;
+    memset(iter, 0, sizeof(*iter));
+    iter->store = store;
+    iter->block = -1;
+    if (range) {
+        iter->range = *range;
+    } else {
+        snooper_ts_range_all(&iter->range);
+    }
+    if (store && series >= 0 && (size_t)series < store->series_count) {
+        iter->block = store->series[series].oldest;
+    }
+}
+
+const SnooperTsBlock *snooper_ts_iter_next_block(SnooperTsIterator *iter) {
+    if (!iter || !iter->store) return NULL;
+
+    while (iter->block >= 0) {
+        const SnooperTsBlock *block = &iter->store->blocks[iter->block];
+        iter->block = iter->store->next[iter->block];
+        if (block->first_ns > iter->range.to_ns) {
+            iter->block = -1;
+            return NULL;
+        }
+        if (snooper_ts_block_overlaps(block, &iter->range)) {
+            return block;
+        }
+        ++iter->blocks_skipped;
+    }
+    return NULL;
+}
+
+int snooper_ts_iter_next(SnooperTsIterator *iter, uint64_t *timestamp_ns, double *value) {
+    if (!iter) return 0;
+
+    for (;;) {
+        if (iter->reading) {
+            uint64_t t;
+            double v;
+            while (snooper_ts_block_reader_next(&iter->reader, &t, &v)) {
+                if (t > iter->range.to_ns) {
+                    iter->reading = 0;
+                    iter->block = -1;
+                    return 0;
+                }
+                if (t >= iter->range.from_ns && v >= iter->range.min_value && v <= iter->range.max_value) {
+                    if (timestamp_ns) *timestamp_ns = t;
+                    if (value) *value = v;
+                    return 1;
+                }
+            }
+            iter->reading = 0;
+        }
+
+        const SnooperTsBlock *block = snooper_ts_iter_next_block(iter);
+        if (!block) {
+            return 0;
+        }
+        snooper_ts_block_reader_init(&iter->reader, block, iter->store->resolution_ns);
+        iter->reading = 1;
+    }
+}
+
+SnooperStatus snooper_tsstore_aggregate(const SnooperTsStore *store, int series, uint64_t from_ns, uint64_t to_ns, SnooperTsAggregate *out) {
+    if (!store || !out || series < 0 || (size_t)series >= store->series_count) {
+        return SNOOPER_ERR_INVALID;
+    }
+
+    out->count = 0;
+    out->min = DBL_MAX;
+    out->max = -DBL_MAX;
+    out->sum = 0.0;
+
+    SnooperTsRange range;
+    snooper_ts_range_all(&range);
+    range.from_ns = from_ns;
+    range.to_ns = to_ns;
+
+    SnooperTsIterator iter;
+    snooper_ts_iter_init(&iter, store, series, &range);
+    const SnooperTsBlock *block;
+    while ((block = snooper_ts_iter_next_block(&iter)) != NULL) {
+        if (block->first_ns >= from_ns && block->last_ns <= to_ns) {
+            out->count += block->count;
+            out->sum += block->sum;
+            if (block->min < out->min) out->min = block->min;
+            if (block->max > out->max) out->max = block->max;
+            continue;
+        }
+
+        SnooperTsBlockReader reader;
+        snooper_ts_block_reader_init(&reader, block, store->resolution_ns);
+        uint64_t t;
+        double v;
+        while (snooper_ts_block_reader_next(&reader, &t, &v)) {
+            if (t < from_ns) continue;
+            if (t > to_ns) break;
+            ++out->count;
+            out->sum += v;
+            if (v < out->min) out->min = v;
+            if (v > out->max) out->max = v;
+        }
+    }
+
+    return out->count > 0 ? SNOOPER_OK : SNOOPER_ERR_UNAVAILABLE;
+}
@@ -0,0 +1,453 @@
+// Accuracy and overhead harness for the collector.
+//
+//   cmake --build build --target snooper_accuracy
+//   ./build/snooper_accuracy --load 0:25,1:50,2:90 --intervals 100,500,1000 --duration 10
+//
+// Forks one duty-cycle worker per --load entry, pinned to its CPU where the
+// platform allows it, then runs the collector at each interval in turn. Every
+// sample's per-core usage is compared with the CPU time the worker actually
+// consumed over the same window. One NDJSON line is written per interval with
+// the error distribution, the collector's own CPU cost and its wakeup jitter,
+// so two runs can be diffed directly.
+#define _GNU_SOURCE
+#include "snooper/telemetry.h"
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#define HARNESS_MAX_WORKERS 64
+#define HARNESS_MAX_INTERVALS 16
+
+typedef struct {
+    int cpu;
+    double percent;
+} HarnessLoad;
+
+// Shared with the workers; each one publishes its consumed CPU time.
+typedef struct {
+    volatile uint64_t cpu_ns[HARNESS_MAX_WORKERS];
+    volatile int pinned[HARNESS_MAX_WORKERS];
+    volatile int ready[HARNESS_MAX_WORKERS];
+} HarnessShared;
+
+typedef struct {
+    HarnessLoad loads[HARNESS_MAX_WORKERS];
+    size_t load_count;
+    int intervals[HARNESS_MAX_INTERVALS];
+    size_t interval_count;
+    int duration_seconds;
+    int duty_ms;
+} HarnessOptions;
+
+typedef struct {
+    double *values;
+    size_t count;
+    size_t capacity;
+    int sorted;
+} HarnessSeries;
+
+static volatile sig_atomic_t harness_stop = 0;
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    harness_stop = 1;
+}
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t deadline_ns) {
+    struct timespec ts = { (time_t)(deadline_ns / 1000000000ull), (long)(deadline_ns % 1000000000ull) };
+#ifdef __linux__
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !harness_stop) {
+    }
+#else
+    uint64_t now = clock_ns(CLOCK_MONOTONIC);
+    if (deadline_ns > now) {
+        uint64_t delta = deadline_ns - now;
+        ts.tv_sec = (time_t)(delta / 1000000000ull);
+        ts.tv_nsec = (long)(delta % 1000000000ull);
+        nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+static uint64_t process_cpu_ns(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ull
+         + ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ull;
+}
+
+static int pin_to_cpu(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+// Spins for percent of every duty period and sleeps for the rest, publishing
+// CPU time as it goes so the parent can read it at any instant.
+static void run_worker(HarnessShared *shared, size_t index, const HarnessLoad *load, int duty_ms) {
+    shared->pinned[index] = pin_to_cpu(load->cpu);
+    shared->ready[index] = 1;
+
+    uint64_t period_ns = (uint64_t)duty_ms * 1000000ull;
+    uint64_t busy_ns = (uint64_t)((double)period_ns * load->percent / 100.0);
+    uint64_t start = clock_ns(CLOCK_MONOTONIC);
+    while (getppid() != 1) {
+        uint64_t busy_until = start + busy_ns;
+        while (clock_ns(CLOCK_MONOTONIC) < busy_until) {
+            shared->cpu_ns[index] = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+        }
+        shared->cpu_ns[index] = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+        start += period_ns;
+        sleep_until(start);
+    }
+    _exit(0);
+}
+
+static int series_push(HarnessSeries *series, double value) {
+    if (series->count == series->capacity) {
+        size_t capacity = series->capacity ? series->capacity * 2 : 256;
+        double *grown = realloc(series->values, capacity * sizeof(double));
+        if (!grown) {
+            return -1;
+        }
+        series->values = grown;
+        series->capacity = capacity;
+    }
+    series->values[series->count++] = value;
+    series->sorted = 0;
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts in place; nearest-rank percentile.
+static double series_percentile(HarnessSeries *series, double percentile) {
+    if (series->count == 0) return 0.0;
+    if (!series->sorted) {
+        qsort(series->values, series->count, sizeof(double), compare_double);
+        series->sorted = 1;
+    }
+    size_t rank = (size_t)ceil(percentile / 100.0 * (double)series->count);
+    if (rank == 0) rank = 1;
+    return series->values[rank - 1];
+}
+
+static double series_mean(const HarnessSeries *series) {
+    if (series->count == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < series->count; ++i) {
+        sum += series->values[i];
+    }
+    return sum / (double)series->count;
+}
+
+static void series_print(const char *name, HarnessSeries *series) {
+    double mean = series_mean(series);
+    double p50 = series_percentile(series, 50.0);
+    double p95 = series_percentile(series, 95.0);
+    double p99 = series_percentile(series, 99.0);
+    double max = series_percentile(series, 100.0);
+    printf("\"%s\":{\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f}"
+           , name, mean, p50, p95, p99, max);
+}
+
+static int parse_loads(const char *list, HarnessOptions *options) {
+    const char *cursor = list;
+    while (*cursor) {
+        char *end = NULL;
+        long cpu = strtol(cursor, &end, 10);
+        if (end == cursor || *end != ':' || cpu < 0) return -1;
+        cursor = end + 1;
+        double percent = strtod(cursor, &end);
+        if (end == cursor || percent < 0.0 || percent > 100.0) return -1;
+        if (options->load_count == HARNESS_MAX_WORKERS) return -1;
+        options->loads[options->load_count].cpu = (int)cpu;
+        options->loads[options->load_count].percent = percent;
+        options->load_count++;
+        cursor = end;
+        if (*cursor == ',') {
+            ++cursor;
+        } else if (*cursor) {
+            return -1;
+        }
+    }
+    return options->load_count > 0 ? 0 : -1;
+}
+
+static int parse_intervals(const char *list, HarnessOptions *options) {
+    const char *cursor = list;
+    options->interval_count = 0;
+    while (*cursor) {
+        char *end = NULL;
+        long interval = strtol(cursor, &end, 10);
+        if (end == cursor || interval <= 0 || options->interval_count == HARNESS_MAX_INTERVALS) return -1;
+        options->intervals[options->interval_count++] = (int)interval;
+        cursor = end;
+        if (*cursor == ',') {
+            ++cursor;
+        } else if (*cursor) {
+            return -1;
+        }
+    }
+    return options->interval_count > 0 ? 0 : -1;
+}
+
+static void print_usage(const char *progname) {
+    printf("Usage: %s --load <cpu:percent,...> [--intervals <ms,...>] [--duration <seconds>] [--duty <ms>]\n", progname);
+    printf("\nOptions:\n");
+    printf("  --load <cpu:pct,...>  Duty-cycle workers to start, e.g. 0:25,1:50,2:90.\n");
+    printf("  --intervals <ms,...>  Collector intervals to measure (default 100,250,1000).\n");
+    printf("  --duration <seconds>  Measurement time per interval (default 10).\n");
+    printf("  --duty <ms>           Busy/idle period of each worker (default 10).\n");
+}
+
+static int parse_arguments(int argc, char **argv, HarnessOptions *options) {
+    memset(options, 0, sizeof(*options));
+    options->duration_seconds = 10;
+    options->duty_ms = 10;
+    parse_intervals("100,250,1000", options);
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--load") == 0) {
+            if (i + 1 >= argc || parse_loads(argv[++i], options) != 0) {
+                fprintf(stderr, "Invalid --load.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--intervals") == 0) {
+            if (i + 1 >= argc || parse_intervals(argv[++i], options) != 0) {
+                fprintf(stderr, "Invalid --intervals.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--duration") == 0) {
+            if (i + 1 >= argc || (options->duration_seconds = atoi(argv[++i])) <= 0) {
+                fprintf(stderr, "Invalid --duration.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--duty") == 0) {
+            if (i + 1 >= argc || (options->duty_ms = atoi(argv[++i])) <= 0) {
+                fprintf(stderr, "Invalid --duty.\n");
+                return -1;
+            }
+        } else {
+            return -1;
+        }
+    }
+    if (options->load_count == 0) {
+        fprintf(stderr, "--load is required.\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void print_config(const HarnessOptions *options, const HarnessShared *shared) {
+    printf("{\"type\":\"config\",\"duration_s\":%d,\"duty_ms\":%d,\"online_cpus\":%ld,\"load\":["
+           , options->duration_seconds
+           , options->duty_ms
+           , sysconf(_SC_NPROCESSORS_ONLN));
+    for (size_t i = 0; i < options->load_count; ++i) {
+        printf("%s{\"cpu\":%d,\"percent\":%.1f,\"pinned\":%s}"
+               , i > 0 ? "," : ""
+               , options->loads[i].cpu
+               , options->loads[i].percent
+               , shared->pinned[i] ? "true" : "false");
+    }
+    printf("]}\n");
+    fflush(stdout);
+}
+
+// Measures one collector interval. Errors are measured minus true usage in
+// percentage points, over the window between two consecutive snapshots.
+static int measure_interval(const HarnessOptions *options, HarnessShared *shared, int interval_ms) {
+    SnooperTelemetry telemetry;
+    if (snooper_telemetry_init(&telemetry, 0) != SNOOPER_OK) {
+        fprintf(stderr, "Failed to initialize telemetry.\n");
+        return -1;
+    }
+    const SnooperSnapshot *snapshot = NULL;
+    HarnessSeries errors = {0};
+    HarnessSeries abs_errors = {0};
+    HarnessSeries lateness = {0};
+    HarnessSeries collect_us = {0};
+    HarnessSeries worker_abs[HARNESS_MAX_WORKERS];
+    double worker_truth[HARNESS_MAX_WORKERS] = {0};
+    double worker_measured[HARNESS_MAX_WORKERS] = {0};
+    memset(worker_abs, 0, sizeof(worker_abs));
+
+    uint64_t interval_ns = (uint64_t)interval_ms * 1000000ull;
+    uint64_t previous_cpu[HARNESS_MAX_WORKERS] = {0};
+    uint64_t previous_ns = 0;
+    size_t samples = 0;
+    uint64_t deadline = clock_ns(CLOCK_MONOTONIC);
+    uint64_t end = deadline + (uint64_t)options->duration_seconds * 1000000000ull;
+    uint64_t wall_start = 0;
+    uint64_t cpu_start = 0;
+
+    while (!harness_stop && deadline < end) {
+        sleep_until(deadline);
+        uint64_t woke = clock_ns(CLOCK_MONOTONIC);
+        SnooperStatus rc = snooper_snapshot_collect(&telemetry, &snapshot);
+        uint64_t collected = clock_ns(CLOCK_MONOTONIC);
+        uint64_t worker_cpu[HARNESS_MAX_WORKERS];
+        for (size_t i = 0; i < options->load_count; ++i) {
+            worker_cpu[i] = shared->cpu_ns[i];
+        }
+
+        if (rc == SNOOPER_OK) {
+            if (previous_ns != 0) {
+                double window = (double)(snapshot->monotonic_ns - previous_ns);
+                for (size_t i = 0; i < options->load_count; ++i) {
+                    size_t cpu = (size_t)options->loads[i].cpu;
+                    if (cpu >= snapshot->core_count || window <= 0.0) continue;
+                    double truth = 100.0 * (double)(worker_cpu[i] - previous_cpu[i]) / window;
+                    double measured = 100.0 - snapshot->per_core[cpu].idle;
+                    series_push(&errors, measured - truth);
+                    series_push(&abs_errors, fabs(measured - truth));
+                    series_push(&worker_abs[i], fabs(measured - truth));
+                    worker_truth[i] += truth;
+                    worker_measured[i] += measured;
+                }
+                series_push(&lateness, (double)(woke - deadline) / 1000.0);
+                series_push(&collect_us, (double)(collected - woke) / 1000.0);
+                ++samples;
+            } else {
+                // CPU overhead is counted from the first real sample so
+                // telemetry setup and warmup are excluded.
+                wall_start = clock_ns(CLOCK_MONOTONIC);
+                cpu_start = process_cpu_ns();
+            }
+            previous_ns = snapshot->monotonic_ns;
+            memcpy(previous_cpu, worker_cpu, sizeof(previous_cpu));
+        } else if (rc != SNOOPER_ERR_WARMUP) {
+            fprintf(stderr, "Failed to collect snapshot (%d).\n", rc);
+            break;
+        }
+
+        deadline += interval_ns;
+    }
+
+    uint64_t wall_ns = clock_ns(CLOCK_MONOTONIC) - wall_start;
+    uint64_t cpu_ns = process_cpu_ns() - cpu_start;
+    double mean_error = series_mean(&errors);
+
+    printf("{\"type\":\"interval\",\"interval_ms\":%d,\"samples\":%zu,\"cores\":%zu,\"error\":{\"mean\":%.4f,"
+           , interval_ms
+           , samples
+           , snapshot ? snapshot->core_count : 0
+           , mean_error);
+    series_print("abs", &abs_errors);
+    printf("},\"workers\":[");
+    for (size_t i = 0; i < options->load_count; ++i) {
+        double count = worker_abs[i].count ? (double)worker_abs[i].count : 1.0;
+        printf("%s{\"cpu\":%d,\"target\":%.1f,\"truth\":%.3f,\"measured\":%.3f,"
+               , i > 0 ? "," : ""
+               , options->loads[i].cpu
+               , options->loads[i].percent
+               , worker_truth[i] / count
+               , worker_measured[i] / count);
+        series_print("abs_error", &worker_abs[i]);
+        printf("}");
+    }
+    printf("],\"overhead\":{\"cpu_percent\":%.4f,\"cpu_us_per_sample\":%.2f,"
+           , wall_ns ? 100.0 * (double)cpu_ns / (double)wall_ns : 0.0
+           , samples ? (double)cpu_ns / 1000.0 / (double)samples : 0.0);
+    series_print("collect_us", &collect_us);
+    printf("},");
+    series_print("jitter_us", &lateness);
+    printf("}\n");
+    fflush(stdout);
+
+    free(errors.values);
+    free(abs_errors.values);
+    free(lateness.values);
+    free(collect_us.values);
+    for (size_t i = 0; i < options->load_count; ++i) {
+        free(worker_abs[i].values);
+    }
+    snooper_telemetry_destroy(&telemetry);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    HarnessOptions options;
+    if (parse_arguments(argc, argv, &options) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    HarnessShared *shared = mmap(NULL, sizeof(HarnessShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    memset(shared, 0, sizeof(*shared));
+
+    pid_t workers[HARNESS_MAX_WORKERS];
+    size_t started = 0;
+    for (; started < options.load_count; ++started) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        if (pid == 0) {
+            run_worker(shared, started, &options.loads[started], options.duty_ms);
+        }
+        workers[started] = pid;
+    }
+
+    int status = started == options.load_count ? 0 : 1;
+    if (status == 0) {
+        signal(SIGINT, handle_stop_signal);
+        signal(SIGTERM, handle_stop_signal);
+        for (size_t i = 0; i < started; ++i) {
+            while (!shared->ready[i]) {
+                usleep(1000);
+            }
+        }
+        print_config(&options, shared);
+        for (size_t i = 0; i < options.interval_count && !harness_stop; ++i) {
+            if (measure_interval(&options, shared, options.intervals[i]) != 0) {
+                status = 1;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < started; ++i) {
+        kill(workers[i], SIGTERM);
+        waitpid(workers[i], NULL, 0);
+    }
+    munmap(shared, sizeof(HarnessShared));
+    return status;
+}
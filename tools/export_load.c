@@ -0,0 +1,370 @@
+// Load generator for the Prometheus exporter.
+//
+//   cmake --build build --target snooper_export_load
+//   ./build/silicon_snooper export --listen 127.0.0.1:9464 --watch 1000 &
+//   ./build/snooper_export_load --listen 127.0.0.1:9464 --watch 1000 --scrapers 64 --duration 10
+//
+// Holds --scrapers keep-alive connections to a running exporter and has each
+// one request /metrics again as soon as its previous reply is complete. Every
+// reply's snooper_sample_monotonic_seconds is read back: the gap between
+// consecutive distinct samples minus --watch is the sampler's cadence slip
+// under that scrape load, and receive time minus sample time is how stale a
+// scrape was. Prints one NDJSON line with scrape throughput, reply latency,
+// slip and staleness.
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOAD_MAX_SCRAPERS 1024
+#define LOAD_REQUEST "GET /metrics HTTP/1.1\r\nHost: snooper\r\n\r\n"
+#define LOAD_SAMPLE_METRIC "\nsnooper_sample_monotonic_seconds "
+
+typedef struct {
+    double *values;
+    size_t count;
+    size_t capacity;
+} LoadSeries;
+
+typedef struct {
+    int fd;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    size_t request_offset;
+    uint64_t sent_ns;
+} LoadScraper;
+
+typedef struct {
+    uint64_t scrapes;
+    uint64_t unavailable;
+    uint64_t errors;
+    uint64_t bytes;
+    uint64_t last_sample_ns;
+    LoadSeries latency_us;
+    LoadSeries slip_ms;
+    LoadSeries staleness_ms;
+} LoadStats;
+
+static volatile sig_atomic_t load_stop = 0;
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    load_stop = 1;
+}
+
+// The collector stamps samples from the raw monotonic clock, so staleness
+// has to be measured against the same one.
+static uint64_t monotonic_now_ns(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC_RAW, &ts) != 0 && clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void series_add(LoadSeries *series, double value) {
+    if (series->count == series->capacity) {
+        size_t capacity = series->capacity ? series->capacity * 2 : 1024;
+        double *grown = realloc(series->values, capacity * sizeof(*grown));
+        if (!grown) return;
+        series->values = grown;
+        series->capacity = capacity;
+    }
+    series->values[series->count++] = value;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts the series in place; prints "name":{mean,p50,p99,max}.
+static void series_print(const char *name, LoadSeries *series) {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    if (series->count > 0) {
+        qsort(series->values, series->count, sizeof(double), compare_doubles);
+        for (size_t i = 0; i < series->count; ++i) {
+            mean += series->values[i];
+        }
+        mean /= (double)series->count;
+        size_t rank = (size_t)ceil(0.99 * (double)series->count);
+        p50 = series->values[(series->count - 1) / 2];
+        p99 = series->values[rank > 0 ? rank - 1 : 0];
+        max = series->values[series->count - 1];
+    }
+    printf("\"%s\":{\"count\":%zu,\"mean\":%.3f,\"p50\":%.3f,\"p99\":%.3f,\"max\":%.3f}"
+           , name
+           , series->count
+           , mean
+           , p50
+           , p99
+           , max);
+}
+
+static int parse_listen_address(const char *text, struct sockaddr_in *address) {
+    const char *colon = strrchr(text, ':');
+    if (!colon || colon == text || colon - text >= 64) {
+        return -1;
+    }
+    char host[64];
+    memcpy(host, text, (size_t)(colon - text));
+    host[colon - text] = '\0';
+    char *end = NULL;
+    long port = strtol(colon + 1, &end, 10);
+    if (*end != '\0' || port <= 0 || port > 65535) {
+        return -1;
+    }
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_port = htons((uint16_t)port);
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1 ? 0 : -1;
+}
+
+static int scraper_connect(LoadScraper *scraper, const struct sockaddr_in *address) {
+    scraper->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (scraper->fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(scraper->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(scraper->fd, (const struct sockaddr *)address, sizeof(*address)) != 0
+        || fcntl(scraper->fd, F_SETFL, fcntl(scraper->fd, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        close(scraper->fd);
+        scraper->fd = -1;
+        return -1;
+    }
+    scraper->length = 0;
+    scraper->request_offset = 0;
+    scraper->sent_ns = monotonic_now_ns();
+    return 0;
+}
+
+static void scraper_reset(LoadScraper *scraper) {
+    if (scraper->fd >= 0) close(scraper->fd);
+    scraper->fd = -1;
+}
+
+static int scraper_send(LoadScraper *scraper) {
+    static const char request[] = LOAD_REQUEST;
+    while (scraper->request_offset < sizeof(request) - 1) {
+        ssize_t n = write(scraper->fd, request + scraper->request_offset, sizeof(request) - 1 - scraper->request_offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        scraper->request_offset += (size_t)n;
+    }
+    return 0;
+}
+
+static void record_reply(LoadStats *stats, const char *body, size_t body_length, uint64_t sent_ns, uint64_t now_ns, uint64_t interval_ns) {
+    stats->scrapes++;
+    stats->bytes += body_length;
+    series_add(&stats->latency_us, (double)(now_ns - sent_ns) / 1e3);
+
+    // The reply buffer is NUL-terminated right after the body.
+    const char *line = strstr(body, LOAD_SAMPLE_METRIC);
+    if (!line) return;
+    double seconds = strtod(line + sizeof(LOAD_SAMPLE_METRIC) - 1, NULL);
+    uint64_t sample_ns = (uint64_t)llround(seconds * 1e9);
+    series_add(&stats->staleness_ms, (double)((int64_t)now_ns - (int64_t)sample_ns) / 1e6);
+
+    // Scrapers race each other, so only a sample newer than any seen before
+    // marks a new tick of the exporter's sampler.
+    if (sample_ns > stats->last_sample_ns) {
+        if (stats->last_sample_ns > 0) {
+            series_add(&stats->slip_ms, ((double)(sample_ns - stats->last_sample_ns) - (double)interval_ns) / 1e6);
+        }
+        stats->last_sample_ns = sample_ns;
+    }
+}
+
+// Returns 1 once a full reply is consumed, 0 while more bytes are pending
+// and -1 when the connection has to be replaced.
+static int scraper_receive(LoadScraper *scraper, LoadStats *stats, uint64_t interval_ns) {
+    for (;;) {
+        if (scraper->capacity - scraper->length < 4096) {
+            size_t capacity = scraper->capacity ? scraper->capacity * 2 : 65536;
+            char *grown = realloc(scraper->buffer, capacity + 1);
+            if (!grown) return -1;
+            scraper->buffer = grown;
+            scraper->capacity = capacity;
+        }
+        ssize_t n = recv(scraper->fd, scraper->buffer + scraper->length, scraper->capacity - scraper->length, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        if (n == 0) return -1;
+        scraper->length += (size_t)n;
+    }
+
+    scraper->buffer[scraper->length] = '\0';
+    char *headers_end = strstr(scraper->buffer, "\r\n\r\n");
+    if (!headers_end) return 0;
+    const char *length_header = strstr(scraper->buffer, "Content-Length: ");
+    if (!length_header || length_header > headers_end) return -1;
+
+    size_t header_length = (size_t)(headers_end - scraper->buffer) + 4;
+    size_t body_length = strtoul(length_header + 16, NULL, 10);
+    if (scraper->length < header_length + body_length) return 0;
+
+    uint64_t now = monotonic_now_ns();
+    if (strncmp(scraper->buffer, "HTTP/1.1 200 ", 13) == 0) {
+        record_reply(stats, scraper->buffer + header_length, body_length, scraper->sent_ns, now, interval_ns);
+    } else if (strncmp(scraper->buffer, "HTTP/1.1 503 ", 13) == 0) {
+        stats->unavailable++;
+    } else {
+        stats->errors++;
+    }
+
+    // Closed loop: the next request goes out as soon as a reply lands.
+    scraper->length = 0;
+    scraper->request_offset = 0;
+    scraper->sent_ns = now;
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    const char *listen_address = "127.0.0.1:9464";
+    int scraper_count = 16;
+    int duration_seconds = 10;
+    int interval_ms = 1000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            listen_address = argv[++i];
+        } else if (strcmp(argv[i], "--scrapers") == 0 && i + 1 < argc) {
+            scraper_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            interval_ms = atoi(argv[++i]);
+        } else {
+            printf("Usage: %s [--listen <ip>:<port>] [--scrapers <n>] [--duration <seconds>] [--watch <milliseconds>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (scraper_count <= 0 || scraper_count > LOAD_MAX_SCRAPERS || duration_seconds <= 0 || interval_ms <= 0) {
+        fprintf(stderr, "--scrapers must be 1..%d; --duration and --watch must be positive.\n", LOAD_MAX_SCRAPERS);
+        return 1;
+    }
+
+    struct sockaddr_in address;
+    if (parse_listen_address(listen_address, &address) != 0) {
+        fprintf(stderr, "Invalid address: %s\n", listen_address);
+        return 1;
+    }
+
+    LoadScraper *scrapers = calloc((size_t)scraper_count, sizeof(*scrapers));
+    struct pollfd *fds = calloc((size_t)scraper_count, sizeof(*fds));
+    if (!scrapers || !fds) {
+        fprintf(stderr, "Failed to allocate scrapers.\n");
+        free(scrapers);
+        free(fds);
+        return 1;
+    }
+    for (int i = 0; i < scraper_count; ++i) {
+        scrapers[i].fd = -1;
+    }
+    for (int i = 0; i < scraper_count; ++i) {
+        if (scraper_connect(&scrapers[i], &address) != 0) {
+            fprintf(stderr, "Failed to connect to %s.\n", listen_address);
+            for (int j = 0; j < i; ++j) {
+                scraper_reset(&scrapers[j]);
+            }
+            free(scrapers);
+            free(fds);
+            return 1;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handle_stop_signal);
+    signal(SIGTERM, handle_stop_signal);
+
+    LoadStats stats;
+    memset(&stats, 0, sizeof(stats));
+    uint64_t interval_ns = (uint64_t)interval_ms * 1000000ull;
+    uint64_t start = monotonic_now_ns();
+    uint64_t end = start + (uint64_t)duration_seconds * 1000000000ull;
+    uint64_t now = start;
+    while (!load_stop && now < end) {
+        for (int i = 0; i < scraper_count; ++i) {
+            LoadScraper *scraper = &scrapers[i];
+            if (scraper->fd < 0 && scraper_connect(scraper, &address) != 0) {
+                stats.errors++;
+            }
+            if (scraper->fd >= 0 && scraper_send(scraper) != 0) {
+                stats.errors++;
+                scraper_reset(scraper);
+            }
+            fds[i].fd = scraper->fd;
+            fds[i].events = scraper->request_offset < sizeof(LOAD_REQUEST) - 1 ? POLLOUT : POLLIN;
+            fds[i].revents = 0;
+        }
+
+        int remaining_ms = (int)((end - now) / 1000000ull) + 1;
+        if (poll(fds, (nfds_t)scraper_count, remaining_ms < 100 ? remaining_ms : 100) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        for (int i = 0; i < scraper_count; ++i) {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (scrapers[i].request_offset < sizeof(LOAD_REQUEST) - 1) continue;
+            if (scraper_receive(&scrapers[i], &stats, interval_ns) < 0) {
+                stats.errors++;
+                scraper_reset(&scrapers[i]);
+            }
+        }
+        now = monotonic_now_ns();
+    }
+
+    double elapsed = (double)(monotonic_now_ns() - start) / 1e9;
+    printf("{\"type\":\"export_load\",\"listen\":\"%s\",\"scrapers\":%d,\"watch_ms\":%d,\"seconds\":%.3f,\"scrapes\":%llu,\"scrapes_per_sec\":%.1f,\"mib_per_sec\":%.2f,\"unavailable\":%llu,\"errors\":%llu,"
+           , listen_address
+           , scraper_count
+           , interval_ms
+           , elapsed
+           , (unsigned long long)stats.scrapes
+           , (double)stats.scrapes / elapsed
+           , (double)stats.bytes / elapsed / (1024.0 * 1024.0)
+           , (unsigned long long)stats.unavailable
+           , (unsigned long long)stats.errors);
+    series_print("latency_us", &stats.latency_us);
+    printf(",");
+    series_print("cadence_slip_ms", &stats.slip_ms);
+    printf(",");
+    series_print("staleness_ms", &stats.staleness_ms);
+    printf("}\n");
+
+    for (int i = 0; i < scraper_count; ++i) {
+        scraper_reset(&scrapers[i]);
+        free(scrapers[i].buffer);
+    }
+    free(scrapers);
+    free(fds);
+    free(stats.latency_us.values);
+    free(stats.slip_ms.values);
+    free(stats.staleness_ms.values);
+    return stats.scrapes > 0 ? 0 : 1;
+}
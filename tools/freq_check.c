@@ -0,0 +1,198 @@
+// Fixture check for the frequency probe.
+//
+//   cmake --build build --target snooper_freq_check
+//   ./build/snooper_freq_check [--fixtures tools/fixtures/freq]
+//
+// Same shape as snooper_numa_check: before/ is copied into a temporary
+// SNOOPER_FS_ROOT for a first sample, after/ is written over it in place
+// and a second sample is taken two seconds later. cpu1 has no cpufreq
+// directory, so cpu2 must still be found and keep its id, and the acpitz
+// zone reports negative millidegrees. Prints one NDJSON line and exits
+// non-zero on any mismatch.
+#include "snooper/frequency.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHECK_WINDOW_NS 2000000000ull
+
+typedef struct {
+    size_t checks;
+    size_t failed;
+} CheckResult;
+
+static int copy_file(const char *source, const char *target) {
+    int in = open(source, O_RDONLY);
+    if (in < 0) return -1;
+    // Truncating in place keeps the inode, so fds the probe already holds
+    // see the new contents.
+    int out = open(target, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+
+    char buffer[4096];
+    ssize_t n;
+    int status = 0;
+    while ((n = read(in, buffer, sizeof(buffer))) > 0) {
+        if (write(out, buffer, (size_t)n) != n) {
+            status = -1;
+            break;
+        }
+    }
+    if (n < 0) status = -1;
+    close(in);
+    close(out);
+    return status;
+}
+
+static int copy_tree(const char *source, const char *target) {
+    DIR *dir = opendir(source);
+    if (!dir) return -1;
+    if (mkdir(target, 0755) != 0 && access(target, F_OK) != 0) {
+        closedir(dir);
+        return -1;
+    }
+
+    int status = 0;
+    struct dirent *entry;
+    while (status == 0 && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        char from[PATH_MAX];
+        char to[PATH_MAX];
+        snprintf(from, sizeof(from), "%s/%s", source, entry->d_name);
+        snprintf(to, sizeof(to), "%s/%s", target, entry->d_name);
+        struct stat st;
+        if (stat(from, &st) != 0) {
+            status = -1;
+        } else if (S_ISDIR(st.st_mode)) {
+            status = copy_tree(from, to);
+        } else {
+            status = copy_file(from, to);
+        }
+    }
+    closedir(dir);
+    return status;
+}
+
+static void remove_tree(const char *path) {
+    DIR *dir = opendir(path);
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            char child[PATH_MAX];
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            remove_tree(child);
+        }
+        closedir(dir);
+    }
+    remove(path);
+}
+
+static void expect(CheckResult *result, const char *name, double actual, double expected) {
+    result->checks++;
+    if (fabs(actual - expected) > 1e-6 * fmax(1.0, fabs(expected))) {
+        result->failed++;
+        fprintf(stderr, "%s: got %.6f, expected %.6f\n", name, actual, expected);
+    }
+}
+
+static void check_stats(CheckResult *result, const SnooperFreqStats *stats) {
+    expect(result, "core_count", (double)stats->core_count, 3);
+    expect(result, "has_msr", stats->has_msr, 0);
+    if (stats->core_count != 3) return;
+
+    const SnooperFreqCore *cpu0 = &stats->cores[0];
+    expect(result, "cpu0.present", cpu0->present, 1);
+    expect(result, "cpu0.current_mhz", cpu0->current_mhz, 1200.0);
+    expect(result, "cpu0.max_mhz", cpu0->max_mhz, 3000.0);
+    expect(result, "cpu0.used_percent", cpu0->used_percent, 50.0);
+    expect(result, "cpu0.normalized_used_percent", cpu0->normalized_used_percent, 20.0);
+    expect(result, "cpu0.core_throttles", (double)cpu0->core_throttles, 3);
+    expect(result, "cpu0.package_throttles", (double)cpu0->package_throttles, 1);
+
+    expect(result, "cpu1.present", stats->cores[1].present, 0);
+
+    const SnooperFreqCore *cpu2 = &stats->cores[2];
+    expect(result, "cpu2.present", cpu2->present, 1);
+    expect(result, "cpu2.current_mhz", cpu2->current_mhz, 2400.0);
+    expect(result, "cpu2.normalized_used_percent", cpu2->normalized_used_percent, 20.0);
+    expect(result, "cpu2.core_throttles", (double)cpu2->core_throttles, 0);
+    expect(result, "cpu2.package_throttles", (double)cpu2->package_throttles, 1);
+
+    expect(result, "zone_count", (double)stats->zone_count, 2);
+    if (stats->zone_count != 2) return;
+    expect(result, "zone0.celsius", stats->zones[0].celsius, 47.5);
+    expect(result, "zone1.celsius", stats->zones[1].celsius, -5.0);
+    result->checks++;
+    if (strcmp(stats->zones[1].type, "acpitz") != 0) {
+        result->failed++;
+        fprintf(stderr, "zone1.type: got \"%s\", expected \"acpitz\"\n", stats->zones[1].type);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *fixtures = "tools/fixtures/freq";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--fixtures") == 0 && i + 1 < argc) {
+            fixtures = argv[++i];
+        } else {
+            printf("Usage: %s [--fixtures <dir>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char root[] = "/tmp/snooper-freq-XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    char before[PATH_MAX];
+    char after[PATH_MAX];
+    snprintf(before, sizeof(before), "%s/before", fixtures);
+    snprintf(after, sizeof(after), "%s/after", fixtures);
+    if (copy_tree(before, root) != 0) {
+        fprintf(stderr, "Failed to copy fixtures from %s.\n", before);
+        remove_tree(root);
+        return 1;
+    }
+    setenv("SNOOPER_FS_ROOT", root, 1);
+
+    // Average busy percent per core over the window, as telemetry passes it.
+    const double used_percent[3] = { 50.0, 0.0, 25.0 };
+
+    CheckResult result = {0};
+    FreqProbe probe;
+    SnooperFreqStats *stats = calloc(1, sizeof(*stats));
+    SnooperStatus first = SNOOPER_ERR_INVALID;
+    SnooperStatus second = SNOOPER_ERR_INVALID;
+    if (stats && freq_probe_init(&probe, NULL) == SNOOPER_OK) {
+        first = freq_probe_sample(&probe, CHECK_WINDOW_NS, NULL, 0, stats);
+        if (copy_tree(after, root) != 0) {
+            fprintf(stderr, "Failed to copy fixtures from %s.\n", after);
+        } else {
+            second = freq_probe_sample(&probe, 2 * CHECK_WINDOW_NS, used_percent, 3, stats);
+        }
+        freq_probe_destroy(&probe);
+    }
+
+    expect(&result, "first_status", first, SNOOPER_OK);
+    expect(&result, "sample_status", second, SNOOPER_OK);
+    if (second == SNOOPER_OK) {
+        check_stats(&result, stats);
+    }
+    free(stats);
+    remove_tree(root);
+
+    printf("{\"type\":\"freq_check\",\"fixtures\":\"%s\",\"checks\":%zu,\"failed\":%zu}\n", fixtures, result.checks, result.failed);
+    return result.failed == 0 ? 0 : 1;
+}
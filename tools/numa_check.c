@@ -0,0 +1,193 @@
+// Fixture check for the NUMA probe.
+//
+//   cmake --build build --target snooper_numa_check
+//   ./build/snooper_numa_check [--fixtures tools/fixtures/numa]
+//
+// Copies the fixture's before/ tree into a temporary root, points
+// SNOOPER_FS_ROOT at it and takes a warmup sample, then overwrites the same
+// files with after/ and samples again two seconds later. The probe keeps its
+// fds open across samples, so the rewrite is seen the way a live sysfs
+// update would be. Every rate and byte count is compared with the values
+// the fixture was built for; prints one NDJSON line and exits non-zero on
+// any mismatch.
+#include "snooper/numa.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHECK_WINDOW_NS 2000000000ull
+
+typedef struct {
+    size_t checks;
+    size_t failed;
+} CheckResult;
+
+static int copy_file(const char *source, const char *target) {
+    int in = open(source, O_RDONLY);
+    if (in < 0) return -1;
+    // Truncating in place keeps the inode, so fds the probe already holds
+    // see the new contents.
+    int out = open(target, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+
+    char buffer[4096];
+    ssize_t n;
+    int status = 0;
+    while ((n = read(in, buffer, sizeof(buffer))) > 0) {
+        if (write(out, buffer, (size_t)n) != n) {
+            status = -1;
+            break;
+        }
+    }
+    if (n < 0) status = -1;
+    close(in);
+    close(out);
+    return status;
+}
+
+static int copy_tree(const char *source, const char *target) {
+    DIR *dir = opendir(source);
+    if (!dir) return -1;
+    if (mkdir(target, 0755) != 0 && access(target, F_OK) != 0) {
+        closedir(dir);
+        return -1;
+    }
+
+    int status = 0;
+    struct dirent *entry;
+    while (status == 0 && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        char from[PATH_MAX];
+        char to[PATH_MAX];
+        snprintf(from, sizeof(from), "%s/%s", source, entry->d_name);
+        snprintf(to, sizeof(to), "%s/%s", target, entry->d_name);
+        struct stat st;
+        if (stat(from, &st) != 0) {
+            status = -1;
+        } else if (S_ISDIR(st.st_mode)) {
+            status = copy_tree(from, to);
+        } else {
+            status = copy_file(from, to);
+        }
+    }
+    closedir(dir);
+    return status;
+}
+
+static void remove_tree(const char *path) {
+    DIR *dir = opendir(path);
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            char child[PATH_MAX];
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            remove_tree(child);
+        }
+        closedir(dir);
+    }
+    remove(path);
+}
+
+static void expect(CheckResult *result, const char *name, double actual, double expected) {
+    result->checks++;
+    if (fabs(actual - expected) > 1e-6 * fmax(1.0, fabs(expected))) {
+        result->failed++;
+        fprintf(stderr, "%s: got %.6f, expected %.6f\n", name, actual, expected);
+    }
+}
+
+static void check_stats(CheckResult *result, const SnooperNumaStats *stats) {
+    expect(result, "node_count", (double)stats->node_count, 2);
+    if (stats->node_count != 2) return;
+
+    const SnooperNumaNode *node0 = &stats->nodes[0];
+    const SnooperNumaNode *node1 = &stats->nodes[1];
+    expect(result, "node0.id", node0->id, 0);
+    expect(result, "node0.total_bytes", (double)node0->total_bytes, 16318464.0 * 1024.0);
+    expect(result, "node0.free_bytes", (double)node0->free_bytes, 8000000.0 * 1024.0);
+    expect(result, "node0.used_bytes", (double)node0->used_bytes, 8318464.0 * 1024.0);
+    expect(result, "node0.hit_per_sec", node0->hit_per_sec, 10000.0);
+    expect(result, "node0.miss_per_sec", node0->miss_per_sec, 200.0);
+    expect(result, "node0.foreign_per_sec", node0->foreign_per_sec, 50.0);
+    expect(result, "node0.local_per_sec", node0->local_per_sec, 9500.0);
+    expect(result, "node0.other_per_sec", node0->other_per_sec, 700.0);
+
+    expect(result, "node1.id", node1->id, 1);
+    expect(result, "node1.used_bytes", (double)node1->used_bytes, 4128768.0 * 1024.0);
+    expect(result, "node1.hit_per_sec", node1->hit_per_sec, 3000.0);
+    expect(result, "node1.miss_per_sec", node1->miss_per_sec, 0.0);
+    expect(result, "node1.foreign_per_sec", node1->foreign_per_sec, 200.0);
+    expect(result, "node1.local_per_sec", node1->local_per_sec, 2500.0);
+    expect(result, "node1.other_per_sec", node1->other_per_sec, 500.0);
+
+    expect(result, "has_vmstat", stats->has_vmstat, 1);
+    expect(result, "pages_migrated_per_sec", stats->pages_migrated_per_sec, 1000.0);
+    expect(result, "migrate_failures_per_sec", stats->migrate_failures_per_sec, 10.0);
+    expect(result, "balancing_migrated_per_sec", stats->balancing_migrated_per_sec, 300.0);
+    expect(result, "hint_faults_per_sec", stats->hint_faults_per_sec, 4000.0);
+    expect(result, "hint_faults_local_percent", stats->hint_faults_local_percent, 75.0);
+}
+
+int main(int argc, char **argv) {
+    const char *fixtures = "tools/fixtures/numa";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--fixtures") == 0 && i + 1 < argc) {
+            fixtures = argv[++i];
+        } else {
+            printf("Usage: %s [--fixtures <dir>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char root[] = "/tmp/snooper-numa-XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    char before[PATH_MAX];
+    char after[PATH_MAX];
+    snprintf(before, sizeof(before), "%s/before", fixtures);
+    snprintf(after, sizeof(after), "%s/after", fixtures);
+    if (copy_tree(before, root) != 0) {
+        fprintf(stderr, "Failed to copy fixtures from %s.\n", before);
+        remove_tree(root);
+        return 1;
+    }
+    setenv("SNOOPER_FS_ROOT", root, 1);
+
+    CheckResult result = {0};
+    NumaProbe probe;
+    SnooperNumaStats stats;
+    SnooperStatus first = SNOOPER_ERR_INVALID;
+    SnooperStatus second = SNOOPER_ERR_INVALID;
+    if (numa_probe_init(&probe, NULL) == SNOOPER_OK) {
+        first = numa_probe_sample(&probe, CHECK_WINDOW_NS, &stats);
+        if (copy_tree(after, root) != 0) {
+            fprintf(stderr, "Failed to copy fixtures from %s.\n", after);
+        } else {
+            second = numa_probe_sample(&probe, 2 * CHECK_WINDOW_NS, &stats);
+        }
+        numa_probe_destroy(&probe);
+    }
+
+    expect(&result, "warmup_status", first, SNOOPER_ERR_WARMUP);
+    expect(&result, "sample_status", second, SNOOPER_OK);
+    if (second == SNOOPER_OK) {
+        check_stats(&result, &stats);
+    }
+    remove_tree(root);
+
+    printf("{\"type\":\"numa_check\",\"fixtures\":\"%s\",\"checks\":%zu,\"failed\":%zu}\n", fixtures, result.checks, result.failed);
+    return result.failed == 0 ? 0 : 1;
+}
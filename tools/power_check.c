@@ -0,0 +1,197 @@
+// Fixture check for the power probe.
+//
+//   cmake --build build --target snooper_power_check
+//   ./build/snooper_power_check [--fixtures tools/fixtures/power]
+//
+// Same shape as snooper_numa_check: before/ is copied into a temporary
+// SNOOPER_FS_ROOT for a warmup sample, after/ is written over it in place
+// and a second sample is taken two seconds later. package-0's energy_uj
+// wraps past max_energy_range_uj between the two, so the check covers the
+// wraparound path as well as subzone naming and the joules per busy
+// core-second figure. Prints one NDJSON line and exits non-zero on any
+// mismatch.
+#include "snooper/power.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHECK_WINDOW_NS 2000000000ull
+// Busy core-seconds handed to the second sample.
+#define CHECK_BUSY_CORE_SECONDS 4.0
+
+typedef struct {
+    size_t checks;
+    size_t failed;
+} CheckResult;
+
+static int copy_file(const char *source, const char *target) {
+    int in = open(source, O_RDONLY);
+    if (in < 0) return -1;
+    // Truncating in place keeps the inode, so fds the probe already holds
+    // see the new contents.
+    int out = open(target, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+
+    char buffer[4096];
+    ssize_t n;
+    int status = 0;
+    while ((n = read(in, buffer, sizeof(buffer))) > 0) {
+        if (write(out, buffer, (size_t)n) != n) {
+            status = -1;
+            break;
+        }
+    }
+    if (n < 0) status = -1;
+    close(in);
+    close(out);
+    return status;
+}
+
+static int copy_tree(const char *source, const char *target) {
+    DIR *dir = opendir(source);
+    if (!dir) return -1;
+    if (mkdir(target, 0755) != 0 && access(target, F_OK) != 0) {
+        closedir(dir);
+        return -1;
+    }
+
+    int status = 0;
+    struct dirent *entry;
+    while (status == 0 && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        char from[PATH_MAX];
+        char to[PATH_MAX];
+        snprintf(from, sizeof(from), "%s/%s", source, entry->d_name);
+        snprintf(to, sizeof(to), "%s/%s", target, entry->d_name);
+        struct stat st;
+        if (stat(from, &st) != 0) {
+            status = -1;
+        } else if (S_ISDIR(st.st_mode)) {
+            status = copy_tree(from, to);
+        } else {
+            status = copy_file(from, to);
+        }
+    }
+    closedir(dir);
+    return status;
+}
+
+static void remove_tree(const char *path) {
+    DIR *dir = opendir(path);
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            char child[PATH_MAX];
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            remove_tree(child);
+        }
+        closedir(dir);
+    }
+    remove(path);
+}
+
+static void expect(CheckResult *result, const char *name, double actual, double expected) {
+    result->checks++;
+    if (fabs(actual - expected) > 1e-6 * fmax(1.0, fabs(expected))) {
+        result->failed++;
+        fprintf(stderr, "%s: got %.6f, expected %.6f\n", name, actual, expected);
+    }
+}
+
+static void expect_name(CheckResult *result, const char *name, const char *actual, const char *expected) {
+    result->checks++;
+    if (strcmp(actual, expected) != 0) {
+        result->failed++;
+        fprintf(stderr, "%s: got \"%s\", expected \"%s\"\n", name, actual, expected);
+    }
+}
+
+static void check_sample(CheckResult *result, const SnooperPowerSample *sample) {
+    expect(result, "available", sample->available, 1);
+    expect(result, "domain_count", (double)sample->domain_count, 3);
+    if (sample->domain_count != 3) return;
+
+    // package-0 wraps: (262143328850 - 262143000000) + 39671150 uJ = 40 J.
+    const SnooperPowerDomain *package0 = &sample->domains[0];
+    expect_name(result, "domain0.name", package0->name, "package-0");
+    expect(result, "domain0.is_package", package0->is_package, 1);
+    expect(result, "domain0.joules", package0->joules, 40.0);
+    expect(result, "domain0.watts", package0->watts, 20.0);
+
+    const SnooperPowerDomain *core = &sample->domains[1];
+    expect_name(result, "domain1.name", core->name, "package-0/core");
+    expect(result, "domain1.is_package", core->is_package, 0);
+    expect(result, "domain1.joules", core->joules, 20.0);
+    expect(result, "domain1.watts", core->watts, 10.0);
+
+    const SnooperPowerDomain *package1 = &sample->domains[2];
+    expect_name(result, "domain2.name", package1->name, "package-1");
+    expect(result, "domain2.joules", package1->joules, 20.0);
+
+    expect(result, "package_watts", sample->package_watts, 30.0);
+    expect(result, "joules_per_busy_core_second", sample->joules_per_busy_core_second, 60.0 / CHECK_BUSY_CORE_SECONDS);
+}
+
+int main(int argc, char **argv) {
+    const char *fixtures = "tools/fixtures/power";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--fixtures") == 0 && i + 1 < argc) {
+            fixtures = argv[++i];
+        } else {
+            printf("Usage: %s [--fixtures <dir>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char root[] = "/tmp/snooper-power-XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    char before[PATH_MAX];
+    char after[PATH_MAX];
+    snprintf(before, sizeof(before), "%s/before", fixtures);
+    snprintf(after, sizeof(after), "%s/after", fixtures);
+    if (copy_tree(before, root) != 0) {
+        fprintf(stderr, "Failed to copy fixtures from %s.\n", before);
+        remove_tree(root);
+        return 1;
+    }
+    setenv("SNOOPER_FS_ROOT", root, 1);
+
+    CheckResult result = {0};
+    PowerProbe probe;
+    SnooperPowerSample sample;
+    SnooperStatus first = SNOOPER_ERR_INVALID;
+    SnooperStatus second = SNOOPER_ERR_INVALID;
+    if (power_probe_init(&probe, NULL) == SNOOPER_OK) {
+        first = power_probe_sample(&probe, CHECK_WINDOW_NS, 0.0, &sample);
+        if (copy_tree(after, root) != 0) {
+            fprintf(stderr, "Failed to copy fixtures from %s.\n", after);
+        } else {
+            second = power_probe_sample(&probe, 2 * CHECK_WINDOW_NS, CHECK_BUSY_CORE_SECONDS, &sample);
+        }
+        power_probe_destroy(&probe);
+    }
+
+    expect(&result, "warmup_status", first, SNOOPER_ERR_WARMUP);
+    expect(&result, "sample_status", second, SNOOPER_OK);
+    if (second == SNOOPER_OK) {
+        check_sample(&result, &sample);
+    }
+    remove_tree(root);
+
+    printf("{\"type\":\"power_check\",\"fixtures\":\"%s\",\"checks\":%zu,\"failed\":%zu}\n", fixtures, result.checks, result.failed);
+    return result.failed == 0 ? 0 : 1;
+}
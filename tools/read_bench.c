@@ -0,0 +1,239 @@
+// Benchmark for the batched read engine.
+//
+//   cmake --build build --target snooper_read_bench
+//   ./build/snooper_read_bench --files 10000 --ticks 50 [--dir /proc/sys/kernel]
+//
+// Re-reads --files small files once per tick three ways: open/read/close per
+// file, the read engine's preadv fallback on persistent fds, and the read
+// engine's io_uring backend. By default the files are created in a temporary
+// directory; --dir reads the readable regular files directly under an
+// existing tree instead, repeated to reach --files. Prints one NDJSON line per
+// mode with syscalls per tick and tick latency.
+#include "snooper/read_engine.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_FILE_SIZE 64
+
+typedef struct {
+    char **paths;
+    size_t count;
+} BenchFiles;
+
+static uint64_t monotonic_now_ns(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void raise_fd_limit(size_t needed) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < needed + 64) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static int add_path(BenchFiles *files, size_t limit, const char *path) {
+    if (files->count == limit) return 0;
+    files->paths[files->count] = strdup(path);
+    if (!files->paths[files->count]) return -1;
+    files->count++;
+    return 0;
+}
+
+static int create_files(BenchFiles *files, size_t count, char *dir, size_t dir_size) {
+    snprintf(dir, dir_size, "/tmp/snooper_read_bench.XXXXXX");
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return -1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%zu", dir, i);
+        FILE *file = fopen(path, "w");
+        if (!file) {
+            perror(path);
+            return -1;
+        }
+        fprintf(file, "%zu\n", 1000000 + i * 7);
+        fclose(file);
+        if (add_path(files, count, path) != 0) return -1;
+    }
+    return 0;
+}
+
+static int collect_files(BenchFiles *files, size_t count, const char *dir) {
+    size_t found = 0;
+    while (files->count < count) {
+        DIR *handle = opendir(dir);
+        if (!handle) {
+            perror(dir);
+            return -1;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(handle)) != NULL && files->count < count) {
+            char path[PATH_MAX];
+            struct stat info;
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+            if (stat(path, &info) == 0 && S_ISREG(info.st_mode) && access(path, R_OK) == 0 && add_path(files, count, path) == 0) {
+                ++found;
+            }
+        }
+        closedir(handle);
+        if (found == 0) {
+            fprintf(stderr, "No regular files under %s.\n", dir);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void print_result(const char *mode, size_t file_count, int ticks, uint64_t syscalls, uint64_t *tick_ns) {
+    qsort(tick_ns, (size_t)ticks, sizeof(uint64_t), compare_u64);
+    double sum = 0.0;
+    for (int i = 0; i < ticks; ++i) {
+        sum += (double)tick_ns[i];
+    }
+    size_t p99 = (size_t)ceil(0.99 * ticks);
+    printf("{\"mode\":\"%s\",\"files\":%zu,\"ticks\":%d,\"syscalls_per_tick\":%.1f,\"tick_us\":{\"mean\":%.1f,\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f}}\n"
+           , mode
+           , file_count
+           , ticks
+           , (double)syscalls / ticks
+           , sum / ticks / 1000.0
+           , (double)tick_ns[(ticks - 1) / 2] / 1000.0
+           , (double)tick_ns[p99 > 0 ? p99 - 1 : 0] / 1000.0
+           , (double)tick_ns[ticks - 1] / 1000.0);
+    fflush(stdout);
+}
+
+static void bench_reopen(const BenchFiles *files, int ticks, uint64_t *tick_ns) {
+    char buffer[BENCH_FILE_SIZE];
+    uint64_t syscalls = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        uint64_t start = monotonic_now_ns();
+        for (size_t i = 0; i < files->count; ++i) {
+            int fd = open(files->paths[i], O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            (void)!read(fd, buffer, sizeof(buffer));
+            close(fd);
+            syscalls += 3;
+        }
+        tick_ns[tick] = monotonic_now_ns() - start;
+    }
+    print_result("reopen", files->count, ticks, syscalls, tick_ns);
+}
+
+static int bench_engine(const BenchFiles *files, int ticks, int use_uring, int *fds, uint64_t *tick_ns) {
+    SnooperReadEngine engine;
+    snooper_read_engine_init(&engine, use_uring);
+    for (size_t i = 0; i < files->count; ++i) {
+        if (snooper_read_engine_add(&engine, fds[i], BENCH_FILE_SIZE) < 0) {
+            fprintf(stderr, "Failed to add slot %zu.\n", i);
+            snooper_read_engine_destroy(&engine);
+            return -1;
+        }
+    }
+
+    // The first submit registers fds and buffers; it is not counted.
+    snooper_read_engine_submit(&engine);
+    if (use_uring && strcmp(snooper_read_engine_backend(&engine), "io_uring") != 0) {
+        fprintf(stderr, "io_uring is unavailable; skipping.\n");
+        snooper_read_engine_destroy(&engine);
+        return 0;
+    }
+
+    uint64_t syscalls = engine.syscalls;
+    for (int tick = 0; tick < ticks; ++tick) {
+        uint64_t start = monotonic_now_ns();
+        snooper_read_engine_submit(&engine);
+        tick_ns[tick] = monotonic_now_ns() - start;
+    }
+    print_result(snooper_read_engine_backend(&engine), files->count, ticks, engine.syscalls - syscalls, tick_ns);
+    snooper_read_engine_destroy(&engine);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t file_count = 10000;
+    int ticks = 50;
+    const char *source_dir = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--files") == 0 && i + 1 < argc) {
+            file_count = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            source_dir = argv[++i];
+        } else {
+            printf("Usage: %s [--files <n>] [--ticks <n>] [--dir <path>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (file_count == 0 || ticks <= 0) {
+        fprintf(stderr, "--files and --ticks must be positive.\n");
+        return 1;
+    }
+
+    raise_fd_limit(file_count);
+    BenchFiles files = { calloc(file_count, sizeof(char *)), 0 };
+    uint64_t *tick_ns = calloc((size_t)ticks, sizeof(uint64_t));
+    int *fds = calloc(file_count, sizeof(int));
+    char temp_dir[64] = "";
+    int status = 1;
+    if (!files.paths || !tick_ns || !fds) {
+        fprintf(stderr, "Out of memory.\n");
+        goto done;
+    }
+    if ((source_dir ? collect_files(&files, file_count, source_dir) : create_files(&files, file_count, temp_dir, sizeof(temp_dir))) != 0) {
+        goto done;
+    }
+
+    size_t opened = 0;
+    for (; opened < files.count; ++opened) {
+        fds[opened] = open(files.paths[opened], O_RDONLY | O_CLOEXEC);
+        if (fds[opened] < 0) {
+            perror(files.paths[opened]);
+            break;
+        }
+    }
+    if (opened == files.count) {
+        bench_reopen(&files, ticks, tick_ns);
+        if (bench_engine(&files, ticks, 0, fds, tick_ns) == 0 && bench_engine(&files, ticks, 1, fds, tick_ns) == 0) {
+            status = 0;
+        }
+    }
+    for (size_t i = 0; i < opened; ++i) {
+        close(fds[i]);
+    }
+
+done:
+    for (size_t i = 0; i < files.count; ++i) {
+        if (temp_dir[0]) unlink(files.paths[i]);
+        free(files.paths[i]);
+    }
+    if (temp_dir[0]) rmdir(temp_dir);
+    free(files.paths);
+    free(tick_ns);
+    free(fds);
+    return status;
+}